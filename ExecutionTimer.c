@@ -5,14 +5,38 @@
  * statistics.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "ExecutionTimer.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <limits.h>
 #include <time.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <sys/types.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef HAVE_PERF_EVENTS
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
 
 //
 
@@ -24,17 +48,321 @@ const char* ExecutionTimerMetricNames[] = {
                 "rusage.ru_nswap",
                 "rusage.ru_inblock",
                 "rusage.ru_outblock",
+                "GFLOP/s",
+                "GB/s",
+                "Arithmetic intensity",
+                "perf.cycles",
+                "perf.instructions",
+                "perf.L1D-misses",
+                "perf.LLC-misses",
+                "perf.dTLB-misses",
+                "perf.branch-misses",
+                "IPC",
+                "L1D misses/kflop",
+                "LLC misses/kflop",
+                "Thread imbalance",
+                "Slowest thread",
+                "CPU time",
+                "CPU utilization",
+                "I/O MB/s",
+                "I/O IOPS",
+                "rusage.ru_minflt",
+                "rusage.ru_majflt",
+                "Cache residency",
                 NULL
             };
 
 //
 
+//
+// Each datum records its samples in a log-linear histogram:  every binary
+// order of magnitude is split into EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS linear
+// sub-buckets, so a sample is represented by its bucket's midpoint with a
+// relative error under 1/(2 * EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS).  Positive
+// and negative samples occupy separate key ranges that are grown on demand to
+// span only the orders of magnitude actually seen; zeroes are just counted.
+//
+#ifndef EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS
+#define EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS 64
+#endif
+
+//
+// Number of resamples used to bootstrap the confidence interval on the
+// median, and the Tukey fence multiplier for outliers:
+//
+#ifndef EXECUTIONTIMER_BOOTSTRAP_RESAMPLES
+#define EXECUTIONTIMER_BOOTSTRAP_RESAMPLES 1000
+#endif
+
+//
+// Results whose median walltime is less than this multiple of the median
+// timer overhead are flagged as unreliable:
+//
+#ifndef EXECUTIONTIMER_RELIABILITY_FACTOR
+#define EXECUTIONTIMER_RELIABILITY_FACTOR 10
+#endif
+
+#ifndef EXECUTIONTIMER_TUKEY_FENCE
+#define EXECUTIONTIMER_TUKEY_FENCE 1.5
+#endif
+
+typedef struct ExecutionTimerHistogramRange {
+    int             baseKey;
+    unsigned int    nKeys;
+    unsigned int    *counts;
+} ExecutionTimerHistogramRange;
+
+typedef struct ExecutionTimerHistogram {
+    unsigned int                    count;
+    unsigned int                    nZero;
+    ExecutionTimerHistogramRange    positive;
+    ExecutionTimerHistogramRange    negative;
+} ExecutionTimerHistogram;
+
+//
+
+int
+__ExecutionTimerHistogramKey(
+    double          magnitude
+)
+{
+    int             e, s;
+    double          m = frexp(magnitude, &e);
+
+    // m is in [0.5, 1), so 2m - 1 is the fractional position in the octave:
+    s = (int)((2.0 * m - 1.0) * EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS);
+    if ( s >= EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS ) s = EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS - 1;
+    return e * EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS + s;
+}
+
+//
+
+double
+__ExecutionTimerHistogramKeyValue(
+    int             key
+)
+{
+    int             e, s;
+
+    e = (key >= 0) ? (key / EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS) : -((-key + EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS - 1) / EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS);
+    s = key - e * EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS;
+    return ldexp(0.5 * (1.0 + ((double)s + 0.5) / EXECUTIONTIMER_HISTOGRAM_SUBBUCKETS), e);
+}
+
+//
+
+bool
+__ExecutionTimerHistogramRangeAdd(
+    ExecutionTimerHistogramRange    *r,
+    int                             key
+)
+{
+    if ( r->nKeys == 0 ) {
+        if ( ! (r->counts = (unsigned int*)calloc(1, sizeof(unsigned int))) ) return false;
+        r->baseKey = key;
+        r->nKeys = 1;
+    } else if ( (key < r->baseKey) || (key >= r->baseKey + (int)r->nKeys) ) {
+        int             newBase = (key < r->baseKey) ? key : r->baseKey;
+        int             newEnd = (key >= r->baseKey + (int)r->nKeys) ? (key + 1) : (r->baseKey + (int)r->nKeys);
+        unsigned int    *newCounts = (unsigned int*)calloc(newEnd - newBase, sizeof(unsigned int));
+
+        if ( ! newCounts ) return false;
+        memcpy(newCounts + (r->baseKey - newBase), r->counts, r->nKeys * sizeof(unsigned int));
+        free((void*)r->counts);
+        r->counts = newCounts;
+        r->baseKey = newBase;
+        r->nKeys = newEnd - newBase;
+    }
+    r->counts[key - r->baseKey]++;
+    return true;
+}
+
+//
+
+void
+__ExecutionTimerHistogramReset(
+    ExecutionTimerHistogram *h
+)
+{
+    if ( h->positive.counts ) free((void*)h->positive.counts);
+    if ( h->negative.counts ) free((void*)h->negative.counts);
+    memset(h, 0, sizeof(*h));
+}
+
+//
+
+void
+__ExecutionTimerHistogramAdd(
+    ExecutionTimerHistogram *h,
+    double                  value
+)
+{
+    bool                    ok;
+
+    if ( ! isfinite(value) ) return;
+    if ( value == 0.0 ) {
+        h->nZero++;
+        ok = true;
+    } else if ( value > 0.0 ) {
+        ok = __ExecutionTimerHistogramRangeAdd(&h->positive, __ExecutionTimerHistogramKey(value));
+    } else {
+        ok = __ExecutionTimerHistogramRangeAdd(&h->negative, __ExecutionTimerHistogramKey(-value));
+    }
+    if ( ok ) h->count++;
+}
+
+//
+
+void
+__ExecutionTimerHistogramMerge(
+    ExecutionTimerHistogram *h,
+    ExecutionTimerHistogram *other
+)
+{
+    ExecutionTimerHistogramRange    *ranges[2][2] = { { &h->positive, &other->positive }, { &h->negative, &other->negative } };
+    unsigned int                    r, i;
+
+    //
+    // Both histograms share the same key space, so buckets are merged by
+    // adding their counts:
+    //
+    for ( r = 0; r < 2; r++ ) {
+        ExecutionTimerHistogramRange    *dst = ranges[r][0], *src = ranges[r][1];
+
+        for ( i = 0; i < src->nKeys; i++ ) {
+            int                         key = src->baseKey + (int)i;
+
+            if ( ! src->counts[i] ) continue;
+            if ( ! __ExecutionTimerHistogramRangeAdd(dst, key) ) continue;
+            dst->counts[key - dst->baseKey] += src->counts[i] - 1;
+            h->count += src->counts[i];
+        }
+    }
+    h->nZero += other->nZero;
+    h->count += other->nZero;
+}
+
+//
+
+unsigned int
+__ExecutionTimerHistogramCollect(
+    ExecutionTimerHistogram *h,
+    double                  lowerBound,
+    double                  upperBound,
+    double                  **outValues,
+    unsigned int            **outCounts
+)
+{
+    unsigned int            nBuckets = (h->nZero ? 1 : 0), i;
+    double                  *values;
+    unsigned int            *counts;
+
+    //
+    // Gather the non-empty buckets in ascending order of value; bucket
+    // midpoints are clamped to the exact extrema of the samples:
+    //
+    for ( i = 0; i < h->negative.nKeys; i++ ) if ( h->negative.counts[i] ) nBuckets++;
+    for ( i = 0; i < h->positive.nKeys; i++ ) if ( h->positive.counts[i] ) nBuckets++;
+    if ( nBuckets == 0 ) return 0;
+
+    values = (double*)malloc(nBuckets * (sizeof(double) + sizeof(unsigned int)));
+    if ( ! values ) return 0;
+    counts = (unsigned int*)(values + nBuckets);
+
+    nBuckets = 0;
+    i = h->negative.nKeys;
+    while ( i-- > 0 ) {
+        if ( h->negative.counts[i] ) {
+            values[nBuckets] = -__ExecutionTimerHistogramKeyValue(h->negative.baseKey + (int)i);
+            counts[nBuckets++] = h->negative.counts[i];
+        }
+    }
+    if ( h->nZero ) {
+        values[nBuckets] = 0.0;
+        counts[nBuckets++] = h->nZero;
+    }
+    for ( i = 0; i < h->positive.nKeys; i++ ) {
+        if ( h->positive.counts[i] ) {
+            values[nBuckets] = __ExecutionTimerHistogramKeyValue(h->positive.baseKey + (int)i);
+            counts[nBuckets++] = h->positive.counts[i];
+        }
+    }
+    for ( i = 0; i < nBuckets; i++ ) {
+        if ( values[i] < lowerBound ) values[i] = lowerBound;
+        else if ( values[i] > upperBound ) values[i] = upperBound;
+    }
+    *outValues = values;
+    *outCounts = counts;
+    return nBuckets;
+}
+
+//
+
+double
+__ExecutionTimerWeightedValueAtRank(
+    double          *values,
+    unsigned int    *counts,
+    unsigned int    nBuckets,
+    unsigned int    rank
+)
+{
+    unsigned int    i = 0;
+
+    while ( i + 1 < nBuckets ) {
+        if ( rank < counts[i] ) break;
+        rank -= counts[i++];
+    }
+    return values[i];
+}
+
+//
+
+double
+__ExecutionTimerWeightedQuantile(
+    double          *values,
+    unsigned int    *counts,
+    unsigned int    nBuckets,
+    unsigned int    total,
+    double          q
+)
+{
+    double          pos = q * (double)(total - 1), frac, lo, hi;
+    unsigned int    rank = (unsigned int)pos;
+
+    //
+    // Linear interpolation between the closest ranks:
+    //
+    frac = pos - (double)rank;
+    lo = __ExecutionTimerWeightedValueAtRank(values, counts, nBuckets, rank);
+    if ( frac == 0.0 || rank + 1 >= total ) return lo;
+    hi = __ExecutionTimerWeightedValueAtRank(values, counts, nBuckets, rank + 1);
+    return lo + frac * (hi - lo);
+}
+
+//
+
+typedef struct ExecutionTimerRobustStatistics {
+    unsigned int    count;
+    double          median;
+    double          p90;
+    double          p99;
+    double          mad;
+    double          medianCI95Low;
+    double          medianCI95High;
+    double          outliers;
+} ExecutionTimerRobustStatistics;
+
+//
+
 typedef struct ExecutionTimerDatum {
-    double          value;
-    double          min;
-    double          max;
-    double          m_i;
-    double          s_i;
+    unsigned int                    count;
+    double                          value;
+    double                          min;
+    double                          max;
+    double                          m_i;
+    double                          s_i;
+    ExecutionTimerHistogram         histogram;
+    ExecutionTimerRobustStatistics  robust;
 } ExecutionTimerDatum;
 
 //
@@ -44,6 +372,7 @@ ExecutionTimerDatumReset(
     ExecutionTimerDatum *d
 )
 {
+    __ExecutionTimerHistogramReset(&d->histogram);
     memset(d, 0, sizeof(*d));
 }
 
@@ -52,11 +381,13 @@ ExecutionTimerDatumReset(
 void
 ExecutionTimerDatumUpdate(
     ExecutionTimerDatum *d,
-    unsigned int        n,
     double              value
 )
 {
+    unsigned int        n = ++(d->count);
+
     d->value = value;
+    __ExecutionTimerHistogramAdd(&d->histogram, value);
     if ( n > 1 ) {
         double          m_prev;
 
@@ -79,6 +410,39 @@ ExecutionTimerDatumUpdate(
 
 //
 
+void
+ExecutionTimerDatumMerge(
+    ExecutionTimerDatum *d,
+    ExecutionTimerDatum *other
+)
+{
+    if ( other->count == 0 ) return;
+    if ( d->count == 0 ) {
+        d->min = other->min;
+        d->max = other->max;
+        d->m_i = other->m_i;
+        d->s_i = other->s_i;
+    } else {
+        double          na = (double)d->count, nb = (double)other->count, n = na + nb;
+        double          delta = other->m_i - d->m_i;
+
+        //
+        // Combine the running variance accumulators of the two partitions:
+        //   ( Chan, Golub & LeVeque, "Updating formulae and a pairwise
+        //     algorithm for computing sample variances", 1979 )
+        //
+        d->m_i += delta * nb / n;
+        d->s_i += other->s_i + delta * delta * na * nb / n;
+        if ( other->min < d->min ) d->min = other->min;
+        if ( other->max > d->max ) d->max = other->max;
+    }
+    d->count += other->count;
+    d->value = other->value;
+    __ExecutionTimerHistogramMerge(&d->histogram, &other->histogram);
+}
+
+//
+
 double
 ExecutionTimerDatumGetAverage(
     ExecutionTimerDatum *d
@@ -91,228 +455,2147 @@ ExecutionTimerDatumGetAverage(
 
 double
 ExecutionTimerDatumGetVariance(
-    ExecutionTimerDatum *d,
-    unsigned int        n
+    ExecutionTimerDatum *d
 )
 {
-    return d->s_i / (double)(n - 1);
+    return d->s_i / (double)(d->count - 1);
 }
 
 //
 
 double
 ExecutionTimerDatumGetStdDeviation(
-    ExecutionTimerDatum *d,
-    unsigned int        n
+    ExecutionTimerDatum *d
 )
 {
-    return sqrt(ExecutionTimerDatumGetVariance(d, n));
+    return sqrt(ExecutionTimerDatumGetVariance(d));
 }
 
-//
-////
 //
 
-typedef struct ExecutionTimer {
-    unsigned int            refCount;
-    bool                    isStarted;
+double
+__ExecutionTimerStudentT975(
+    unsigned int        df
+)
+{
+    //
+    // Two-sided 95% quantiles of Student's t distribution; beyond the table
+    // the first-order Cornish-Fisher expansion about z = 1.96 suffices:
+    //
+    static const double tTable[] = {
+                    INFINITY,
+                    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+                };
+
+    if ( df < sizeof(tTable) / sizeof(double) ) return tTable[df];
+    return 1.959964 + 2.372 / (double)df;
+}
 
-    struct timespec         startTime, endTime;
-    struct rusage           startUsage, endUsage;
+//
 
-    unsigned int            cycleCount;
-    ExecutionTimerDatum     metrics[ExecutionTimerMetricEOL];
-} ExecutionTimer;
+double
+ExecutionTimerDatumGetMeanCI95(
+    ExecutionTimerDatum *d
+)
+{
+    return __ExecutionTimerStudentT975(d->count - 1) * ExecutionTimerDatumGetStdDeviation(d) / sqrt((double)d->count);
+}
 
 //
 
-void
-__ExecutionTimerReset(
-    ExecutionTimer  *aTimer
+int
+__ExecutionTimerDoubleCompare(
+    const void      *a,
+    const void      *b
 )
 {
-    int             i;
+    double          A = *((const double*)a), B = *((const double*)b);
 
-    aTimer->isStarted = false;
-    aTimer->cycleCount = 0;
-    for ( i = 0; i < ExecutionTimerMetricEOL; i++ ) ExecutionTimerDatumReset(&aTimer->metrics[i]);
+    return (A < B) ? -1 : ((A > B) ? 1 : 0);
 }
 
 //
 
-void
-__ExecutionTimerUpdateMetrics(
-    ExecutionTimer  *aTimer
+typedef struct ExecutionTimerDeviation {
+    double          deviation;
+    unsigned int    count;
+} ExecutionTimerDeviation;
+
+int
+__ExecutionTimerDeviationCompare(
+    const void      *a,
+    const void      *b
 )
 {
-    double          v;
-
-    aTimer->cycleCount++;
+    double          A = ((const ExecutionTimerDeviation*)a)->deviation, B = ((const ExecutionTimerDeviation*)b)->deviation;
 
-    v = (double)(aTimer->endTime.tv_sec - aTimer->startTime.tv_sec);
-    v += 1e-9 * (double)(aTimer->endTime.tv_nsec - aTimer->startTime.tv_nsec);
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricWalltime], aTimer->cycleCount, v);
+    return (A < B) ? -1 : ((A > B) ? 1 : 0);
+}
 
-    v = (aTimer->endUsage.ru_utime.tv_sec - aTimer->startUsage.ru_utime.tv_sec);
-    v += 1e-6 * (aTimer->endUsage.ru_utime.tv_usec - aTimer->startUsage.ru_utime.tv_usec);
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricUserCPU], aTimer->cycleCount, v);
+//
 
-    v = (aTimer->endUsage.ru_stime.tv_sec - aTimer->startUsage.ru_stime.tv_sec);
-    v += 1e-6 * (aTimer->endUsage.ru_stime.tv_usec - aTimer->startUsage.ru_stime.tv_usec);
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricSystemCPU], aTimer->cycleCount, v);
+static inline uint64_t
+__ExecutionTimerXorshift64(
+    uint64_t        *state
+)
+{
+    uint64_t        x = *state;
 
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricMaxRSS], aTimer->cycleCount, (double)aTimer->endUsage.ru_maxrss);
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
 
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricNSwaps], aTimer->cycleCount, (double)(aTimer->endUsage.ru_nswap - aTimer->startUsage.ru_nswap));
+//
 
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOBlocksIn], aTimer->cycleCount, (double)(aTimer->endUsage.ru_inblock - aTimer->startUsage.ru_inblock));
+void
+__ExecutionTimerDatumBootstrapMedian(
+    ExecutionTimerDatum *d,
+    double              *values,
+    unsigned int        *counts,
+    unsigned int        nBuckets
+)
+{
+    unsigned int        total = d->histogram.count, b, i;
+    unsigned int        *cumulative = (unsigned int*)malloc(2 * nBuckets * sizeof(unsigned int));
+    unsigned int        *resampled;
+    double              *medians = (double*)malloc(EXECUTIONTIMER_BOOTSTRAP_RESAMPLES * sizeof(double));
+    uint64_t            rngState = 0x9E3779B97F4A7C15ULL;
+
+    d->robust.medianCI95Low = d->robust.medianCI95High = INFINITY;
+    if ( ! cumulative || ! medians ) goto early_exit;
+    resampled = cumulative + nBuckets;
+
+    cumulative[0] = counts[0];
+    for ( i = 1; i < nBuckets; i++ ) cumulative[i] = cumulative[i - 1] + counts[i];
+
+    //
+    // Each resample draws total samples (with replacement) from the
+    // histogram; only the per-bucket counts of the resample are needed
+    // to locate its median.  A fixed seed keeps the interval reproducible:
+    //
+    for ( b = 0; b < EXECUTIONTIMER_BOOTSTRAP_RESAMPLES; b++ ) {
+        memset(resampled, 0, nBuckets * sizeof(unsigned int));
+        for ( i = 0; i < total; i++ ) {
+            unsigned int    r = (unsigned int)((double)(__ExecutionTimerXorshift64(&rngState) >> 11) * 0x1.0p-53 * (double)total);
+            unsigned int    lo = 0, hi = nBuckets - 1;
+
+            while ( lo < hi ) {
+                unsigned int    mid = (lo + hi) / 2;
+
+                if ( r < cumulative[mid] ) hi = mid; else lo = mid + 1;
+            }
+            resampled[lo]++;
+        }
+        medians[b] = __ExecutionTimerWeightedQuantile(values, resampled, nBuckets, total, 0.5);
+    }
+    qsort(medians, EXECUTIONTIMER_BOOTSTRAP_RESAMPLES, sizeof(double), __ExecutionTimerDoubleCompare);
+    d->robust.medianCI95Low = medians[(unsigned int)(0.025 * (EXECUTIONTIMER_BOOTSTRAP_RESAMPLES - 1))];
+    d->robust.medianCI95High = medians[(unsigned int)(0.975 * (EXECUTIONTIMER_BOOTSTRAP_RESAMPLES - 1) + 0.5)];
 
-    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOBlocksOut], aTimer->cycleCount, (double)(aTimer->endUsage.ru_oublock - aTimer->startUsage.ru_oublock));
+early_exit:
+    if ( medians ) free((void*)medians);
+    if ( cumulative ) free((void*)cumulative);
 }
 
 //
 
-ExecutionTimerRef
-ExecutionTimerCreate(void)
+void
+__ExecutionTimerDatumUpdateRobustStatistics(
+    ExecutionTimerDatum *d
+)
 {
-    ExecutionTimer  *newTimer = (ExecutionTimer*)malloc(sizeof(ExecutionTimer));
+    ExecutionTimerHistogram *h = &d->histogram;
+    double                  *values = NULL;
+    unsigned int            *counts = NULL, nBuckets, i;
+    ExecutionTimerDeviation *deviations;
+
+    if ( d->robust.count == d->count ) return;
+    d->robust.count = d->count;
+    d->robust.median = d->robust.p90 = d->robust.p99 = d->robust.mad = INFINITY;
+    d->robust.medianCI95Low = d->robust.medianCI95High = d->robust.outliers = INFINITY;
+
+    if ( (nBuckets = __ExecutionTimerHistogramCollect(h, d->min, d->max, &values, &counts)) == 0 ) return;
+
+    d->robust.median = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.5);
+    d->robust.p90 = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.9);
+    d->robust.p99 = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.99);
+
+    //
+    // Tukey outliers lie more than EXECUTIONTIMER_TUKEY_FENCE interquartile
+    // ranges beyond the first or third quartile:
+    //
+    {
+        double              q1 = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.25);
+        double              q3 = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.75);
+        double              lowerFence = q1 - EXECUTIONTIMER_TUKEY_FENCE * (q3 - q1);
+        double              upperFence = q3 + EXECUTIONTIMER_TUKEY_FENCE * (q3 - q1);
+        unsigned int        nOutliers = 0;
+
+        for ( i = 0; i < nBuckets; i++ ) if ( (values[i] < lowerFence) || (values[i] > upperFence) ) nOutliers += counts[i];
+        d->robust.outliers = nOutliers;
+    }
 
-    if ( newTimer ) {
-        newTimer->refCount = 1;
-        __ExecutionTimerReset(newTimer);
+    __ExecutionTimerDatumBootstrapMedian(d, values, counts, nBuckets);
+
+    //
+    // Median absolute deviation:  re-sort the buckets by their distance from
+    // the median:
+    //
+    if ( (deviations = (ExecutionTimerDeviation*)malloc(nBuckets * sizeof(ExecutionTimerDeviation))) ) {
+        for ( i = 0; i < nBuckets; i++ ) {
+            deviations[i].deviation = fabs(values[i] - d->robust.median);
+            deviations[i].count = counts[i];
+        }
+        qsort(deviations, nBuckets, sizeof(ExecutionTimerDeviation), __ExecutionTimerDeviationCompare);
+        for ( i = 0; i < nBuckets; i++ ) {
+            values[i] = deviations[i].deviation;
+            counts[i] = deviations[i].count;
+        }
+        d->robust.mad = __ExecutionTimerWeightedQuantile(values, counts, nBuckets, h->count, 0.5);
+        free((void*)deviations);
     }
-    return (ExecutionTimerRef)newTimer;
+    free((void*)values);
 }
 
 //
 
-ExecutionTimerRef
-ExecutionTimerRetain(
-    ExecutionTimerRef   aTimer
+double
+ExecutionTimerDatumGetValue(
+    ExecutionTimerDatum *d,
+    ExecutionTimerValue theValue
 )
 {
-    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+    if ( d->count > 1 ) {
+        switch ( theValue ) {
+            case ExecutionTimerValueLastValue:
+                return d->value;
+            case ExecutionTimerValueMin:
+                return d->min;
+            case ExecutionTimerValueMax:
+                return d->max;
+            case ExecutionTimerValueAverage:
+                return ExecutionTimerDatumGetAverage(d);
+            case ExecutionTimerValueVariance:
+                return ExecutionTimerDatumGetVariance(d);
+            case ExecutionTimerValueStdDeviation:
+                return ExecutionTimerDatumGetStdDeviation(d);
+            case ExecutionTimerValueMeanCI95:
+                return ExecutionTimerDatumGetMeanCI95(d);
+            case ExecutionTimerValueMedian:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.median;
+            case ExecutionTimerValueP90:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.p90;
+            case ExecutionTimerValueP99:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.p99;
+            case ExecutionTimerValueMAD:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.mad;
+            case ExecutionTimerValueMedianCI95Low:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.medianCI95Low;
+            case ExecutionTimerValueMedianCI95High:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.medianCI95High;
+            case ExecutionTimerValueOutliers:
+                __ExecutionTimerDatumUpdateRobustStatistics(d);
+                return d->robust.outliers;
 
-    TIMER->refCount++;
-    return aTimer;
+            default:
+                break;
+        }
+    } else if ( d->count > 0 && theValue == ExecutionTimerValueLastValue ) {
+        return d->value;
+    }
+    return INFINITY;
 }
 
+//
+////
 //
 
-void
-ExecutionTimerRelease(
-    ExecutionTimerRef   aTimer
-)
+#ifdef HAVE_PERF_EVENTS
+
+//
+// Hardware events counted by the perf_event metric group, in the same order
+// as the ExecutionTimerMetricHW* metrics.  The first event (cycles) acts as
+// the group leader.
+//
+enum {
+    ExecutionTimerHWEventCycles = 0,
+    ExecutionTimerHWEventInstructions,
+    ExecutionTimerHWEventL1DMisses,
+    ExecutionTimerHWEventLLCMisses,
+    ExecutionTimerHWEventDTLBMisses,
+    ExecutionTimerHWEventBranchMisses,
+    //
+    ExecutionTimerHWEventMax
+};
+
+static const struct {
+    uint32_t    type;
+    uint64_t    config;
+} ExecutionTimerHWEvents[ExecutionTimerHWEventMax] = {
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+            };
+
+//
+// A reading of a single event:  the raw count plus the times the event was
+// enabled and actually running (which differ when the PMU is multiplexed).
+//
+typedef struct {
+    uint64_t    value;
+    uint64_t    timeEnabled;
+    uint64_t    timeRunning;
+} ExecutionTimerHWReading;
+
+typedef struct ExecutionTimerHWCounters {
+    int                     fd[ExecutionTimerHWEventMax];
+    ExecutionTimerHWReading start[ExecutionTimerHWEventMax];
+    ExecutionTimerHWReading end[ExecutionTimerHWEventMax];
+} ExecutionTimerHWCounters;
+
+//
+
+int
+__ExecutionTimerHWParanoidLevel(void)
 {
-    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+    FILE        *fptr = fopen("/proc/sys/kernel/perf_event_paranoid", "r");
+    int         level = INT_MAX;
 
-    if ( --(TIMER->refCount) == 0 ) free((void*)aTimer);
+    if ( fptr ) {
+        if ( fscanf(fptr, "%d", &level) != 1 ) level = INT_MAX;
+        fclose(fptr);
+    }
+    return level;
 }
 
 //
 
-void
-ExecutionTimerReset(
-    ExecutionTimerRef   aTimer
+int
+__ExecutionTimerHWOpenEvent(
+    unsigned int    event,
+    int             groupFd
 )
 {
-    __ExecutionTimerReset((ExecutionTimer*)aTimer);
+    struct perf_event_attr  attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = ExecutionTimerHWEvents[event].type;
+    attr.config = ExecutionTimerHWEvents[event].config;
+    attr.disabled = (groupFd < 0) ? 1 : 0;
+    // Count threads (e.g. OpenMP workers) spawned after the group is opened:
+    attr.inherit = 1;
+    // User-space only so that perf_event_paranoid <= 2 is sufficient:
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // PERF_FORMAT_GROUP is not permitted with inherit, so each member of the
+    // group is read individually with its own scaling times:
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
 }
 
 //
 
-bool
-ExecutionTimerIsStarted(
-    ExecutionTimerRef   aTimer
-)
+ExecutionTimerHWCounters*
+__ExecutionTimerHWCountersCreate(void)
 {
-    return aTimer->isStarted;
+    ExecutionTimerHWCounters    *counters = malloc(sizeof(ExecutionTimerHWCounters));
+
+    if ( counters ) {
+        unsigned int            event;
+
+        for ( event = 0; event < ExecutionTimerHWEventMax; event++ ) counters->fd[event] = -1;
+
+        counters->fd[ExecutionTimerHWEventCycles] = __ExecutionTimerHWOpenEvent(ExecutionTimerHWEventCycles, -1);
+        if ( counters->fd[ExecutionTimerHWEventCycles] < 0 ) {
+            int                 savedErrno = errno;
+
+            fprintf(stderr, "WARNING:  hardware performance counters unavailable (errno = %d, perf_event_paranoid = %d); continuing without them\n", savedErrno, __ExecutionTimerHWParanoidLevel());
+            free((void*)counters);
+            return NULL;
+        }
+        // Events the PMU does not support are simply omitted from the group:
+        for ( event = ExecutionTimerHWEventCycles + 1; event < ExecutionTimerHWEventMax; event++ ) {
+            counters->fd[event] = __ExecutionTimerHWOpenEvent(event, counters->fd[ExecutionTimerHWEventCycles]);
+        }
+        memset(counters->start, 0, sizeof(counters->start));
+        memset(counters->end, 0, sizeof(counters->end));
+        ioctl(counters->fd[ExecutionTimerHWEventCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(counters->fd[ExecutionTimerHWEventCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    return counters;
 }
 
 //
 
-bool
-ExecutionTimerHasStatistics(
-    ExecutionTimerRef   aTimer
+void
+__ExecutionTimerHWCountersDestroy(
+    ExecutionTimerHWCounters    *counters
 )
 {
-    return (aTimer->cycleCount > 1) ? true : false;
+    unsigned int                event = ExecutionTimerHWEventMax;
+
+    // Close group members before the leader:
+    while ( event-- > 0 ) if ( counters->fd[event] >= 0 ) close(counters->fd[event]);
+    free((void*)counters);
 }
 
 //
 
 void
-ExecutionTimerStart(
-    ExecutionTimerRef   aTimer
+__ExecutionTimerHWCountersRead(
+    ExecutionTimerHWCounters    *counters,
+    ExecutionTimerHWReading     *readings
 )
 {
-    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+    unsigned int                event;
 
-    TIMER->isStarted = true;
-    clock_gettime(CLOCK_MONOTONIC, &TIMER->startTime);
-    getrusage(RUSAGE_SELF, &TIMER->startUsage);
+    for ( event = 0; event < ExecutionTimerHWEventMax; event++ ) {
+        if ( (counters->fd[event] < 0) || (read(counters->fd[event], &readings[event], sizeof(readings[event])) != sizeof(readings[event])) ) {
+            memset(&readings[event], 0, sizeof(readings[event]));
+        }
+    }
 }
 
 //
 
-void
-ExecutionTimerStop(
-    ExecutionTimerRef   aTimer
+bool
+__ExecutionTimerHWCountersGetDelta(
+    ExecutionTimerHWCounters    *counters,
+    unsigned int                event,
+    double                      *delta
+)
+{
+    uint64_t                    enabled, running;
+
+    if ( counters->fd[event] < 0 ) return false;
+
+    enabled = counters->end[event].timeEnabled - counters->start[event].timeEnabled;
+    running = counters->end[event].timeRunning - counters->start[event].timeRunning;
+
+    // Never scheduled onto the PMU during the cycle, no estimate possible:
+    if ( running == 0 ) return false;
+
+    *delta = (double)(counters->end[event].value - counters->start[event].value);
+    // Scale up for the fraction of time the group was multiplexed out:
+    if ( running < enabled ) *delta *= (double)enabled / (double)running;
+    return true;
+}
+
+#else /* HAVE_PERF_EVENTS */
+
+typedef struct ExecutionTimerHWCounters ExecutionTimerHWCounters;
+
+#endif /* HAVE_PERF_EVENTS */
+
+//
+////
+//
+
+//
+// Per-thread busy-time slot.  Each thread participating in a parallel region
+// writes only its own slot, and slots are padded to a cache line to avoid
+// false sharing.  The busy* and ioBytes fields accumulate over a single
+// start-stop cycle.  When threads are sampled from /proc, each slot belongs
+// to a single task (tid) for the life of the statistics.
+//
+typedef struct ExecutionTimerThreadSlot {
+    bool                    isActive;
+    pid_t                   tid;
+    unsigned int            slowestCount;   // cycles in which the slot was slowest
+    struct timespec         startTime, startCPU;
+    double                  busyWall, busyCPU;
+    double                  ioBytes;
+    ExecutionTimerDatum     cpuTime;
+    ExecutionTimerDatum     ioRate;
+} __attribute__((aligned(64))) ExecutionTimerThreadSlot;
+
+//
+
+double
+__ExecutionTimerTimespecDelta(
+    struct timespec     *t0,
+    struct timespec     *t1
+)
+{
+    return (double)(t1->tv_sec - t0->tv_sec) + 1e-9 * (double)(t1->tv_nsec - t0->tv_nsec);
+}
+
+//
+
+typedef struct ExecutionTimerTaskSample {
+    pid_t               tid;
+    double              cpu;
+} ExecutionTimerTaskSample;
+
+//
+
+int
+__ExecutionTimerTaskSampleCompare(
+    const void          *a,
+    const void          *b
+)
+{
+    pid_t               tidA = ((ExecutionTimerTaskSample*)a)->tid, tidB = ((ExecutionTimerTaskSample*)b)->tid;
+
+    return (tidA < tidB) ? -1 : ((tidA > tidB) ? 1 : 0);
+}
+
+//
+
+double
+__ExecutionTimerTaskCPUTime(
+    const char          *tidStr
+)
+{
+    char                path[64];
+    FILE                *fptr;
+    double              cpu = -1.0;
+
+    // schedstat has nanosecond resolution but is not present on all kernels:
+    snprintf(path, sizeof(path), "/proc/self/task/%s/schedstat", tidStr);
+    if ( (fptr = fopen(path, "r")) ) {
+        unsigned long long  ns;
+
+        if ( fscanf(fptr, "%llu", &ns) == 1 ) cpu = 1e-9 * (double)ns;
+        fclose(fptr);
+    } else {
+        snprintf(path, sizeof(path), "/proc/self/task/%s/stat", tidStr);
+        if ( (fptr = fopen(path, "r")) ) {
+            unsigned long       utime, stime;
+
+            // Skip the comm field, which may contain spaces:
+            if ( (fscanf(fptr, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) == 2) ) {
+                cpu = (double)(utime + stime) / (double)sysconf(_SC_CLK_TCK);
+            }
+            fclose(fptr);
+        }
+    }
+    return cpu;
+}
+
+//
+
+bool
+__ExecutionTimerSampleTasks(
+    ExecutionTimerTaskSample    **samples,
+    unsigned int                *nSamples,
+    unsigned int                *capacity
+)
+{
+    DIR                         *dir = opendir("/proc/self/task");
+    struct dirent               *entry;
+
+    *nSamples = 0;
+    if ( ! dir ) return false;
+    while ( (entry = readdir(dir)) ) {
+        double                  cpu;
+
+        if ( entry->d_name[0] < '0' || entry->d_name[0] > '9' ) continue;
+        if ( (cpu = __ExecutionTimerTaskCPUTime(entry->d_name)) < 0.0 ) continue;
+        if ( *nSamples >= *capacity ) {
+            unsigned int                newCapacity = *capacity + 16;
+            ExecutionTimerTaskSample    *newSamples = realloc(*samples, newCapacity * sizeof(ExecutionTimerTaskSample));
+
+            if ( ! newSamples ) break;
+            *samples = newSamples;
+            *capacity = newCapacity;
+        }
+        (*samples)[*nSamples].tid = (pid_t)strtol(entry->d_name, NULL, 10);
+        (*samples)[*nSamples].cpu = cpu;
+        (*nSamples)++;
+    }
+    closedir(dir);
+    qsort(*samples, *nSamples, sizeof(ExecutionTimerTaskSample), __ExecutionTimerTaskSampleCompare);
+    return true;
+}
+
+//
+////
+//
+
+//
+// Lightweight timing:  the time-stamp counter is read directly (x86) and
+// converted to seconds with a ratio calibrated against CLOCK_MONOTONIC_RAW.
+// Without an invariant TSC (or on other architectures) CLOCK_MONOTONIC_RAW
+// itself is read, which the vDSO still services without a syscall.
+//
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define EXECUTIONTIMER_HAVE_TSC
+#endif
+
+#ifndef EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS
+#define EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS 5
+#endif
+
+#ifndef EXECUTIONTIMER_TSC_CALIBRATION_NSEC
+#define EXECUTIONTIMER_TSC_CALIBRATION_NSEC 10000000
+#endif
+
+static bool __ExecutionTimerTSCIsCalibrated = false;
+static bool __ExecutionTimerTSCIsInvariant = false;
+static double __ExecutionTimerTSCFrequency = 0.0;
+
+//
+
+static inline uint64_t
+__ExecutionTimerRawNanoseconds(void)
+{
+    struct timespec     t;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+//
+
+static inline uint64_t
+__ExecutionTimerTicksStart(void)
+{
+#ifdef EXECUTIONTIMER_HAVE_TSC
+    if ( __ExecutionTimerTSCIsInvariant ) {
+        uint64_t        ticks;
+
+        // Earlier instructions retire before the read, later ones wait for it:
+        _mm_lfence();
+        ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+    }
+#endif
+    return __ExecutionTimerRawNanoseconds();
+}
+
+//
+
+static inline uint64_t
+__ExecutionTimerTicksStop(void)
+{
+#ifdef EXECUTIONTIMER_HAVE_TSC
+    if ( __ExecutionTimerTSCIsInvariant ) {
+        unsigned int    aux;
+        uint64_t        ticks;
+
+        // rdtscp waits for the timed instructions to complete:
+        ticks = __rdtscp(&aux);
+        _mm_lfence();
+        return ticks;
+    }
+#endif
+    return __ExecutionTimerRawNanoseconds();
+}
+
+//
+
+bool
+ExecutionTimerCalibrateTSC(void)
+{
+    if ( __ExecutionTimerTSCIsCalibrated ) return __ExecutionTimerTSCIsInvariant;
+    __ExecutionTimerTSCIsCalibrated = true;
+    __ExecutionTimerTSCFrequency = 1e9;
+#ifdef EXECUTIONTIMER_HAVE_TSC
+    {
+        unsigned int    eax, ebx, ecx, edx;
+        double          ratios[EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS];
+        int             round;
+
+        //
+        // CPUID leaf 0x80000007, EDX bit 8:  the TSC ticks at a constant rate
+        // in all ACPI P-, C-, and T-states:
+        //
+        if ( ! __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || ! (edx & (1 << 8)) ) {
+            fprintf(stderr, "WARNING:  no invariant TSC; lightweight timers will use CLOCK_MONOTONIC_RAW\n");
+            return false;
+        }
+        for ( round = 0; round < EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS; round++ ) {
+            uint64_t    t0, t1, tsc0, tsc1, a, b;
+
+            // Bracket each clock reading with TSC reads and use the midpoint:
+            a = __rdtsc(); t0 = __ExecutionTimerRawNanoseconds(); b = __rdtsc();
+            tsc0 = a + (b - a) / 2;
+            while ( __ExecutionTimerRawNanoseconds() - t0 < EXECUTIONTIMER_TSC_CALIBRATION_NSEC );
+            a = __rdtsc(); t1 = __ExecutionTimerRawNanoseconds(); b = __rdtsc();
+            tsc1 = a + (b - a) / 2;
+            ratios[round] = 1e9 * (double)(tsc1 - tsc0) / (double)(t1 - t0);
+        }
+        qsort(ratios, EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS, sizeof(double), __ExecutionTimerDoubleCompare);
+        __ExecutionTimerTSCFrequency = ratios[EXECUTIONTIMER_TSC_CALIBRATION_ROUNDS / 2];
+        __ExecutionTimerTSCIsInvariant = true;
+    }
+#endif
+    return __ExecutionTimerTSCIsInvariant;
+}
+
+//
+
+double
+ExecutionTimerGetTSCFrequency(void)
+{
+    ExecutionTimerCalibrateTSC();
+    return __ExecutionTimerTSCIsInvariant ? __ExecutionTimerTSCFrequency : 0.0;
+}
+
+//
+////
+//
+
+//
+// Named regions within a cycle form a tree below an unnamed root; each node
+// accumulates its time over the cycle and then adds it to its datum.
+//
+typedef struct ExecutionTimerRegion {
+    char                            *name;
+    struct ExecutionTimerRegion     *parent, *firstChild, *nextSibling;
+    bool                            isActive;
+    double                          startTime, cycleTime;
+    ExecutionTimerDatum             time;
+} ExecutionTimerRegion;
+
+//
+
+//
+// Start/stop cycles issued from any thread other than the one that created
+// the timer -- or from inside an OpenMP parallel region -- are accumulated
+// in a shard private to the calling thread.  Shards are pushed onto a
+// lock-free list and folded into the timer's walltime and CPU time metrics
+// when its values are next read.
+//
+typedef struct ExecutionTimerShard {
+    pthread_t                       owner;
+    struct ExecutionTimerShard      *next;
+    bool                            isStarted;
+    unsigned int                    batchCount;
+    double                          startTime;
+    struct timespec                 startCPUTime;
+    ExecutionTimerDatum             walltime, cpuTime;
+} __attribute__((aligned(64))) ExecutionTimerShard;
+
+//
+// Each timer gets a unique serial number so that a thread's most recently
+// used shard can be cached without ever matching a freed (and reused) timer:
+//
+static atomic_ulong __ExecutionTimerNextSerial = 1;
+
+static __thread struct {
+    unsigned long           serial;
+    ExecutionTimerShard     *shard;
+} __ExecutionTimerShardCache = { 0, NULL };
+
+//
+
+typedef struct ExecutionTimer {
+    atomic_uint             refCount;
+    char                    *name;
+    bool                    isStarted;
+
+    pthread_t                       owner;
+    unsigned long                   serial;
+    _Atomic(ExecutionTimerShard*)   shards;
+
+    struct timespec         startTime, endTime;
+    struct rusage           startUsage, endUsage;
+
+    ExecutionTimerScope     scope;
+    struct timespec         startCPUTime, endCPUTime;
+    unsigned int            cycleThreads;
+
+    ExecutionTimerClock     clock;
+    uint64_t                startTicks, endTicks;
+    unsigned int            batchSize, batchCount;
+
+    bool                    hasOverhead, shouldSubtractOverhead;
+    double                  overheadMedian;
+    ExecutionTimerDatum     overhead;
+
+    ExecutionTimerRegion    regionRoot;
+    ExecutionTimerRegion    *currentRegion;
+
+    bool                    hasWorkModel;
+    double                  workFlops, workBytes;
+
+    atomic_ulong            ioBytes, ioOperations;
+    double                  cacheResidency;     // NAN if none has been noted
+
+    ExecutionTimerHWCounters    *hwCounters;
+
+    unsigned int                nThreadSlots;
+    ExecutionTimerThreadSlot    *threadSlots;
+    bool                        shouldSampleTasks;
+    unsigned int                nTaskSamples, taskSamplesCapacity;
+    ExecutionTimerTaskSample    *taskSamples;
+
+    bool                    shouldRecordSamples;
+    unsigned int            nSamples, samplesCapacity;
+    double                  *samples[ExecutionTimerMetricEOL];
+
+    unsigned int            cycleCount;
+    ExecutionTimerDatum     metrics[ExecutionTimerMetricEOL];
+} ExecutionTimer;
+
+//
+
+static ExecutionTimerEventHook __ExecutionTimerEventHook = NULL;
+static void *__ExecutionTimerEventHookContext = NULL;
+
+static inline void
+__ExecutionTimerNotify(
+    ExecutionTimer          *aTimer,
+    ExecutionTimerEvent     theEvent,
+    const char              *label
+)
+{
+    if ( __ExecutionTimerEventHook && aTimer->name ) __ExecutionTimerEventHook(aTimer, theEvent, label, __ExecutionTimerEventHookContext);
+}
+
+//
+
+static inline double
+__ExecutionTimerNow(
+    ExecutionTimer  *aTimer
+)
+{
+    if ( aTimer->clock == ExecutionTimerClockTSC ) {
+        return (double)__ExecutionTimerTicksStop() / (__ExecutionTimerTSCIsInvariant ? __ExecutionTimerTSCFrequency : 1e9);
+    } else {
+        struct timespec t;
+
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+    }
+}
+
+//
+
+void
+__ExecutionTimerRegionFreeChildren(
+    ExecutionTimerRegion    *aRegion
+)
+{
+    ExecutionTimerRegion    *child = aRegion->firstChild;
+
+    while ( child ) {
+        ExecutionTimerRegion    *next = child->nextSibling;
+
+        __ExecutionTimerRegionFreeChildren(child);
+        ExecutionTimerDatumReset(&child->time);
+        free((void*)child->name);
+        free((void*)child);
+        child = next;
+    }
+    aRegion->firstChild = NULL;
+}
+
+//
+
+void
+__ExecutionTimerRegionUpdate(
+    ExecutionTimerRegion    *aRegion,
+    double                  perCall
+)
+{
+    ExecutionTimerRegion    *child;
+
+    for ( child = aRegion->firstChild; child; child = child->nextSibling ) {
+        if ( child->isActive ) {
+            ExecutionTimerDatumUpdate(&child->time, perCall * child->cycleTime);
+            child->isActive = false;
+            child->cycleTime = 0.0;
+        }
+        __ExecutionTimerRegionUpdate(child, perCall);
+    }
+}
+
+//
+
+static inline void
+__ExecutionTimerGetUsage(
+    ExecutionTimer  *aTimer,
+    struct rusage   *usage,
+    struct timespec *cpuTime
+)
+{
+    if ( aTimer->scope == ExecutionTimerScopeThread ) {
+#ifdef RUSAGE_THREAD
+        getrusage(RUSAGE_THREAD, usage);
+#else
+        getrusage(RUSAGE_SELF, usage);
+#endif
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, cpuTime);
+    } else {
+        getrusage(RUSAGE_SELF, usage);
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, cpuTime);
+    }
+}
+
+//
+
+void
+__ExecutionTimerFreeShards(
+    ExecutionTimer          *aTimer
+)
+{
+    ExecutionTimerShard     *shard = atomic_exchange(&aTimer->shards, NULL);
+
+    while ( shard ) {
+        ExecutionTimerShard *next = shard->next;
+
+        ExecutionTimerDatumReset(&shard->walltime);
+        ExecutionTimerDatumReset(&shard->cpuTime);
+        free((void*)shard);
+        shard = next;
+    }
+    // Cached pointers into the list are now stale:
+    aTimer->serial = atomic_fetch_add(&__ExecutionTimerNextSerial, 1);
+}
+
+//
+
+ExecutionTimerShard*
+__ExecutionTimerGetShard(
+    ExecutionTimer          *aTimer
+)
+{
+    ExecutionTimerShard     *shard;
+    pthread_t               self;
+
+    if ( __ExecutionTimerShardCache.serial == aTimer->serial ) return __ExecutionTimerShardCache.shard;
+
+    self = pthread_self();
+    for ( shard = atomic_load_explicit(&aTimer->shards, memory_order_acquire); shard; shard = shard->next ) {
+        if ( pthread_equal(shard->owner, self) ) break;
+    }
+    if ( ! shard ) {
+        if ( posix_memalign((void**)&shard, 64, sizeof(ExecutionTimerShard)) != 0 ) return NULL;
+        memset(shard, 0, sizeof(*shard));
+        shard->owner = self;
+        shard->next = atomic_load_explicit(&aTimer->shards, memory_order_relaxed);
+        while ( ! atomic_compare_exchange_weak_explicit(&aTimer->shards, &shard->next, shard, memory_order_release, memory_order_relaxed) );
+    }
+    __ExecutionTimerShardCache.serial = aTimer->serial;
+    __ExecutionTimerShardCache.shard = shard;
+    return shard;
+}
+
+//
+
+static inline bool
+__ExecutionTimerShouldUseShard(
+    ExecutionTimer          *aTimer
+)
+{
+#ifdef HAVE_OPENMP
+    if ( omp_in_parallel() ) return true;
+#endif
+    return pthread_equal(aTimer->owner, pthread_self()) ? false : true;
+}
+
+//
+
+void
+__ExecutionTimerMergeShards(
+    ExecutionTimer          *aTimer
+)
+{
+    ExecutionTimerShard     *shard;
+
+    for ( shard = atomic_load_explicit(&aTimer->shards, memory_order_acquire); shard; shard = shard->next ) {
+        if ( shard->walltime.count == 0 ) continue;
+        aTimer->cycleCount += shard->walltime.count;
+        ExecutionTimerDatumMerge(&aTimer->metrics[ExecutionTimerMetricWalltime], &shard->walltime);
+        ExecutionTimerDatumMerge(&aTimer->metrics[ExecutionTimerMetricCPUTime], &shard->cpuTime);
+        ExecutionTimerDatumReset(&shard->walltime);
+        ExecutionTimerDatumReset(&shard->cpuTime);
+    }
+}
+
+//
+
+void
+__ExecutionTimerReset(
+    ExecutionTimer  *aTimer
+)
+{
+    int             i;
+
+    aTimer->isStarted = false;
+    aTimer->cycleCount = 0;
+    aTimer->cycleThreads = 0;
+    aTimer->batchCount = 0;
+    aTimer->nSamples = 0;
+    atomic_store(&aTimer->ioBytes, 0);
+    atomic_store(&aTimer->ioOperations, 0);
+    aTimer->cacheResidency = NAN;
+    __ExecutionTimerRegionFreeChildren(&aTimer->regionRoot);
+    aTimer->currentRegion = &aTimer->regionRoot;
+    __ExecutionTimerFreeShards(aTimer);
+    for ( i = 0; i < ExecutionTimerMetricEOL; i++ ) ExecutionTimerDatumReset(&aTimer->metrics[i]);
+    for ( i = 0; i < aTimer->nThreadSlots; i++ ) {
+        aTimer->threadSlots[i].isActive = false;
+        aTimer->threadSlots[i].busyWall = aTimer->threadSlots[i].busyCPU = 0.0;
+        aTimer->threadSlots[i].ioBytes = 0.0;
+        aTimer->threadSlots[i].tid = 0;
+        aTimer->threadSlots[i].slowestCount = 0;
+        ExecutionTimerDatumReset(&aTimer->threadSlots[i].cpuTime);
+        ExecutionTimerDatumReset(&aTimer->threadSlots[i].ioRate);
+    }
+}
+
+//
+
+bool
+__ExecutionTimerGrowThreadSlots(
+    ExecutionTimer  *aTimer,
+    unsigned int    nThreadSlots
+)
+{
+    if ( nThreadSlots > aTimer->nThreadSlots ) {
+        ExecutionTimerThreadSlot    *newSlots = NULL;
+
+        if ( posix_memalign((void**)&newSlots, 64, nThreadSlots * sizeof(ExecutionTimerThreadSlot)) != 0 ) return false;
+        memset(newSlots, 0, nThreadSlots * sizeof(ExecutionTimerThreadSlot));
+        if ( aTimer->threadSlots ) {
+            memcpy(newSlots, aTimer->threadSlots, aTimer->nThreadSlots * sizeof(ExecutionTimerThreadSlot));
+            free((void*)aTimer->threadSlots);
+        }
+        aTimer->threadSlots = newSlots;
+        aTimer->nThreadSlots = nThreadSlots;
+    }
+    return true;
+}
+
+//
+
+void
+__ExecutionTimerUpdateTaskSlots(
+    ExecutionTimer              *aTimer
+)
+{
+    ExecutionTimerTaskSample    *before = aTimer->taskSamples, *after = NULL;
+    unsigned int                nBefore = aTimer->nTaskSamples, nAfter = 0, capacity = 0;
+    unsigned int                iBefore = 0, iAfter = 0, slot;
+
+    if ( ! __ExecutionTimerSampleTasks(&after, &nAfter, &capacity) ) return;
+
+    //
+    // Both lists are sorted by thread id.  A task that consumed CPU time
+    // during the cycle keeps the slot it was given the first time it did so;
+    // new tasks take the next unclaimed slot:
+    //
+    while ( (iBefore < nBefore) && (iAfter < nAfter) ) {
+        if ( before[iBefore].tid < after[iAfter].tid ) {
+            iBefore++;
+        } else if ( before[iBefore].tid > after[iAfter].tid ) {
+            iAfter++;
+        } else {
+            double      cpu = after[iAfter].cpu - before[iBefore].cpu;
+
+            if ( cpu > 0.0 ) {
+                for ( slot = 0; slot < aTimer->nThreadSlots; slot++ ) {
+                    if ( (aTimer->threadSlots[slot].tid == after[iAfter].tid) || (aTimer->threadSlots[slot].tid == 0) ) break;
+                }
+                if ( (slot < aTimer->nThreadSlots) || __ExecutionTimerGrowThreadSlots(aTimer, slot + 1) ) {
+                    aTimer->threadSlots[slot].tid = after[iAfter].tid;
+                    aTimer->threadSlots[slot].isActive = true;
+                    aTimer->threadSlots[slot].busyWall = aTimer->threadSlots[slot].busyCPU = cpu;
+                }
+            }
+            iBefore++;
+            iAfter++;
+        }
+    }
+    if ( after ) free((void*)after);
+}
+
+//
+
+void
+__ExecutionTimerUpdateMetrics(
+    ExecutionTimer  *aTimer
+)
+{
+    double          v, walltime;
+    unsigned int    nThreads = aTimer->cycleThreads;
+    bool            isLightweight = (aTimer->clock == ExecutionTimerClockTSC);
+
+    //
+    // A cycle spans batchSize calls; times and counts are reported per call:
+    //
+    double          perCall = 1.0 / (double)aTimer->batchSize;
+
+    aTimer->cycleCount++;
+    aTimer->cycleThreads = 0;
+    __ExecutionTimerRegionUpdate(&aTimer->regionRoot, perCall);
+
+    if ( isLightweight ) {
+        v = (double)(aTimer->endTicks - aTimer->startTicks);
+        v /= __ExecutionTimerTSCIsInvariant ? __ExecutionTimerTSCFrequency : 1e9;
+    } else {
+        v = (double)(aTimer->endTime.tv_sec - aTimer->startTime.tv_sec);
+        v += 1e-9 * (double)(aTimer->endTime.tv_nsec - aTimer->startTime.tv_nsec);
+    }
+    v *= perCall;
+    if ( aTimer->hasOverhead && aTimer->shouldSubtractOverhead ) {
+        v -= aTimer->overheadMedian;
+        if ( v < 0.0 ) v = 0.0;
+    }
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricWalltime], v);
+    walltime = v;
+
+    // The lightweight clock does not collect resource usage:
+    if ( isLightweight ) goto threadSlots;
+
+    v = (aTimer->endUsage.ru_utime.tv_sec - aTimer->startUsage.ru_utime.tv_sec);
+    v += 1e-6 * (aTimer->endUsage.ru_utime.tv_usec - aTimer->startUsage.ru_utime.tv_usec);
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricUserCPU], perCall * v);
+
+    v = (aTimer->endUsage.ru_stime.tv_sec - aTimer->startUsage.ru_stime.tv_sec);
+    v += 1e-6 * (aTimer->endUsage.ru_stime.tv_usec - aTimer->startUsage.ru_stime.tv_usec);
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricSystemCPU], perCall * v);
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricMaxRSS], (double)aTimer->endUsage.ru_maxrss);
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricNSwaps], perCall * (double)(aTimer->endUsage.ru_nswap - aTimer->startUsage.ru_nswap));
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOBlocksIn], perCall * (double)(aTimer->endUsage.ru_inblock - aTimer->startUsage.ru_inblock));
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOBlocksOut], perCall * (double)(aTimer->endUsage.ru_oublock - aTimer->startUsage.ru_oublock));
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricMinorFaults], perCall * (double)(aTimer->endUsage.ru_minflt - aTimer->startUsage.ru_minflt));
+
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricMajorFaults], perCall * (double)(aTimer->endUsage.ru_majflt - aTimer->startUsage.ru_majflt));
+
+    v = perCall * __ExecutionTimerTimespecDelta(&aTimer->startCPUTime, &aTimer->endCPUTime);
+    ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricCPUTime], v);
+
+    //
+    // Per-thread load balance:
+    //
+threadSlots:
+    if ( aTimer->shouldSampleTasks ) __ExecutionTimerUpdateTaskSlots(aTimer);
+    if ( aTimer->nThreadSlots > 0 ) {
+        unsigned int    i, nActive = 0, slowest = 0;
+        double          sum = 0.0, max = -1.0;
+
+        for ( i = 0; i < aTimer->nThreadSlots; i++ ) {
+            ExecutionTimerThreadSlot    *slot = &aTimer->threadSlots[i];
+
+            if ( ! slot->isActive ) continue;
+            nActive++;
+            sum += slot->busyWall;
+            if ( slot->busyWall > max ) {
+                max = slot->busyWall;
+                slowest = i;
+            }
+            ExecutionTimerDatumUpdate(&slot->cpuTime, perCall * slot->busyCPU);
+            if ( (slot->ioBytes > 0.0) && (slot->busyWall > 0.0) ) {
+                ExecutionTimerDatumUpdate(&slot->ioRate, 1e-6 * slot->ioBytes / slot->busyWall);
+            }
+            slot->isActive = false;
+            slot->busyWall = slot->busyCPU = slot->ioBytes = 0.0;
+        }
+        if ( nActive > 0 && sum > 0.0 ) {
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricThreadImbalance], max / (sum / (double)nActive));
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricSlowestThread], (double)slowest);
+            aTimer->threadSlots[slowest].slowestCount++;
+        }
+        if ( nActive > nThreads ) nThreads = nActive;
+    }
+
+    //
+    // CPU utilization relative to the threads that were available to the
+    // cycle:  a thread-scope timer only ever accounts for its own thread,
+    // while a process-scope timer charges every thread (including OpenMP
+    // workers spin-waiting at a barrier) against walltime * threads:
+    //
+    if ( (aTimer->scope == ExecutionTimerScopeThread) || (nThreads < 1) ) nThreads = 1;
+    if ( ! isLightweight && (walltime > 0.0) ) {
+        ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricCPUUtilization], v / (walltime * (double)nThreads));
+    }
+
+#ifdef HAVE_PERF_EVENTS
+    if ( aTimer->hwCounters ) {
+        double          counts[ExecutionTimerHWEventMax];
+        bool            haveCount[ExecutionTimerHWEventMax];
+        unsigned int    event;
+
+        for ( event = 0; event < ExecutionTimerHWEventMax; event++ ) {
+            haveCount[event] = __ExecutionTimerHWCountersGetDelta(aTimer->hwCounters, event, &counts[event]);
+            if ( haveCount[event] ) ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricHWCycles + event], perCall * counts[event]);
+        }
+        if ( haveCount[ExecutionTimerHWEventCycles] && haveCount[ExecutionTimerHWEventInstructions] && (counts[ExecutionTimerHWEventCycles] > 0.0) ) {
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIPC], counts[ExecutionTimerHWEventInstructions] / counts[ExecutionTimerHWEventCycles]);
+        }
+        if ( aTimer->hasWorkModel && (aTimer->workFlops > 0.0) ) {
+            if ( haveCount[ExecutionTimerHWEventL1DMisses] ) {
+                ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricL1DMissesPerKFlop], 1e3 * perCall * counts[ExecutionTimerHWEventL1DMisses] / aTimer->workFlops);
+            }
+            if ( haveCount[ExecutionTimerHWEventLLCMisses] ) {
+                ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricLLCMissesPerKFlop], 1e3 * perCall * counts[ExecutionTimerHWEventLLCMisses] / aTimer->workFlops);
+            }
+        }
+    }
+#endif /* HAVE_PERF_EVENTS */
+
+    //
+    // I/O throughput, if the cycle counted any:
+    //
+    {
+        unsigned long   ioBytes = atomic_exchange(&aTimer->ioBytes, 0);
+        unsigned long   ioOperations = atomic_exchange(&aTimer->ioOperations, 0);
+
+        if ( (ioOperations > 0) && (walltime > 0.0) ) {
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOMBPerSec], 1e-6 * perCall * (double)ioBytes / walltime);
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricIOPS], perCall * (double)ioOperations / walltime);
+        }
+    }
+    if ( ! isnan(aTimer->cacheResidency) ) {
+        ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricCacheResidency], aTimer->cacheResidency);
+        aTimer->cacheResidency = NAN;
+    }
+
+    //
+    // Derived throughput metrics are only produced if a work model has been
+    // attached to the timer:
+    //
+    if ( aTimer->hasWorkModel && (walltime > 0.0) ) {
+        if ( aTimer->workFlops > 0.0 ) {
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricGFLOPs], 1e-9 * aTimer->workFlops / walltime);
+        }
+        if ( aTimer->workBytes > 0.0 ) {
+            ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricGBPerSec], 1e-9 * aTimer->workBytes / walltime);
+            if ( aTimer->workFlops > 0.0 ) {
+                ExecutionTimerDatumUpdate(&aTimer->metrics[ExecutionTimerMetricArithIntensity], aTimer->workFlops / aTimer->workBytes);
+            }
+        }
+    }
+}
+
+//
+
+void
+__ExecutionTimerRecordSamples(
+    ExecutionTimer  *aTimer,
+    unsigned int    *countsBefore
+)
+{
+    unsigned int    metric;
+
+    if ( aTimer->nSamples == aTimer->samplesCapacity ) {
+        unsigned int    newCapacity = aTimer->samplesCapacity ? (2 * aTimer->samplesCapacity) : 256;
+
+        for ( metric = 0; metric < ExecutionTimerMetricEOL; metric++ ) {
+            double      *newSamples = (double*)realloc(aTimer->samples[metric], newCapacity * sizeof(double));
+
+            if ( ! newSamples ) return;
+            aTimer->samples[metric] = newSamples;
+        }
+        aTimer->samplesCapacity = newCapacity;
+    }
+    for ( metric = 0; metric < ExecutionTimerMetricEOL; metric++ ) {
+        aTimer->samples[metric][aTimer->nSamples] = (aTimer->metrics[metric].count > countsBefore[metric]) ? aTimer->metrics[metric].value : NAN;
+    }
+    aTimer->nSamples++;
+}
+
+//
+
+void
+__ExecutionTimerClearOverhead(
+    ExecutionTimer  *aTimer
+)
+{
+    aTimer->hasOverhead = false;
+    aTimer->overheadMedian = 0.0;
+    ExecutionTimerDatumReset(&aTimer->overhead);
+}
+
+//
+
+ExecutionTimerRef
+ExecutionTimerCreate(void)
+{
+    ExecutionTimer  *newTimer = (ExecutionTimer*)malloc(sizeof(ExecutionTimer));
+
+    if ( newTimer ) {
+        atomic_init(&newTimer->refCount, 1);
+        newTimer->name = NULL;
+        newTimer->owner = pthread_self();
+        atomic_init(&newTimer->shards, NULL);
+        newTimer->scope = ExecutionTimerScopeProcess;
+        newTimer->clock = ExecutionTimerClockMonotonic;
+        newTimer->batchSize = 1;
+        newTimer->hasOverhead = newTimer->shouldSubtractOverhead = false;
+        newTimer->overheadMedian = 0.0;
+        memset(&newTimer->overhead, 0, sizeof(newTimer->overhead));
+        memset(&newTimer->regionRoot, 0, sizeof(newTimer->regionRoot));
+        newTimer->currentRegion = &newTimer->regionRoot;
+        newTimer->hasWorkModel = false;
+        newTimer->workFlops = newTimer->workBytes = 0.0;
+        atomic_init(&newTimer->ioBytes, 0);
+        atomic_init(&newTimer->ioOperations, 0);
+        newTimer->cacheResidency = NAN;
+        newTimer->hwCounters = NULL;
+        newTimer->nThreadSlots = 0;
+        newTimer->threadSlots = NULL;
+        newTimer->shouldSampleTasks = false;
+        newTimer->nTaskSamples = newTimer->taskSamplesCapacity = 0;
+        newTimer->taskSamples = NULL;
+        newTimer->shouldRecordSamples = false;
+        newTimer->nSamples = newTimer->samplesCapacity = 0;
+        memset(newTimer->samples, 0, sizeof(newTimer->samples));
+        memset(newTimer->metrics, 0, sizeof(newTimer->metrics));
+        __ExecutionTimerReset(newTimer);
+    }
+    return (ExecutionTimerRef)newTimer;
+}
+
+//
+
+ExecutionTimerRef
+ExecutionTimerCreateWithScope(
+    ExecutionTimerScope theScope
+)
+{
+    ExecutionTimerRef   newTimer = ExecutionTimerCreate();
+
+    if ( newTimer ) ExecutionTimerSetScope(newTimer, theScope);
+    return newTimer;
+}
+
+//
+
+ExecutionTimerRef
+ExecutionTimerRetain(
+    ExecutionTimerRef   aTimer
+)
+{
+    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+
+    atomic_fetch_add_explicit(&TIMER->refCount, 1, memory_order_relaxed);
+    return aTimer;
+}
+
+//
+
+void
+ExecutionTimerRelease(
+    ExecutionTimerRef   aTimer
+)
+{
+    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+
+    if ( atomic_fetch_sub_explicit(&TIMER->refCount, 1, memory_order_acq_rel) == 1 ) {
+#ifdef HAVE_PERF_EVENTS
+        if ( TIMER->hwCounters ) __ExecutionTimerHWCountersDestroy(TIMER->hwCounters);
+#endif
+        __ExecutionTimerReset(TIMER);
+        ExecutionTimerDatumReset(&TIMER->overhead);
+        if ( TIMER->threadSlots ) free((void*)TIMER->threadSlots);
+        if ( TIMER->taskSamples ) free((void*)TIMER->taskSamples);
+        if ( TIMER->name ) free((void*)TIMER->name);
+        ExecutionTimerSetShouldRecordSamples(aTimer, false);
+        free((void*)aTimer);
+    }
+}
+
+//
+
+void
+ExecutionTimerReset(
+    ExecutionTimerRef   aTimer
+)
+{
+    __ExecutionTimerReset((ExecutionTimer*)aTimer);
+}
+
+//
+
+ExecutionTimerScope
+ExecutionTimerGetScope(
+    ExecutionTimerRef   aTimer
+)
+{
+    return aTimer->scope;
+}
+
+//
+
+void
+ExecutionTimerSetScope(
+    ExecutionTimerRef   aTimer,
+    ExecutionTimerScope theScope
+)
+{
+    if ( (theScope < ExecutionTimerScopeMax) && (theScope != aTimer->scope) ) {
+        aTimer->scope = theScope;
+        __ExecutionTimerClearOverhead((ExecutionTimer*)aTimer);
+        __ExecutionTimerReset((ExecutionTimer*)aTimer);
+    }
+}
+
+//
+
+ExecutionTimerClock
+ExecutionTimerGetClock(
+    ExecutionTimerRef   aTimer
+)
+{
+    return aTimer->clock;
+}
+
+//
+
+void
+ExecutionTimerSetClock(
+    ExecutionTimerRef   aTimer,
+    ExecutionTimerClock theClock
+)
+{
+    if ( (theClock < ExecutionTimerClockMax) && (theClock != aTimer->clock) ) {
+        if ( theClock == ExecutionTimerClockTSC ) ExecutionTimerCalibrateTSC();
+        aTimer->clock = theClock;
+        __ExecutionTimerClearOverhead((ExecutionTimer*)aTimer);
+        __ExecutionTimerReset((ExecutionTimer*)aTimer);
+    }
+}
+
+//
+
+unsigned int
+ExecutionTimerGetBatchSize(
+    ExecutionTimerRef   aTimer
+)
+{
+    return aTimer->batchSize;
+}
+
+//
+
+void
+ExecutionTimerSetBatchSize(
+    ExecutionTimerRef   aTimer,
+    unsigned int        batchSize
+)
+{
+    if ( batchSize < 1 ) batchSize = 1;
+    if ( batchSize != aTimer->batchSize ) {
+        aTimer->batchSize = batchSize;
+        __ExecutionTimerClearOverhead((ExecutionTimer*)aTimer);
+        __ExecutionTimerReset((ExecutionTimer*)aTimer);
+    }
+}
+
+//
+
+bool
+ExecutionTimerCalibrateOverhead(
+    ExecutionTimerRef   aTimer,
+    unsigned int        nSamples
+)
+{
+    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+    ExecutionTimer      *probe = (ExecutionTimer*)ExecutionTimerCreate();
+    unsigned int        i, call;
+
+    if ( ! probe ) return false;
+    if ( nSamples < 1 ) nSamples = 1;
+
+    //
+    // An identically-configured timer is cycled around nothing; the first
+    // tenth of the cycles warm up the caches and branch predictors:
+    //
+    probe->scope = TIMER->scope;
+    probe->clock = TIMER->clock;
+    probe->batchSize = TIMER->batchSize;
+#ifdef HAVE_PERF_EVENTS
+    if ( TIMER->hwCounters ) probe->hwCounters = __ExecutionTimerHWCountersCreate();
+#endif
+    for ( i = 0; i < nSamples / 10; i++ ) {
+        for ( call = 0; call < probe->batchSize; call++ ) {
+            ExecutionTimerStart(probe);
+            ExecutionTimerStop(probe);
+        }
+    }
+    __ExecutionTimerReset(probe);
+    for ( i = 0; i < nSamples; i++ ) {
+        for ( call = 0; call < probe->batchSize; call++ ) {
+            ExecutionTimerStart(probe);
+            ExecutionTimerStop(probe);
+        }
+    }
+
+    // Take ownership of the probe's walltime datum:
+    ExecutionTimerDatumReset(&TIMER->overhead);
+    TIMER->overhead = probe->metrics[ExecutionTimerMetricWalltime];
+    memset(&probe->metrics[ExecutionTimerMetricWalltime], 0, sizeof(ExecutionTimerDatum));
+    ExecutionTimerRelease(probe);
+
+    TIMER->overheadMedian = ExecutionTimerDatumGetValue(&TIMER->overhead, ExecutionTimerValueMedian);
+    TIMER->hasOverhead = true;
+    return true;
+}
+
+//
+
+bool
+ExecutionTimerHasOverheadCalibration(
+    ExecutionTimerRef   aTimer
+)
+{
+    return aTimer->hasOverhead;
+}
+
+//
+
+double
+ExecutionTimerGetOverheadValue(
+    ExecutionTimerRef   aTimer,
+    ExecutionTimerValue theValue
+)
+{
+    if ( aTimer->hasOverhead ) return ExecutionTimerDatumGetValue(&aTimer->overhead, theValue);
+    return INFINITY;
+}
+
+//
+
+void
+ExecutionTimerSetShouldSubtractOverhead(
+    ExecutionTimerRef   aTimer,
+    bool                shouldSubtractOverhead
+)
+{
+    aTimer->shouldSubtractOverhead = shouldSubtractOverhead;
+}
+
+//
+
+bool
+ExecutionTimerIsReliable(
+    ExecutionTimerRef   aTimer
+)
+{
+    double              walltime;
+
+    __ExecutionTimerMergeShards(aTimer);
+    if ( ! aTimer->hasOverhead || (aTimer->metrics[ExecutionTimerMetricWalltime].count == 0) ) return true;
+    walltime = ExecutionTimerDatumGetValue(&aTimer->metrics[ExecutionTimerMetricWalltime], ExecutionTimerValueMedian);
+    if ( aTimer->shouldSubtractOverhead ) walltime += aTimer->overheadMedian;
+    return (walltime >= EXECUTIONTIMER_RELIABILITY_FACTOR * aTimer->overheadMedian) ? true : false;
+}
+
+//
+
+const char* __ExecutionTimerClockStrings[] = {
+                "monotonic",
+                "tsc",
+                NULL
+            };
+
+const char*
+ExecutionTimerClocks(void)
+{
+    return "monotonic|tsc";
+}
+
+ExecutionTimerClock
+ExecutionTimerClockParse(
+    const char      *s
+)
+{
+    ExecutionTimerClock clock = ExecutionTimerClockMonotonic;
+
+    if ( !s || ! *s ) return ExecutionTimerClockMonotonic;
+    while ( clock < ExecutionTimerClockMax ) {
+        if ( strcasecmp(s, __ExecutionTimerClockStrings[clock]) == 0 ) return clock;
+        clock++;
+    }
+    return ExecutionTimerClockInvalid;
+}
+
+//
+
+const char*
+ExecutionTimerClockToString(
+    ExecutionTimerClock theClock
+)
+{
+    if ( theClock < ExecutionTimerClockMax ) return __ExecutionTimerClockStrings[theClock];
+    return NULL;
+}
+
+//
+
+const char* __ExecutionTimerScopeStrings[] = {
+                "process",
+                "thread",
+                NULL
+            };
+
+const char*
+ExecutionTimerScopes(void)
+{
+    return "process|thread";
+}
+
+ExecutionTimerScope
+ExecutionTimerScopeParse(
+    const char      *s
+)
+{
+    ExecutionTimerScope scope = ExecutionTimerScopeProcess;
+
+    if ( !s || ! *s ) return ExecutionTimerScopeProcess;
+    while ( scope < ExecutionTimerScopeMax ) {
+        if ( strcasecmp(s, __ExecutionTimerScopeStrings[scope]) == 0 ) return scope;
+        scope++;
+    }
+    return ExecutionTimerScopeInvalid;
+}
+
+//
+
+const char*
+ExecutionTimerScopeToString(
+    ExecutionTimerScope theScope
+)
+{
+    if ( theScope < ExecutionTimerScopeMax ) return __ExecutionTimerScopeStrings[theScope];
+    return NULL;
+}
+
+//
+
+bool
+ExecutionTimerIsStarted(
+    ExecutionTimerRef   aTimer
+)
+{
+    return aTimer->isStarted;
+}
+
+//
+
+bool
+ExecutionTimerHasStatistics(
+    ExecutionTimerRef   aTimer
+)
+{
+    __ExecutionTimerMergeShards(aTimer);
+    return (aTimer->cycleCount > 1) ? true : false;
+}
+
+//
+
+void
+ExecutionTimerStart(
+    ExecutionTimerRef   aTimer
+)
+{
+    ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+
+    if ( __ExecutionTimerShouldUseShard(TIMER) ) {
+        ExecutionTimerShard *shard = __ExecutionTimerGetShard(TIMER);
+
+        if ( ! shard || (shard->isStarted && (shard->batchCount > 0)) ) return;
+        __ExecutionTimerNotify(TIMER, ExecutionTimerEventStart, TIMER->name);
+        shard->isStarted = true;
+        if ( TIMER->clock != ExecutionTimerClockTSC ) clock_gettime(CLOCK_THREAD_CPUTIME_ID, &shard->startCPUTime);
+        shard->startTime = __ExecutionTimerNow(TIMER);
+        return;
+    }
+
+    // Inside a batch the cycle simply continues:
+    if ( TIMER->isStarted && (TIMER->batchCount > 0) ) return;
+    __ExecutionTimerNotify(TIMER, ExecutionTimerEventStart, TIMER->name);
+
+    // Task sampling is slow, keep it outside the timed interval:
+    if ( TIMER->shouldSampleTasks ) __ExecutionTimerSampleTasks(&TIMER->taskSamples, &TIMER->nTaskSamples, &TIMER->taskSamplesCapacity);
+    TIMER->isStarted = true;
+    if ( TIMER->clock == ExecutionTimerClockTSC ) {
+#ifdef HAVE_PERF_EVENTS
+        if ( TIMER->hwCounters ) __ExecutionTimerHWCountersRead(TIMER->hwCounters, TIMER->hwCounters->start);
+#endif
+        TIMER->startTicks = __ExecutionTimerTicksStart();
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &TIMER->startTime);
+    __ExecutionTimerGetUsage(TIMER, &TIMER->startUsage, &TIMER->startCPUTime);
+#ifdef HAVE_PERF_EVENTS
+    // Counters are read last so that the timer's own work is not counted:
+    if ( TIMER->hwCounters ) __ExecutionTimerHWCountersRead(TIMER->hwCounters, TIMER->hwCounters->start);
+#endif
+}
+
+//
+
+void
+ExecutionTimerStop(
+    ExecutionTimerRef   aTimer
+)
+{
+    if ( __ExecutionTimerShouldUseShard(aTimer) ) {
+        double              now = __ExecutionTimerNow(aTimer), v;
+        ExecutionTimerShard *shard = __ExecutionTimerGetShard(aTimer);
+
+        if ( ! shard || ! shard->isStarted ) return;
+        if ( ++shard->batchCount < aTimer->batchSize ) return;
+        v = (now - shard->startTime) / (double)aTimer->batchSize;
+        if ( aTimer->hasOverhead && aTimer->shouldSubtractOverhead ) {
+            v -= aTimer->overheadMedian;
+            if ( v < 0.0 ) v = 0.0;
+        }
+        ExecutionTimerDatumUpdate(&shard->walltime, v);
+        if ( aTimer->clock != ExecutionTimerClockTSC ) {
+            struct timespec endCPUTime;
+
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &endCPUTime);
+            ExecutionTimerDatumUpdate(&shard->cpuTime, __ExecutionTimerTimespecDelta(&shard->startCPUTime, &endCPUTime) / (double)aTimer->batchSize);
+        }
+        shard->isStarted = false;
+        shard->batchCount = 0;
+        __ExecutionTimerNotify(aTimer, ExecutionTimerEventStop, aTimer->name);
+    } else if ( aTimer->isStarted ) {
+        ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+
+        if ( TIMER->clock == ExecutionTimerClockTSC ) {
+            uint64_t        ticks = __ExecutionTimerTicksStop();
+
+            if ( ++TIMER->batchCount < TIMER->batchSize ) return;
+            TIMER->endTicks = ticks;
+#ifdef HAVE_PERF_EVENTS
+            if ( TIMER->hwCounters ) __ExecutionTimerHWCountersRead(TIMER->hwCounters, TIMER->hwCounters->end);
+#endif
+        } else {
+            if ( ++TIMER->batchCount < TIMER->batchSize ) return;
+#ifdef HAVE_PERF_EVENTS
+            if ( TIMER->hwCounters ) __ExecutionTimerHWCountersRead(TIMER->hwCounters, TIMER->hwCounters->end);
+#endif
+            __ExecutionTimerGetUsage(TIMER, &TIMER->endUsage, &TIMER->endCPUTime);
+            clock_gettime(CLOCK_MONOTONIC, &TIMER->endTime);
+        }
+        // Regions left open end with the cycle:
+        if ( TIMER->currentRegion != &TIMER->regionRoot ) {
+            double          now = __ExecutionTimerNow(TIMER);
+
+            while ( TIMER->currentRegion != &TIMER->regionRoot ) {
+                TIMER->currentRegion->cycleTime += now - TIMER->currentRegion->startTime;
+                __ExecutionTimerNotify(TIMER, ExecutionTimerEventPopRegion, TIMER->currentRegion->name);
+                TIMER->currentRegion = TIMER->currentRegion->parent;
+            }
+        }
+        __ExecutionTimerNotify(TIMER, ExecutionTimerEventStop, TIMER->name);
+        TIMER->isStarted = false;
+        TIMER->batchCount = 0;
+
+        if ( TIMER->shouldRecordSamples ) {
+            unsigned int    counts[ExecutionTimerMetricEOL], metric;
+
+            for ( metric = 0; metric < ExecutionTimerMetricEOL; metric++ ) counts[metric] = TIMER->metrics[metric].count;
+            __ExecutionTimerUpdateMetrics(aTimer);
+            __ExecutionTimerRecordSamples(TIMER, counts);
+        } else {
+            __ExecutionTimerUpdateMetrics(aTimer);
+        }
+    }
+}
+
+//
+
+unsigned int
+ExecutionTimerCycleCount(
+    ExecutionTimerRef   aTimer
+)
+{
+    __ExecutionTimerMergeShards(aTimer);
+    return aTimer->cycleCount;
+}
+
+//
+
+double
+ExecutionTimerGetValue(
+    ExecutionTimerRef       aTimer,
+    ExecutionTimerMetric    theMetric,
+    ExecutionTimerValue     theValue
+)
+{
+    if ( theMetric < ExecutionTimerMetricEOL ) {
+        __ExecutionTimerMergeShards(aTimer);
+        return ExecutionTimerDatumGetValue(&aTimer->metrics[theMetric], theValue);
+    }
+    return INFINITY;
+}
+
+//
+
+bool
+ExecutionTimerMetricIsActive(
+    ExecutionTimerRef       aTimer,
+    ExecutionTimerMetric    theMetric
+)
+{
+    if ( theMetric < ExecutionTimerMetricEOL ) {
+        __ExecutionTimerMergeShards(aTimer);
+        return (aTimer->metrics[theMetric].count > 0) ? true : false;
+    }
+    return false;
+}
+
+//
+
+const char*
+ExecutionTimerMetricGetName(
+    ExecutionTimerMetric    theMetric
+)
+{
+    if ( theMetric < ExecutionTimerMetricEOL ) return ExecutionTimerMetricNames[theMetric];
+    return NULL;
+}
+
+//
+
+void
+ExecutionTimerSetWorkModel(
+    ExecutionTimerRef   aTimer,
+    double              flops,
+    double              bytes
+)
+{
+    aTimer->hasWorkModel = true;
+    aTimer->workFlops = flops;
+    aTimer->workBytes = bytes;
+}
+
+//
+
+void
+ExecutionTimerCountIO(
+    ExecutionTimerRef   aTimer,
+    double              bytes,
+    unsigned long       operations
+)
+{
+    if ( bytes > 0.0 ) atomic_fetch_add(&aTimer->ioBytes, (unsigned long)bytes);
+    atomic_fetch_add(&aTimer->ioOperations, operations);
+}
+
+//
+
+void
+ExecutionTimerNoteCacheResidency(
+    ExecutionTimerRef   aTimer,
+    double              fraction
+)
+{
+    aTimer->cacheResidency = fraction;
+}
+
+//
+
+void
+ExecutionTimerThreadCountIO(
+    ExecutionTimerRef   aTimer,
+    int                 threadId,
+    double              bytes,
+    unsigned long       operations
+)
+{
+    if ( (threadId >= 0) && (threadId < aTimer->nThreadSlots) && (bytes > 0.0) ) {
+        aTimer->threadSlots[threadId].ioBytes += bytes;
+    }
+    ExecutionTimerCountIO(aTimer, bytes, operations);
+}
+
+//
+
+void
+ExecutionTimerClearWorkModel(
+    ExecutionTimerRef   aTimer
+)
+{
+    aTimer->hasWorkModel = false;
+    aTimer->workFlops = aTimer->workBytes = 0.0;
+}
+
+//
+
+bool
+ExecutionTimerEnableHardwareCounters(
+    ExecutionTimerRef   aTimer
+)
+{
+#ifdef HAVE_PERF_EVENTS
+    if ( ! aTimer->hwCounters ) aTimer->hwCounters = __ExecutionTimerHWCountersCreate();
+    return (aTimer->hwCounters != NULL) ? true : false;
+#else
+    fprintf(stderr, "WARNING:  hardware performance counter support not compiled in; continuing without them\n");
+    return false;
+#endif
+}
+
+//
+
+void
+ExecutionTimerDisableHardwareCounters(
+    ExecutionTimerRef   aTimer
+)
+{
+#ifdef HAVE_PERF_EVENTS
+    if ( aTimer->hwCounters ) {
+        __ExecutionTimerHWCountersDestroy(aTimer->hwCounters);
+        aTimer->hwCounters = NULL;
+    }
+#endif
+}
+
+//
+
+bool
+ExecutionTimerPrepareThreadSlots(
+    ExecutionTimerRef   aTimer,
+    int                 nthreads
+)
+{
+    if ( nthreads < 1 ) nthreads = 1;
+    aTimer->cycleThreads = nthreads;
+    return __ExecutionTimerGrowThreadSlots(aTimer, nthreads);
+}
+
+//
+
+void
+ExecutionTimerThreadStart(
+    ExecutionTimerRef   aTimer,
+    int                 threadId
+)
+{
+    __ExecutionTimerNotify(aTimer, ExecutionTimerEventThreadStart, aTimer->name);
+    if ( (threadId >= 0) && (threadId < aTimer->nThreadSlots) ) {
+        ExecutionTimerThreadSlot    *slot = &aTimer->threadSlots[threadId];
+
+        clock_gettime(CLOCK_MONOTONIC, &slot->startTime);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &slot->startCPU);
+    }
+}
+
+//
+
+void
+ExecutionTimerThreadStop(
+    ExecutionTimerRef   aTimer,
+    int                 threadId
+)
+{
+    if ( (threadId >= 0) && (threadId < aTimer->nThreadSlots) ) {
+        ExecutionTimerThreadSlot    *slot = &aTimer->threadSlots[threadId];
+        struct timespec             endTime, endCPU;
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &endCPU);
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+        slot->busyWall += __ExecutionTimerTimespecDelta(&slot->startTime, &endTime);
+        slot->busyCPU += __ExecutionTimerTimespecDelta(&slot->startCPU, &endCPU);
+        slot->isActive = true;
+    }
+    __ExecutionTimerNotify(aTimer, ExecutionTimerEventThreadStop, aTimer->name);
+}
+
+//
+
+void
+ExecutionTimerSetShouldSampleThreads(
+    ExecutionTimerRef   aTimer,
+    bool                shouldSampleThreads
+)
+{
+    aTimer->shouldSampleTasks = shouldSampleThreads;
+}
+
+//
+
+unsigned int
+ExecutionTimerThreadCount(
+    ExecutionTimerRef   aTimer
+)
+{
+    unsigned int        i = aTimer->nThreadSlots;
+
+    while ( i > 0 && aTimer->threadSlots[i - 1].cpuTime.count == 0 ) i--;
+    return i;
+}
+
+//
+
+double
+ExecutionTimerGetThreadCPUValue(
+    ExecutionTimerRef   aTimer,
+    int                 threadId,
+    ExecutionTimerValue theValue
+)
+{
+    if ( (threadId >= 0) && (threadId < aTimer->nThreadSlots) ) {
+        return ExecutionTimerDatumGetValue(&aTimer->threadSlots[threadId].cpuTime, theValue);
+    }
+    return INFINITY;
+}
+
+//
+
+void
+ExecutionTimerSetShouldRecordSamples(
+    ExecutionTimerRef   aTimer,
+    bool                shouldRecordSamples
+)
+{
+    if ( ! shouldRecordSamples ) {
+        unsigned int    metric;
+
+        for ( metric = 0; metric < ExecutionTimerMetricEOL; metric++ ) {
+            if ( aTimer->samples[metric] ) free((void*)aTimer->samples[metric]);
+            aTimer->samples[metric] = NULL;
+        }
+        aTimer->nSamples = aTimer->samplesCapacity = 0;
+    }
+    aTimer->shouldRecordSamples = shouldRecordSamples;
+}
+
+//
+
+unsigned int
+ExecutionTimerGetSamples(
+    ExecutionTimerRef       aTimer,
+    ExecutionTimerMetric    theMetric,
+    const double*           *outValues
+)
+{
+    if ( (theMetric >= ExecutionTimerMetricEOL) || (aTimer->nSamples == 0) ) return 0;
+    *outValues = (const double*)aTimer->samples[theMetric];
+    return aTimer->nSamples;
+}
+
+//
+
+void
+ExecutionTimerSetName(
+    ExecutionTimerRef   aTimer,
+    const char          *name
+)
+{
+    if ( aTimer->name ) free((void*)aTimer->name);
+    aTimer->name = name ? strdup(name) : NULL;
+}
+
+//
+
+const char*
+ExecutionTimerGetName(
+    ExecutionTimerRef   aTimer
+)
+{
+    return (const char*)aTimer->name;
+}
+
+//
+
+void
+ExecutionTimerSetEventHook(
+    ExecutionTimerEventHook hook,
+    void                    *context
 )
 {
-    if ( aTimer->isStarted ) {
-        ExecutionTimer      *TIMER = (ExecutionTimer*)aTimer;
+    __ExecutionTimerEventHook = hook;
+    __ExecutionTimerEventHookContext = context;
+}
 
-        getrusage(RUSAGE_SELF, &TIMER->endUsage);
-        clock_gettime(CLOCK_MONOTONIC, &TIMER->endTime);
-        TIMER->isStarted = false;
+//
 
-        __ExecutionTimerUpdateMetrics(aTimer);
+bool
+ExecutionTimerPushRegion(
+    ExecutionTimerRef       aTimer,
+    const char              *regionName
+)
+{
+    ExecutionTimer          *TIMER = (ExecutionTimer*)aTimer;
+    ExecutionTimerRegion    *parent = TIMER->currentRegion, *region, **tail;
+
+    // The region tree belongs to the thread that owns the timer:
+    if ( ! TIMER->isStarted || ! regionName || __ExecutionTimerShouldUseShard(TIMER) ) return false;
+
+    // Find the named child of the current region, else append a new one:
+    tail = &parent->firstChild;
+    while ( (region = *tail) && strcmp(region->name, regionName) ) tail = &region->nextSibling;
+    if ( ! region ) {
+        if ( ! (region = (ExecutionTimerRegion*)malloc(sizeof(ExecutionTimerRegion))) ) return false;
+        memset(region, 0, sizeof(*region));
+        if ( ! (region->name = strdup(regionName)) ) {
+            free((void*)region);
+            return false;
+        }
+        region->parent = parent;
+        *tail = region;
     }
+    region->isActive = true;
+    TIMER->currentRegion = region;
+    __ExecutionTimerNotify(TIMER, ExecutionTimerEventPushRegion, region->name);
+    region->startTime = __ExecutionTimerNow(TIMER);
+    return true;
 }
 
 //
 
-unsigned int
-ExecutionTimerCycleCount(
-    ExecutionTimerRef   aTimer
+bool
+ExecutionTimerPopRegion(
+    ExecutionTimerRef       aTimer
 )
 {
-    return aTimer->cycleCount;
+    ExecutionTimer          *TIMER = (ExecutionTimer*)aTimer;
+    ExecutionTimerRegion    *region = TIMER->currentRegion;
+    double                  now = __ExecutionTimerNow(TIMER);
+
+    if ( (region == &TIMER->regionRoot) || __ExecutionTimerShouldUseShard(TIMER) ) return false;
+    region->cycleTime += now - region->startTime;
+    TIMER->currentRegion = region->parent;
+    __ExecutionTimerNotify(TIMER, ExecutionTimerEventPopRegion, region->name);
+    return true;
 }
 
 //
 
 double
-ExecutionTimerGetValue(
+ExecutionTimerGetRegionValue(
     ExecutionTimerRef       aTimer,
-    ExecutionTimerMetric    theMetric,
+    const char              *regionPath,
     ExecutionTimerValue     theValue
 )
 {
-    if ( theMetric < ExecutionTimerMetricEOL ) {
-        if ( ExecutionTimerHasStatistics(aTimer) ) {
-            switch ( theValue ) {
-                case ExecutionTimerValueLastValue:
-                    return aTimer->metrics[theMetric].value;
-                case ExecutionTimerValueMin:
-                    return aTimer->metrics[theMetric].min;
-                case ExecutionTimerValueMax:
-                    return aTimer->metrics[theMetric].max;
-                case ExecutionTimerValueAverage:
-                    return ExecutionTimerDatumGetAverage(&aTimer->metrics[theMetric]);
-                case ExecutionTimerValueVariance:
-                    return ExecutionTimerDatumGetVariance(&aTimer->metrics[theMetric], aTimer->cycleCount);
-                case ExecutionTimerValueStdDeviation:
-                    return ExecutionTimerDatumGetStdDeviation(&aTimer->metrics[theMetric], aTimer->cycleCount);
+    ExecutionTimerRegion    *region = &aTimer->regionRoot;
 
-                default:
-                    break;
-            }
-        } else if ( aTimer->cycleCount > 0 && theValue == ExecutionTimerValueLastValue ) {
-            return aTimer->metrics[theMetric].value;
-        }
+    while ( region && regionPath && *regionPath ) {
+        size_t              len = strcspn(regionPath, "/");
+        ExecutionTimerRegion    *child = region->firstChild;
+
+        while ( child && ((strlen(child->name) != len) || strncmp(child->name, regionPath, len)) ) child = child->nextSibling;
+        region = child;
+        regionPath += len;
+        if ( *regionPath == '/' ) regionPath++;
     }
+    if ( region && (region != &aTimer->regionRoot) ) return ExecutionTimerDatumGetValue(&region->time, theValue);
     return INFINITY;
 }
 
@@ -362,205 +2645,302 @@ ExecutionTimerOutputFormatToString(
 
 //
 
+//
+// The statistics displayed for each metric (when the timer has statistics)
+// with their table header and the key used in JSON/YAML:
+//
+static const struct {
+    ExecutionTimerValue     value;
+    const char              *header;
+    const char              *key;
+} __ExecutionTimerSummaryColumns[] = {
+                { ExecutionTimerValueLastValue, "last value", "last-value" },
+                { ExecutionTimerValueMin, "miniumum", "minimum" },
+                { ExecutionTimerValueMax, "maximum", "maximum" },
+                { ExecutionTimerValueAverage, "average", "average" },
+                { ExecutionTimerValueVariance, "variance", "variance" },
+                { ExecutionTimerValueStdDeviation, "std deviation", "standard-deviation" },
+                { ExecutionTimerValueMeanCI95, "average 95% CI", "average-ci95" },
+                { ExecutionTimerValueMedian, "median", "median" },
+                { ExecutionTimerValueP90, "p90", "p90" },
+                { ExecutionTimerValueP99, "p99", "p99" },
+                { ExecutionTimerValueMAD, "MAD", "median-absolute-deviation" },
+                { ExecutionTimerValueMedianCI95Low, "median CI95 low", "median-ci95-low" },
+                { ExecutionTimerValueMedianCI95High, "median CI95 high", "median-ci95-high" },
+                { ExecutionTimerValueOutliers, "outliers", "outliers" }
+            };
+
+//
+
+typedef struct {
+    ExecutionTimerOutputFormat  format;
+    bool                        withStatistics;
+    unsigned int                nColumns;
+    const char                  *timerName;
+    const char                  *delim;
+    const char                  *indent;
+    FILE                        *stream;
+} ExecutionTimerSummaryState;
+
+//
+
 void
-ExecutionTimerSummarizeToStream(
-    ExecutionTimerRef           aTimer,
-    ExecutionTimerOutputFormat  format,
-    const char                  *timerName,
-    FILE                        *stream
+__ExecutionTimerSummarizeHeader(
+    ExecutionTimerSummaryState  *state
 )
 {
-    if ( ExecutionTimerHasStatistics(aTimer) ) {
-        ExecutionTimerMetric    metric;
-        const char              *delim = ",", *indent;
-
-        switch ( format ) {
-            case ExecutionTimerOutputFormatTable:
-                fprintf(stream, "%24.24s %16.16s %16.16s %16.16s %16.16s %16.16s %16.16s\n",
-                        timerName ? timerName : "",
-                        "last value",
-                        "miniumum",
-                        "maximum",
-                        "average",
-                        "variance",
-                        "std deviation"
-                    );
-                fprintf(stream, "%1$.24s %1$.16s %1$.16s %1$.16s %1$.16s %1$.16s %1$.16s\n",
-                        "-------------------------------"
-                    );
-                break;
+    const char                  *timerName = state->timerName;
+    FILE                        *stream = state->stream;
+    unsigned int                i;
+
+    state->delim = ",";
+    state->indent = "";
+    state->nColumns = state->withStatistics ? (sizeof(__ExecutionTimerSummaryColumns) / sizeof(__ExecutionTimerSummaryColumns[0])) : 1;
+    switch ( state->format ) {
+        case ExecutionTimerOutputFormatTable:
+            fprintf(stream, "%24.24s", timerName ? timerName : "");
+            for ( i = 0; i < state->nColumns; i++ ) fprintf(stream, " %16.16s", __ExecutionTimerSummaryColumns[i].header);
+            fprintf(stream, "\n%.24s", "-------------------------------");
+            for ( i = 0; i < state->nColumns; i++ ) fprintf(stream, " %.16s", "-------------------------------");
+            fputc('\n', stream);
+            break;
+
+        case ExecutionTimerOutputFormatTSV:
+            state->delim = "\t";
+        case ExecutionTimerOutputFormatCSV:
+            fprintf(stream, "\"%s\"", timerName ? timerName : "");
+            for ( i = 0; i < state->nColumns; i++ ) fprintf(stream, "%s\"%s\"", state->delim, __ExecutionTimerSummaryColumns[i].header);
+            fputc('\n', stream);
+            break;
+
+        case ExecutionTimerOutputFormatJSON:
+            fprintf(stream, timerName ? "{\"%s\":{" : "{", timerName);
+            state->delim = "";
+            break;
+
+        case ExecutionTimerOutputFormatYAML:
+            if ( timerName ) {
+                fprintf(stream, "%s:\n", timerName);
+                state->indent = "    ";
+            }
+            break;
 
-            case ExecutionTimerOutputFormatTSV:
-                delim = "\t";
-            case ExecutionTimerOutputFormatCSV:
-                fprintf(stream, "\"%2$s\"%1$s\"%3$s\"%1$s\"%4$s\"%1$s\"%5$s\"%1$s\"%6$s\"%1$s\"%7$s\"%1$s\"%8$s\"\n",
-                        delim,
-                        timerName ? timerName : "",
-                        "last value",
-                        "miniumum",
-                        "maximum",
-                        "average",
-                        "variance",
-                        "std deviation"
-                    );
-                break;
+    }
+}
 
-            case ExecutionTimerOutputFormatJSON:
-                fprintf(stream, timerName ? "{\"%s\":{" : "{", timerName);
-                delim = "";
-                break;
+//
+// Returns true for the metrics that are only collected under some
+// circumstances (work models, counters, threads, file I/O); the rest are
+// collected every cycle.
+//
+bool
+__ExecutionTimerMetricIsOptional(
+    ExecutionTimerMetric    metric
+)
+{
+    switch ( metric ) {
+        case ExecutionTimerMetricWalltime:
+        case ExecutionTimerMetricUserCPU:
+        case ExecutionTimerMetricSystemCPU:
+        case ExecutionTimerMetricMaxRSS:
+        case ExecutionTimerMetricNSwaps:
+        case ExecutionTimerMetricIOBlocksIn:
+        case ExecutionTimerMetricIOBlocksOut:
+            return false;
+    }
+    return true;
+}
 
-            case ExecutionTimerOutputFormatYAML:
-                if ( timerName ) {
-                    fprintf(stream, "%s:\n", timerName);
-                    indent = "    ";
-                } else {
-                    indent = "";
-                }
-                break;
+//
 
-        }
-        for ( metric = ExecutionTimerMetricWalltime; metric < ExecutionTimerMetricEOL; metric++ ) {
-            switch ( format ) {
-                case ExecutionTimerOutputFormatTable:
-                    fprintf(stream, "%24s %16lg %16lg %16lg %16lg %16lg %16lg\n",
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMin),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMax),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueAverage),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueVariance),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueStdDeviation)
-                    );
-                    break;
+void
+__ExecutionTimerSummarizeValues(
+    ExecutionTimerSummaryState  *state,
+    const char                  *rowName,
+    const double                *values
+)
+{
+    FILE                        *stream = state->stream;
+    unsigned int                i;
+
+    switch ( state->format ) {
+        case ExecutionTimerOutputFormatTable:
+            fprintf(stream, "%24s", rowName);
+            for ( i = 0; i < state->nColumns; i++ ) fprintf(stream, " %16lg", values[i]);
+            fputc('\n', stream);
+            break;
+
+        case ExecutionTimerOutputFormatTSV:
+        case ExecutionTimerOutputFormatCSV:
+            fprintf(stream, "\"%s\"", rowName);
+            for ( i = 0; i < state->nColumns; i++ ) {
+                double          v = values[i];
+
+                // Non-finite values are left empty:
+                fputs(state->delim, stream);
+                if ( isfinite(v) ) fprintf(stream, "%lg", v);
+            }
+            fputc('\n', stream);
+            break;
 
-                case ExecutionTimerOutputFormatTSV:
-                case ExecutionTimerOutputFormatCSV:
-                    fprintf(stream, "\"%2$s\"%1$s%3$lg%1$s%4$lg%1$s%5$lg%1$s%6$lg%1$s%7$lg%1$s%8$lg\n",
-                        delim,
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMin),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMax),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueAverage),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueVariance),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueStdDeviation)
-                    );
-                    break;
+        case ExecutionTimerOutputFormatJSON:
+            fprintf(stream, "%s\"%s\":{", state->delim, rowName);
+            for ( i = 0; i < state->nColumns; i++ ) {
+                double          v = values[i];
 
-                case ExecutionTimerOutputFormatJSON:
-                    fprintf(stream, "%s\"%s\":{\"last-value\":%lg, \"minimum\":%lg, \"maximum\":%lg, \"average\":%lg, \"variance\":%lg, \"standard-deviation\":%lg}", delim,
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMin),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMax),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueAverage),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueVariance),
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueStdDeviation)
-                    );
-                    delim = ",";
-                    break;
+                // JSON has no representation for non-finite values:
+                fprintf(stream, "%s\"%s\":", (i ? ", " : ""), __ExecutionTimerSummaryColumns[i].key);
+                if ( isfinite(v) ) fprintf(stream, "%lg", v); else fputs("null", stream);
+            }
+            fputc('}', stream);
+            state->delim = ",";
+            break;
 
-                case ExecutionTimerOutputFormatYAML:
-                    fprintf(stream, "%s%s:\n", indent, ExecutionTimerMetricNames[metric]);
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "last-value", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue));
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "minimum", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMin));
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "maximum", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueMax));
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "average", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueAverage));
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "variance", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueVariance));
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "standard-deviation", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueStdDeviation));
-                    break;
+        case ExecutionTimerOutputFormatYAML:
+            fprintf(stream, "%s%s:\n", state->indent, rowName);
+            for ( i = 0; i < state->nColumns; i++ ) {
+                double          v = values[i];
+
+                fprintf(stream, "%1$s%1$s%2$s: ", state->indent, __ExecutionTimerSummaryColumns[i].key);
+                if ( isfinite(v) ) fprintf(stream, "%lg\n", v); else fputs("~\n", stream);
             }
-        }
-        switch ( format ) {
-            default:
-                break;
+            break;
+    }
+}
 
-            case ExecutionTimerOutputFormatJSON:
-                fprintf(stream, timerName ? "}}" : "}");
-                break;
-        }
-    } else {
-        ExecutionTimerMetric    metric;
-        const char              *delim = ",", *indent;
-
-        switch ( format ) {
-            case ExecutionTimerOutputFormatTable:
-                fprintf(stream, "%24.24s %16.16s\n",
-                        timerName ? timerName : "",
-                        "last value"
-                    );
-                fprintf(stream, "%1$.24s %1$.16s\n",
-                        "-------------------------------"
-                    );
-                break;
+//
 
-            case ExecutionTimerOutputFormatTSV:
-                delim = "\t";
-            case ExecutionTimerOutputFormatCSV:
-                fprintf(stream, "\"%2$s\"%1$s\"%3$s\"\n",
-                        delim,
-                        timerName ? timerName : "",
-                        "last value"
-                    );
-                break;
+void
+__ExecutionTimerSummarizeRow(
+    ExecutionTimerSummaryState  *state,
+    const char                  *rowName,
+    ExecutionTimerDatum         *d
+)
+{
+    double                      values[sizeof(__ExecutionTimerSummaryColumns) / sizeof(__ExecutionTimerSummaryColumns[0])];
+    unsigned int                i;
 
-            case ExecutionTimerOutputFormatJSON:
-                fprintf(stream, timerName ? "{\"%s\":{" : "{", timerName);
-                delim = "";
-                break;
+    for ( i = 0; i < state->nColumns; i++ ) values[i] = ExecutionTimerDatumGetValue(d, __ExecutionTimerSummaryColumns[i].value);
+    __ExecutionTimerSummarizeValues(state, rowName, values);
+}
 
-            case ExecutionTimerOutputFormatYAML:
-                if ( timerName ) {
-                    fprintf(stream, "%s:\n", timerName);
-                    indent = "    ";
-                } else {
-                    indent = "";
-                }
-                break;
+//
+
+void
+__ExecutionTimerSummarizeFooter(
+    ExecutionTimerSummaryState  *state
+)
+{
+    switch ( state->format ) {
+        default:
+            break;
+
+        case ExecutionTimerOutputFormatJSON:
+            fprintf(state->stream, state->timerName ? "}}" : "}");
+            break;
+    }
+}
+
+//
+
+void
+__ExecutionTimerSummarizeRegions(
+    ExecutionTimerSummaryState  *state,
+    ExecutionTimerRegion        *aRegion,
+    const char                  *prefix
+)
+{
+    ExecutionTimerRegion        *child;
+
+    // Rows are named by the path of the region, e.g. "Region compute/epilogue":
+    for ( child = aRegion->firstChild; child; child = child->nextSibling ) {
+        char                    rowName[strlen(prefix) + strlen(child->name) + 2];
+
+        snprintf(rowName, sizeof(rowName), "%s%s", prefix, child->name);
+        if ( child->time.count > 0 ) __ExecutionTimerSummarizeRow(state, rowName, &child->time);
+        strcat(rowName, "/");
+        __ExecutionTimerSummarizeRegions(state, child, rowName);
+    }
+}
+
+//
 
+void
+ExecutionTimerSummarizeToStream(
+    ExecutionTimerRef           aTimer,
+    ExecutionTimerOutputFormat  format,
+    const char                  *timerName,
+    FILE                        *stream
+)
+{
+    ExecutionTimerSummaryState  state = {
+                                        .format = format,
+                                        .withStatistics = ExecutionTimerHasStatistics(aTimer),
+                                        .timerName = timerName,
+                                        .stream = stream
+                                    };
+    ExecutionTimerMetric        metric;
+
+    __ExecutionTimerSummarizeHeader(&state);
+    for ( metric = ExecutionTimerMetricWalltime; metric < ExecutionTimerMetricEOL; metric++ ) {
+        // Optional metrics (and, once timing has happened, any others) that were
+        // never collected are not displayed:
+        if ( (aTimer->metrics[metric].count == 0) && (__ExecutionTimerMetricIsOptional(metric) || (aTimer->cycleCount > 0)) ) continue;
+        if ( metric == ExecutionTimerMetricSlowestThread ) {
+            //
+            // A slot index is categorical, so statistics of it are
+            // meaningless; every column holds the slot that was slowest in
+            // the most cycles:
+            //
+            double                  mode[sizeof(__ExecutionTimerSummaryColumns) / sizeof(__ExecutionTimerSummaryColumns[0])];
+            unsigned int            i, modeSlot = 0;
+
+            for ( i = 1; i < aTimer->nThreadSlots; i++ ) {
+                if ( aTimer->threadSlots[i].slowestCount > aTimer->threadSlots[modeSlot].slowestCount ) modeSlot = i;
+            }
+            for ( i = 0; i < state.nColumns; i++ ) mode[i] = (double)modeSlot;
+            __ExecutionTimerSummarizeValues(&state, ExecutionTimerMetricNames[metric], mode);
+            continue;
         }
-        for ( metric = ExecutionTimerMetricWalltime; metric < ExecutionTimerMetricEOL; metric++ ) {
+        __ExecutionTimerSummarizeRow(&state, ExecutionTimerMetricNames[metric], &aTimer->metrics[metric]);
+    }
+    for ( metric = 0; metric < aTimer->nThreadSlots; metric++ ) {
+        char                    rowName[32];
+
+        if ( aTimer->threadSlots[metric].cpuTime.count == 0 ) continue;
+        snprintf(rowName, sizeof(rowName), "Thread %u CPU time", metric);
+        __ExecutionTimerSummarizeRow(&state, rowName, &aTimer->threadSlots[metric].cpuTime);
+    }
+    for ( metric = 0; metric < aTimer->nThreadSlots; metric++ ) {
+        char                    rowName[32];
+
+        if ( aTimer->threadSlots[metric].ioRate.count == 0 ) continue;
+        snprintf(rowName, sizeof(rowName), "Thread %u I/O MB/s", metric);
+        __ExecutionTimerSummarizeRow(&state, rowName, &aTimer->threadSlots[metric].ioRate);
+    }
+    __ExecutionTimerSummarizeRegions(&state, &aTimer->regionRoot, "Region ");
+    if ( aTimer->hasOverhead ) {
+        __ExecutionTimerSummarizeRow(&state, "Timer overhead", &aTimer->overhead);
+        if ( ! ExecutionTimerIsReliable(aTimer) ) {
+            //
+            // Mark the result; the delimited formats have no place for it:
+            //
             switch ( format ) {
                 case ExecutionTimerOutputFormatTable:
-                    fprintf(stream, "%24s %16lg\n",
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue)
-                    );
-                    break;
-
-                case ExecutionTimerOutputFormatTSV:
-                case ExecutionTimerOutputFormatCSV:
-                    fprintf(stream, "\"%2$s\"%1$s%3$lg\n",
-                        delim,
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue)
-                    );
+                    fprintf(stream, "%24s walltime within %gx of the timer overhead; result is unreliable\n", "*", (double)EXECUTIONTIMER_RELIABILITY_FACTOR);
                     break;
-
                 case ExecutionTimerOutputFormatJSON:
-                    fprintf(stream, "%s\"%s\":{\"last-value\":%lg}", delim,
-                        ExecutionTimerMetricNames[metric],
-                        ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue)
-                    );
-                    delim = ",";
+                    fprintf(stream, ",\"unreliable\":true");
                     break;
-
                 case ExecutionTimerOutputFormatYAML:
-                    fprintf(stream, "%s%s:\n", indent, ExecutionTimerMetricNames[metric]);
-                    fprintf(stream, "%1$s%1$s%2$s: %3$lg\n", indent, "last-value", ExecutionTimerGetValue(aTimer, metric, ExecutionTimerValueLastValue));
+                    fprintf(stream, "%sunreliable: true\n", state.indent);
+                    break;
+                default:
                     break;
             }
         }
-        switch ( format ) {
-            default:
-                break;
-
-            case ExecutionTimerOutputFormatJSON:
-                fprintf(stream, timerName ? "}}" : "}");
-                break;
-        }
     }
+    __ExecutionTimerSummarizeFooter(&state);
 }
 
 //
@@ -568,39 +2948,112 @@ ExecutionTimerSummarizeToStream(
 
 #include "FortranInterface.h"
 
-#ifndef EXECUTIONTIMER_FORTRAN_MAX_INSTANCES
-#define EXECUTIONTIMER_FORTRAN_MAX_INSTANCES 8
+//
+// Fortran code refers to timers by integer ids that index a table of
+// EXECUTIONTIMER_FORTRAN_CHUNK_SIZE-slot chunks.  Chunks are allocated on
+// demand and never freed or moved, and slots are claimed and released with
+// compare-and-swap, so the table grows without locks and lookups are a pair
+// of atomic loads.
+//
+#ifndef EXECUTIONTIMER_FORTRAN_CHUNK_SIZE
+#define EXECUTIONTIMER_FORTRAN_CHUNK_SIZE 64
+#endif
+
+#ifndef EXECUTIONTIMER_FORTRAN_MAX_CHUNKS
+#define EXECUTIONTIMER_FORTRAN_MAX_CHUNKS 1024
 #endif
 
-static bool ExecutionTimerFortranInstancesReady = false;
-static ExecutionTimerRef ExecutionTimerFortranInstances[EXECUTIONTIMER_FORTRAN_MAX_INSTANCES];
+typedef struct ExecutionTimerFortranChunk {
+    _Atomic(ExecutionTimerRef)  slots[EXECUTIONTIMER_FORTRAN_CHUNK_SIZE];
+} ExecutionTimerFortranChunk;
+
+static _Atomic(ExecutionTimerFortranChunk*) ExecutionTimerFortranChunks[EXECUTIONTIMER_FORTRAN_MAX_CHUNKS];
+
+//
+
+ExecutionTimerRef
+__ExecutionTimerFortranLookup(
+    f_integer       timer_id
+)
+{
+    ExecutionTimerFortranChunk  *chunk;
+
+    if ( (timer_id < 0) || (timer_id >= EXECUTIONTIMER_FORTRAN_MAX_CHUNKS * EXECUTIONTIMER_FORTRAN_CHUNK_SIZE) ) return NULL;
+    chunk = atomic_load_explicit(&ExecutionTimerFortranChunks[timer_id / EXECUTIONTIMER_FORTRAN_CHUNK_SIZE], memory_order_acquire);
+    if ( ! chunk ) return NULL;
+    return atomic_load_explicit(&chunk->slots[timer_id % EXECUTIONTIMER_FORTRAN_CHUNK_SIZE], memory_order_acquire);
+}
+
+//
 
 f_integer
-FORTRAN_FN_NAME(executiontimer_create)(void)
+__ExecutionTimerFortranRegister(
+    ExecutionTimerRef   aTimer
+)
 {
-    f_integer       i;
+    unsigned int        c, s;
 
-    if ( ! ExecutionTimerFortranInstancesReady ) {
-        memset(&ExecutionTimerFortranInstances[0], 0, sizeof(ExecutionTimerFortranInstances));
-        ExecutionTimerFortranInstancesReady = true;
-    }
+    for ( c = 0; c < EXECUTIONTIMER_FORTRAN_MAX_CHUNKS; c++ ) {
+        ExecutionTimerFortranChunk  *chunk = atomic_load_explicit(&ExecutionTimerFortranChunks[c], memory_order_acquire);
+
+        if ( ! chunk ) {
+            ExecutionTimerFortranChunk  *expected = NULL;
 
-    // Find first free slot:
-    i = 0;
-    while ( i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES ) {
-        if ( ExecutionTimerFortranInstances[i] == NULL ) {
-            if ( (ExecutionTimerFortranInstances[i] = ExecutionTimerCreate()) ) {
-                return i;
+            // Race to install a new chunk; the loser frees its copy:
+            if ( ! (chunk = (ExecutionTimerFortranChunk*)calloc(1, sizeof(ExecutionTimerFortranChunk))) ) return -1;
+            if ( ! atomic_compare_exchange_strong(&ExecutionTimerFortranChunks[c], &expected, chunk) ) {
+                free((void*)chunk);
+                chunk = expected;
             }
         }
-        i++;
-    }
+        for ( s = 0; s < EXECUTIONTIMER_FORTRAN_CHUNK_SIZE; s++ ) {
+            ExecutionTimerRef   expected = NULL;
 
+            if ( atomic_compare_exchange_strong(&chunk->slots[s], &expected, aTimer) ) {
+                return (f_integer)(c * EXECUTIONTIMER_FORTRAN_CHUNK_SIZE + s);
+            }
+        }
+    }
     return -1;
 }
 
 //
 
+f_integer
+FORTRAN_FN_NAME(executiontimer_create)(void)
+{
+    ExecutionTimerRef   newTimer = ExecutionTimerCreate();
+    f_integer           i = -1;
+
+    if ( newTimer && ((i = __ExecutionTimerFortranRegister(newTimer)) < 0) ) ExecutionTimerRelease(newTimer);
+    return i;
+}
+
+//
+
+f_integer
+ExecutionTimerFortranGetId(
+    ExecutionTimerRef   aTimer
+)
+{
+    unsigned int        c, s;
+    f_integer           i;
+
+    // Already registered?
+    for ( c = 0; c < EXECUTIONTIMER_FORTRAN_MAX_CHUNKS; c++ ) {
+        ExecutionTimerFortranChunk  *chunk = atomic_load_explicit(&ExecutionTimerFortranChunks[c], memory_order_acquire);
+
+        if ( ! chunk ) break;
+        for ( s = 0; s < EXECUTIONTIMER_FORTRAN_CHUNK_SIZE; s++ ) {
+            if ( atomic_load_explicit(&chunk->slots[s], memory_order_acquire) == aTimer ) return (f_integer)(c * EXECUTIONTIMER_FORTRAN_CHUNK_SIZE + s);
+        }
+    }
+    if ( (i = __ExecutionTimerFortranRegister(aTimer)) >= 0 ) ExecutionTimerRetain(aTimer);
+    return i;
+}
+
+//
+
 void
 FORTRAN_FN_NAME(executiontimer_destroy)(
     f_integer   *timer_id
@@ -608,11 +3061,11 @@ FORTRAN_FN_NAME(executiontimer_destroy)(
 {
     f_integer   i = *timer_id;
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            ExecutionTimerRelease(ExecutionTimerFortranInstances[i]);
-            ExecutionTimerFortranInstances[i] = NULL;
-        }
+    if ( __ExecutionTimerFortranLookup(i) ) {
+        ExecutionTimerFortranChunk  *chunk = atomic_load_explicit(&ExecutionTimerFortranChunks[i / EXECUTIONTIMER_FORTRAN_CHUNK_SIZE], memory_order_acquire);
+        ExecutionTimerRef           aTimer = atomic_exchange(&chunk->slots[i % EXECUTIONTIMER_FORTRAN_CHUNK_SIZE], NULL);
+
+        if ( aTimer ) ExecutionTimerRelease(aTimer);
     }
     *timer_id = -1;
 }
@@ -624,28 +3077,73 @@ FORTRAN_FN_NAME(executiontimer_reset)(
     f_integer   *timer_id
 )
 {
-    f_integer   i = *timer_id;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            ExecutionTimerReset(ExecutionTimerFortranInstances[i]);
-        }
+    if ( aTimer ) {
+        ExecutionTimerReset(aTimer);
+    }
+}
+
+//
+
+void
+FORTRAN_FN_NAME(executiontimer_setscope)(
+    f_integer   *timer_id,
+    f_integer   *scope
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer && (*scope >= 0) ) {
+        ExecutionTimerSetScope(aTimer, (ExecutionTimerScope)*scope);
+    }
+}
+
+//
+
+void
+FORTRAN_FN_NAME(executiontimer_pushregion)(
+    f_integer   *timer_id,
+    const char  *region_name,
+    size_t      region_name_len
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer ) {
+        char    name[region_name_len + 1];
+
+        // Fortran strings are blank-padded, not nul-terminated:
+        while ( (region_name_len > 0) && (region_name[region_name_len - 1] == ' ') ) region_name_len--;
+        memcpy(name, region_name, region_name_len);
+        name[region_name_len] = '\0';
+        ExecutionTimerPushRegion(aTimer, name);
     }
 }
 
 //
 
+void
+FORTRAN_FN_NAME(executiontimer_popregion)(
+    f_integer   *timer_id
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer ) ExecutionTimerPopRegion(aTimer);
+}
+
+//
+
 void
 FORTRAN_FN_NAME(executiontimer_start)(
     f_integer   *timer_id
 )
 {
-    f_integer   i = *timer_id;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            ExecutionTimerStart(ExecutionTimerFortranInstances[i]);
-        }
+    if ( aTimer ) {
+        ExecutionTimerStart(aTimer);
     }
 }
 
@@ -656,12 +3154,56 @@ FORTRAN_FN_NAME(executiontimer_stop)(
     f_integer   *timer_id
 )
 {
-    f_integer   i = *timer_id;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            ExecutionTimerStop(ExecutionTimerFortranInstances[i]);
-        }
+    if ( aTimer ) {
+        ExecutionTimerStop(aTimer);
+    }
+}
+
+//
+
+void
+FORTRAN_FN_NAME(executiontimer_threadstart)(
+    f_integer   *timer_id,
+    f_integer   *thread_id
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer ) {
+        ExecutionTimerThreadStart(aTimer, *thread_id);
+    }
+}
+
+//
+
+void
+FORTRAN_FN_NAME(executiontimer_threadstop)(
+    f_integer   *timer_id,
+    f_integer   *thread_id
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer ) {
+        ExecutionTimerThreadStop(aTimer, *thread_id);
+    }
+}
+
+//
+
+void
+FORTRAN_FN_NAME(executiontimer_setworkmodel)(
+    f_integer   *timer_id,
+    f_real      *flops,
+    f_real      *bytes
+)
+{
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+
+    if ( aTimer ) {
+        ExecutionTimerSetWorkModel(aTimer, *flops, *bytes);
     }
 }
 
@@ -674,13 +3216,11 @@ FORTRAN_FN_NAME(executiontimer_getvalue)(
     f_integer   *value_id
 )
 {
-    f_integer   i = *timer_id;
-    double      v = INFINITY;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+    double              v = INFINITY;
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, *value_id);
-        }
+    if ( aTimer ) {
+        v = ExecutionTimerGetValue(aTimer, *metric_id, *value_id);
     }
     if ( v == INFINITY ) {
 #ifdef HAVE_FORTRAN_REAL8
@@ -712,31 +3252,29 @@ FORTRAN_FN_NAME(executiontimer_getvalues)(
     f_real      *stdDeviationValue
 )
 {
-    f_integer   i = *timer_id;
-    double      v = INFINITY;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
+    double              v = INFINITY;
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueLastValue);
-            *lastValue = EXECUTIONTIMER_MAP_INFINITY(v);
+    if ( aTimer ) {
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueLastValue);
+        *lastValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueMin);
-            *minValue = EXECUTIONTIMER_MAP_INFINITY(v);
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueMin);
+        *minValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueMax);
-            *maxValue = EXECUTIONTIMER_MAP_INFINITY(v);
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueMax);
+        *maxValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueAverage);
-            *averageValue = EXECUTIONTIMER_MAP_INFINITY(v);
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueAverage);
+        *averageValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueVariance);
-            *varianceValue = EXECUTIONTIMER_MAP_INFINITY(v);
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueVariance);
+        *varianceValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            v = ExecutionTimerGetValue(ExecutionTimerFortranInstances[i], *metric_id, ExecutionTimerValueStdDeviation);
-            *stdDeviationValue = EXECUTIONTIMER_MAP_INFINITY(v);
+        v = ExecutionTimerGetValue(aTimer, *metric_id, ExecutionTimerValueStdDeviation);
+        *stdDeviationValue = EXECUTIONTIMER_MAP_INFINITY(v);
 
-            return F_TRUE;
-        }
+        return F_TRUE;
     }
     return F_FALSE;
 }
@@ -750,18 +3288,15 @@ FORTRAN_FN_NAME(executiontimer_summarize)(
     f_integer   nameLen
 )
 {
-    f_integer   i = *timer_id;
-    double      v = INFINITY;
+    ExecutionTimerRef   aTimer = __ExecutionTimerFortranLookup(*timer_id);
 
-    if ( ExecutionTimerFortranInstancesReady && (i >= 0) && (i < EXECUTIONTIMER_FORTRAN_MAX_INSTANCES) ) {
-        if ( ExecutionTimerFortranInstances[i] ) {
-            char        localName[nameLen + 1];
+    if ( aTimer ) {
+        char        localName[nameLen + 1];
 
-            memcpy(localName, name, nameLen);
-            localName[nameLen] = '\0';
+        memcpy(localName, name, nameLen);
+        localName[nameLen] = '\0';
 
-            ExecutionTimerSummarizeToStream(ExecutionTimerFortranInstances[i], ExecutionTimerOutputFormatTable, localName, stdout);
-        }
+        ExecutionTimerSummarizeToStream(aTimer, ExecutionTimerOutputFormatTable, localName, stdout);
     }
 }
 
@@ -799,7 +3334,7 @@ main()
         }
         ExecutionTimerStop(theTimer);
     }
-    ExecutionTimerSummarizeToStream(theTimer, NULL, stdout);
+    ExecutionTimerSummarizeToStream(theTimer, ExecutionTimerOutputFormatTable, NULL, stdout);
 
     FILE                    *fptr = fopen("/dev/null", "w");
 
@@ -812,7 +3347,21 @@ main()
     fclose(fptr);
 
     printf("\n\n");
-    ExecutionTimerSummarizeToStream(theTimer, "file write", stdout);
+    ExecutionTimerSummarizeToStream(theTimer, ExecutionTimerOutputFormatTable, "file write", stdout);
+
+    // Each worker thread times its own rows in a private shard:
+    ExecutionTimerReset(theTimer);
+    #pragma omp parallel for private(j)
+    for ( i = 0; i < MATRIX_DIM; i++ ) {
+        ExecutionTimerStart(theTimer);
+        for ( j = 0; j < MATRIX_DIM; j++ ) {
+            M[i*MATRIX_DIM + j] = i * i - 2 * i * j + j * j;
+        }
+        ExecutionTimerStop(theTimer);
+    }
+
+    printf("\n\n");
+    ExecutionTimerSummarizeToStream(theTimer, ExecutionTimerOutputFormatTable, "parallel rows", stdout);
 
     ExecutionTimerRelease(theTimer);
 
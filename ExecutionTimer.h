@@ -25,6 +25,193 @@ typedef struct ExecutionTimer * ExecutionTimerRef;
  */
 ExecutionTimerRef ExecutionTimerCreate(void);
 
+/*!
+ * @enum ExecutionTimerScope
+ *
+ * The scope over which an ExecutionTimer object accounts CPU time and
+ * resource usage:
+ *
+ *     ExecutionTimerScopeProcess:  all threads of the process (getrusage(RUSAGE_SELF)
+ *                                  and CLOCK_PROCESS_CPUTIME_ID); the default
+ *     ExecutionTimerScopeThread:   only the calling thread (getrusage(RUSAGE_THREAD)
+ *                                  and CLOCK_THREAD_CPUTIME_ID)
+ *
+ * A thread-scope timer must be started and stopped on the same thread.
+ * Walltime is always measured with CLOCK_MONOTONIC.
+ */
+enum {
+    ExecutionTimerScopeProcess = 0,
+    ExecutionTimerScopeThread,
+    //
+    ExecutionTimerScopeMax,
+    ExecutionTimerScopeInvalid
+};
+
+/*!
+ * @typedef ExecutionTimerScope
+ *
+ * Type used in conjunction with the ExecutionTimerScope enumeration.
+ */
+typedef unsigned int ExecutionTimerScope;
+
+/*!
+ * @function ExecutionTimerCreateWithScope
+ *
+ * Allocate and initialize a new ExecutionTimer object that accounts CPU time
+ * and resource usage over theScope.
+ */
+ExecutionTimerRef ExecutionTimerCreateWithScope(ExecutionTimerScope theScope);
+
+/*!
+ * @function ExecutionTimerGetScope
+ *
+ * Returns the resource accounting scope of aTimer.
+ */
+ExecutionTimerScope ExecutionTimerGetScope(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerSetScope
+ *
+ * Change the resource accounting scope of aTimer.  Values accumulated under
+ * a different scope are not comparable, so aTimer is reset if the scope
+ * changes.
+ */
+void ExecutionTimerSetScope(ExecutionTimerRef aTimer, ExecutionTimerScope theScope);
+
+/*!
+ * @function ExecutionTimerScopes
+ *
+ * Returns a string containing the recognized scope names delimited
+ * by vertical bars (for help text).
+ */
+const char* ExecutionTimerScopes(void);
+
+/*!
+ * @function ExecutionTimerScopeParse
+ *
+ * Returns the scope named by s (case-insensitive), ExecutionTimerScopeProcess
+ * if s is NULL or empty, or ExecutionTimerScopeInvalid.
+ */
+ExecutionTimerScope ExecutionTimerScopeParse(const char *s);
+
+/*!
+ * @function ExecutionTimerScopeToString
+ *
+ * Returns the name of theScope.
+ */
+const char* ExecutionTimerScopeToString(ExecutionTimerScope theScope);
+
+/*!
+ * @enum ExecutionTimerClock
+ *
+ * The clock an ExecutionTimer object uses:
+ *
+ *     ExecutionTimerClockMonotonic:  walltime from CLOCK_MONOTONIC plus CPU time
+ *                                    and resource usage (see ExecutionTimerScope);
+ *                                    the default
+ *     ExecutionTimerClockTSC:        walltime only, from the time-stamp counter
+ *                                    (rdtsc/rdtscp fenced with lfence) converted
+ *                                    with the frequency measured by
+ *                                    ExecutionTimerCalibrateTSC()
+ *
+ * A start/stop pair with the monotonic clock costs several microseconds of
+ * system calls; the TSC clock costs tens of nanoseconds, so it is suited to
+ * very short intervals.  Without an invariant TSC the TSC clock falls back to
+ * CLOCK_MONOTONIC_RAW (still without resource usage).
+ */
+enum {
+    ExecutionTimerClockMonotonic = 0,
+    ExecutionTimerClockTSC,
+    //
+    ExecutionTimerClockMax,
+    ExecutionTimerClockInvalid
+};
+
+/*!
+ * @typedef ExecutionTimerClock
+ *
+ * Type used in conjunction with the ExecutionTimerClock enumeration.
+ */
+typedef unsigned int ExecutionTimerClock;
+
+/*!
+ * @function ExecutionTimerCalibrateTSC
+ *
+ * Check for an invariant time-stamp counter (CPUID leaf 0x80000007) and
+ * measure its frequency against CLOCK_MONOTONIC_RAW (the median of several
+ * 10 ms rounds).  Calibration happens once per process; it is performed
+ * implicitly when a timer first selects ExecutionTimerClockTSC, so programs
+ * may call this at startup to keep it out of the measurements.
+ *
+ * Returns boolean true if an invariant TSC is available.
+ */
+bool ExecutionTimerCalibrateTSC(void);
+
+/*!
+ * @function ExecutionTimerGetTSCFrequency
+ *
+ * Returns the calibrated TSC frequency in Hz, or zero if no invariant TSC is
+ * available.
+ */
+double ExecutionTimerGetTSCFrequency(void);
+
+/*!
+ * @function ExecutionTimerGetClock
+ *
+ * Returns the clock used by aTimer.
+ */
+ExecutionTimerClock ExecutionTimerGetClock(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerSetClock
+ *
+ * Change the clock used by aTimer; aTimer is reset if the clock changes.
+ */
+void ExecutionTimerSetClock(ExecutionTimerRef aTimer, ExecutionTimerClock theClock);
+
+/*!
+ * @function ExecutionTimerClocks
+ *
+ * Returns a string containing the recognized clock names delimited
+ * by vertical bars (for help text).
+ */
+const char* ExecutionTimerClocks(void);
+
+/*!
+ * @function ExecutionTimerClockParse
+ *
+ * Returns the clock named by s (case-insensitive), ExecutionTimerClockMonotonic
+ * if s is NULL or empty, or ExecutionTimerClockInvalid.
+ */
+ExecutionTimerClock ExecutionTimerClockParse(const char *s);
+
+/*!
+ * @function ExecutionTimerClockToString
+ *
+ * Returns the name of theClock.
+ */
+const char* ExecutionTimerClockToString(ExecutionTimerClock theClock);
+
+/*!
+ * @function ExecutionTimerGetBatchSize
+ *
+ * Returns the number of start-stop pairs that make up one cycle of aTimer.
+ */
+unsigned int ExecutionTimerGetBatchSize(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerSetBatchSize
+ *
+ * Time batches of batchSize calls as a single cycle:  the first
+ * ExecutionTimerStart() of a batch starts the clock, the intervening
+ * stop/start pairs only count calls, and the batchSize'th ExecutionTimerStop()
+ * stops the clock.  Times and counts are divided by batchSize, so each cycle
+ * reports per-call values for code too quick to time individually.  Anything
+ * executed between the calls of a batch is included in the measurement.
+ * aTimer is reset if the batch size changes.
+ */
+void ExecutionTimerSetBatchSize(ExecutionTimerRef aTimer, unsigned int batchSize);
+
 /*!
  * @function ExecutionTimerRetain
  *
@@ -72,6 +259,19 @@ bool ExecutionTimerHasStatistics(ExecutionTimerRef aTimer);
  *
  * Additional calls to ExecutionTimerStart() without calling ExecutionTimerStop()
  * simply restart the current timing cycle and do NOT accumulate statistics.
+ *
+ * ExecutionTimerStart() and ExecutionTimerStop() may be called concurrently
+ * from any number of threads, e.g. inside an OpenMP parallel region.  Cycles
+ * issued by a thread other than the one that created aTimer (or from inside
+ * a parallel region) are timed independently on each thread without locks:
+ * walltime (on the timer's clock) and the calling thread's CPU time are
+ * accumulated in a per-thread shard, and the shards are merged into the
+ * Walltime and CPU time metrics -- and the cycle count -- when aTimer is
+ * next read.  Resource usage, hardware counters, regions, and derived
+ * metrics are only collected by the creating thread.
+ *
+ * Reading values, ExecutionTimerReset(), and the final ExecutionTimerRelease()
+ * must happen outside of any concurrent use of aTimer.
  */
 void ExecutionTimerStart(ExecutionTimerRef aTimer);
 
@@ -95,6 +295,43 @@ unsigned int ExecutionTimerCycleCount(ExecutionTimerRef aTimer);
  * @enum ExecutionTimerMetric
  *
  * The various metrics that are maintained by an ExecutionTimer object.
+ *
+ * The I/O MB/s and IOPS metrics are derived from the walltime and the
+ * bytes and operations counted with ExecutionTimerCountIO() during each
+ * cycle; they are only collected for cycles that counted I/O.  Cache
+ * residency is the fraction of the data to be read that was already in the
+ * page cache, as noted by ExecutionTimerNoteCacheResidency().
+ *
+ * The GFLOP/s, GB/s, and arithmetic intensity metrics are derived from
+ * the walltime and the work model attached to the timer (see
+ * ExecutionTimerSetWorkModel()); they are only collected while a work
+ * model is present.
+ *
+ * The perf.* metrics are hardware event counts collected via perf_event_open()
+ * and are only present when enabled with ExecutionTimerEnableHardwareCounters().
+ * The counts are scaled to compensate for multiplexing of the PMU.  IPC is
+ * derived from the cycle and instruction counts; the misses per kflop metrics
+ * additionally require a work model.
+ *
+ * The thread imbalance (maximum over mean per-thread busy time) and slowest
+ * thread (slot index of the maximum) metrics are only present when per-thread
+ * busy times have been collected (see ExecutionTimerPrepareThreadSlots() and
+ * ExecutionTimerSetShouldSampleThreads()).  The slowest thread is a slot index,
+ * not a thread id:  its value is the slot that was slowest in the last cycle,
+ * and summaries write the slot that was slowest in the most cycles into
+ * every column.  Sampled threads keep the slot assigned to their OS thread id
+ * the first time they consume CPU time until the timer is reset.
+ *
+ * CPU time is read from the nanosecond-resolution CPU clock of the timer's
+ * scope (see ExecutionTimerScope).  CPU utilization is the CPU time over
+ * walltime times the number of threads available to the cycle:  one for a
+ * thread-scope timer, otherwise the count passed to ExecutionTimerPrepareThreadSlots()
+ * or the number of sampled threads.  A value well below 1.0 for a
+ * process-scope timer indicates idle threads; OpenMP workers spin-waiting at
+ * a barrier count as busy.
+ *
+ * Timers using ExecutionTimerClockTSC collect neither resource usage, CPU
+ * time, nor CPU utilization.
  */
 enum {
     ExecutionTimerMetricWalltime = 0,
@@ -104,6 +341,27 @@ enum {
     ExecutionTimerMetricNSwaps,
     ExecutionTimerMetricIOBlocksIn,
     ExecutionTimerMetricIOBlocksOut,
+    ExecutionTimerMetricGFLOPs,
+    ExecutionTimerMetricGBPerSec,
+    ExecutionTimerMetricArithIntensity,
+    ExecutionTimerMetricHWCycles,
+    ExecutionTimerMetricHWInstructions,
+    ExecutionTimerMetricHWL1DMisses,
+    ExecutionTimerMetricHWLLCMisses,
+    ExecutionTimerMetricHWDTLBMisses,
+    ExecutionTimerMetricHWBranchMisses,
+    ExecutionTimerMetricIPC,
+    ExecutionTimerMetricL1DMissesPerKFlop,
+    ExecutionTimerMetricLLCMissesPerKFlop,
+    ExecutionTimerMetricThreadImbalance,
+    ExecutionTimerMetricSlowestThread,
+    ExecutionTimerMetricCPUTime,
+    ExecutionTimerMetricCPUUtilization,
+    ExecutionTimerMetricIOMBPerSec,
+    ExecutionTimerMetricIOPS,
+    ExecutionTimerMetricMinorFaults,
+    ExecutionTimerMetricMajorFaults,
+    ExecutionTimerMetricCacheResidency,
     //
     ExecutionTimerMetricEOL
 };
@@ -120,6 +378,16 @@ typedef unsigned int ExecutionTimerMetric;
  *
  * The various values that are maintained by an ExecutionTimer object for
  * each metric.
+ *
+ * ExecutionTimerValueMeanCI95 is the half-width of the 95% confidence
+ * interval on the average (Student's t distribution).
+ *
+ * The order statistics (median, percentiles, median absolute deviation) are
+ * computed from a log-linear histogram of the samples, so they carry a
+ * relative error below 1%.  The 95% confidence interval on the median is
+ * bootstrapped from the same histogram, and ExecutionTimerValueOutliers is
+ * the number of samples beyond the Tukey fences (1.5 interquartile ranges
+ * outside the first and third quartiles).
  */
 enum {
     ExecutionTimerValueLastValue = 0,
@@ -128,6 +396,14 @@ enum {
     ExecutionTimerValueAverage,
     ExecutionTimerValueVariance,
     ExecutionTimerValueStdDeviation,
+    ExecutionTimerValueMeanCI95,
+    ExecutionTimerValueMedian,
+    ExecutionTimerValueP90,
+    ExecutionTimerValueP99,
+    ExecutionTimerValueMAD,
+    ExecutionTimerValueMedianCI95Low,
+    ExecutionTimerValueMedianCI95High,
+    ExecutionTimerValueOutliers,
     //
     ExecutionTimerValueEOL
 };
@@ -147,6 +423,319 @@ typedef unsigned int ExecutionTimerValue;
  */
 double ExecutionTimerGetValue(ExecutionTimerRef aTimer, ExecutionTimerMetric theMetric, ExecutionTimerValue theValue);
 
+/*!
+ * @function ExecutionTimerMetricIsActive
+ *
+ * Returns boolean true if at least one value of theMetric has been collected
+ * by aTimer since its creation (or last ExecutionTimerReset()).
+ */
+bool ExecutionTimerMetricIsActive(ExecutionTimerRef aTimer, ExecutionTimerMetric theMetric);
+
+/*!
+ * @function ExecutionTimerMetricGetName
+ *
+ * Returns a C string constant containing the display name of theMetric.
+ */
+const char* ExecutionTimerMetricGetName(ExecutionTimerMetric theMetric);
+
+/*!
+ * @function ExecutionTimerSetWorkModel
+ *
+ * Attach a work model to aTimer:  each start-stop cycle is assumed to
+ * perform flops floating-point operations and move bytes bytes of data.
+ * Each cycle will then also produce the derived GFLOP/s, GB/s, and
+ * arithmetic intensity (flops per byte) metrics.  A non-positive flops or
+ * bytes disables the metrics that depend on it.
+ *
+ * The work model is not affected by ExecutionTimerReset().
+ */
+void ExecutionTimerSetWorkModel(ExecutionTimerRef aTimer, double flops, double bytes);
+
+/*!
+ * @function ExecutionTimerCountIO
+ *
+ * Add the bytes transferred by a number of i/o operations (e.g. read()
+ * calls or io_uring completions) to the current cycle of aTimer; the totals
+ * become the cycle's I/O MB/s and IOPS.  May be called from any thread.
+ */
+void ExecutionTimerCountIO(ExecutionTimerRef aTimer, double bytes, unsigned long operations);
+
+/*!
+ * @function ExecutionTimerNoteCacheResidency
+ *
+ * Note the fraction (0 to 1) of the data about to be read that is resident
+ * in the page cache; it becomes the cache residency of aTimer's next cycle
+ * to end.  Typically called just before ExecutionTimerStart().
+ */
+void ExecutionTimerNoteCacheResidency(ExecutionTimerRef aTimer, double fraction);
+
+/*!
+ * @function ExecutionTimerClearWorkModel
+ *
+ * Remove any work model from aTimer; derived throughput metrics will no
+ * longer be collected.
+ */
+void ExecutionTimerClearWorkModel(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerEnableHardwareCounters
+ *
+ * Open a perf_event counter group (cycles, instructions, L1D/LLC/dTLB misses,
+ * and branch misses) for the calling process and read it at each start and
+ * stop of aTimer.  Threads created after this call are included in the counts.
+ *
+ * Returns boolean false (after writing a warning to stderr) if the counters
+ * are not available, e.g. because perf_event_paranoid denies access; the timer
+ * continues to function without them.
+ */
+bool ExecutionTimerEnableHardwareCounters(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerDisableHardwareCounters
+ *
+ * Close any perf_event counter group associated with aTimer.
+ */
+void ExecutionTimerDisableHardwareCounters(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerCalibrateOverhead
+ *
+ * Measure the cost of the timer itself:  an identically-configured timer
+ * (scope, clock, batch size, and hardware counters) is started and stopped
+ * around no code for nSamples cycles.  The distribution is displayed as a
+ * "Timer overhead" row by ExecutionTimerSummarizeToStream().  The calibration
+ * survives ExecutionTimerReset() but is discarded if the scope, clock, or
+ * batch size changes.
+ *
+ * Returns boolean false if memory could not be allocated.
+ */
+bool ExecutionTimerCalibrateOverhead(ExecutionTimerRef aTimer, unsigned int nSamples);
+
+/*!
+ * @function ExecutionTimerHasOverheadCalibration
+ *
+ * Returns boolean true if ExecutionTimerCalibrateOverhead() has measured the
+ * overhead of aTimer's current configuration.
+ */
+bool ExecutionTimerHasOverheadCalibration(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerGetOverheadValue
+ *
+ * Returns a statistic of the calibrated per-cycle timer overhead (in seconds),
+ * or INFINITY if aTimer has not been calibrated.
+ */
+double ExecutionTimerGetOverheadValue(ExecutionTimerRef aTimer, ExecutionTimerValue theValue);
+
+/*!
+ * @function ExecutionTimerSetShouldSubtractOverhead
+ *
+ * If shouldSubtractOverhead is true, the median calibrated overhead is
+ * subtracted from each walltime (clamped at zero) before statistics and
+ * derived rates are calculated.
+ */
+void ExecutionTimerSetShouldSubtractOverhead(ExecutionTimerRef aTimer, bool shouldSubtractOverhead);
+
+/*!
+ * @function ExecutionTimerIsReliable
+ *
+ * Returns boolean false if aTimer has been calibrated and its median walltime
+ * (before any subtraction) is less than ten times the median timer overhead,
+ * i.e. the measurement is dominated by the timer itself.
+ */
+bool ExecutionTimerIsReliable(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerPrepareThreadSlots
+ *
+ * Ensure aTimer has per-thread busy-time slots for thread ids 0 through
+ * nthreads - 1.  Must be called outside of any parallel region, before the
+ * threads call ExecutionTimerThreadStart()/ExecutionTimerThreadStop().
+ *
+ * Returns boolean false if the slots could not be allocated.
+ */
+bool ExecutionTimerPrepareThreadSlots(ExecutionTimerRef aTimer, int nthreads);
+
+/*!
+ * @function ExecutionTimerThreadStart
+ *
+ * Called by thread threadId inside a parallel region to mark the start of its
+ * share of the work.  Each thread only writes its own slot, so no locking is
+ * required.
+ */
+void ExecutionTimerThreadStart(ExecutionTimerRef aTimer, int threadId);
+
+/*!
+ * @function ExecutionTimerThreadStop
+ *
+ * Called by thread threadId inside a parallel region to mark the end of its
+ * share of the work (i.e. before any implicit barrier).  Busy time accumulates
+ * over all thread start-stops within a single timer cycle and is aggregated
+ * into the thread imbalance metrics by ExecutionTimerStop().
+ */
+void ExecutionTimerThreadStop(ExecutionTimerRef aTimer, int threadId);
+
+/*!
+ * @function ExecutionTimerThreadCountIO
+ *
+ * Called by thread threadId inside a parallel region to count the bytes and
+ * operations of its own i/o (see ExecutionTimerCountIO(), to whose totals
+ * they are also added).  The thread's bytes divided by its busy time become
+ * its "Thread N I/O MB/s" statistic.
+ */
+void ExecutionTimerThreadCountIO(ExecutionTimerRef aTimer, int threadId, double bytes, unsigned long operations);
+
+/*!
+ * @function ExecutionTimerSetShouldSampleThreads
+ *
+ * For code whose threads cannot be instrumented (e.g. a BLAS library's own
+ * thread pool), have aTimer sample the CPU time of every thread in the process
+ * (from /proc/self/task) at start and stop.  Threads that consumed CPU time
+ * during the cycle fill the per-thread slots in thread id order.  The sampling
+ * happens outside the timed interval.
+ */
+void ExecutionTimerSetShouldSampleThreads(ExecutionTimerRef aTimer, bool shouldSampleThreads);
+
+/*!
+ * @function ExecutionTimerThreadCount
+ *
+ * Returns the number of per-thread slots of aTimer that have statistics.
+ */
+unsigned int ExecutionTimerThreadCount(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerGetThreadCPUValue
+ *
+ * Return the given value of the per-thread CPU time for thread threadId of aTimer.
+ * Returns the constant INFINITY for undefined values.
+ */
+double ExecutionTimerGetThreadCPUValue(ExecutionTimerRef aTimer, int threadId, ExecutionTimerValue theValue);
+
+/*!
+ * @function ExecutionTimerSetShouldRecordSamples
+ *
+ * Have aTimer keep every cycle's value of every metric in memory, for export
+ * and offline analysis, in addition to the running statistics.  Recording
+ * appends one value per metric to growable arrays at the end of each cycle
+ * (outside the timed interval).  ExecutionTimerReset() discards the samples.
+ * Cycles accumulated in per-thread shards (see ExecutionTimerStart()) are
+ * not recorded.
+ */
+void ExecutionTimerSetShouldRecordSamples(ExecutionTimerRef aTimer, bool shouldRecordSamples);
+
+/*!
+ * @function ExecutionTimerGetSamples
+ *
+ * Returns the number of cycles recorded by aTimer and, in *outValues, the
+ * array of the metric's value in each of those cycles (owned by aTimer and
+ * valid until its next cycle or reset).  Cycles that did not produce the
+ * metric hold NaN.  Returns zero if samples are not being recorded.
+ */
+unsigned int ExecutionTimerGetSamples(ExecutionTimerRef aTimer, ExecutionTimerMetric theMetric, const double* *outValues);
+
+/*!
+ * @function ExecutionTimerSetName
+ *
+ * Give aTimer a name (copied), e.g. for identifying it to the event hook.
+ * Passing NULL removes the name.
+ */
+void ExecutionTimerSetName(ExecutionTimerRef aTimer, const char *name);
+
+/*!
+ * @function ExecutionTimerGetName
+ *
+ * Returns the name of aTimer, or NULL if it has none.
+ */
+const char* ExecutionTimerGetName(ExecutionTimerRef aTimer);
+
+/*!
+ * @enum ExecutionTimerEvent
+ *
+ * The events of a named timer reported to the event hook:
+ *
+ *     ExecutionTimerEventStart:        a cycle starts (label = timer name)
+ *     ExecutionTimerEventStop:         a cycle stops (label = timer name)
+ *     ExecutionTimerEventThreadStart:  ExecutionTimerThreadStart() (label = timer name)
+ *     ExecutionTimerEventThreadStop:   ExecutionTimerThreadStop() (label = timer name)
+ *     ExecutionTimerEventPushRegion:   a region opens (label = region name)
+ *     ExecutionTimerEventPopRegion:    a region closes (label = region name)
+ */
+enum {
+    ExecutionTimerEventStart = 0,
+    ExecutionTimerEventStop,
+    ExecutionTimerEventThreadStart,
+    ExecutionTimerEventThreadStop,
+    ExecutionTimerEventPushRegion,
+    ExecutionTimerEventPopRegion,
+    //
+    ExecutionTimerEventMax
+};
+
+/*!
+ * @typedef ExecutionTimerEvent
+ *
+ * Type used in conjunction with the ExecutionTimerEvent enumeration.
+ */
+typedef unsigned int ExecutionTimerEvent;
+
+/*!
+ * @typedef ExecutionTimerEventHook
+ *
+ * Type of a function that is notified of the events of named timers, e.g.
+ * to record a timeline.  The hook is called on the thread that caused the
+ * event -- possibly many threads at once -- and outside the timed interval
+ * (before the clocks are read at a start, after they are read at a stop).
+ * In a batched cycle only the first start and the final stop are reported.
+ */
+typedef void (*ExecutionTimerEventHook)(ExecutionTimerRef aTimer, ExecutionTimerEvent theEvent, const char *label, void *context);
+
+/*!
+ * @function ExecutionTimerSetEventHook
+ *
+ * Set the process-wide hook called for the events of every named timer
+ * (see ExecutionTimerSetName()); unnamed timers are never reported.  Pass
+ * NULL to remove the hook.  Should be set before any timer is in use.
+ */
+void ExecutionTimerSetEventHook(ExecutionTimerEventHook hook, void *context);
+
+/*!
+ * @function ExecutionTimerPushRegion
+ *
+ * Mark the start of a named sub-phase (e.g. "pack", "compute", "epilogue") of
+ * the current cycle of aTimer.  Regions nest:  a region pushed while another
+ * is open becomes its child.  Regions with the same name under the same
+ * parent are aggregated, and each region's time within a cycle (summed over
+ * repeated pushes, divided by the batch size) is added to its statistics
+ * when the cycle stops.  The summary includes a "Region <path>" row for each
+ * region, with the path components separated by '/'.
+ *
+ * Regions must be pushed and popped by the thread that starts and stops
+ * aTimer, between ExecutionTimerStart() and ExecutionTimerStop(); regions
+ * left open are closed by ExecutionTimerStop().  ExecutionTimerReset()
+ * discards the region tree.
+ *
+ * Returns boolean false if aTimer is not started or memory could not be
+ * allocated.
+ */
+bool ExecutionTimerPushRegion(ExecutionTimerRef aTimer, const char *regionName);
+
+/*!
+ * @function ExecutionTimerPopRegion
+ *
+ * Mark the end of the innermost open region of aTimer.  Returns boolean false
+ * if no region is open.
+ */
+bool ExecutionTimerPopRegion(ExecutionTimerRef aTimer);
+
+/*!
+ * @function ExecutionTimerGetRegionValue
+ *
+ * Return the given value of the time spent per cycle in the region of aTimer
+ * at regionPath (region names separated by '/', e.g. "compute/epilogue").
+ * Returns the constant INFINITY if there is no such region.
+ */
+double ExecutionTimerGetRegionValue(ExecutionTimerRef aTimer, const char *regionPath, ExecutionTimerValue theValue);
+
 /*!
  * @enum ExecutionTimerOutputFormat
  *
@@ -199,6 +788,21 @@ const char* ExecutionTimerOutputFormatToString(ExecutionTimerOutputFormat format
  */
 void ExecutionTimerSummarizeToStream(ExecutionTimerRef aTimer, ExecutionTimerOutputFormat format, const char *timerName, FILE *stream);
 
+#ifdef EXECUTIONTIMER_FORTRAN_INTERFACE
+
+#include "FortranInterface.h"
+
+/*!
+ * @function ExecutionTimerFortranGetId
+ *
+ * Returns the Fortran interface id of aTimer, registering (and retaining) it
+ * in the Fortran instance table if necessary.  This allows a timer created in
+ * C to be passed to Fortran code.  Returns -1 if the table is full.
+ */
+f_integer ExecutionTimerFortranGetId(ExecutionTimerRef aTimer);
+
+#endif
+
 
 /*
 
@@ -209,10 +813,9 @@ If the ExecutionTimer.c source is compiled with the EXECUTIONTIMER_FORTRAN_INTER
 macro defined, a set of Fortran subroutines/functions will be included that provide
 an interface to this pseudo class.
 
-There are a fixed number of timers available to the Fortran interface.  This is because a
-static, fixed-dimension array of ExecutionTimerRef values is used to map the pointers to
-Fortran integers.  The EXECUTIONTIMER_FORTRAN_MAX_INSTANCES macro controls the size of the
-table and defaults to 8.
+Timers are mapped to Fortran integers by a lock-free table that grows in chunks of
+EXECUTIONTIMER_FORTRAN_CHUNK_SIZE (default 64) entries, up to EXECUTIONTIMER_FORTRAN_MAX_CHUNKS
+(default 1024) chunks.  Timers may be created, used, and destroyed from any thread.
 
 
 Allocating a Timer
@@ -229,6 +832,14 @@ timerId = ExecutionTimer_Create()
 ```
 
 
+The resource accounting scope (0 = process, 1 = thread; see ExecutionTimerScope)
+of a timer can be changed, which resets the timer:
+
+```
+Call ExecutionTimer_SetScope(timerId, 1)
+```
+
+
 Starting/Stopping a Timer
 -------------------------
 
@@ -243,6 +854,78 @@ Call ExecutionTimer_Stop(timerId)
 ```
 
 
+Attaching a Work Model
+----------------------
+
+If the amount of work done per start-stop cycle is known, the derived GFLOP/s,
+GB/s, and arithmetic intensity metrics can be enabled:
+
+```
+real :: flops, bytes
+
+flops = 2.0 * n**3
+bytes = 3.0 * 4 * n**2
+Call ExecutionTimer_SetWorkModel(timerId, flops, bytes)
+```
+
+
+Per-Thread Busy Time
+--------------------
+
+Inside a parallel region, each thread can mark its share of the work so that
+load imbalance is reported.  The C code must call ExecutionTimerPrepareThreadSlots()
+before the parallel region.  Use `nowait` so the stop precedes the barrier:
+
+```
+integer :: tid
+
+!$omp parallel private(tid)
+tid = omp_get_thread_num()
+Call ExecutionTimer_ThreadStart(timerId, tid)
+!$omp do
+  :
+!$omp end do nowait
+Call ExecutionTimer_ThreadStop(timerId, tid)
+!$omp end parallel
+```
+
+
+Timing Inside a Parallel Region
+-------------------------------
+
+Each thread can time its own work inside a parallel region; the cycles are
+accumulated per thread and merged into the timer's walltime and CPU time
+statistics once it is read (after the parallel region):
+
+```
+!$omp parallel do
+do i = 1, n
+  Call ExecutionTimer_Start(timerId)
+    :
+  Call ExecutionTimer_Stop(timerId)
+end do
+!$omp end parallel do
+```
+
+
+Named Regions
+-------------
+
+Sub-phases of a timed cycle can be marked with nested, named regions (see
+ExecutionTimerPushRegion()); trailing blanks are removed from the name:
+
+```
+Call ExecutionTimer_Start(timerId)
+Call ExecutionTimer_PushRegion(timerId, 'pack')
+  :
+Call ExecutionTimer_PopRegion(timerId)
+Call ExecutionTimer_PushRegion(timerId, 'compute')
+  :
+Call ExecutionTimer_PopRegion(timerId)
+Call ExecutionTimer_Stop(timerId)
+```
+
+
 Retrieving Data
 ---------------
 
@@ -262,17 +945,49 @@ Metrics are the data points analyzed by a timer:
 | 4         | Number of pages moved in/out of swap |
 | 5         | Number of blocks read from disk      |
 | 6         | Number of blocks written to disk     |
+| 7         | GFLOP/s (requires a work model)      |
+| 8         | GB/s (requires a work model)         |
+| 9         | Arithmetic intensity (flop/byte)     |
+| 10        | CPU cycles (hardware counters)       |
+| 11        | Instructions retired                 |
+| 12        | L1D read misses                      |
+| 13        | Last-level cache misses              |
+| 14        | dTLB read misses                     |
+| 15        | Branch misses                        |
+| 16        | Instructions per cycle               |
+| 17        | L1D misses per 1000 flops            |
+| 18        | LLC misses per 1000 flops            |
+| 19        | Thread imbalance (max/mean busy)     |
+| 20        | Slowest thread slot index            |
+| 21        | CPU time (timer's scope)             |
+| 22        | CPU utilization (CPU/(wall*threads)) |
+| 23        | I/O MB/s (file init methods)         |
+| 24        | I/O operations per second            |
+| 25        | Minor page faults                    |
+| 26        | Major page faults                    |
+| 27        | Cache residency of the input file    |
 
 Values are the statistics maintained for each metric:
 
-| Value Id | Description        |
-| -------- | ------------------ |
-| 0        | Last value         |
-| 1        | Minimum value      |
-| 2        | Maximum value      |
-| 3        | Average value      |
-| 4        | Variance           |
-| 5        | Standard deviation |
+| Value Id | Description                                |
+| -------- | ------------------------------------------ |
+| 0        | Last value                                 |
+| 1        | Minimum value                              |
+| 2        | Maximum value                              |
+| 3        | Average value                              |
+| 4        | Variance                                   |
+| 5        | Standard deviation                         |
+| 6        | Half-width of 95% confidence interval      |
+|          | on the average                             |
+| 7        | Median                                     |
+| 8        | 90th percentile                            |
+| 9        | 99th percentile                            |
+| 10       | Median absolute deviation                  |
+| 11       | Lower bound of bootstrap 95% confidence    |
+|          | interval on the median                     |
+| 12       | Upper bound of bootstrap 95% confidence    |
+|          | interval on the median                     |
+| 13       | Number of Tukey outliers                   |
 
 The average walltime can thus be fetched as:
 
@@ -0,0 +1,235 @@
+/*
+ * MachineInfo.c
+ *
+ * Pseudo-class that gathers a description of the host's processor:  model,
+ * data cache sizes, and CPU count.
+ */
+
+#include "MachineInfo.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+
+//
+
+typedef struct MachineInfo {
+    unsigned int    refCount;
+    char            cpuModel[128];
+    int             cpuCount;
+    unsigned int    nCacheLevels;
+    long            cacheSize[MACHINEINFO_MAX_CACHE_LEVEL];
+    char            fingerprint[256];
+} MachineInfo;
+
+//
+
+bool
+__MachineInfoReadLine(
+    const char      *path,
+    char            *buffer,
+    size_t          bufferLen
+)
+{
+    FILE            *fptr = fopen(path, "r");
+    bool            ok = false;
+
+    if ( fptr ) {
+        if ( fgets(buffer, bufferLen, fptr) ) {
+            size_t  len = strlen(buffer);
+
+            while ( len && isspace(buffer[len - 1]) ) buffer[--len] = '\0';
+            ok = true;
+        }
+        fclose(fptr);
+    }
+    return ok;
+}
+
+//
+
+void
+__MachineInfoReadCPUModel(
+    MachineInfo     *aMachine
+)
+{
+    FILE            *fptr = fopen("/proc/cpuinfo", "r");
+    char            line[512];
+
+    strcpy(aMachine->cpuModel, "unknown");
+    if ( ! fptr ) return;
+    while ( fgets(line, sizeof(line), fptr) ) {
+        //
+        // x86 uses "model name", many other architectures "cpu model" or
+        // "Processor" (case matters:  x86 also has a "processor" line with
+        // the CPU index):
+        //
+        if ( (strncasecmp(line, "model name", 10) == 0) || (strncasecmp(line, "cpu model", 9) == 0) || (strncmp(line, "Processor", 9) == 0) ) {
+            char    *value = strchr(line, ':'), *end;
+
+            if ( ! value ) continue;
+            value++;
+            while ( isspace(*value) ) value++;
+            end = value + strlen(value);
+            while ( (end > value) && isspace(end[-1]) ) *(--end) = '\0';
+            if ( *value ) {
+                char    *p;
+
+                snprintf(aMachine->cpuModel, sizeof(aMachine->cpuModel), "%s", value);
+                // The fingerprint is delimited by semicolons and tabs:
+                for ( p = aMachine->cpuModel; *p; p++ ) if ( (*p == ';') || (*p == '\t') ) *p = ' ';
+                break;
+            }
+        }
+    }
+    fclose(fptr);
+}
+
+//
+
+void
+__MachineInfoReadCaches(
+    MachineInfo     *aMachine
+)
+{
+    int             index = 0;
+
+    while ( 1 ) {
+        char        path[128], value[64];
+        long        level, size;
+        char        *end;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", index);
+        if ( ! __MachineInfoReadLine(path, value, sizeof(value)) ) break;
+        level = strtol(value, NULL, 10);
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", index);
+        if ( __MachineInfoReadLine(path, value, sizeof(value)) && (strcasecmp(value, "Instruction") != 0) ) {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", index);
+            if ( (level >= 1) && (level <= MACHINEINFO_MAX_CACHE_LEVEL) && __MachineInfoReadLine(path, value, sizeof(value)) ) {
+                size = strtol(value, &end, 10);
+                switch ( toupper(*end) ) {
+                    case 'K':
+                        size *= 1024;
+                        break;
+                    case 'M':
+                        size *= 1024 * 1024;
+                        break;
+                    case 'G':
+                        size *= 1024 * 1024 * 1024;
+                        break;
+                }
+                aMachine->cacheSize[level - 1] = size;
+                if ( level > aMachine->nCacheLevels ) aMachine->nCacheLevels = level;
+            }
+        }
+        index++;
+    }
+}
+
+//
+
+MachineInfoRef
+MachineInfoCreate(void)
+{
+    MachineInfo     *newMachine = (MachineInfo*)malloc(sizeof(MachineInfo));
+
+    if ( newMachine ) {
+        unsigned int    level;
+        size_t          len;
+
+        memset(newMachine, 0, sizeof(*newMachine));
+        newMachine->refCount = 1;
+        __MachineInfoReadCPUModel(newMachine);
+        __MachineInfoReadCaches(newMachine);
+        newMachine->cpuCount = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if ( newMachine->cpuCount < 1 ) newMachine->cpuCount = 1;
+
+        len = snprintf(newMachine->fingerprint, sizeof(newMachine->fingerprint), "%s", newMachine->cpuModel);
+        for ( level = 1; level <= newMachine->nCacheLevels; level++ ) {
+            if ( len >= sizeof(newMachine->fingerprint) ) break;
+            len += snprintf(newMachine->fingerprint + len, sizeof(newMachine->fingerprint) - len, ";L%u%s=%ldK",
+                        level, (level == 1) ? "d" : "", newMachine->cacheSize[level - 1] / 1024);
+        }
+        if ( len < sizeof(newMachine->fingerprint) ) {
+            snprintf(newMachine->fingerprint + len, sizeof(newMachine->fingerprint) - len, ";cpus=%d", newMachine->cpuCount);
+        }
+    }
+    return (MachineInfoRef)newMachine;
+}
+
+//
+
+MachineInfoRef
+MachineInfoRetain(
+    MachineInfoRef  aMachine
+)
+{
+    aMachine->refCount++;
+    return aMachine;
+}
+
+//
+
+void
+MachineInfoRelease(
+    MachineInfoRef  aMachine
+)
+{
+    if ( --(aMachine->refCount) == 0 ) free((void*)aMachine);
+}
+
+//
+
+const char*
+MachineInfoGetCPUModel(
+    MachineInfoRef  aMachine
+)
+{
+    return (const char*)aMachine->cpuModel;
+}
+
+//
+
+int
+MachineInfoGetCPUCount(
+    MachineInfoRef  aMachine
+)
+{
+    return aMachine->cpuCount;
+}
+
+//
+
+unsigned int
+MachineInfoGetCacheLevelCount(
+    MachineInfoRef  aMachine
+)
+{
+    return aMachine->nCacheLevels;
+}
+
+//
+
+long
+MachineInfoGetCacheSize(
+    MachineInfoRef  aMachine,
+    unsigned int    level
+)
+{
+    if ( (level >= 1) && (level <= MACHINEINFO_MAX_CACHE_LEVEL) ) return aMachine->cacheSize[level - 1];
+    return 0;
+}
+
+//
+
+const char*
+MachineInfoGetFingerprint(
+    MachineInfoRef  aMachine
+)
+{
+    return (const char*)aMachine->fingerprint;
+}
@@ -0,0 +1,92 @@
+/*
+ * MachineInfo.h
+ *
+ * Pseudo-class that gathers a description of the host's processor:  model,
+ * data cache sizes, and CPU count.
+ */
+
+#ifndef __MACHINEINFO_H__
+#define __MACHINEINFO_H__
+
+#include <stdbool.h>
+
+/*!
+ * @defined MACHINEINFO_MAX_CACHE_LEVEL
+ *
+ * Deepest level of the cache hierarchy that is recorded.
+ */
+#define MACHINEINFO_MAX_CACHE_LEVEL 4
+
+/*!
+ * @typedef MachineInfoRef
+ *
+ * Type of a reference to a MachineInfo object.
+ */
+typedef struct MachineInfo * MachineInfoRef;
+
+/*!
+ * @function MachineInfoCreate
+ *
+ * Gather information about the host (from /proc/cpuinfo and the sysfs
+ * cache topology of cpu0) into a new MachineInfo object.  Any information
+ * that is unavailable is left empty or zero.
+ */
+MachineInfoRef MachineInfoCreate(void);
+
+/*!
+ * @function MachineInfoRetain
+ *
+ * Increase the reference count of aMachine.
+ */
+MachineInfoRef MachineInfoRetain(MachineInfoRef aMachine);
+
+/*!
+ * @function MachineInfoRelease
+ *
+ * Decrease the reference count of aMachine, deallocating it once it reaches
+ * zero.
+ */
+void MachineInfoRelease(MachineInfoRef aMachine);
+
+/*!
+ * @function MachineInfoGetCPUModel
+ *
+ * Returns the processor model name, or "unknown".
+ */
+const char* MachineInfoGetCPUModel(MachineInfoRef aMachine);
+
+/*!
+ * @function MachineInfoGetCPUCount
+ *
+ * Returns the number of online logical CPUs.
+ */
+int MachineInfoGetCPUCount(MachineInfoRef aMachine);
+
+/*!
+ * @function MachineInfoGetCacheLevelCount
+ *
+ * Returns the number of levels of data (or unified) cache.
+ */
+unsigned int MachineInfoGetCacheLevelCount(MachineInfoRef aMachine);
+
+/*!
+ * @function MachineInfoGetCacheSize
+ *
+ * Returns the size in bytes of the data (or unified) cache at the given
+ * level (1 = L1), or zero if there is no such cache.
+ */
+long MachineInfoGetCacheSize(MachineInfoRef aMachine, unsigned int level);
+
+/*!
+ * @function MachineInfoGetFingerprint
+ *
+ * Returns a C string that identifies the hardware for the purpose of
+ * caching hardware-dependent results, e.g.
+ *
+ *     Intel(R) Xeon(R) Processor;L1d=48K;L2=2048K;L3=107520K;cpus=8
+ *
+ * The string contains no tab or newline characters.
+ */
+const char* MachineInfoGetFingerprint(MachineInfoRef aMachine);
+
+#endif /* __MACHINEINFO_H__ */
@@ -0,0 +1,826 @@
+/*
+ * MachineProbe.c
+ *
+ * Pseudo-class that measures the performance ceilings of the host:  peak
+ * floating-point (FMA) throughput, STREAM-style bandwidth at each level of
+ * the cache hierarchy and main memory, and load-to-use latency across a
+ * range of working-set sizes.
+ *
+ * The kernels in this file are compiled with optimization regardless of the
+ * build type (see CMakeLists.txt).
+ */
+
+#include "MachineProbe.h"
+#include "ResultTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_OPENMP
+#   include <omp.h>
+#endif
+
+//
+// Each timed measurement is repeated until it takes at least this long, and
+// the best of MACHINEPROBE_TRIALS such measurements is kept:
+//
+#define MACHINEPROBE_MIN_SECONDS        0.05
+#define MACHINEPROBE_TRIALS             5
+
+//
+// The FMA kernel keeps this many independent accumulators in flight to hide
+// the FMA latency (latency x issue ports, with headroom):
+//
+#define MACHINEPROBE_FMA_ACCUMULATORS   12
+
+//
+// Main memory is probed with a working set this many times the last-level
+// cache, but no more than MACHINEPROBE_DRAM_MAX_BYTES:
+//
+#define MACHINEPROBE_DRAM_FACTOR        4
+#define MACHINEPROBE_DRAM_MIN_BYTES     (64L * 1024 * 1024)
+#define MACHINEPROBE_DRAM_MAX_BYTES     (1024L * 1024 * 1024)
+
+//
+// Pointer chasing:  one node per cache line, working sets from
+// MACHINEPROBE_LATENCY_MIN_BYTES doubling to twice the last-level cache.
+//
+#define MACHINEPROBE_LINE_BYTES         64
+#define MACHINEPROBE_LATENCY_MIN_BYTES  (4L * 1024)
+#define MACHINEPROBE_LATENCY_STEPS      (1L << 20)
+#define MACHINEPROBE_LATENCY_TRIALS     3
+
+#ifdef __GNUC__
+#   define MACHINEPROBE_COMPILER_BARRIER()  __asm__ __volatile__("" ::: "memory")
+#else
+#   define MACHINEPROBE_COMPILER_BARRIER()
+#endif
+
+//
+
+typedef struct MachineProbe {
+    unsigned int    refCount;
+    bool            isCached;
+    char            fingerprint[256];
+    int             nthreads;
+    int             vectorWidth;
+    double          peakGFLOPs;
+    unsigned int    nLevels;
+    long            levelCapacity[MACHINEPROBE_MAX_LEVELS];
+    long            levelWorkingSet[MACHINEPROBE_MAX_LEVELS];
+    double          bandwidth[MACHINEPROBE_MAX_LEVELS][MachineProbeStreamKernelMax];
+    unsigned int    nLatency;
+    long            latencyWorkingSet[MACHINEPROBE_MAX_LATENCY_POINTS];
+    double          latencyNS[MACHINEPROBE_MAX_LATENCY_POINTS];
+} MachineProbe;
+
+//
+
+static const char* __MachineProbeLevelNames[MACHINEPROBE_MAX_LEVELS] = { "L1", "L2", "L3", "L4", "DRAM" };
+
+//
+
+static double
+__MachineProbeNow(void)
+{
+    struct timespec     t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + 1e-9 * (double)t.tv_nsec;
+}
+
+//
+////
+//
+
+//
+// The FMA kernel is generated for several vector sizes (in bytes) and uses
+// the same floating-point type as the multiplication routines; on x86 the
+// widest vectors the processor supports are selected at runtime.  Each
+// accumulator converges towards y / (1 - x), which none starts at (a
+// constant accumulator would be optimized away).
+//
+#define MACHINEPROBE_FMA_KERNEL(NAME, BYTES, ATTRS) \
+    typedef f_real NAME##Vector __attribute__((vector_size(BYTES))); \
+    ATTRS static double \
+    NAME( \
+        long    iterations \
+    ) \
+    { \
+        NAME##Vector    x = (NAME##Vector){ 0 } + (f_real)0.999, y = (NAME##Vector){ 0 } + (f_real)1e-4; \
+        NAME##Vector    a0 = x, a1 = x + y, a2 = x + 2 * y, a3 = x + 3 * y, a4 = x + 4 * y, a5 = x + 5 * y; \
+        NAME##Vector    a6 = x + 6 * y, a7 = x + 7 * y, a8 = x + 8 * y, a9 = x + 9 * y, a10 = x + 10 * y, a11 = x + 11 * y; \
+        double          sum = 0.0; \
+        long            i; \
+        int             k; \
+        for ( i = 0; i < iterations; i++ ) { \
+            a0 = a0 * x + y; a1 = a1 * x + y; a2 = a2 * x + y; a3 = a3 * x + y; \
+            a4 = a4 * x + y; a5 = a5 * x + y; a6 = a6 * x + y; a7 = a7 * x + y; \
+            a8 = a8 * x + y; a9 = a9 * x + y; a10 = a10 * x + y; a11 = a11 * x + y; \
+        } \
+        a0 = a0 + a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11; \
+        for ( k = 0; k < (int)((BYTES) / sizeof(f_real)); k++ ) sum += a0[k]; \
+        return sum; \
+    }
+
+MACHINEPROBE_FMA_KERNEL(__MachineProbeFMA128, 16, )
+
+#if defined(__GNUC__) && defined(__x86_64__)
+MACHINEPROBE_FMA_KERNEL(__MachineProbeFMA256, 32, __attribute__((target("avx2,fma"))))
+MACHINEPROBE_FMA_KERNEL(__MachineProbeFMA512, 64, __attribute__((target("avx512f"))))
+#endif
+
+typedef double (*MachineProbeFMAKernel)(long iterations);
+
+//
+
+static MachineProbeFMAKernel
+__MachineProbeSelectFMAKernel(
+    int                 *outWidth
+)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx512f") ) {
+        *outWidth = 64 / sizeof(f_real);
+        return __MachineProbeFMA512;
+    }
+    if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ) {
+        *outWidth = 32 / sizeof(f_real);
+        return __MachineProbeFMA256;
+    }
+#endif
+    *outWidth = 16 / sizeof(f_real);
+    return __MachineProbeFMA128;
+}
+
+//
+
+void
+__MachineProbeMeasurePeak(
+    MachineProbe        *aProbe
+)
+{
+    MachineProbeFMAKernel   kernel = __MachineProbeSelectFMAKernel(&aProbe->vectorWidth);
+    double                  flopsPerIteration = 2.0 * MACHINEPROBE_FMA_ACCUMULATORS * aProbe->vectorWidth;
+    long                    iterations = 1024;
+    volatile double         sink = 0.0;
+    int                     trial;
+
+    aProbe->peakGFLOPs = 0.0;
+    for ( trial = 0; trial < MACHINEPROBE_TRIALS; ) {
+        double              elapsed = __MachineProbeNow();
+
+        #pragma omp parallel num_threads(aProbe->nthreads)
+        {
+            double          s = kernel(iterations);
+
+            #pragma omp atomic
+            sink += s;
+        }
+        elapsed = __MachineProbeNow() - elapsed;
+        if ( elapsed < MACHINEPROBE_MIN_SECONDS ) {
+            // Still calibrating the iteration count:
+            iterations *= 2;
+            continue;
+        }
+        if ( flopsPerIteration * iterations * aProbe->nthreads / elapsed > 1e9 * aProbe->peakGFLOPs ) {
+            aProbe->peakGFLOPs = 1e-9 * flopsPerIteration * iterations * aProbe->nthreads / elapsed;
+        }
+        trial++;
+    }
+}
+
+//
+////
+//
+
+//
+// Run reps repetitions of a STREAM kernel over n elements, split statically
+// across nthreads threads.  Returns the elapsed time.
+//
+double
+__MachineProbeStreamRun(
+    MachineProbeStreamKernel    kernel,
+    double * restrict           a,
+    const double * restrict     b,
+    const double * restrict     c,
+    long                        n,
+    long                        reps,
+    int                         nthreads
+)
+{
+    double                      elapsed = __MachineProbeNow();
+
+    #pragma omp parallel num_threads(nthreads)
+    {
+        int                     tid = 0, nt = 1;
+        long                    lo, hi, i, r;
+        const double            q = 3.0;
+
+#ifdef HAVE_OPENMP
+        tid = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        lo = (n * tid) / nt;
+        hi = (n * (tid + 1)) / nt;
+        for ( r = 0; r < reps; r++ ) {
+            switch ( kernel ) {
+                case MachineProbeStreamKernelCopy:
+                    for ( i = lo; i < hi; i++ ) a[i] = b[i];
+                    break;
+                case MachineProbeStreamKernelScale:
+                    for ( i = lo; i < hi; i++ ) a[i] = q * b[i];
+                    break;
+                case MachineProbeStreamKernelAdd:
+                    for ( i = lo; i < hi; i++ ) a[i] = b[i] + c[i];
+                    break;
+                case MachineProbeStreamKernelTriad:
+                    for ( i = lo; i < hi; i++ ) a[i] = b[i] + q * c[i];
+                    break;
+                default:
+                    break;
+            }
+            MACHINEPROBE_COMPILER_BARRIER();
+        }
+    }
+    return __MachineProbeNow() - elapsed;
+}
+
+//
+
+bool
+__MachineProbeMeasureBandwidth(
+    MachineProbe        *aProbe,
+    unsigned int        level
+)
+{
+    long                n = aProbe->levelWorkingSet[level] / (3 * sizeof(double));
+    double              *a, *b, *c;
+    int                 k;
+
+    if ( n < 64 ) n = 64;
+    a = (double*)aligned_alloc(MACHINEPROBE_LINE_BYTES, ((n * sizeof(double) + MACHINEPROBE_LINE_BYTES - 1) / MACHINEPROBE_LINE_BYTES) * MACHINEPROBE_LINE_BYTES);
+    b = (double*)aligned_alloc(MACHINEPROBE_LINE_BYTES, ((n * sizeof(double) + MACHINEPROBE_LINE_BYTES - 1) / MACHINEPROBE_LINE_BYTES) * MACHINEPROBE_LINE_BYTES);
+    c = (double*)aligned_alloc(MACHINEPROBE_LINE_BYTES, ((n * sizeof(double) + MACHINEPROBE_LINE_BYTES - 1) / MACHINEPROBE_LINE_BYTES) * MACHINEPROBE_LINE_BYTES);
+    if ( ! a || ! b || ! c ) {
+        fprintf(stderr, "ERROR:  unable to allocate %ld-byte STREAM arrays\n", (long)(n * sizeof(double)));
+        if ( a ) free((void*)a);
+        if ( b ) free((void*)b);
+        if ( c ) free((void*)c);
+        return false;
+    }
+
+    // First touch by the same threads that run the kernels:
+    #pragma omp parallel num_threads(aProbe->nthreads)
+    {
+        int             tid = 0, nt = 1;
+        long            i;
+
+#ifdef HAVE_OPENMP
+        tid = omp_get_thread_num();
+        nt = omp_get_num_threads();
+#endif
+        for ( i = (n * tid) / nt; i < (n * (tid + 1)) / nt; i++ ) {
+            a[i] = 0.0;
+            b[i] = 1.0;
+            c[i] = 2.0;
+        }
+    }
+
+    for ( k = 0; k < MachineProbeStreamKernelMax; k++ ) {
+        double          bytesPerElement = (k <= MachineProbeStreamKernelScale) ? 16.0 : 24.0;
+        double          best = 0.0;
+        long            reps = 1;
+        int             trial = 0;
+
+        while ( trial < MACHINEPROBE_TRIALS ) {
+            double      elapsed = __MachineProbeStreamRun((MachineProbeStreamKernel)k, a, b, c, n, reps, aProbe->nthreads);
+
+            if ( elapsed < MACHINEPROBE_MIN_SECONDS / MACHINEPROBE_TRIALS ) {
+                reps *= 2;
+                continue;
+            }
+            if ( bytesPerElement * n * reps / elapsed > best ) best = bytesPerElement * n * reps / elapsed;
+            trial++;
+        }
+        aProbe->bandwidth[level][k] = 1e-9 * best;
+    }
+    free((void*)a);
+    free((void*)b);
+    free((void*)c);
+    return true;
+}
+
+//
+////
+//
+
+//
+// Average load-to-use latency (in nanoseconds) of a chain of dependent
+// loads through a random cyclic permutation of the cache lines of a working
+// set.  The randomization defeats the hardware prefetchers.
+//
+double
+__MachineProbeMeasureLatency(
+    long            workingSet
+)
+{
+    long            nLines = workingSet / MACHINEPROBE_LINE_BYTES, i, steps;
+    long            *order;
+    char            *lines;
+    void            **p;
+    uint64_t        rngState = 0x2545F4914F6CDD1DULL;
+    double          elapsed, best = INFINITY;
+    int             trial;
+
+    if ( nLines < 2 ) return NAN;
+    lines = (char*)aligned_alloc(MACHINEPROBE_LINE_BYTES, nLines * MACHINEPROBE_LINE_BYTES);
+    order = (long*)malloc(nLines * sizeof(long));
+    if ( ! lines || ! order ) {
+        if ( lines ) free((void*)lines);
+        if ( order ) free((void*)order);
+        return NAN;
+    }
+
+    // Sattolo's algorithm yields a single cycle through every line:
+    for ( i = 0; i < nLines; i++ ) order[i] = i;
+    for ( i = nLines - 1; i > 0; i-- ) {
+        long        j, swap;
+
+        rngState ^= rngState << 13; rngState ^= rngState >> 7; rngState ^= rngState << 17;
+        j = (long)(rngState % (uint64_t)i);
+        swap = order[i]; order[i] = order[j]; order[j] = swap;
+    }
+    for ( i = 0; i < nLines; i++ ) {
+        *(void**)(lines + order[i] * MACHINEPROBE_LINE_BYTES) = (void*)(lines + order[(i + 1) % nLines] * MACHINEPROBE_LINE_BYTES);
+    }
+    free((void*)order);
+
+    // Walk the whole chain once to warm the caches and TLB:
+    p = (void**)lines;
+    for ( i = 0; i < nLines; i++ ) p = (void**)*p;
+
+    steps = MACHINEPROBE_LATENCY_STEPS;
+    for ( trial = 0; trial < MACHINEPROBE_LATENCY_TRIALS; trial++ ) {
+        elapsed = __MachineProbeNow();
+        for ( i = 0; i < steps; i++ ) p = (void**)*p;
+        elapsed = __MachineProbeNow() - elapsed;
+        if ( elapsed < best ) best = elapsed;
+    }
+    // Make the chase observable so it is not optimized away:
+    if ( p == NULL ) fprintf(stderr, "WARNING:  pointer chase reached NULL\n");
+    free((void*)lines);
+    return 1e9 * best / (double)steps;
+}
+
+//
+////
+//
+
+const char*
+MachineProbeDefaultPath(void)
+{
+    static char     defaultPath[4096];
+    const char      *s;
+
+    if ( (s = getenv("MMBENCH_PROBE_CACHE")) && *s ) return s;
+    if ( (s = getenv("XDG_CACHE_HOME")) && *s ) {
+        snprintf(defaultPath, sizeof(defaultPath), "%s/mmbench/probe.cache", s);
+        return (const char*)defaultPath;
+    }
+    if ( (s = getenv("HOME")) && *s ) {
+        snprintf(defaultPath, sizeof(defaultPath), "%s/.cache/mmbench/probe.cache", s);
+        return (const char*)defaultPath;
+    }
+    return NULL;
+}
+
+//
+
+MachineProbe*
+__MachineProbeAlloc(
+    MachineInfoRef      aMachine,
+    int                 nthreads
+)
+{
+    MachineProbe        *newProbe = (MachineProbe*)malloc(sizeof(MachineProbe));
+
+    if ( newProbe ) {
+        unsigned int    level, nCaches = MachineInfoGetCacheLevelCount(aMachine);
+        long            lastLevel = 0;
+
+        memset(newProbe, 0, sizeof(*newProbe));
+        newProbe->refCount = 1;
+        newProbe->nthreads = (nthreads > 0) ? nthreads : 1;
+        // The peak depends on the floating-point precision, too:
+        snprintf(newProbe->fingerprint, sizeof(newProbe->fingerprint), "%s;real%d", MachineInfoGetFingerprint(aMachine), (int)(8 * sizeof(f_real)));
+
+        //
+        // Each cache level is probed with a working set of half its capacity,
+        // main memory with a multiple of the last-level cache:
+        //
+        for ( level = 1; level <= nCaches; level++ ) {
+            long        capacity = MachineInfoGetCacheSize(aMachine, level);
+
+            if ( capacity <= 0 ) continue;
+            newProbe->levelCapacity[newProbe->nLevels] = capacity;
+            newProbe->levelWorkingSet[newProbe->nLevels] = capacity / 2;
+            newProbe->nLevels++;
+            lastLevel = capacity;
+        }
+        newProbe->levelCapacity[newProbe->nLevels] = 0;
+        lastLevel *= MACHINEPROBE_DRAM_FACTOR;
+        if ( lastLevel < MACHINEPROBE_DRAM_MIN_BYTES ) lastLevel = MACHINEPROBE_DRAM_MIN_BYTES;
+        if ( lastLevel > MACHINEPROBE_DRAM_MAX_BYTES ) lastLevel = MACHINEPROBE_DRAM_MAX_BYTES;
+        newProbe->levelWorkingSet[newProbe->nLevels] = lastLevel;
+        newProbe->nLevels++;
+    }
+    return newProbe;
+}
+
+//
+
+MachineProbeRef
+MachineProbeCreate(
+    MachineInfoRef      aMachine,
+    int                 nthreads
+)
+{
+    MachineProbe        *newProbe = __MachineProbeAlloc(aMachine, nthreads);
+
+    if ( newProbe ) {
+        unsigned int    level;
+        long            workingSet, maxWorkingSet;
+
+        __MachineProbeMeasurePeak(newProbe);
+        for ( level = 0; level < newProbe->nLevels; level++ ) {
+            if ( ! __MachineProbeMeasureBandwidth(newProbe, level) ) {
+                MachineProbeRelease(newProbe);
+                return NULL;
+            }
+        }
+        maxWorkingSet = newProbe->levelWorkingSet[newProbe->nLevels - 1] / MACHINEPROBE_DRAM_FACTOR * 2;
+        if ( maxWorkingSet < MACHINEPROBE_LATENCY_MIN_BYTES ) maxWorkingSet = MACHINEPROBE_LATENCY_MIN_BYTES;
+        workingSet = MACHINEPROBE_LATENCY_MIN_BYTES;
+        while ( (workingSet <= maxWorkingSet) && (newProbe->nLatency < MACHINEPROBE_MAX_LATENCY_POINTS) ) {
+            newProbe->latencyWorkingSet[newProbe->nLatency] = workingSet;
+            newProbe->latencyNS[newProbe->nLatency] = __MachineProbeMeasureLatency(workingSet);
+            newProbe->nLatency++;
+            workingSet *= 2;
+        }
+    }
+    return (MachineProbeRef)newProbe;
+}
+
+//
+
+bool
+__MachineProbeLoad(
+    MachineProbe        *aProbe,
+    const char          *path
+)
+{
+    FILE                *fptr = fopen(path, "r");
+    char                line[8192];
+    bool                hasPeak = false;
+    unsigned int        nBandwidth = 0;
+
+    if ( ! fptr ) return false;
+    while ( fgets(line, sizeof(line), fptr) ) {
+        char            *fields[10], *p = line;
+        int             nFields = 0;
+
+        line[strcspn(line, "\r\n")] = '\0';
+        if ( (*line == '#') || (*line == '\0') ) continue;
+        while ( nFields < 10 ) {
+            fields[nFields++] = p;
+            if ( ! (p = strchr(p, '\t')) ) break;
+            *p++ = '\0';
+        }
+        if ( (nFields < 4) || strcmp(fields[0], aProbe->fingerprint) || (strtol(fields[1], NULL, 10) != aProbe->nthreads) ) continue;
+        if ( (strcmp(fields[2], "peak") == 0) && (nFields == 5) ) {
+            aProbe->peakGFLOPs = strtod(fields[3], NULL);
+            aProbe->vectorWidth = (int)strtol(fields[4], NULL, 10);
+            hasPeak = true;
+        } else if ( (strcmp(fields[2], "bandwidth") == 0) && (nFields == 9) ) {
+            unsigned int    level = 0;
+            int             k;
+
+            while ( (level < aProbe->nLevels) && strcmp(fields[3], MachineProbeGetLevelName(aProbe, level)) ) level++;
+            if ( level == aProbe->nLevels ) continue;
+            aProbe->levelWorkingSet[level] = strtol(fields[4], NULL, 10);
+            for ( k = 0; k < MachineProbeStreamKernelMax; k++ ) aProbe->bandwidth[level][k] = strtod(fields[5 + k], NULL);
+            nBandwidth++;
+        } else if ( (strcmp(fields[2], "latency") == 0) && (nFields == 5) && (aProbe->nLatency < MACHINEPROBE_MAX_LATENCY_POINTS) ) {
+            aProbe->latencyWorkingSet[aProbe->nLatency] = strtol(fields[3], NULL, 10);
+            aProbe->latencyNS[aProbe->nLatency] = strtod(fields[4], NULL);
+            aProbe->nLatency++;
+        }
+    }
+    fclose(fptr);
+    return (hasPeak && (nBandwidth == aProbe->nLevels)) ? true : false;
+}
+
+//
+
+bool
+__MachineProbeSave(
+    MachineProbe        *aProbe,
+    const char          *path
+)
+{
+    size_t              pathLen = strlen(path);
+    char                tmpPath[pathLen + 32], dirPath[pathLen + 1], *slash, line[8192];
+    FILE                *fptr, *oldFptr;
+    unsigned int        i;
+    int                 k;
+
+    //
+    // Create the parent directory (and its parents) as needed:
+    //
+    strcpy(dirPath, path);
+    if ( (slash = strrchr(dirPath, '/')) && (slash > dirPath) ) {
+        char            *p = dirPath + 1;
+
+        *slash = '\0';
+        while ( 1 ) {
+            char        *nextSlash = strchr(p, '/');
+
+            if ( nextSlash ) *nextSlash = '\0';
+            if ( (mkdir(dirPath, 0755) != 0) && (errno != EEXIST) ) {
+                fprintf(stderr, "ERROR:  unable to create directory %s (errno = %d)\n", dirPath, errno);
+                return false;
+            }
+            if ( ! nextSlash ) break;
+            *nextSlash = '/';
+            p = nextSlash + 1;
+        }
+    }
+
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%ld", path, (long)getpid());
+    if ( ! (fptr = fopen(tmpPath, "w")) ) {
+        fprintf(stderr, "ERROR:  unable to write probe cache %s (errno = %d)\n", tmpPath, errno);
+        return false;
+    }
+
+    //
+    // Keep the records for other machines and thread counts:
+    //
+    if ( (oldFptr = fopen(path, "r")) ) {
+        size_t          fpLen = strlen(aProbe->fingerprint);
+
+        while ( fgets(line, sizeof(line), oldFptr) ) {
+            if ( (strncmp(line, aProbe->fingerprint, fpLen) == 0) && (line[fpLen] == '\t') && (strtol(line + fpLen + 1, NULL, 10) == aProbe->nthreads) ) continue;
+            fputs(line, fptr);
+        }
+        fclose(oldFptr);
+    } else {
+        fprintf(fptr, "# mmbench probe cache\n# fingerprint\tthreads\t(peak <GFLOP/s> <vector-width>|bandwidth <level> <bytes> <copy> <scale> <add> <triad>|latency <bytes> <ns>)\n");
+    }
+    fprintf(fptr, "%s\t%d\tpeak\t%.6lg\t%d\n", aProbe->fingerprint, aProbe->nthreads, aProbe->peakGFLOPs, aProbe->vectorWidth);
+    for ( i = 0; i < aProbe->nLevels; i++ ) {
+        fprintf(fptr, "%s\t%d\tbandwidth\t%s\t%ld", aProbe->fingerprint, aProbe->nthreads, MachineProbeGetLevelName(aProbe, i), aProbe->levelWorkingSet[i]);
+        for ( k = 0; k < MachineProbeStreamKernelMax; k++ ) fprintf(fptr, "\t%.6lg", aProbe->bandwidth[i][k]);
+        fputc('\n', fptr);
+    }
+    for ( i = 0; i < aProbe->nLatency; i++ ) {
+        fprintf(fptr, "%s\t%d\tlatency\t%ld\t%.6lg\n", aProbe->fingerprint, aProbe->nthreads, aProbe->latencyWorkingSet[i], aProbe->latencyNS[i]);
+    }
+    if ( fclose(fptr) != 0 || rename(tmpPath, path) != 0 ) {
+        fprintf(stderr, "ERROR:  unable to write probe cache %s (errno = %d)\n", path, errno);
+        unlink(tmpPath);
+        return false;
+    }
+    return true;
+}
+
+//
+
+MachineProbeRef
+MachineProbeCreateWithCache(
+    MachineInfoRef      aMachine,
+    int                 nthreads,
+    const char          *path,
+    bool                shouldRefresh
+)
+{
+    MachineProbe        *newProbe;
+
+    if ( ! path && ! (path = MachineProbeDefaultPath()) ) {
+        fprintf(stderr, "WARNING:  no probe cache path could be determined\n");
+        return MachineProbeCreate(aMachine, nthreads);
+    }
+    if ( ! shouldRefresh && (newProbe = __MachineProbeAlloc(aMachine, nthreads)) ) {
+        if ( __MachineProbeLoad(newProbe, path) ) {
+            newProbe->isCached = true;
+            return (MachineProbeRef)newProbe;
+        }
+        MachineProbeRelease(newProbe);
+    }
+    if ( (newProbe = MachineProbeCreate(aMachine, nthreads)) ) __MachineProbeSave(newProbe, path);
+    return (MachineProbeRef)newProbe;
+}
+
+//
+
+MachineProbeRef
+MachineProbeRetain(
+    MachineProbeRef     aProbe
+)
+{
+    aProbe->refCount++;
+    return aProbe;
+}
+
+//
+
+void
+MachineProbeRelease(
+    MachineProbeRef     aProbe
+)
+{
+    if ( --(aProbe->refCount) == 0 ) free((void*)aProbe);
+}
+
+//
+
+bool
+MachineProbeIsCached(
+    MachineProbeRef     aProbe
+)
+{
+    return aProbe->isCached;
+}
+
+//
+
+int
+MachineProbeGetThreadCount(
+    MachineProbeRef     aProbe
+)
+{
+    return aProbe->nthreads;
+}
+
+//
+
+double
+MachineProbeGetPeakGFLOPs(
+    MachineProbeRef     aProbe
+)
+{
+    return aProbe->peakGFLOPs;
+}
+
+//
+
+unsigned int
+MachineProbeGetLevelCount(
+    MachineProbeRef     aProbe
+)
+{
+    return aProbe->nLevels;
+}
+
+//
+
+const char*
+MachineProbeGetLevelName(
+    MachineProbeRef     aProbe,
+    unsigned int        level
+)
+{
+    if ( level >= aProbe->nLevels ) return NULL;
+    if ( level == aProbe->nLevels - 1 ) return __MachineProbeLevelNames[MACHINEPROBE_MAX_LEVELS - 1];
+    return __MachineProbeLevelNames[level];
+}
+
+//
+
+long
+MachineProbeGetLevelCapacity(
+    MachineProbeRef     aProbe,
+    unsigned int        level
+)
+{
+    return (level < aProbe->nLevels) ? aProbe->levelCapacity[level] : 0;
+}
+
+//
+
+double
+MachineProbeGetBandwidth(
+    MachineProbeRef             aProbe,
+    unsigned int                level,
+    MachineProbeStreamKernel    kernel
+)
+{
+    if ( (level >= aProbe->nLevels) || (kernel < 0) || (kernel >= MachineProbeStreamKernelMax) ) return NAN;
+    return aProbe->bandwidth[level][kernel];
+}
+
+//
+
+unsigned int
+MachineProbeGetLevelForFootprint(
+    MachineProbeRef     aProbe,
+    double              bytes
+)
+{
+    unsigned int        level = 0;
+
+    while ( (level < aProbe->nLevels - 1) && (bytes > (double)aProbe->levelCapacity[level]) ) level++;
+    return level;
+}
+
+//
+
+double
+MachineProbeGetRoofline(
+    MachineProbeRef             aProbe,
+    double                      intensity,
+    double                      footprint,
+    double                      *outBandwidth,
+    unsigned int                *outLevel,
+    MachineProbeRooflineBound   *outBound
+)
+{
+    unsigned int                level = MachineProbeGetLevelForFootprint(aProbe, footprint);
+    double                      bandwidth = aProbe->bandwidth[level][MachineProbeStreamKernelTriad];
+    double                      memoryRoof = intensity * bandwidth;
+
+    if ( outBandwidth ) *outBandwidth = bandwidth;
+    if ( outLevel ) *outLevel = level;
+    if ( outBound ) *outBound = (memoryRoof < aProbe->peakGFLOPs) ? MachineProbeRooflineBoundMemory : MachineProbeRooflineBoundCompute;
+    return (memoryRoof < aProbe->peakGFLOPs) ? memoryRoof : aProbe->peakGFLOPs;
+}
+
+//
+
+static const ResultTableColumn __MachineProbePeakColumns[] = {
+                { "threads", ResultTableColumnTypeInteger },
+                { "vector width", ResultTableColumnTypeInteger },
+                { "GFLOP/s", ResultTableColumnTypeReal }
+            };
+
+static const ResultTableColumn __MachineProbeBandwidthColumns[] = {
+                { "level", ResultTableColumnTypeString },
+                { "working set", ResultTableColumnTypeInteger },
+                { "copy GB/s", ResultTableColumnTypeReal },
+                { "scale GB/s", ResultTableColumnTypeReal },
+                { "add GB/s", ResultTableColumnTypeReal },
+                { "triad GB/s", ResultTableColumnTypeReal }
+            };
+
+static const ResultTableColumn __MachineProbeLatencyColumns[] = {
+                { "working set", ResultTableColumnTypeInteger },
+                { "latency ns", ResultTableColumnTypeReal }
+            };
+
+void
+MachineProbeSummarizeToStream(
+    MachineProbeRef             aProbe,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              table;
+    unsigned int                i;
+    bool                        isJSON = (format == ExecutionTimerOutputFormatJSON);
+
+    //
+    // In JSON the three tables are the keys of a single object (named
+    // tables would each be an object of their own):
+    //
+    if ( isJSON ) fputs("{\"peak\":", stream);
+    if ( (table = ResultTableCreate(format, isJSON ? NULL : "peak", sizeof(__MachineProbePeakColumns) / sizeof(__MachineProbePeakColumns[0]), __MachineProbePeakColumns, stream)) ) {
+        ResultTableAddRow(table, (long)aProbe->nthreads, (long)aProbe->vectorWidth, aProbe->peakGFLOPs);
+        ResultTableRelease(table);
+    }
+    if ( format == ExecutionTimerOutputFormatTable ) fputc('\n', stream);
+    if ( isJSON ) fputs(",\"bandwidth\":", stream);
+    if ( (table = ResultTableCreate(format, isJSON ? NULL : "bandwidth", sizeof(__MachineProbeBandwidthColumns) / sizeof(__MachineProbeBandwidthColumns[0]), __MachineProbeBandwidthColumns, stream)) ) {
+        for ( i = 0; i < aProbe->nLevels; i++ ) {
+            ResultTableAddRow(table, MachineProbeGetLevelName(aProbe, i), aProbe->levelWorkingSet[i],
+                    aProbe->bandwidth[i][MachineProbeStreamKernelCopy], aProbe->bandwidth[i][MachineProbeStreamKernelScale],
+                    aProbe->bandwidth[i][MachineProbeStreamKernelAdd], aProbe->bandwidth[i][MachineProbeStreamKernelTriad]);
+        }
+        ResultTableRelease(table);
+    }
+    if ( format == ExecutionTimerOutputFormatTable ) fputc('\n', stream);
+    if ( isJSON ) fputs(",\"latency\":", stream);
+    if ( (table = ResultTableCreate(format, isJSON ? NULL : "latency", sizeof(__MachineProbeLatencyColumns) / sizeof(__MachineProbeLatencyColumns[0]), __MachineProbeLatencyColumns, stream)) ) {
+        for ( i = 0; i < aProbe->nLatency; i++ ) ResultTableAddRow(table, aProbe->latencyWorkingSet[i], aProbe->latencyNS[i]);
+        ResultTableRelease(table);
+    }
+    if ( isJSON ) fputs("}\n", stream);
+}
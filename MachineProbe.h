@@ -0,0 +1,206 @@
+/*
+ * MachineProbe.h
+ *
+ * Pseudo-class that measures the performance ceilings of the host:  peak
+ * floating-point (FMA) throughput, STREAM-style bandwidth at each level of
+ * the cache hierarchy and main memory, and load-to-use latency across a
+ * range of working-set sizes.  Results can be placed on a roofline.
+ *
+ * Probing takes several seconds, so results are cached in a plain text file
+ * keyed by the hardware fingerprint (see MachineInfoGetFingerprint()) with
+ * the floating-point precision appended, and the thread count:
+ *
+ *     <fingerprint> <threads> peak <GFLOP/s> <vector-width (f_real elements)>
+ *     <fingerprint> <threads> bandwidth <level> <bytes> <copy> <scale> <add> <triad>
+ *     <fingerprint> <threads> latency <bytes> <nanoseconds>
+ *
+ * with tab-delimited fields.  Lines starting with '#' are comments.
+ */
+
+#ifndef __MACHINEPROBE_H__
+#define __MACHINEPROBE_H__
+
+#include "MachineInfo.h"
+#include "ExecutionTimer.h"
+#include "FortranInterface.h"
+
+/*!
+ * @defined MACHINEPROBE_MAX_LEVELS
+ *
+ * Maximum number of levels of the memory hierarchy (caches plus main
+ * memory).
+ */
+#define MACHINEPROBE_MAX_LEVELS (MACHINEINFO_MAX_CACHE_LEVEL + 1)
+
+/*!
+ * @defined MACHINEPROBE_MAX_LATENCY_POINTS
+ *
+ * Maximum number of working-set sizes in the latency curve.
+ */
+#define MACHINEPROBE_MAX_LATENCY_POINTS 32
+
+/*!
+ * @typedef MachineProbeStreamKernel
+ *
+ * The STREAM kernels:
+ *
+ *     copy:   a[i] = b[i]
+ *     scale:  a[i] = q * b[i]
+ *     add:    a[i] = b[i] + c[i]
+ *     triad:  a[i] = b[i] + q * c[i]
+ *
+ * Bandwidth is computed STREAM-style from the bytes explicitly read and
+ * written (16 per element for copy and scale, 24 for add and triad).
+ */
+typedef enum {
+    MachineProbeStreamKernelCopy = 0,
+    MachineProbeStreamKernelScale,
+    MachineProbeStreamKernelAdd,
+    MachineProbeStreamKernelTriad,
+    MachineProbeStreamKernelMax
+} MachineProbeStreamKernel;
+
+/*!
+ * @typedef MachineProbeRooflineBound
+ *
+ * Which roof limits a kernel of a given arithmetic intensity.
+ */
+typedef enum {
+    MachineProbeRooflineBoundMemory = 0,
+    MachineProbeRooflineBoundCompute
+} MachineProbeRooflineBound;
+
+/*!
+ * @typedef MachineProbeRef
+ *
+ * Type of a reference to a MachineProbe object.
+ */
+typedef struct MachineProbe * MachineProbeRef;
+
+/*!
+ * @function MachineProbeDefaultPath
+ *
+ * Returns the default path of the probe cache file:  the value of the
+ * MMBENCH_PROBE_CACHE environment variable, else
+ * $XDG_CACHE_HOME/mmbench/probe.cache, else $HOME/.cache/mmbench/probe.cache.
+ * Returns NULL if none can be determined.
+ */
+const char* MachineProbeDefaultPath(void);
+
+/*!
+ * @function MachineProbeCreate
+ *
+ * Measure the performance ceilings of aMachine using nthreads threads.
+ * Cache levels are taken from aMachine; main memory is probed with a
+ * working set four times the size of the last-level cache.
+ */
+MachineProbeRef MachineProbeCreate(MachineInfoRef aMachine, int nthreads);
+
+/*!
+ * @function MachineProbeCreateWithCache
+ *
+ * Returns the cached probe of aMachine with nthreads threads from the file
+ * at path (NULL for the default path).  If there is no such probe -- or if
+ * shouldRefresh is true -- the machine is probed and the result is saved to
+ * the file.
+ */
+MachineProbeRef MachineProbeCreateWithCache(MachineInfoRef aMachine, int nthreads, const char *path, bool shouldRefresh);
+
+/*!
+ * @function MachineProbeRetain
+ *
+ * Increase the reference count of aProbe.
+ */
+MachineProbeRef MachineProbeRetain(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeRelease
+ *
+ * Decrease the reference count of aProbe, deallocating it once it reaches
+ * zero.
+ */
+void MachineProbeRelease(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeIsCached
+ *
+ * Returns boolean true if aProbe was loaded from the cache rather than
+ * measured.
+ */
+bool MachineProbeIsCached(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeGetThreadCount
+ *
+ * Returns the number of threads used by the probe.
+ */
+int MachineProbeGetThreadCount(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeGetPeakGFLOPs
+ *
+ * Returns the measured peak floating-point rate in the precision of the
+ * multiplication routines (f_real).
+ */
+double MachineProbeGetPeakGFLOPs(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeGetLevelCount
+ *
+ * Returns the number of levels of the memory hierarchy that were probed
+ * (the data caches plus main memory).
+ */
+unsigned int MachineProbeGetLevelCount(MachineProbeRef aProbe);
+
+/*!
+ * @function MachineProbeGetLevelName
+ *
+ * Returns the name of a level of the memory hierarchy (0 = L1), e.g. "L2"
+ * or "DRAM".
+ */
+const char* MachineProbeGetLevelName(MachineProbeRef aProbe, unsigned int level);
+
+/*!
+ * @function MachineProbeGetLevelCapacity
+ *
+ * Returns the capacity in bytes of a level of the memory hierarchy (0 = L1);
+ * main memory is reported as zero (unbounded).
+ */
+long MachineProbeGetLevelCapacity(MachineProbeRef aProbe, unsigned int level);
+
+/*!
+ * @function MachineProbeGetBandwidth
+ *
+ * Returns the bandwidth in GB/s of a STREAM kernel at a level of the memory
+ * hierarchy (0 = L1).
+ */
+double MachineProbeGetBandwidth(MachineProbeRef aProbe, unsigned int level, MachineProbeStreamKernel kernel);
+
+/*!
+ * @function MachineProbeGetLevelForFootprint
+ *
+ * Returns the innermost level of the memory hierarchy that can hold a
+ * working set of the given size in bytes.
+ */
+unsigned int MachineProbeGetLevelForFootprint(MachineProbeRef aProbe, double bytes);
+
+/*!
+ * @function MachineProbeGetRoofline
+ *
+ * Place a kernel with the given arithmetic intensity (flops per byte) and
+ * working set (bytes) on the roofline:  the bandwidth roof is the triad
+ * bandwidth of the level that holds the working set.  Returns the
+ * attainable GFLOP/s, and in the (optional) out arguments the bandwidth
+ * roof (GB/s), the level, and which roof bounds the kernel.
+ */
+double MachineProbeGetRoofline(MachineProbeRef aProbe, double intensity, double footprint, double *outBandwidth, unsigned int *outLevel, MachineProbeRooflineBound *outBound);
+
+/*!
+ * @function MachineProbeSummarizeToStream
+ *
+ * Write the probe results to stream as three tables in the given format:
+ * "peak", "bandwidth", and "latency".
+ */
+void MachineProbeSummarizeToStream(MachineProbeRef aProbe, ExecutionTimerOutputFormat format, FILE *stream);
+
+#endif /* __MACHINEPROBE_H__ */
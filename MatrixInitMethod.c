@@ -4,20 +4,36 @@
  * Generalized interface to routines that initialize a matrix.
  */
 
-#ifdef HAVE_DIRECTIO
+#ifndef _GNU_SOURCE
 #define _GNU_SOURCE
 #endif
 
 #include "MatrixInitMethod.h"
+#include "TraceLog.h"
 
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <errno.h>
 
+#ifdef __linux__
+#   include <linux/fs.h>
+#endif
+
+#ifdef HAVE_IO_URING
+#   include <sys/syscall.h>
+#   include <sys/uio.h>
+#   include <linux/io_uring.h>
+#endif /* HAVE_IO_URING */
+
 //
 
 static bool __MatrixInitMethodIsInitialized = false;
@@ -324,6 +340,24 @@ MatrixInitObjectInit(
     return false;
 }
 
+//
+
+f_real*
+MatrixInitObjectProvide(
+    MatrixInitObjectRef initObj,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    MatrixInitMatrix    which,
+    f_real              *M
+)
+{
+    if ( initObj->initMethod->callbacks.map ) {
+        return initObj->initMethod->callbacks.map(initObj->context, timer, nthreads, n, which);
+    }
+    return MatrixInitObjectInit(initObj, timer, nthreads, n, M) ? M : NULL;
+}
+
 //
 ////
 //
@@ -500,74 +534,446 @@ MatrixInitMethodCallbacks   __MatrixInitMethodRandom = {
 ////
 //
 
+//
+// Options of the file-based methods take the form
+//
+//     <method>={opt{,..}:}<path>
+//
+// where each opt is a word (e.g. "direct") or a word and a value separated
+// by a colon (e.g. "chunk:4M").  Parsing stops at the first word that is
+// not an option, so a path with no options needs no colon.
+//
 typedef struct {
-    int         fd;
-} MatrixInitMethodFileContext;
+    const char      *name;
+    bool            hasValue;
+} MatrixInitMethodOption;
+
+typedef bool (*MatrixInitMethodOptionHandler)(void *context, unsigned int optionIndex, const char *value, size_t valueLen);
 
 //
 
 bool
-__MatrixInitMethodFileAlloc(
-    const char  *inArgs,
-    const void* *outContext
+__MatrixInitMethodParseOptions(
+    const char                      *methodName,
+    const char                      *inArgs,
+    const MatrixInitMethodOption    *options,
+    MatrixInitMethodOptionHandler   handler,
+    void                            *context,
+    const char*                     *outPath
 )
 {
-    int         oflags = 0;
-    const char  *args = inArgs;
+    const char                      *args = inArgs;
+
+    while ( *args ) {
+        size_t                      wordLen = strcspn(args, ",:");
+        unsigned int                i;
+
+        for ( i = 0; options[i].name; i++ ) {
+            if ( (strlen(options[i].name) == wordLen) && (strncasecmp(args, options[i].name, wordLen) == 0) ) break;
+        }
+        if ( ! options[i].name || ! args[wordLen] ) break;
+        args += wordLen;
+        if ( options[i].hasValue ) {
+            size_t                  valueLen;
 
-    while ( 1 ) {
-        if ( strncasecmp(args, "sync,", 5) == 0 ) {
-            oflags |= O_SYNC;
-            args += 5;
+            if ( *args != ':' ) {
+                fprintf(stderr, "ERROR:  %s option %s requires a value\n", methodName, options[i].name);
+                return false;
+            }
+            args++;
+            valueLen = strcspn(args, ",:");
+            if ( ! handler(context, i, args, valueLen) ) {
+                fprintf(stderr, "ERROR:  invalid %s option value: %s:%.*s\n", methodName, options[i].name, (int)valueLen, args);
+                return false;
+            }
+            args += valueLen;
+        } else if ( ! handler(context, i, NULL, 0) ) {
+            fprintf(stderr, "ERROR:  %s option %s is not supported\n", methodName, options[i].name);
+            return false;
         }
-        else if ( strncasecmp(args, "noatime,", 8) == 0 ) {
-            oflags |= O_NOATIME;
-            args += 8;
+        // A colon ends the options, a comma precedes another:
+        if ( *args == ':' ) {
+            args++;
+            break;
         }
-#ifdef HAVE_DIRECTIO
-        else if ( strncasecmp(args, "direct,", 7) == 0 ) {
-            oflags |= O_DIRECT;
-            args += 7;
+        if ( *args == ',' ) args++;
+    }
+    if ( ! *args ) {
+        fprintf(stderr, "ERROR:  no file specified for the %s init method\n", methodName);
+        return false;
+    }
+    *outPath = args;
+    return true;
+}
+
+//
+
+bool
+__MatrixInitMethodParseSize(
+    const char      *value,
+    size_t          valueLen,
+    size_t          *outSize
+)
+{
+    char            *end;
+    unsigned long   size = strtoul(value, &end, 10);
+
+    if ( end == value ) return false;
+    if ( end < value + valueLen ) {
+        switch ( toupper(*end++) ) {
+            case 'K':
+                size *= 1024;
+                break;
+            case 'M':
+                size *= 1024 * 1024;
+                break;
+            case 'G':
+                size *= 1024 * 1024 * 1024;
+                break;
+            default:
+                return false;
         }
-#endif /* HAVE_DIRECTIO */
-        else break;
     }
-    if ( *args ) {
-        int         fd;
-        char        *colon = strchr(args, ':');
+    if ( (end != value + valueLen) || (size == 0) ) return false;
+    *outSize = size;
+    return true;
+}
+
+//
+
+#ifndef MATRIXINITMETHOD_FILE_BOUNCE_SIZE
+#define MATRIXINITMETHOD_FILE_BOUNCE_SIZE (4 * 1024 * 1024)
+#endif
+
+//
+// O_DIRECT alignment used when the file system does not report one (a
+// multiple of both the 512-byte and 4 KiB logical block sizes):
+//
+#ifndef MATRIXINITMETHOD_FILE_DIRECT_ALIGN
+#define MATRIXINITMETHOD_FILE_DIRECT_ALIGN 4096
+#endif
+
+typedef struct {
+    int         fd;
+    int         oflags;
+    bool        isDirect;
+    size_t      chunkSize;      // bytes per read, 0 = the whole matrix
+    size_t      blockSize;      // logical block size, for O_DIRECT alignment
+    off_t       usableSize;     // file size rounded down to whole elements
+    off_t       offset;         // where the next read starts
+    size_t      bounceSize;
+    void        *bounce;        // aligned buffer for O_DIRECT reads
+    int         cacheMode;      // page cache preparation before each read
+    int         accessAdvice;   // posix_fadvise() access pattern for the file
+} MatrixInitMethodFileContext;
+
+enum {
+    MatrixInitMethodFileCacheAsIs = 0,
+    MatrixInitMethodFileCacheCold,
+    MatrixInitMethodFileCacheWarm
+};
+
+//
+// The options shared by all file-based methods come first, in this order, so
+// the file method's handler can parse them for every method; chunk (or its
+// equivalent) always comes last:
+//
+enum {
+    MatrixInitMethodFileOptionSync = 0,
+    MatrixInitMethodFileOptionNoatime,
+    MatrixInitMethodFileOptionDirect,
+    MatrixInitMethodFileOptionCache,
+    MatrixInitMethodFileOptionAccess,
+    MatrixInitMethodFileOptionChunk
+};
+
+static const MatrixInitMethodOption __MatrixInitMethodFileOptions[] = {
+            { "sync", false },
+            { "noatime", false },
+            { "direct", false },
+            { "cache", true },
+            { "access", true },
+            { "chunk", true },
+            { NULL, false }
+        };
+
+//
 
-        if ( colon ) args = colon + 1;
-        if ( (fd = open(args, oflags)) >= 0 ) {
-            MatrixInitMethodFileContext     *context = malloc(sizeof(MatrixInitMethodFileContext));
+bool
+__MatrixInitMethodFileOption(
+    void            *inContext,
+    unsigned int    optionIndex,
+    const char      *value,
+    size_t          valueLen
+)
+{
+    MatrixInitMethodFileContext *CONTEXT = (MatrixInitMethodFileContext*)inContext;
 
-            if ( context ) {
-                context->fd = fd;
-                *outContext = context;
+    switch ( optionIndex ) {
+        case MatrixInitMethodFileOptionSync:
+            CONTEXT->oflags |= O_SYNC;
+            return true;
+        case MatrixInitMethodFileOptionNoatime:
+            CONTEXT->oflags |= O_NOATIME;
+            return true;
+        case MatrixInitMethodFileOptionDirect:
+#ifdef HAVE_DIRECTIO
+            CONTEXT->oflags |= O_DIRECT;
+            CONTEXT->isDirect = true;
+            return true;
+#else
+            return false;
+#endif /* HAVE_DIRECTIO */
+        case MatrixInitMethodFileOptionCache:
+            if ( (valueLen == 4) && (strncasecmp(value, "cold", 4) == 0) ) {
+                CONTEXT->cacheMode = MatrixInitMethodFileCacheCold;
                 return true;
             }
-            close(fd);
-        } else {
-            fprintf(stderr, "ERROR:  could not open matrix init file %s (flags = 0x%x, errno = %d)\n", args, oflags, errno);
-        }
+            if ( (valueLen == 4) && (strncasecmp(value, "warm", 4) == 0) ) {
+                CONTEXT->cacheMode = MatrixInitMethodFileCacheWarm;
+                return true;
+            }
+            return false;
+        case MatrixInitMethodFileOptionAccess:
+            if ( (valueLen == 10) && (strncasecmp(value, "sequential", 10) == 0) ) {
+                CONTEXT->accessAdvice = POSIX_FADV_SEQUENTIAL;
+                return true;
+            }
+            if ( (valueLen == 6) && (strncasecmp(value, "random", 6) == 0) ) {
+                CONTEXT->accessAdvice = POSIX_FADV_RANDOM;
+                return true;
+            }
+            return false;
+        case MatrixInitMethodFileOptionChunk:
+            return __MatrixInitMethodParseSize(value, valueLen, &CONTEXT->chunkSize);
     }
     return false;
 }
 
 //
 
+bool
+__MatrixInitMethodFileGetGeometry(
+    int             fd,
+    const char      *path,
+    size_t          *outBlockSize,
+    off_t           *outUsableSize
+)
+{
+    struct stat     finfo;
+    off_t           size;
+
+    if ( fstat(fd, &finfo) != 0 ) {
+        fprintf(stderr, "ERROR:  unable to stat matrix init file %s (errno = %d)\n", path, errno);
+        return false;
+    }
+    size = finfo.st_size;
+
+    //
+    // The block size is the O_DIRECT alignment, not st_blksize:  that is the
+    // preferred I/O size, which can be MiBs on Lustre or ZFS.
+    //
+    *outBlockSize = MATRIXINITMETHOD_FILE_DIRECT_ALIGN;
+#ifdef STATX_DIOALIGN
+    if ( S_ISREG(finfo.st_mode) ) {
+        struct statx        xinfo;
+
+        if ( (statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &xinfo) == 0) && (xinfo.stx_mask & STATX_DIOALIGN) && (xinfo.stx_dio_offset_align > 0) ) {
+            *outBlockSize = (xinfo.stx_dio_mem_align > xinfo.stx_dio_offset_align) ? xinfo.stx_dio_mem_align : xinfo.stx_dio_offset_align;
+        }
+    }
+#endif
+#ifdef __linux__
+    if ( S_ISBLK(finfo.st_mode) ) {
+        unsigned long long  devSize;
+        int                 sectorSize;
+
+        if ( ioctl(fd, BLKGETSIZE64, &devSize) == 0 ) size = (off_t)devSize;
+        if ( (ioctl(fd, BLKSSZGET, &sectorSize) == 0) && (sectorSize > 0) ) *outBlockSize = sectorSize;
+    }
+#endif
+    *outUsableSize = size - (size % sizeof(f_real));
+    if ( *outUsableSize <= 0 ) {
+        fprintf(stderr, "ERROR:  matrix init file %s is too small\n", path);
+        return false;
+    }
+    return true;
+}
+
+//
+
+//
+// Open the file for a file-based method whose options have already been
+// parsed into the context.
+//
+
+bool
+__MatrixInitMethodFileOpen(
+    MatrixInitMethodFileContext     *context,
+    const char                      *path
+)
+{
+    if ( (context->fd = open(path, O_RDONLY | context->oflags)) < 0 ) {
+        fprintf(stderr, "ERROR:  could not open matrix init file %s (flags = 0x%x, errno = %d)\n", path, context->oflags, errno);
+        return false;
+    }
+    if ( ! __MatrixInitMethodFileGetGeometry(context->fd, path, &context->blockSize, &context->usableSize) ) {
+        close(context->fd);
+        context->fd = -1;
+        return false;
+    }
+    if ( (context->accessAdvice != POSIX_FADV_NORMAL) && (posix_fadvise(context->fd, 0, 0, context->accessAdvice) != 0) ) {
+        fprintf(stderr, "WARNING:  unable to advise the kernel of the access pattern of %s\n", path);
+    }
+    if ( context->isDirect ) {
+        //
+        // Reads that do not land on an aligned destination go through a
+        // bounce buffer of whole blocks:
+        //
+        context->bounceSize = context->chunkSize ? context->chunkSize : MATRIXINITMETHOD_FILE_BOUNCE_SIZE;
+        context->bounceSize = ((context->bounceSize + context->blockSize - 1) / context->blockSize) * context->blockSize;
+        if ( posix_memalign(&context->bounce, context->blockSize, context->bounceSize) != 0 ) {
+            fprintf(stderr, "ERROR:  unable to allocate %lu-byte direct i/o buffer\n", (unsigned long)context->bounceSize);
+            context->bounce = NULL;
+            close(context->fd);
+            context->fd = -1;
+            return false;
+        }
+    }
+    return true;
+}
+
+//
+
+void
+__MatrixInitMethodFileClose(
+    MatrixInitMethodFileContext     *context
+)
+{
+    if ( context->fd >= 0 ) close(context->fd);
+    if ( context->bounce ) free(context->bounce);
+}
+
+//
+
+bool
+__MatrixInitMethodFileAlloc(
+    const char  *inArgs,
+    const void* *outContext
+)
+{
+    MatrixInitMethodFileContext     *context = calloc(1, sizeof(MatrixInitMethodFileContext));
+    const char                      *path;
+
+    if ( ! context ) return false;
+    context->fd = -1;
+    if ( ! __MatrixInitMethodParseOptions("file", inArgs, __MatrixInitMethodFileOptions, __MatrixInitMethodFileOption, context, &path) ) {
+        free((void*)context);
+        return false;
+    }
+    if ( ! __MatrixInitMethodFileOpen(context, path) ) {
+        free((void*)context);
+        return false;
+    }
+    *outContext = context;
+    return true;
+}
+
+//
+
 void
 __MatrixInitMethodFileDealloc(
     const void *inContext
 )
 {
-    MatrixInitMethodFileContext *CONTEXT = (MatrixInitMethodFileContext*)inContext;
-
-    close(CONTEXT->fd);
+    __MatrixInitMethodFileClose((MatrixInitMethodFileContext*)inContext);
     free((void*)inContext);
 }
 
 //
+// Count the pages of a span of the file that are resident in the page cache.
+// Mapping the span does not fault anything in.
+//
+
+void
+__MatrixInitMethodFileCountResident(
+    MatrixInitMethodFileContext     *context,
+    off_t                           offset,
+    size_t                          length,
+    size_t                          *nResident,
+    size_t                          *nPages
+)
+{
+    size_t                          pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    off_t                           start = offset - (offset % pageSize);
+    size_t                          mapLength = length + (offset - start);
+    size_t                          nSpanPages = (mapLength + pageSize - 1) / pageSize, i;
+    unsigned char                   *vec;
+    void                            *base;
+
+    if ( (base = mmap(NULL, mapLength, PROT_READ, MAP_SHARED, context->fd, start)) == MAP_FAILED ) return;
+    if ( (vec = malloc(nSpanPages)) ) {
+        if ( mincore(base, mapLength, vec) == 0 ) {
+            for ( i = 0; i < nSpanPages; i++ ) if ( vec[i] & 1 ) (*nResident)++;
+            *nPages += nSpanPages;
+        }
+        free(vec);
+    }
+    munmap(base, mapLength);
+}
+
+//
+// Prepare the page cache for the next read of length bytes (which starts
+// at the context's offset, wrapping around at the end of the file):  drop
+// the span from the cache (cold) or read it in ahead of time (warm).  Then
+// note on the timer how much of the span is resident as the read starts.
+//
+
+void
+__MatrixInitMethodFilePrepareCache(
+    MatrixInitMethodFileContext     *context,
+    ExecutionTimerRef               timer,
+    size_t                          length
+)
+{
+    off_t                           offset = (context->offset >= context->usableSize) ? 0 : context->offset;
+    size_t                          nResident = 0, nPages = 0;
+
+    if ( (off_t)length > context->usableSize ) length = context->usableSize;
+    while ( length > 0 ) {
+        size_t                      spanLength = length;
+
+        if ( (off_t)spanLength > context->usableSize - offset ) spanLength = context->usableSize - offset;
+        switch ( context->cacheMode ) {
+            case MatrixInitMethodFileCacheCold: {
+                // Only whole pages are dropped, so cover the partial ones at
+                // either end, too:
+                size_t              pageSize = (size_t)sysconf(_SC_PAGESIZE);
+                off_t               start = offset - (offset % pageSize);
+
+                posix_fadvise(context->fd, start, ((offset - start + spanLength + pageSize - 1) / pageSize) * pageSize, POSIX_FADV_DONTNEED);
+                break;
+            }
+            case MatrixInitMethodFileCacheWarm:
+                posix_fadvise(context->fd, offset, spanLength, POSIX_FADV_WILLNEED);
+                readahead(context->fd, offset, spanLength);
+                break;
+        }
+        __MatrixInitMethodFileCountResident(context, offset, spanLength, &nResident, &nPages);
+        length -= spanLength;
+        offset = 0;
+    }
+    if ( nPages > 0 ) ExecutionTimerNoteCacheResidency(timer, (double)nResident / (double)nPages);
+}
 
+//
+// Fill the n-by-n matrix from the file, continuing where the previous call
+// stopped and wrapping around to the start at EOF.  Each read is a chunk
+// (by default, everything still needed).  With O_DIRECT, offsets and
+// lengths are whole blocks:  reads go straight into M where it is aligned,
+// otherwise through the bounce buffer, and the next read starts at the
+// block following the last byte used.
+//
 bool
 __MatrixInitMethodFileInit(
     const void          *inContext,
@@ -578,29 +984,56 @@ __MatrixInitMethodFileInit(
 )
 {
     MatrixInitMethodFileContext *CONTEXT = (MatrixInitMethodFileContext*)inContext;
+    size_t                      remaining = (size_t)n * (size_t)n * sizeof(f_real);
+    char                        *dst = (char*)M;
+    bool                        ok = true;
 
-    f_integer           i, j;
-
+    __MatrixInitMethodFilePrepareCache(CONTEXT, timer, remaining);
     ExecutionTimerStart(timer);
-    for ( i = 0; i < n; i++ ) {
-        for ( j = 0; j < n; j++ ) {
-            ssize_t     actual = read(CONTEXT->fd, &M[i * n + j], sizeof(f_real));
-
-            if ( actual < sizeof(f_real) ) {
-                if ( lseek(CONTEXT->fd, 0, SEEK_SET) != 0 ) {
-                    fprintf(stderr, "ERROR:  unable to rewind matrix initialization file (errno = %d)\n", errno);
-                    return false;
-                }
-                actual = read(CONTEXT->fd, &M[i * n + j], sizeof(f_real));
+    TraceLogAddEvent(TraceLogPhaseBegin, "io", "read", "bytes", (double)remaining);
+    while ( remaining > 0 ) {
+        size_t          want = (CONTEXT->chunkSize && (CONTEXT->chunkSize < remaining)) ? CONTEXT->chunkSize : remaining;
+        size_t          readLen = want, used;
+        char            *buffer = dst;
+        ssize_t         actual;
+
+        if ( CONTEXT->offset >= CONTEXT->usableSize ) CONTEXT->offset = 0;
+        if ( CONTEXT->isDirect ) {
+            readLen = ((want + CONTEXT->blockSize - 1) / CONTEXT->blockSize) * CONTEXT->blockSize;
+            if ( (readLen != want) || ((uintptr_t)dst % CONTEXT->blockSize) ) {
+                buffer = (char*)CONTEXT->bounce;
+                if ( readLen > CONTEXT->bounceSize ) readLen = CONTEXT->bounceSize;
             }
-            if ( actual != sizeof(f_real) ) {
-                fprintf(stderr, "ERROR:  unable to read from matrix initialization file (errno = %d)\n", errno);
-                return false;
+        }
+        actual = pread(CONTEXT->fd, buffer, readLen, CONTEXT->offset);
+        if ( actual < 0 ) {
+            if ( errno == EINTR ) continue;
+            fprintf(stderr, "ERROR:  unable to read from matrix initialization file (errno = %d)\n", errno);
+            ok = false;
+            break;
+        }
+        // Only whole elements before EOF count; the rest of the file is
+        // skipped by wrapping around:
+        if ( CONTEXT->offset + actual > CONTEXT->usableSize ) actual = CONTEXT->usableSize - CONTEXT->offset;
+        if ( actual == 0 ) {
+            if ( CONTEXT->offset == 0 ) {
+                fprintf(stderr, "ERROR:  matrix initialization file is empty\n");
+                ok = false;
+                break;
             }
+            CONTEXT->offset = 0;
+            continue;
         }
+        ExecutionTimerCountIO(timer, (double)actual, 1);
+        used = ((size_t)actual < want) ? (size_t)actual : want;
+        if ( buffer != dst ) memcpy(dst, buffer, used);
+        dst += used;
+        remaining -= used;
+        CONTEXT->offset += CONTEXT->isDirect ? ((used + CONTEXT->blockSize - 1) / CONTEXT->blockSize) * CONTEXT->blockSize : used;
     }
+    TraceLogEnd("io", "read");
     ExecutionTimerStop(timer);
-    return true;
+    return ok;
 }
 
 MatrixInitMethodCallbacks   __MatrixInitMethodFile = {
@@ -614,14 +1047,1015 @@ MatrixInitMethodCallbacks   __MatrixInitMethodFile = {
 ////
 //
 
+#ifndef MATRIXINITMETHOD_IOURING_DEFAULT_QD
+#define MATRIXINITMETHOD_IOURING_DEFAULT_QD 32
+#endif
+
+#ifndef MATRIXINITMETHOD_IOURING_MAX_QD
+#define MATRIXINITMETHOD_IOURING_MAX_QD 4096
+#endif
+
+#ifndef MATRIXINITMETHOD_IOURING_DEFAULT_CHUNK
+#define MATRIXINITMETHOD_IOURING_DEFAULT_CHUNK (1024 * 1024)
+#endif
+
+typedef struct {
+    char        *dst;           // where the read's data belongs in the matrix
+    size_t      used;           // bytes of the read that belong there
+} MatrixInitMethodIOURingSlot;
+
+typedef struct {
+    MatrixInitMethodFileContext file;   // must be first:  the pread() fallback uses it
+    unsigned int                queueDepth;
+    bool                        hasRing;
+#ifdef HAVE_IO_URING
+    int                         ringFd;
+    bool                        hasFixedFile;
+    bool                        hasFixedBuffers;
+    void                        *sqRing, *cqRing;
+    size_t                      sqRingSize, cqRingSize;
+    struct io_uring_sqe         *sqes;
+    size_t                      sqesSize;
+    unsigned                    *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned                    *cqHead, *cqTail, *cqMask;
+    struct io_uring_cqe         *cqes;
+    size_t                      bufferSize;     // bytes per slot, whole blocks
+    char                        *buffers;       // queueDepth slots' buffers
+    struct iovec                *iovecs;
+    MatrixInitMethodIOURingSlot *slots;
+    unsigned int                *freeSlots;
+    unsigned int                nFreeSlots;
+#endif /* HAVE_IO_URING */
+} MatrixInitMethodIOURingContext;
+
+enum {
+    MatrixInitMethodIOURingOptionQueueDepth = MatrixInitMethodFileOptionChunk + 1
+};
+
+static const MatrixInitMethodOption __MatrixInitMethodIOURingOptions[] = {
+            { "sync", false },
+            { "noatime", false },
+            { "direct", false },
+            { "cache", true },
+            { "access", true },
+            { "chunk", true },
+            { "qd", true },
+            { NULL, false }
+        };
+
+//
+
+bool
+__MatrixInitMethodIOURingOption(
+    void            *inContext,
+    unsigned int    optionIndex,
+    const char      *value,
+    size_t          valueLen
+)
+{
+    MatrixInitMethodIOURingContext  *CONTEXT = (MatrixInitMethodIOURingContext*)inContext;
+
+    if ( optionIndex == MatrixInitMethodIOURingOptionQueueDepth ) {
+        char            *end;
+        unsigned long   qd = strtoul(value, &end, 10);
+
+        if ( (end != value + valueLen) || (qd < 1) || (qd > MATRIXINITMETHOD_IOURING_MAX_QD) ) return false;
+        CONTEXT->queueDepth = (unsigned int)qd;
+        return true;
+    }
+    return __MatrixInitMethodFileOption(&CONTEXT->file, optionIndex, value, valueLen);
+}
+
+#ifdef HAVE_IO_URING
+
+//
+// There is deliberately no liburing dependency:  the three system calls
+// are made directly and the rings are shared with the kernel by hand.
+//
+
+static inline int
+__io_uring_setup(
+    unsigned int            entries,
+    struct io_uring_params  *params
+)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static inline int
+__io_uring_enter(
+    int             ringFd,
+    unsigned int    toSubmit,
+    unsigned int    minComplete,
+    unsigned int    flags
+)
+{
+    return (int)syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+static inline int
+__io_uring_register(
+    int             ringFd,
+    unsigned int    opcode,
+    const void      *arg,
+    unsigned int    nArgs
+)
+{
+    return (int)syscall(__NR_io_uring_register, ringFd, opcode, arg, nArgs);
+}
+
+//
+
 void
-__MatrixInitMethodInitialize(void)
+__MatrixInitMethodIOURingTeardown(
+    MatrixInitMethodIOURingContext  *context
+)
 {
-    if ( __MatrixInitMethodIsInitializing ) return;
+    if ( context->sqes ) munmap(context->sqes, context->sqesSize);
+    if ( context->cqRing && (context->cqRing != context->sqRing) ) munmap(context->cqRing, context->cqRingSize);
+    if ( context->sqRing ) munmap(context->sqRing, context->sqRingSize);
+    if ( context->ringFd >= 0 ) close(context->ringFd);
+    if ( context->buffers ) free(context->buffers);
+    if ( context->iovecs ) free(context->iovecs);
+    if ( context->slots ) free(context->slots);
+    if ( context->freeSlots ) free(context->freeSlots);
+    context->sqRing = context->cqRing = NULL;
+    context->sqes = NULL;
+    context->buffers = NULL;
+    context->iovecs = NULL;
+    context->slots = NULL;
+    context->freeSlots = NULL;
+    context->ringFd = -1;
+    context->hasRing = false;
+}
 
-    __MatrixInitMethodIsInitializing = true;
+//
+// Create the ring and map its queues, then register the slot buffers and the
+// file with it.  Registration failures are not fatal:  reads fall back to
+// IORING_OP_READV and a plain descriptor, respectively.  Returns boolean false
+// (with errno set) if the kernel will not provide a ring at all.
+//
 
-    __MatrixInitMethodRegister("file", &__MatrixInitMethodFile, false);
+bool
+__MatrixInitMethodIOURingSetup(
+    MatrixInitMethodIOURingContext  *context
+)
+{
+    struct io_uring_params          params;
+    size_t                          chunkSize = context->file.chunkSize;
+    unsigned int                    i;
+    int                             savedErrno;
+
+    memset(&params, 0, sizeof(params));
+    if ( (context->ringFd = __io_uring_setup(context->queueDepth, &params)) < 0 ) return false;
+
+    context->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    context->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if ( params.features & IORING_FEAT_SINGLE_MMAP ) {
+        if ( context->cqRingSize > context->sqRingSize ) context->sqRingSize = context->cqRingSize;
+        context->cqRingSize = context->sqRingSize;
+    }
+    context->sqRing = mmap(NULL, context->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, context->ringFd, IORING_OFF_SQ_RING);
+    if ( context->sqRing == MAP_FAILED ) {
+        context->sqRing = NULL;
+        goto failure;
+    }
+    if ( params.features & IORING_FEAT_SINGLE_MMAP ) {
+        context->cqRing = context->sqRing;
+    } else {
+        context->cqRing = mmap(NULL, context->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, context->ringFd, IORING_OFF_CQ_RING);
+        if ( context->cqRing == MAP_FAILED ) {
+            context->cqRing = NULL;
+            goto failure;
+        }
+    }
+    context->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    context->sqes = mmap(NULL, context->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, context->ringFd, IORING_OFF_SQES);
+    if ( context->sqes == MAP_FAILED ) {
+        context->sqes = NULL;
+        goto failure;
+    }
+    context->sqHead = (unsigned*)((char*)context->sqRing + params.sq_off.head);
+    context->sqTail = (unsigned*)((char*)context->sqRing + params.sq_off.tail);
+    context->sqMask = (unsigned*)((char*)context->sqRing + params.sq_off.ring_mask);
+    context->sqArray = (unsigned*)((char*)context->sqRing + params.sq_off.array);
+    context->cqHead = (unsigned*)((char*)context->cqRing + params.cq_off.head);
+    context->cqTail = (unsigned*)((char*)context->cqRing + params.cq_off.tail);
+    context->cqMask = (unsigned*)((char*)context->cqRing + params.cq_off.ring_mask);
+    context->cqes = (struct io_uring_cqe*)((char*)context->cqRing + params.cq_off.cqes);
+
+    //
+    // One whole-block buffer per slot; the SQ may have been rounded up to a
+    // power of two, but no more than queueDepth reads are ever in flight:
+    //
+    context->bufferSize = ((chunkSize + context->file.blockSize - 1) / context->file.blockSize) * context->file.blockSize;
+    context->iovecs = calloc(context->queueDepth, sizeof(struct iovec));
+    context->slots = calloc(context->queueDepth, sizeof(MatrixInitMethodIOURingSlot));
+    context->freeSlots = calloc(context->queueDepth, sizeof(unsigned int));
+    if ( ! context->iovecs || ! context->slots || ! context->freeSlots ||
+         (posix_memalign((void**)&context->buffers, context->file.blockSize, context->bufferSize * context->queueDepth) != 0) ) {
+        context->buffers = NULL;
+        errno = ENOMEM;
+        goto failure;
+    }
+    for ( i = 0; i < context->queueDepth; i++ ) {
+        context->iovecs[i].iov_base = context->buffers + i * context->bufferSize;
+        context->iovecs[i].iov_len = context->bufferSize;
+        context->freeSlots[i] = context->queueDepth - 1 - i;
+    }
+    context->nFreeSlots = context->queueDepth;
+
+    // Registered buffers are pinned once rather than mapped on every read:
+    context->hasFixedBuffers = (__io_uring_register(context->ringFd, IORING_REGISTER_BUFFERS, context->iovecs, context->queueDepth) == 0);
+    if ( ! context->hasFixedBuffers ) {
+        fprintf(stderr, "WARNING:  unable to register io_uring buffers (errno = %d), using unregistered buffers\n", errno);
+    }
+    // ...and a registered file is not looked up on every read:
+    context->hasFixedFile = (__io_uring_register(context->ringFd, IORING_REGISTER_FILES, &context->file.fd, 1) == 0);
+    if ( ! context->hasFixedFile ) {
+        fprintf(stderr, "WARNING:  unable to register file with io_uring (errno = %d), using its descriptor\n", errno);
+    }
+    context->hasRing = true;
+    return true;
+
+failure:
+    savedErrno = errno;
+    __MatrixInitMethodIOURingTeardown(context);
+    errno = savedErrno;
+    return false;
+}
+
+#endif /* HAVE_IO_URING */
+
+//
+
+bool
+__MatrixInitMethodIOURingAlloc(
+    const char  *inArgs,
+    const void* *outContext
+)
+{
+    MatrixInitMethodIOURingContext  *context = calloc(1, sizeof(MatrixInitMethodIOURingContext));
+    const char                      *path;
+
+    if ( ! context ) return false;
+    context->file.fd = -1;
+#ifdef HAVE_IO_URING
+    context->ringFd = -1;
+#endif /* HAVE_IO_URING */
+    context->queueDepth = MATRIXINITMETHOD_IOURING_DEFAULT_QD;
+    if ( ! __MatrixInitMethodParseOptions("iouring", inArgs, __MatrixInitMethodIOURingOptions, __MatrixInitMethodIOURingOption, context, &path) ) {
+        free((void*)context);
+        return false;
+    }
+    if ( ! context->file.chunkSize ) context->file.chunkSize = MATRIXINITMETHOD_IOURING_DEFAULT_CHUNK;
+    if ( ! __MatrixInitMethodFileOpen(&context->file, path) ) {
+        free((void*)context);
+        return false;
+    }
+#ifdef HAVE_IO_URING
+    if ( ! __MatrixInitMethodIOURingSetup(context) ) {
+        fprintf(stderr, "WARNING:  io_uring is not available (errno = %d), falling back to synchronous pread()\n", errno);
+    }
+#else
+    fprintf(stderr, "WARNING:  built without io_uring support, falling back to synchronous pread()\n");
+#endif /* HAVE_IO_URING */
+    *outContext = context;
+    return true;
+}
+
+//
+
+void
+__MatrixInitMethodIOURingDealloc(
+    const void *inContext
+)
+{
+    MatrixInitMethodIOURingContext  *CONTEXT = (MatrixInitMethodIOURingContext*)inContext;
+
+#ifdef HAVE_IO_URING
+    __MatrixInitMethodIOURingTeardown(CONTEXT);
+#endif /* HAVE_IO_URING */
+    __MatrixInitMethodFileClose(&CONTEXT->file);
+    free((void*)inContext);
+}
+
+//
+// Fill the n-by-n matrix from the file exactly as the file method would, but
+// with up to queueDepth chunk-sized reads in flight at once.  Each read lands
+// in its slot's registered buffer and is copied into place as it completes,
+// in whatever order the kernel finishes them.
+//
+
+bool
+__MatrixInitMethodIOURingInit(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    f_real              *M
+)
+{
+    MatrixInitMethodIOURingContext  *CONTEXT = (MatrixInitMethodIOURingContext*)inContext;
+
+    if ( ! CONTEXT->hasRing ) return __MatrixInitMethodFileInit(&CONTEXT->file, timer, nthreads, n, M);
+#ifdef HAVE_IO_URING
+    size_t                          remaining = (size_t)n * (size_t)n * sizeof(f_real);
+    char                            *dst = (char*)M;
+    unsigned int                    inFlight = 0, toSubmit = 0;
+    bool                            ok = true;
+
+    __MatrixInitMethodFilePrepareCache(&CONTEXT->file, timer, remaining);
+    ExecutionTimerStart(timer);
+    TraceLogAddEvent(TraceLogPhaseBegin, "io", "read", "bytes", (double)remaining);
+    while ( remaining > 0 || inFlight > 0 ) {
+        unsigned int                tail = *CONTEXT->sqTail;
+        unsigned int                head;
+        int                         rc;
+
+        // Queue reads until every slot is busy:
+        while ( ok && (remaining > 0) && (CONTEXT->nFreeSlots > 0) ) {
+            unsigned int            slot = CONTEXT->freeSlots[--CONTEXT->nFreeSlots];
+            unsigned int            index = tail & *CONTEXT->sqMask;
+            struct io_uring_sqe     *sqe = &CONTEXT->sqes[index];
+            size_t                  used, readLen;
+
+            if ( CONTEXT->file.offset >= CONTEXT->file.usableSize ) CONTEXT->file.offset = 0;
+            used = (CONTEXT->file.chunkSize < remaining) ? CONTEXT->file.chunkSize : remaining;
+            if ( (off_t)used > CONTEXT->file.usableSize - CONTEXT->file.offset ) used = CONTEXT->file.usableSize - CONTEXT->file.offset;
+            readLen = CONTEXT->file.isDirect ? ((used + CONTEXT->file.blockSize - 1) / CONTEXT->file.blockSize) * CONTEXT->file.blockSize : used;
+
+            memset(sqe, 0, sizeof(*sqe));
+            if ( CONTEXT->hasFixedBuffers ) {
+                sqe->opcode = IORING_OP_READ_FIXED;
+                sqe->addr = (uintptr_t)CONTEXT->iovecs[slot].iov_base;
+                sqe->len = readLen;
+                sqe->buf_index = slot;
+            } else {
+                CONTEXT->iovecs[slot].iov_len = readLen;
+                sqe->opcode = IORING_OP_READV;
+                sqe->addr = (uintptr_t)&CONTEXT->iovecs[slot];
+                sqe->len = 1;
+            }
+            if ( CONTEXT->hasFixedFile ) {
+                sqe->flags = IOSQE_FIXED_FILE;
+                sqe->fd = 0;
+            } else {
+                sqe->fd = CONTEXT->file.fd;
+            }
+            sqe->off = CONTEXT->file.offset;
+            sqe->user_data = slot;
+            CONTEXT->sqArray[index] = index;
+            CONTEXT->slots[slot].dst = dst;
+            CONTEXT->slots[slot].used = used;
+
+            dst += used;
+            remaining -= used;
+            CONTEXT->file.offset += readLen;
+            tail++;
+            toSubmit++;
+            inFlight++;
+        }
+        // Publish the new entries before the kernel is told about them:
+        __atomic_store_n(CONTEXT->sqTail, tail, __ATOMIC_RELEASE);
+
+        rc = __io_uring_enter(CONTEXT->ringFd, toSubmit, 1, IORING_ENTER_GETEVENTS);
+        if ( rc < 0 ) {
+            if ( (errno == EINTR) || (errno == EAGAIN) || (errno == EBUSY) ) continue;
+            fprintf(stderr, "ERROR:  io_uring_enter failed (errno = %d)\n", errno);
+            // Nothing more can be learned about the reads still in flight, so
+            // the ring cannot be reused:
+            __MatrixInitMethodIOURingTeardown(CONTEXT);
+            ok = false;
+            break;
+        }
+        toSubmit -= rc;
+
+        // Reap whatever has completed:
+        head = *CONTEXT->cqHead;
+        while ( head != __atomic_load_n(CONTEXT->cqTail, __ATOMIC_ACQUIRE) ) {
+            struct io_uring_cqe     *cqe = &CONTEXT->cqes[head & *CONTEXT->cqMask];
+            unsigned int            slot = (unsigned int)cqe->user_data;
+
+            if ( cqe->res < 0 ) {
+                if ( ok ) fprintf(stderr, "ERROR:  unable to read from matrix initialization file (errno = %d)\n", -cqe->res);
+                ok = false;
+            } else {
+                ExecutionTimerCountIO(timer, (double)cqe->res, 1);
+                if ( (size_t)cqe->res < CONTEXT->slots[slot].used ) {
+                    if ( ok ) fprintf(stderr, "ERROR:  short read from matrix initialization file (%d of %lu bytes)\n", cqe->res, (unsigned long)CONTEXT->slots[slot].used);
+                    ok = false;
+                } else {
+                    memcpy(CONTEXT->slots[slot].dst, CONTEXT->iovecs[slot].iov_base, CONTEXT->slots[slot].used);
+                }
+            }
+            CONTEXT->freeSlots[CONTEXT->nFreeSlots++] = slot;
+            inFlight--;
+            head++;
+        }
+        __atomic_store_n(CONTEXT->cqHead, head, __ATOMIC_RELEASE);
+        // After an error, drain the reads in flight but queue no more:
+        if ( ! ok ) remaining = 0;
+    }
+    TraceLogEnd("io", "read");
+    ExecutionTimerStop(timer);
+    return ok;
+#else
+    return false;
+#endif /* HAVE_IO_URING */
+}
+
+MatrixInitMethodCallbacks   __MatrixInitMethodIOURing = {
+            .helpToken = "iouring={opt{,..}:}<name>",
+            .alloc = __MatrixInitMethodIOURingAlloc,
+            .dealloc = __MatrixInitMethodIOURingDealloc,
+            .init = __MatrixInitMethodIOURingInit
+        };
+
+//
+////
+//
+
+#ifdef HAVE_OPENMP
+
+//
+// A read of one stripe of the matrix:  used bytes of the file at offset
+// belong at byte dst of the matrix.  With O_DIRECT, readLen is used rounded
+// up to whole blocks.
+//
+typedef struct {
+    off_t       offset;
+    size_t      dst;
+    size_t      used;
+    size_t      readLen;
+} MatrixInitMethodPFileStripe;
+
+typedef struct {
+    MatrixInitMethodFileContext file;       // must be first; chunkSize is the stripe size
+    unsigned int                nWorkers;   // 0 = the run's thread count
+    size_t                      nStripes, stripesCapacity;
+    MatrixInitMethodPFileStripe *stripes;
+    unsigned int                nBounces;
+    size_t                      bounceSize;
+    void*                       *bounces;   // one O_DIRECT bounce buffer per worker
+    int                         *errors;    // one errno per worker
+} MatrixInitMethodPFileContext;
+
+enum {
+    MatrixInitMethodPFileOptionStripe = MatrixInitMethodFileOptionChunk,
+    MatrixInitMethodPFileOptionThreads
+};
+
+//
+// The stripe option sits where the file method's chunk option does, so the
+// file method's handler parses it into the stripe (chunk) size:
+//
+static const MatrixInitMethodOption __MatrixInitMethodPFileOptions[] = {
+            { "sync", false },
+            { "noatime", false },
+            { "direct", false },
+            { "cache", true },
+            { "access", true },
+            { "stripe", true },
+            { "threads", true },
+            { NULL, false }
+        };
+
+//
+
+bool
+__MatrixInitMethodPFileOption(
+    void            *inContext,
+    unsigned int    optionIndex,
+    const char      *value,
+    size_t          valueLen
+)
+{
+    MatrixInitMethodPFileContext    *CONTEXT = (MatrixInitMethodPFileContext*)inContext;
+
+    if ( optionIndex == MatrixInitMethodPFileOptionThreads ) {
+        char            *end;
+        unsigned long   nWorkers = strtoul(value, &end, 10);
+
+        if ( (end != value + valueLen) || (nWorkers < 1) || (nWorkers > 1024) ) return false;
+        CONTEXT->nWorkers = (unsigned int)nWorkers;
+        return true;
+    }
+    return __MatrixInitMethodFileOption(&CONTEXT->file, optionIndex, value, valueLen);
+}
+
+//
+
+bool
+__MatrixInitMethodPFileAlloc(
+    const char  *inArgs,
+    const void* *outContext
+)
+{
+    MatrixInitMethodPFileContext    *context = calloc(1, sizeof(MatrixInitMethodPFileContext));
+    const char                      *path;
+
+    if ( ! context ) return false;
+    context->file.fd = -1;
+    if ( ! __MatrixInitMethodParseOptions("pfile", inArgs, __MatrixInitMethodPFileOptions, __MatrixInitMethodPFileOption, context, &path) ) {
+        free((void*)context);
+        return false;
+    }
+    if ( ! __MatrixInitMethodFileOpen(&context->file, path) ) {
+        free((void*)context);
+        return false;
+    }
+    // Each worker gets its own bounce buffer once the stripe size is known:
+    if ( context->file.bounce ) {
+        free(context->file.bounce);
+        context->file.bounce = NULL;
+        context->file.bounceSize = 0;
+    }
+    *outContext = context;
+    return true;
+}
+
+//
+
+void
+__MatrixInitMethodPFileDealloc(
+    const void *inContext
+)
+{
+    MatrixInitMethodPFileContext    *CONTEXT = (MatrixInitMethodPFileContext*)inContext;
+    unsigned int                    i;
+
+    for ( i = 0; i < CONTEXT->nBounces; i++ ) free(CONTEXT->bounces[i]);
+    if ( CONTEXT->bounces ) free((void*)CONTEXT->bounces);
+    if ( CONTEXT->errors ) free((void*)CONTEXT->errors);
+    if ( CONTEXT->stripes ) free((void*)CONTEXT->stripes);
+    __MatrixInitMethodFileClose(&CONTEXT->file);
+    free((void*)inContext);
+}
+
+//
+// Lay out the stripes of the next matrix exactly as the file method would
+// read chunks of the stripe size, advancing (and wrapping) the file offset.
+// Returns boolean false if memory could not be allocated.
+//
+
+bool
+__MatrixInitMethodPFilePlan(
+    MatrixInitMethodPFileContext    *context,
+    size_t                          remaining,
+    size_t                          stripeSize
+)
+{
+    MatrixInitMethodFileContext     *file = &context->file;
+    size_t                          dst = 0;
+
+    context->nStripes = 0;
+    while ( remaining > 0 ) {
+        MatrixInitMethodPFileStripe *stripe;
+
+        if ( context->nStripes == context->stripesCapacity ) {
+            size_t                  newCapacity = context->stripesCapacity ? 2 * context->stripesCapacity : 64;
+            MatrixInitMethodPFileStripe *newStripes = realloc(context->stripes, newCapacity * sizeof(MatrixInitMethodPFileStripe));
+
+            if ( ! newStripes ) return false;
+            context->stripes = newStripes;
+            context->stripesCapacity = newCapacity;
+        }
+        stripe = &context->stripes[context->nStripes++];
+        if ( file->offset >= file->usableSize ) file->offset = 0;
+        stripe->offset = file->offset;
+        stripe->dst = dst;
+        stripe->used = (stripeSize < remaining) ? stripeSize : remaining;
+        if ( (off_t)stripe->used > file->usableSize - file->offset ) stripe->used = file->usableSize - file->offset;
+        stripe->readLen = file->isDirect ? ((stripe->used + file->blockSize - 1) / file->blockSize) * file->blockSize : stripe->used;
+        dst += stripe->used;
+        remaining -= stripe->used;
+        file->offset += stripe->readLen;
+    }
+    return true;
+}
+
+//
+// Make sure there are nWorkers error slots and, for O_DIRECT, nWorkers bounce
+// buffers of at least bounceSize bytes.
+//
+
+bool
+__MatrixInitMethodPFilePrepareWorkers(
+    MatrixInitMethodPFileContext    *context,
+    unsigned int                    nWorkers,
+    size_t                          bounceSize
+)
+{
+    unsigned int                    i;
+
+    if ( nWorkers > context->nBounces || (context->file.isDirect && (bounceSize > context->bounceSize)) ) {
+        int                         *newErrors = realloc(context->errors, nWorkers * sizeof(int));
+        void*                       *newBounces;
+
+        if ( ! newErrors ) return false;
+        context->errors = newErrors;
+        for ( i = 0; i < context->nBounces; i++ ) free(context->bounces[i]);
+        context->nBounces = 0;
+        if ( ! (newBounces = realloc(context->bounces, nWorkers * sizeof(void*))) ) return false;
+        context->bounces = newBounces;
+        if ( bounceSize < context->bounceSize ) bounceSize = context->bounceSize;
+        for ( i = 0; i < nWorkers; i++ ) {
+            context->bounces[i] = NULL;
+            if ( context->file.isDirect && (posix_memalign(&context->bounces[i], context->file.blockSize, bounceSize) != 0) ) {
+                fprintf(stderr, "ERROR:  unable to allocate %lu-byte direct i/o buffer\n", (unsigned long)bounceSize);
+                context->nBounces = i;
+                return false;
+            }
+        }
+        context->nBounces = nWorkers;
+        context->bounceSize = context->file.isDirect ? bounceSize : 0;
+    }
+    return true;
+}
+
+//
+// Read one stripe into place.  Returns zero or an errno value.
+//
+
+int
+__MatrixInitMethodPFileReadStripe(
+    MatrixInitMethodPFileContext    *context,
+    const MatrixInitMethodPFileStripe *stripe,
+    char                            *M,
+    void                            *bounce,
+    ExecutionTimerRef               timer,
+    int                             workerId
+)
+{
+    char                            *dst = M + stripe->dst;
+    char                            *buffer = dst;
+    size_t                          done = 0;
+
+    if ( context->file.isDirect && ((stripe->readLen != stripe->used) || ((uintptr_t)dst % context->file.blockSize)) ) buffer = (char*)bounce;
+    while ( done < stripe->used ) {
+        ssize_t                     actual = pread(context->file.fd, buffer + done, stripe->readLen - done, stripe->offset + done);
+
+        if ( actual < 0 ) {
+            if ( errno == EINTR ) continue;
+            return errno;
+        }
+        // The file shrank since it was opened:
+        if ( actual == 0 ) return ENODATA;
+        ExecutionTimerThreadCountIO(timer, workerId, (double)actual, 1);
+        done += actual;
+    }
+    if ( buffer != dst ) memcpy(dst, buffer, stripe->used);
+    return 0;
+}
+
+//
+// Fill the n-by-n matrix from the file exactly as the file method would with
+// chunk:<stripe>, but with the stripes dealt round-robin to a team of workers
+// that each pread() their own stripes straight into place.  By default the
+// team is the run's thread count and each worker gets a single stripe.
+//
+
+bool
+__MatrixInitMethodPFileInit(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    f_real              *M
+)
+{
+    MatrixInitMethodPFileContext    *CONTEXT = (MatrixInitMethodPFileContext*)inContext;
+    size_t                          total = (size_t)n * (size_t)n * sizeof(f_real);
+    unsigned int                    nWorkers = CONTEXT->nWorkers ? CONTEXT->nWorkers : ((nthreads > 0) ? nthreads : 1);
+    size_t                          stripeSize = CONTEXT->file.chunkSize, bounceSize;
+    unsigned int                    i;
+    bool                            ok = true;
+
+    if ( total == 0 ) return true;
+    if ( ! stripeSize ) {
+        // Whole blocks keep every O_DIRECT stripe but the last aligned in M:
+        stripeSize = (total + nWorkers - 1) / nWorkers;
+        if ( CONTEXT->file.isDirect ) stripeSize = ((stripeSize + CONTEXT->file.blockSize - 1) / CONTEXT->file.blockSize) * CONTEXT->file.blockSize;
+    }
+    bounceSize = ((stripeSize + CONTEXT->file.blockSize - 1) / CONTEXT->file.blockSize) * CONTEXT->file.blockSize;
+    __MatrixInitMethodFilePrepareCache(&CONTEXT->file, timer, total);
+    if ( ! __MatrixInitMethodPFilePlan(CONTEXT, total, stripeSize) || ! __MatrixInitMethodPFilePrepareWorkers(CONTEXT, nWorkers, bounceSize) ) {
+        fprintf(stderr, "ERROR:  unable to plan parallel reads of the matrix initialization file\n");
+        return false;
+    }
+    if ( nWorkers > CONTEXT->nStripes ) nWorkers = CONTEXT->nStripes;
+    for ( i = 0; i < nWorkers; i++ ) CONTEXT->errors[i] = 0;
+    ExecutionTimerPrepareThreadSlots(timer, nWorkers);
+
+    ExecutionTimerStart(timer);
+    TraceLogAddEvent(TraceLogPhaseBegin, "io", "read", "bytes", (double)total);
+#   pragma omp parallel num_threads(nWorkers)
+    {
+        int                         workerId = omp_get_thread_num();
+        size_t                      s;
+
+        ExecutionTimerThreadStart(timer, workerId);
+        for ( s = workerId; s < CONTEXT->nStripes; s += omp_get_num_threads() ) {
+            int                     rc = __MatrixInitMethodPFileReadStripe(CONTEXT, &CONTEXT->stripes[s], (char*)M, CONTEXT->bounces[workerId], timer, workerId);
+
+            if ( rc ) {
+                CONTEXT->errors[workerId] = rc;
+                break;
+            }
+        }
+        ExecutionTimerThreadStop(timer, workerId);
+    }
+    TraceLogEnd("io", "read");
+    ExecutionTimerStop(timer);
+
+    for ( i = 0; i < nWorkers; i++ ) {
+        if ( CONTEXT->errors[i] ) {
+            fprintf(stderr, "ERROR:  worker %u unable to read from matrix initialization file (errno = %d)\n", i, CONTEXT->errors[i]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+MatrixInitMethodCallbacks   __MatrixInitMethodPFile = {
+            .helpToken = "pfile={opt{,..}:}<name>",
+            .alloc = __MatrixInitMethodPFileAlloc,
+            .dealloc = __MatrixInitMethodPFileDealloc,
+            .init = __MatrixInitMethodPFileInit
+        };
+
+#endif /* HAVE_OPENMP */
+
+//
+////
+//
+
+typedef struct {
+    void        *base;          // as returned by mmap(), or NULL
+    size_t      length;
+} MatrixInitMethodMMapMapping;
+
+typedef struct {
+    MatrixInitMethodFileContext file;       // must be first; offset advances by whole pages
+    bool                        shouldPopulate;
+    bool                        shouldUseHugePages;
+    bool                        shouldWillNeed;
+    size_t                      pageSize;
+    MatrixInitMethodMMapMapping mappings[MatrixInitMatrixMax];
+} MatrixInitMethodMMapContext;
+
+enum {
+    MatrixInitMethodMMapOptionPopulate = 0,
+    MatrixInitMethodMMapOptionLazy,
+    MatrixInitMethodMMapOptionHugePage,
+    MatrixInitMethodMMapOptionWillNeed,
+    MatrixInitMethodMMapOptionNoatime
+};
+
+static const MatrixInitMethodOption __MatrixInitMethodMMapOptions[] = {
+            { "populate", false },
+            { "lazy", false },
+            { "hugepage", false },
+            { "willneed", false },
+            { "noatime", false },
+            { NULL, false }
+        };
+
+//
+
+bool
+__MatrixInitMethodMMapOption(
+    void            *inContext,
+    unsigned int    optionIndex,
+    const char      *value,
+    size_t          valueLen
+)
+{
+    MatrixInitMethodMMapContext *CONTEXT = (MatrixInitMethodMMapContext*)inContext;
+
+    switch ( optionIndex ) {
+        case MatrixInitMethodMMapOptionPopulate:
+            CONTEXT->shouldPopulate = true;
+            return true;
+        case MatrixInitMethodMMapOptionLazy:
+            CONTEXT->shouldPopulate = false;
+            return true;
+        case MatrixInitMethodMMapOptionHugePage:
+#ifdef MADV_HUGEPAGE
+            CONTEXT->shouldUseHugePages = true;
+            return true;
+#else
+            return false;
+#endif /* MADV_HUGEPAGE */
+        case MatrixInitMethodMMapOptionWillNeed:
+            CONTEXT->shouldWillNeed = true;
+            return true;
+        case MatrixInitMethodMMapOptionNoatime:
+            CONTEXT->file.oflags |= O_NOATIME;
+            return true;
+    }
+    return false;
+}
+
+//
+
+bool
+__MatrixInitMethodMMapAlloc(
+    const char  *inArgs,
+    const void* *outContext
+)
+{
+    MatrixInitMethodMMapContext *context = calloc(1, sizeof(MatrixInitMethodMMapContext));
+    const char                  *path;
+    long                        pageSize = sysconf(_SC_PAGESIZE);
+
+    if ( ! context ) return false;
+    context->file.fd = -1;
+    context->pageSize = (pageSize > 0) ? pageSize : 4096;
+    if ( ! __MatrixInitMethodParseOptions("mmap", inArgs, __MatrixInitMethodMMapOptions, __MatrixInitMethodMMapOption, context, &path) ) {
+        free((void*)context);
+        return false;
+    }
+    if ( ! __MatrixInitMethodFileOpen(&context->file, path) ) {
+        free((void*)context);
+        return false;
+    }
+    *outContext = context;
+    return true;
+}
+
+//
+
+void
+__MatrixInitMethodMMapDealloc(
+    const void *inContext
+)
+{
+    MatrixInitMethodMMapContext *CONTEXT = (MatrixInitMethodMMapContext*)inContext;
+    unsigned int                i;
+
+    for ( i = 0; i < MatrixInitMatrixMax; i++ ) {
+        if ( CONTEXT->mappings[i].base ) munmap(CONTEXT->mappings[i].base, CONTEXT->mappings[i].length);
+    }
+    __MatrixInitMethodFileClose(&CONTEXT->file);
+    free((void*)inContext);
+}
+
+//
+// A mapping cannot wrap around the end of the file, so each matrix starts at
+// the next page following the previous one, or at the start of the file if
+// it would not fit before the end.  Returns boolean false if the file is too
+// small to hold a matrix of the given size.
+//
+
+bool
+__MatrixInitMethodMMapNextOffset(
+    MatrixInitMethodMMapContext *context,
+    size_t                      size,
+    off_t                       *outOffset
+)
+{
+    if ( (off_t)size > context->file.usableSize ) {
+        fprintf(stderr, "ERROR:  matrix init file is smaller than a %lu-byte matrix and cannot be mapped\n", (unsigned long)size);
+        return false;
+    }
+    if ( context->file.offset + (off_t)size > context->file.usableSize ) context->file.offset = 0;
+    *outOffset = context->file.offset;
+    context->file.offset += ((size + context->pageSize - 1) / context->pageSize) * context->pageSize;
+    return true;
+}
+
+//
+// Fill the caller's matrix with the same bytes a mapping would have shown
+// it, using pread().
+//
+
+bool
+__MatrixInitMethodMMapInit(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    f_real              *M
+)
+{
+    MatrixInitMethodMMapContext *CONTEXT = (MatrixInitMethodMMapContext*)inContext;
+    size_t                      size = (size_t)n * (size_t)n * sizeof(f_real), done = 0;
+    off_t                       offset;
+    bool                        ok = true;
+
+    if ( ! __MatrixInitMethodMMapNextOffset(CONTEXT, size, &offset) ) return false;
+    ExecutionTimerStart(timer);
+    TraceLogAddEvent(TraceLogPhaseBegin, "io", "read", "bytes", (double)size);
+    while ( done < size ) {
+        ssize_t                 actual = pread(CONTEXT->file.fd, (char*)M + done, size - done, offset + done);
+
+        if ( actual < 0 ) {
+            if ( errno == EINTR ) continue;
+            fprintf(stderr, "ERROR:  unable to read from matrix initialization file (errno = %d)\n", errno);
+            ok = false;
+            break;
+        }
+        if ( actual == 0 ) {
+            fprintf(stderr, "ERROR:  matrix initialization file is shorter than expected\n");
+            ok = false;
+            break;
+        }
+        ExecutionTimerCountIO(timer, (double)actual, 1);
+        done += actual;
+    }
+    TraceLogEnd("io", "read");
+    ExecutionTimerStop(timer);
+    return ok;
+}
+
+//
+// Map the next matrix-sized span of the file in place of the caller's
+// matrix.  A and B are read-only shared mappings of the page cache; C is a
+// private (copy-on-write) mapping, so the multiplication's writes never
+// reach the file.  Unless populated, pages are faulted in as the
+// multiplication first touches them.
+//
+
+f_real*
+__MatrixInitMethodMMapMap(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    MatrixInitMatrix    which
+)
+{
+    MatrixInitMethodMMapContext *CONTEXT = (MatrixInitMethodMMapContext*)inContext;
+    MatrixInitMethodMMapMapping *mapping = &CONTEXT->mappings[which];
+    size_t                      size = (size_t)n * (size_t)n * sizeof(f_real);
+    int                         prot = PROT_READ, flags = MAP_SHARED;
+    off_t                       offset;
+    void                        *base;
+
+    if ( which >= MatrixInitMatrixMax ) return NULL;
+    // The previous mapping is disposed of outside the timed interval:
+    if ( mapping->base ) {
+        munmap(mapping->base, mapping->length);
+        mapping->base = NULL;
+    }
+    if ( ! __MatrixInitMethodMMapNextOffset(CONTEXT, size, &offset) ) return NULL;
+    if ( which == MatrixInitMatrixC ) {
+        prot |= PROT_WRITE;
+        flags = MAP_PRIVATE;
+    }
+    if ( CONTEXT->shouldPopulate ) flags |= MAP_POPULATE;
+
+    ExecutionTimerStart(timer);
+    TraceLogAddEvent(TraceLogPhaseBegin, "io", "mmap", "bytes", (double)size);
+    base = mmap(NULL, size, prot, flags, CONTEXT->file.fd, offset);
+    if ( base != MAP_FAILED ) {
+#ifdef MADV_HUGEPAGE
+        if ( CONTEXT->shouldUseHugePages && (madvise(base, size, MADV_HUGEPAGE) != 0) ) {
+            fprintf(stderr, "WARNING:  transparent huge pages are not available for this mapping (errno = %d)\n", errno);
+            CONTEXT->shouldUseHugePages = false;
+        }
+#endif /* MADV_HUGEPAGE */
+        if ( CONTEXT->shouldWillNeed ) madvise(base, size, MADV_WILLNEED);
+    }
+    TraceLogEnd("io", "mmap");
+    ExecutionTimerStop(timer);
+
+    if ( base == MAP_FAILED ) {
+        fprintf(stderr, "ERROR:  unable to map %lu bytes of matrix init file at offset %lld (errno = %d)\n", (unsigned long)size, (long long)offset, errno);
+        return NULL;
+    }
+    mapping->base = base;
+    mapping->length = size;
+    return (f_real*)base;
+}
+
+MatrixInitMethodCallbacks   __MatrixInitMethodMMap = {
+            .helpToken = "mmap={opt{,..}:}<name>",
+            .alloc = __MatrixInitMethodMMapAlloc,
+            .dealloc = __MatrixInitMethodMMapDealloc,
+            .init = __MatrixInitMethodMMapInit,
+            .map = __MatrixInitMethodMMapMap
+        };
+
+//
+////
+//
+
+void
+__MatrixInitMethodInitialize(void)
+{
+    if ( __MatrixInitMethodIsInitializing ) return;
+
+    __MatrixInitMethodIsInitializing = true;
+
+    __MatrixInitMethodRegister("file", &__MatrixInitMethodFile, false);
+    __MatrixInitMethodRegister("iouring", &__MatrixInitMethodIOURing, false);
+    __MatrixInitMethodRegister("mmap", &__MatrixInitMethodMMap, false);
+#ifdef HAVE_OPENMP
+    __MatrixInitMethodRegister("pfile", &__MatrixInitMethodPFile, false);
+#endif /* HAVE_OPENMP */
     __MatrixInitMethodRegister("random", &__MatrixInitMethodRandom, false);
 #ifdef HAVE_OPENMP
     __MatrixInitMethodRegister("simple-omp", &__MatrixInitMethodSimpleOMP, false);
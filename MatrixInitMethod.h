@@ -44,6 +44,32 @@ typedef void (*MatrixInitMethodDealloc)(const void *inContext);
  * The function should return boolean true when successful, false otherwise.
  */
 typedef bool (*MatrixInitMethodInit)(const void *inContext, ExecutionTimerRef timer, int nthreads, f_integer n, f_real *M);
+/*!
+ * @typedef MatrixInitMatrix
+ *
+ * Identifies which of the matrices of C = alpha * A * B + beta * C is being
+ * provided by a MatrixInitMethodMap function.  A and B are only read by the
+ * multiplication; C is also written.
+ */
+typedef unsigned int MatrixInitMatrix;
+enum {
+    MatrixInitMatrixA = 0,
+    MatrixInitMatrixB,
+    MatrixInitMatrixC,
+    MatrixInitMatrixMax
+};
+/*!
+ * @typedef MatrixInitMethodMap
+ *
+ * Type of a function that, rather than filling a caller's matrix, provides
+ * the storage of the n-by-n matrix itself (e.g. a mapping of a file) so that
+ * no copy is made.  The storage returned for a given matrix remains valid
+ * until the next call for the same matrix or until the method's state is
+ * deallocated.  Timing is as for MatrixInitMethodInit().
+ *
+ * The function should return NULL if unsuccessful.
+ */
+typedef f_real* (*MatrixInitMethodMap)(const void *inContext, ExecutionTimerRef timer, int nthreads, f_integer n, MatrixInitMatrix which);
 /*!
  * @typedef MatrixInitMethodCallbacks
  *
@@ -61,12 +87,16 @@ typedef bool (*MatrixInitMethodInit)(const void *inContext, ExecutionTimerRef ti
  *          required by the method.  Set to NULL if nothing needs to
  *          be done.
  * @field init The function used to initialize an n-by-n matrix
+ * @field map The optional function used to provide an n-by-n matrix
+ *          without copying; set to NULL if the method always fills
+ *          the caller's matrix.
  */
 typedef struct {
     const char                  *helpToken;
     MatrixInitMethodAlloc       alloc;
     MatrixInitMethodDealloc     dealloc;
     MatrixInitMethodInit        init;
+    MatrixInitMethodMap         map;
 } MatrixInitMethodCallbacks;
 
 /*!
@@ -162,4 +192,16 @@ const char* MatrixInitObjectGetName(MatrixInitObjectRef initObj);
  */
 bool MatrixInitObjectInit(MatrixInitObjectRef initObj, ExecutionTimerRef timer, int nthreads, f_integer n, f_real *M);
 
+/*!
+ * @function MatrixInitObjectProvide
+ *
+ * Provide the n-by-n dimensional matrix which using the initObj method.  A
+ * method that can map its data (e.g. "mmap") returns its own storage; any
+ * other initializes M and returns it.  Timing data will be collected into
+ * timer.
+ *
+ * Returns NULL if unsuccessful.
+ */
+f_real* MatrixInitObjectProvide(MatrixInitObjectRef initObj, ExecutionTimerRef timer, int nthreads, f_integer n, MatrixInitMatrix which, f_real *M);
+
 #endif /* __MATRIXINITMETHOD_H__ */
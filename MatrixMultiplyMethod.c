@@ -5,19 +5,56 @@
  */
 
 #include "MatrixMultiplyMethod.h"
+#include "MachineInfo.h"
+#include "TuningCache.h"
 
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include <errno.h>
 
+#ifdef HAVE_OPENMP
+#   include <omp.h>
+#endif
+
 //
 // The Fortran subroutines:
 //
 void mat_mult_basic_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
 void mat_mult_smart_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
 void mat_mult_optimized_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
-void mat_mult_openmp_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
-void mat_mult_openmp_optimized_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
+void mat_mult_openmp_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
+void mat_mult_openmp_optimized_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
 void mat_mult_blas_(f_integer*, f_real*, f_real*, f_real*, f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
 
+//
+// Thread-count setters of the common BLAS implementations; whichever one
+// is linked into the program will be non-NULL:
+//
+void openblas_set_num_threads(int) __attribute__((weak));
+void mkl_set_num_threads(int) __attribute__((weak));
+void bli_thread_set_num_threads(long) __attribute__((weak));
+
+static inline void
+__MatrixMultiplyMethodSetBLASThreads(
+    int     nthreads
+)
+{
+    if ( nthreads <= 0 ) return;
+    if ( openblas_set_num_threads ) openblas_set_num_threads(nthreads);
+    if ( mkl_set_num_threads ) mkl_set_num_threads(nthreads);
+    if ( bli_thread_set_num_threads ) bli_thread_set_num_threads(nthreads);
+}
+
+//
+// Fortran code identifies timers by an integer id:
+//
+#ifdef EXECUTIONTIMER_FORTRAN_INTERFACE
+#   define MATRIXMULTIPLYMETHOD_TIMER_ID(T)   ExecutionTimerFortranGetId(T)
+#else
+#   define MATRIXMULTIPLYMETHOD_TIMER_ID(T)   ((f_integer)-1)
+#endif
+
 //
 
 static bool __MatrixMultiplyMethodIsInitialized = false;
@@ -227,6 +264,18 @@ MatrixMultiplyMethodTokenList(void)
     return (const char*)expectedLength;
 }
 
+//
+
+const MatrixMultiplyMethodTuningParameter*
+MatrixMultiplyMethodGetTuningParameters(
+    const char              *name
+)
+{
+    MatrixMultiplyMethod_t  *mp = __MatrixMultiplyMethodLookup(name, strlen(name));
+
+    return mp ? mp->callbacks.tuningParameters : NULL;
+}
+
 //
 ////
 //
@@ -309,6 +358,91 @@ MatrixMultiplyObjectGetName(
 
 //
 
+bool
+MatrixMultiplyObjectIsThreaded(
+    MatrixMultiplyObjectRef matMulObj
+)
+{
+    return matMulObj->matMulMethod->callbacks.isThreaded;
+}
+
+//
+
+bool
+__MatrixMultiplyMethodCompulsoryWorkModel(
+    const void          *inContext,
+    f_integer           m,
+    f_integer           n,
+    f_integer           k,
+    f_real              alpha,
+    f_real              beta,
+    double              *outFlops,
+    double              *outBytes
+)
+{
+    double              mn = (double)m * (double)n;
+
+    //
+    // One multiply and one add per inner-product term; scaling by alpha and
+    // accumulation into beta * C are extra per-element work:
+    //
+    *outFlops = 2.0 * mn * (double)k;
+    if ( alpha != F_ONE ) *outFlops += mn;
+    if ( beta != F_ZERO ) *outFlops += 2.0 * mn;
+
+    //
+    // A and B read once, C written once (and read once if beta is non-zero):
+    //
+    *outBytes = sizeof(f_real) * ((double)m * (double)k + (double)k * (double)n + ((beta != F_ZERO) ? 2.0 : 1.0) * mn);
+    return true;
+}
+
+//
+
+bool
+__MatrixMultiplyMethodNaiveWorkModel(
+    const void          *inContext,
+    f_integer           m,
+    f_integer           n,
+    f_integer           k,
+    f_real              alpha,
+    f_real              beta,
+    double              *outFlops,
+    double              *outBytes
+)
+{
+    double              mn = (double)m * (double)n;
+
+    __MatrixMultiplyMethodCompulsoryWorkModel(inContext, m, n, k, alpha, beta, outFlops, outBytes);
+
+    //
+    // Unblocked triple loops have no explicit reuse:  every inner-product
+    // term loads one element of A and one of B:
+    //
+    *outBytes = sizeof(f_real) * (2.0 * mn * (double)k + ((beta != F_ZERO) ? 2.0 : 1.0) * mn);
+    return true;
+}
+
+//
+
+bool
+MatrixMultiplyObjectGetWorkModel(
+    MatrixMultiplyObjectRef matMulObj,
+    f_integer               n,
+    f_real                  alpha,
+    f_real                  beta,
+    double                  *outFlops,
+    double                  *outBytes
+)
+{
+    if ( matMulObj->matMulMethod->callbacks.workModel ) {
+        return matMulObj->matMulMethod->callbacks.workModel(matMulObj->context, n, n, n, alpha, beta, outFlops, outBytes);
+    }
+    return __MatrixMultiplyMethodCompulsoryWorkModel(matMulObj->context, n, n, n, alpha, beta, outFlops, outBytes);
+}
+
+//
+
 bool
 MatrixMultiplyObjectMultiply(
     MatrixMultiplyObjectRef matMulObj,
@@ -323,6 +457,13 @@ MatrixMultiplyObjectMultiply(
 )
 {
     if ( matMulObj->matMulMethod->callbacks.multiply ) {
+        double      flops, bytes;
+
+        if ( MatrixMultiplyObjectGetWorkModel(matMulObj, n, alpha, beta, &flops, &bytes) ) {
+            ExecutionTimerSetWorkModel(timer, flops, bytes);
+        } else {
+            ExecutionTimerClearWorkModel(timer);
+        }
         return matMulObj->matMulMethod->callbacks.multiply(matMulObj->context, timer, nthreads, n, alpha, A, B, beta, C);
     }
     return false;
@@ -364,7 +505,8 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodBasic = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodBasicMultiply
+            .multiply = __MatrixMultiplyMethodBasicMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel
         };
 
 //
@@ -394,7 +536,8 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodBasicFortran = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodBasicFortranMultiply
+            .multiply = __MatrixMultiplyMethodBasicFortranMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel
         };
 
 //
@@ -424,7 +567,8 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodOptFortran = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodOptFortranMultiply
+            .multiply = __MatrixMultiplyMethodOptFortranMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel
         };
 
 //
@@ -454,7 +598,8 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodSmartFortran = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodSmartFortranMultiply
+            .multiply = __MatrixMultiplyMethodSmartFortranMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel
         };
 
 //
@@ -474,11 +619,14 @@ __MatrixMultiplyMethodBasicFortranOMPMultiply(
     f_real              *C
 )
 {
+    f_integer           timerId = MATRIXMULTIPLYMETHOD_TIMER_ID(timer);
+
 #ifdef HAVE_OPENMP
     omp_set_num_threads(nthreads);
 #endif /* HAVE_OPENMP */
+    ExecutionTimerPrepareThreadSlots(timer, nthreads);
     ExecutionTimerStart(timer);
-    mat_mult_openmp_(&n, &alpha, A, B, &beta, C, n, n, n, n, n, n);
+    mat_mult_openmp_(&n, &alpha, A, B, &beta, C, &timerId, n, n, n, n, n, n);
     ExecutionTimerStop(timer);
 #ifdef HAVE_OPENMP
     omp_set_num_threads(1);
@@ -490,7 +638,9 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodBasicFortranOMP = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodBasicFortranOMPMultiply
+            .multiply = __MatrixMultiplyMethodBasicFortranOMPMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel,
+            .isThreaded = true
         };
 
 //
@@ -510,11 +660,14 @@ __MatrixMultiplyMethodOptFortranOMPMultiply(
     f_real              *C
 )
 {
+    f_integer           timerId = MATRIXMULTIPLYMETHOD_TIMER_ID(timer);
+
 #ifdef HAVE_OPENMP
     omp_set_num_threads(nthreads);
 #endif /* HAVE_OPENMP */
+    ExecutionTimerPrepareThreadSlots(timer, nthreads);
     ExecutionTimerStart(timer);
-    mat_mult_openmp_optimized_(&n, &alpha, A, B, &beta, C, n, n, n, n, n, n);
+    mat_mult_openmp_optimized_(&n, &alpha, A, B, &beta, C, &timerId, n, n, n, n, n, n);
     ExecutionTimerStop(timer);
 #ifdef HAVE_OPENMP
     omp_set_num_threads(1);
@@ -526,7 +679,9 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodOptFortranOMP = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodOptFortranOMPMultiply
+            .multiply = __MatrixMultiplyMethodOptFortranOMPMultiply,
+            .workModel = __MatrixMultiplyMethodNaiveWorkModel,
+            .isThreaded = true
         };
 
 //
@@ -549,9 +704,13 @@ __MatrixMultiplyMethodBLASFortranMultiply(
 #ifdef HAVE_OPENMP
     omp_set_num_threads(nthreads);
 #endif /* HAVE_OPENMP */
+    __MatrixMultiplyMethodSetBLASThreads(nthreads);
+    // The BLAS thread pool cannot be instrumented, so sample its threads:
+    ExecutionTimerSetShouldSampleThreads(timer, true);
     ExecutionTimerStart(timer);
     mat_mult_blas_(&n, &alpha, A, B, &beta, C, n, n, n, n, n, n);
     ExecutionTimerStop(timer);
+    ExecutionTimerSetShouldSampleThreads(timer, false);
 #ifdef HAVE_OPENMP
     omp_set_num_threads(1);
 #endif /* HAVE_OPENMP */
@@ -562,7 +721,9 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodBLASFortran = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodBLASFortranMultiply
+            .multiply = __MatrixMultiplyMethodBLASFortranMultiply,
+            .workModel = __MatrixMultiplyMethodCompulsoryWorkModel,
+            .isThreaded = true
         };
 
 //
@@ -586,6 +747,9 @@ __MatrixMultiplyMethodBLASMultiply(
 #ifdef HAVE_OPENMP
     omp_set_num_threads(nthreads);
 #endif /* HAVE_OPENMP */
+    __MatrixMultiplyMethodSetBLASThreads(nthreads);
+    // The BLAS thread pool cannot be instrumented, so sample its threads:
+    ExecutionTimerSetShouldSampleThreads(timer, true);
     ExecutionTimerStart(timer);
 #ifdef HAVE_FORTRAN_REAL8
     dgemm_("N", "N", &n, &n, &n, &alpha, A, &n, B, &n, &beta, C, &n, 1, 1, n, n, n, n, n, n);
@@ -593,11 +757,12 @@ __MatrixMultiplyMethodBLASMultiply(
     sgemm_("N", "N", &n, &n, &n, &alpha, A, &n, B, &n, &beta, C, &n, 1, 1, n, n, n, n, n, n);
 #endif /* HAVE_FORTRAN_REAL8 */
     ExecutionTimerStop(timer);
+    ExecutionTimerSetShouldSampleThreads(timer, false);
 #ifdef HAVE_OPENMP
     omp_set_num_threads(1);
 #endif /* HAVE_OPENMP */
 #else /* HAVE_BLAS */
-    printf("<<BLAS variant not implemented>>");
+    fprintf(stderr, "<<BLAS variant not implemented>>\n");
 #endif /* HAVE_BLAS */
     return true;
 }
@@ -606,7 +771,359 @@ MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodBLAS = {
             .helpToken = NULL,
             .alloc = NULL,
             .dealloc = NULL,
-            .multiply = __MatrixMultiplyMethodBLASMultiply
+            .multiply = __MatrixMultiplyMethodBLASMultiply,
+            .workModel = __MatrixMultiplyMethodCompulsoryWorkModel,
+            .isThreaded = true
+        };
+
+//
+////
+//
+
+//
+// Cache-blocked multiplication in C (column-major, like the Fortran
+// routines).  The tile sizes along each of the i, j, and k dimensions and
+// the loop order within a tile are parameters:
+//
+//     tiled=<tile-i>:<tile-j>:<tile-k>:<order>
+//
+// Column blocks of C are distributed across threads.
+//
+typedef struct {
+    f_integer       tileI, tileJ, tileK;
+    int             order;
+} MatrixMultiplyMethodTiledContext;
+
+#define MATRIXMULTIPLYMETHOD_TILED_KERNEL(ORDER, L1, L2, L3) \
+    static void \
+    __MatrixMultiplyMethodTiledKernel_##ORDER( \
+        f_integer n, f_real alpha, const f_real * restrict A, const f_real * restrict B, f_real * restrict C, \
+        f_integer i0, f_integer i1, f_integer j0, f_integer j1, f_integer k0, f_integer k1 \
+    ) \
+    { \
+        f_integer   i, j, k; \
+        for ( L1 ) for ( L2 ) for ( L3 ) C[i + j * n] += alpha * A[i + k * n] * B[k + j * n]; \
+    }
+
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(ijk, i = i0; i < i1; i++, j = j0; j < j1; j++, k = k0; k < k1; k++)
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(ikj, i = i0; i < i1; i++, k = k0; k < k1; k++, j = j0; j < j1; j++)
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(jik, j = j0; j < j1; j++, i = i0; i < i1; i++, k = k0; k < k1; k++)
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(jki, j = j0; j < j1; j++, k = k0; k < k1; k++, i = i0; i < i1; i++)
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(kij, k = k0; k < k1; k++, i = i0; i < i1; i++, j = j0; j < j1; j++)
+MATRIXMULTIPLYMETHOD_TILED_KERNEL(kji, k = k0; k < k1; k++, j = j0; j < j1; j++, i = i0; i < i1; i++)
+
+typedef void (*MatrixMultiplyMethodTiledKernel)(f_integer, f_real, const f_real*, const f_real*, f_real*, f_integer, f_integer, f_integer, f_integer, f_integer, f_integer);
+
+static const struct {
+    const char                          *name;
+    MatrixMultiplyMethodTiledKernel     kernel;
+} __MatrixMultiplyMethodTiledOrders[] = {
+                { "jki", __MatrixMultiplyMethodTiledKernel_jki },
+                { "kji", __MatrixMultiplyMethodTiledKernel_kji },
+                { "ijk", __MatrixMultiplyMethodTiledKernel_ijk },
+                { "ikj", __MatrixMultiplyMethodTiledKernel_ikj },
+                { "jik", __MatrixMultiplyMethodTiledKernel_jik },
+                { "kij", __MatrixMultiplyMethodTiledKernel_kij },
+                { NULL, NULL }
+            };
+
+static const MatrixMultiplyMethodTuningParameter __MatrixMultiplyMethodTiledParameters[] = {
+                { "tile-i", "16,32,64,128,256", true },
+                { "tile-j", "16,32,64,128,256", true },
+                { "tile-k", "32,64,128,256,512", true },
+                { "order", "jki,kji,ijk,ikj,jik,kij", false },
+                { NULL, NULL, false }
+            };
+
+bool
+__MatrixMultiplyMethodTiledAlloc(
+    const char          *inArgs,
+    const void*         *outContext
+)
+{
+    MatrixMultiplyMethodTiledContext    *context = malloc(sizeof(MatrixMultiplyMethodTiledContext));
+    f_integer                           *tiles[3];
+    const char                          *args = inArgs;
+    int                                 i;
+    char                                *end;
+
+    if ( ! context ) return false;
+    context->tileI = 64;
+    context->tileJ = 64;
+    context->tileK = 256;
+    context->order = 0;
+    tiles[0] = &context->tileI;
+    tiles[1] = &context->tileJ;
+    tiles[2] = &context->tileK;
+
+    // Positional tile sizes, each optional:
+    for ( i = 0; i < 3 && *args; i++ ) {
+        if ( *args != ':' ) {
+            long        v = strtol(args, &end, 0);
+
+            if ( (end == args) || (v <= 0) || (*end && *end != ':') ) goto bad_args;
+            *tiles[i] = v;
+            args = end;
+        }
+        if ( *args == ':' ) args++;
+    }
+    if ( *args ) {
+        while ( __MatrixMultiplyMethodTiledOrders[context->order].name ) {
+            if ( strcasecmp(args, __MatrixMultiplyMethodTiledOrders[context->order].name) == 0 ) break;
+            context->order++;
+        }
+        if ( ! __MatrixMultiplyMethodTiledOrders[context->order].name ) goto bad_args;
+    }
+    *outContext = context;
+    return true;
+
+bad_args:
+    fprintf(stderr, "ERROR:  invalid tiled method arguments: %s\n", inArgs);
+    free((void*)context);
+    return false;
+}
+
+void
+__MatrixMultiplyMethodTiledDealloc(
+    const void          *inContext
+)
+{
+    free((void*)inContext);
+}
+
+bool
+__MatrixMultiplyMethodTiledMultiply(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    f_real              alpha,
+    f_real              *A,
+    f_real              *B,
+    f_real              beta,
+    f_real              *C
+)
+{
+    const MatrixMultiplyMethodTiledContext  *CONTEXT = (const MatrixMultiplyMethodTiledContext*)inContext;
+    MatrixMultiplyMethodTiledKernel         kernel = __MatrixMultiplyMethodTiledOrders[CONTEXT->order].kernel;
+    f_integer                               tileI = CONTEXT->tileI, tileJ = CONTEXT->tileJ, tileK = CONTEXT->tileK;
+    f_integer                               nBlocksJ = (n + tileJ - 1) / tileJ;
+
+    if ( nthreads < 1 ) nthreads = 1;
+    ExecutionTimerPrepareThreadSlots(timer, nthreads);
+    ExecutionTimerStart(timer);
+
+    // Scale C by beta (the same static schedule of column blocks is used
+    // below, so each thread revisits blocks it just touched):
+    ExecutionTimerPushRegion(timer, "scale");
+    if ( beta != F_ONE ) {
+        f_integer       jb;
+
+        #pragma omp parallel for num_threads(nthreads) schedule(static) shared(C)
+        for ( jb = 0; jb < nBlocksJ; jb++ ) {
+            f_integer   j0 = jb * tileJ, j1 = (j0 + tileJ < n) ? (j0 + tileJ) : n, i;
+
+            if ( beta == F_ZERO ) {
+                memset(&C[j0 * n], 0, (j1 - j0) * n * sizeof(f_real));
+            } else {
+                for ( i = j0 * n; i < j1 * n; i++ ) C[i] *= beta;
+            }
+        }
+    }
+    ExecutionTimerPopRegion(timer);
+
+    ExecutionTimerPushRegion(timer, "compute");
+    #pragma omp parallel num_threads(nthreads) shared(A,B,C)
+    {
+        f_integer       jb, i0, j0, k0;
+        int             tid = 0;
+
+#ifdef HAVE_OPENMP
+        tid = omp_get_thread_num();
+#endif /* HAVE_OPENMP */
+        ExecutionTimerThreadStart(timer, tid);
+        #pragma omp for schedule(static) nowait
+        for ( jb = 0; jb < nBlocksJ; jb++ ) {
+            f_integer   j1;
+
+            j0 = jb * tileJ;
+            j1 = (j0 + tileJ < n) ? (j0 + tileJ) : n;
+            for ( k0 = 0; k0 < n; k0 += tileK ) {
+                f_integer   k1 = (k0 + tileK < n) ? (k0 + tileK) : n;
+
+                for ( i0 = 0; i0 < n; i0 += tileI ) {
+                    f_integer   i1 = (i0 + tileI < n) ? (i0 + tileI) : n;
+
+                    kernel(n, alpha, A, B, C, i0, i1, j0, j1, k0, k1);
+                }
+            }
+        }
+        ExecutionTimerThreadStop(timer, tid);
+    }
+    ExecutionTimerPopRegion(timer);
+    ExecutionTimerStop(timer);
+    return true;
+}
+
+MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodTiled = {
+            .helpToken = "tiled{=<tile-i>:<tile-j>:<tile-k>:<order>}",
+            .alloc = __MatrixMultiplyMethodTiledAlloc,
+            .dealloc = __MatrixMultiplyMethodTiledDealloc,
+            .multiply = __MatrixMultiplyMethodTiledMultiply,
+            .workModel = NULL,
+            .isThreaded = true,
+            .tuningParameters = __MatrixMultiplyMethodTiledParameters
+        };
+
+//
+////
+//
+
+//
+// The "auto" method consults the tuning cache (for the current hardware)
+// and dispatches each multiplication to the fastest configuration recorded
+// for the nearest matrix dimension.  With an empty cache the BLAS routine
+// (or opt-fortran, sans BLAS) is used.  The tuned thread count is used
+// unless it exceeds the requested one.
+//
+#ifdef HAVE_BLAS
+#   define MATRIXMULTIPLYMETHOD_AUTO_FALLBACK  "blas"
+#else
+#   define MATRIXMULTIPLYMETHOD_AUTO_FALLBACK  "opt-fortran"
+#endif
+
+typedef struct {
+    TuningCacheRef          cache;
+    f_integer               n;
+    int                     threads;
+    char                    *targetSpec;
+    MatrixMultiplyObjectRef target;
+} MatrixMultiplyMethodAutoContext;
+
+bool
+__MatrixMultiplyMethodAutoAlloc(
+    const char          *inArgs,
+    const void*         *outContext
+)
+{
+    MatrixMultiplyMethodAutoContext *context = malloc(sizeof(MatrixMultiplyMethodAutoContext));
+    MachineInfoRef                  machine = MachineInfoCreate();
+
+    if ( context && machine ) {
+        context->n = 0;
+        context->threads = 0;
+        context->targetSpec = NULL;
+        context->target = NULL;
+        context->cache = TuningCacheCreate((inArgs && *inArgs) ? inArgs : NULL, MachineInfoGetFingerprint(machine));
+        MachineInfoRelease(machine);
+        if ( context->cache ) {
+            if ( TuningCacheGetCount(context->cache) == 0 ) {
+                fprintf(stderr, "WARNING:  no tuning results for this machine in %s; auto will use %s (run with --tune first)\n",
+                        TuningCacheGetPath(context->cache), MATRIXMULTIPLYMETHOD_AUTO_FALLBACK);
+            }
+            *outContext = context;
+            return true;
+        }
+    }
+    if ( machine ) MachineInfoRelease(machine);
+    if ( context ) free((void*)context);
+    return false;
+}
+
+void
+__MatrixMultiplyMethodAutoDealloc(
+    const void          *inContext
+)
+{
+    MatrixMultiplyMethodAutoContext *CONTEXT = (MatrixMultiplyMethodAutoContext*)inContext;
+
+    if ( CONTEXT->target ) MatrixMultiplyObjectRelease(CONTEXT->target);
+    if ( CONTEXT->targetSpec ) free((void*)CONTEXT->targetSpec);
+    TuningCacheRelease(CONTEXT->cache);
+    free((void*)inContext);
+}
+
+MatrixMultiplyObjectRef
+__MatrixMultiplyMethodAutoResolve(
+    MatrixMultiplyMethodAutoContext *context,
+    f_integer                       n
+)
+{
+    if ( ! context->target || (context->n != n) ) {
+        const char                  *spec = MATRIXMULTIPLYMETHOD_AUTO_FALLBACK;
+        int                         threads = 0;
+        MatrixMultiplyObjectRef     target;
+
+        if ( TuningCacheLookup(context->cache, n, &spec, &threads, NULL) && (strncasecmp(spec, "auto", 4) == 0) ) {
+            spec = MATRIXMULTIPLYMETHOD_AUTO_FALLBACK;
+            threads = 0;
+        }
+        if ( ! context->target || strcmp(spec, context->targetSpec) ) {
+            char                    *targetSpec = strdup(spec);
+
+            if ( ! targetSpec || ! (target = MatrixMultiplyObjectCreate(spec)) ) {
+                fprintf(stderr, "ERROR:  unable to create tuned multiplication method %s\n", spec);
+                if ( targetSpec ) free((void*)targetSpec);
+                return NULL;
+            }
+            if ( context->target ) MatrixMultiplyObjectRelease(context->target);
+            if ( context->targetSpec ) free((void*)context->targetSpec);
+            context->target = target;
+            context->targetSpec = targetSpec;
+        }
+        context->threads = threads;
+        context->n = n;
+    }
+    return context->target;
+}
+
+bool
+__MatrixMultiplyMethodAutoMultiply(
+    const void          *inContext,
+    ExecutionTimerRef   timer,
+    int                 nthreads,
+    f_integer           n,
+    f_real              alpha,
+    f_real              *A,
+    f_real              *B,
+    f_real              beta,
+    f_real              *C
+)
+{
+    MatrixMultiplyMethodAutoContext *CONTEXT = (MatrixMultiplyMethodAutoContext*)inContext;
+    MatrixMultiplyObjectRef         target = __MatrixMultiplyMethodAutoResolve(CONTEXT, n);
+
+    if ( ! target ) return false;
+    if ( (CONTEXT->threads > 0) && (CONTEXT->threads < nthreads) ) nthreads = CONTEXT->threads;
+    return MatrixMultiplyObjectMultiply(target, timer, nthreads, n, alpha, A, B, beta, C);
+}
+
+bool
+__MatrixMultiplyMethodAutoWorkModel(
+    const void          *inContext,
+    f_integer           m,
+    f_integer           n,
+    f_integer           k,
+    f_real              alpha,
+    f_real              beta,
+    double              *outFlops,
+    double              *outBytes
+)
+{
+    MatrixMultiplyMethodAutoContext *CONTEXT = (MatrixMultiplyMethodAutoContext*)inContext;
+    MatrixMultiplyObjectRef         target = __MatrixMultiplyMethodAutoResolve(CONTEXT, n);
+
+    if ( ! target ) return false;
+    return MatrixMultiplyObjectGetWorkModel(target, n, alpha, beta, outFlops, outBytes);
+}
+
+MatrixMultiplyMethodCallbacks   __MatrixMultiplyMethodAuto = {
+            .helpToken = "auto{=<tuning-cache>}",
+            .alloc = __MatrixMultiplyMethodAutoAlloc,
+            .dealloc = __MatrixMultiplyMethodAutoDealloc,
+            .multiply = __MatrixMultiplyMethodAutoMultiply,
+            .workModel = __MatrixMultiplyMethodAutoWorkModel,
+            .isThreaded = true
         };
 
 //
@@ -620,6 +1137,8 @@ __MatrixMultiplyMethodInitialize(void)
 
     __MatrixMultiplyMethodIsInitializing = true;
 
+    __MatrixMultiplyMethodRegister("auto", &__MatrixMultiplyMethodAuto, false);
+    __MatrixMultiplyMethodRegister("tiled", &__MatrixMultiplyMethodTiled, false);
     __MatrixMultiplyMethodRegister("blas-fortran", &__MatrixMultiplyMethodBLASFortran, false);
     __MatrixMultiplyMethodRegister("blas", &__MatrixMultiplyMethodBLAS, false);
     __MatrixMultiplyMethodRegister("opt-fortran-omp", &__MatrixMultiplyMethodOptFortranOMP, false);
@@ -46,6 +46,40 @@ typedef void (*MatrixMultiplyMethodDealloc)(const void *inContext);
  * The function should return boolean true when successful, false otherwise.
  */
 typedef bool (*MatrixMultiplyMethodMultiply)(const void *inContext, ExecutionTimerRef timer, int nthreads, f_integer n, f_real alpha, f_real *A, f_real *B, f_real beta, f_real *C);
+/*!
+ * @typedef MatrixMultiplyMethodWorkModel
+ *
+ * Type of a function that describes the work performed by a MatrixMultiplyMethod
+ * when computing the product of an m-by-k matrix A and a k-by-n matrix B into the
+ * m-by-n matrix C with the given alpha and beta coefficients.  The number of
+ * floating-point operations should be returned in outFlops and the number of bytes
+ * moved between memory and the processor in outBytes.
+ *
+ * The inContext is state storage allocated by the associated
+ * MatrixMultiplyMethodAlloc() function.
+ *
+ * The function should return boolean true when successful, false otherwise.
+ */
+typedef bool (*MatrixMultiplyMethodWorkModel)(const void *inContext, f_integer m, f_integer n, f_integer k, f_real alpha, f_real beta, double *outFlops, double *outBytes);
+/*!
+ * @typedef MatrixMultiplyMethodTuningParameter
+ *
+ * Describes one dimension of the search space of a parameterized method.
+ * A method's tuning parameters are passed to it positionally, separated
+ * by colons, in the order they are declared:  e.g. a method "m" with
+ * parameters "x" and "y" is instantiated as "m=<x>:<y>".
+ *
+ * @field name The name of the parameter (for display).
+ * @field values A comma-separated list of the candidate values.
+ * @field isTileSize Boolean true if the values are tile sizes that can be
+ *          clamped to the matrix dimension (candidates that coincide after
+ *          clamping are only tried once).
+ */
+typedef struct {
+    const char                      *name;
+    const char                      *values;
+    bool                            isTileSize;
+} MatrixMultiplyMethodTuningParameter;
 /*!
  * @typedef MatrixMultiplyMethodCallbacks
  *
@@ -61,12 +95,24 @@ typedef bool (*MatrixMultiplyMethodMultiply)(const void *inContext, ExecutionTim
  *          required by the method.  Set to NULL if nothing needs to
  *          be done.
  * @field init The function used to multiply two n-by-n matrices
+ * @field workModel The function used to determine the floating-point operation
+ *          count and memory traffic of a multiplication.  Set to NULL to use
+ *          the compulsory-traffic model (each element of A, B, and C moved
+ *          exactly once, 2mnk flops).
+ * @field isThreaded Boolean true if the method honors its nthreads argument
+ *          (i.e. its run time depends on the thread count).
+ * @field tuningParameters An optional array of the method's tuning parameters,
+ *          terminated by an entry with a NULL name.  Set to NULL if the method
+ *          is not parameterized.
  */
 typedef struct {
     const char                      *helpToken;
     MatrixMultiplyMethodAlloc       alloc;
     MatrixMultiplyMethodDealloc     dealloc;
     MatrixMultiplyMethodMultiply    multiply;
+    MatrixMultiplyMethodWorkModel   workModel;
+    bool                            isThreaded;
+    const MatrixMultiplyMethodTuningParameter   *tuningParameters;
 } MatrixMultiplyMethodCallbacks;
 
 /*!
@@ -113,6 +159,15 @@ size_t MatrixMultiplyMethodCopyTokenList(char *buffer, size_t bufferLen);
  */
 const char* MatrixMultiplyMethodTokenList(void);
 
+/*!
+ * @function MatrixMultiplyMethodGetTuningParameters
+ *
+ * Returns the array of tuning parameters (terminated by an entry with a NULL
+ * name) of the MatrixMultiplyMethod with the given name, or NULL if the
+ * method is not registered or is not parameterized.
+ */
+const MatrixMultiplyMethodTuningParameter* MatrixMultiplyMethodGetTuningParameters(const char *name);
+
 /*!
  * @typedef MatrixMultiplyObjectRef
  *
@@ -150,6 +205,25 @@ void MatrixMultiplyObjectRelease(MatrixMultiplyObjectRef matMulObj);
  */
 const char* MatrixMultiplyObjectGetName(MatrixMultiplyObjectRef matMulObj);
 
+/*!
+ * @function MatrixMultiplyObjectIsThreaded
+ *
+ * Returns boolean true if the MatrixMultiplyMethod associated with
+ * matMulObj makes use of multiple threads.
+ */
+bool MatrixMultiplyObjectIsThreaded(MatrixMultiplyObjectRef matMulObj);
+
+/*!
+ * @function MatrixMultiplyObjectGetWorkModel
+ *
+ * Determine the floating-point operation count (outFlops) and memory traffic in
+ * bytes (outBytes) of a multiplication of two n-by-n matrices by the matMulObj
+ * method with the given alpha and beta coefficients.
+ *
+ * Returns boolean true if successful.
+ */
+bool MatrixMultiplyObjectGetWorkModel(MatrixMultiplyObjectRef matMulObj, f_integer n, f_real alpha, f_real beta, double *outFlops, double *outBytes);
+
 /*!
  * @function MatrixMultiplyObjectMultiply
  *
@@ -158,7 +232,8 @@ const char* MatrixMultiplyObjectGetName(MatrixMultiplyObjectRef matMulObj);
  *
  *     alpha * A . B + beta * C => C
  *
- * Timing data will be collected into timer.
+ * Timing data will be collected into timer.  The method's work model is
+ * attached to timer so that throughput metrics are also collected.
  *
  * Threaded methods should limit themselves to nthreads.
  *
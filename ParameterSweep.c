@@ -0,0 +1,276 @@
+/*
+ * ParameterSweep.c
+ *
+ * Pseudo-class that holds an ordered list of integer values for a named
+ * parameter, as parsed from a sweep specification.
+ */
+
+#include "ParameterSweep.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+//
+// Upper bound on the number of values a single sweep may expand to:
+//
+#ifndef PARAMETERSWEEP_MAX_VALUES
+#define PARAMETERSWEEP_MAX_VALUES   65536
+#endif
+
+//
+
+typedef struct ParameterSweep {
+    unsigned int    refCount;
+    unsigned int    nValues;
+    unsigned int    capacity;
+    long            *values;
+    char            name[];
+} ParameterSweep;
+
+//
+
+bool
+__ParameterSweepAppend(
+    ParameterSweep  *aSweep,
+    long            value
+)
+{
+    if ( aSweep->nValues == aSweep->capacity ) {
+        unsigned int    newCapacity = aSweep->capacity ? (2 * aSweep->capacity) : 16;
+        long            *newValues;
+
+        if ( newCapacity > PARAMETERSWEEP_MAX_VALUES ) {
+            fprintf(stderr, "ERROR:  parameter sweep %s exceeds %d values\n", aSweep->name, PARAMETERSWEEP_MAX_VALUES);
+            return false;
+        }
+        if ( ! (newValues = (long*)realloc(aSweep->values, newCapacity * sizeof(long))) ) {
+            fprintf(stderr, "ERROR:  unable to allocate parameter sweep values\n");
+            return false;
+        }
+        aSweep->values = newValues;
+        aSweep->capacity = newCapacity;
+    }
+    aSweep->values[aSweep->nValues++] = value;
+    return true;
+}
+
+//
+
+int
+__ParameterSweepCompare(
+    const void      *a,
+    const void      *b
+)
+{
+    long            A = *((const long*)a), B = *((const long*)b);
+
+    return (A < B) ? -1 : ((A > B) ? 1 : 0);
+}
+
+//
+
+bool
+__ParameterSweepParseItem(
+    ParameterSweep  *aSweep,
+    const char      *item,
+    const char      *itemEnd
+)
+{
+    char            buffer[itemEnd - item + 1], *p, *end;
+    long            start, stop;
+
+    memcpy(buffer, item, itemEnd - item);
+    buffer[itemEnd - item] = '\0';
+
+    start = strtol(buffer, &end, 0);
+    if ( end == buffer ) goto bad_item;
+    if ( *end == '\0' ) return __ParameterSweepAppend(aSweep, start);
+    if ( *end != ':' ) goto bad_item;
+
+    p = end + 1;
+    stop = strtol(p, &end, 0);
+    if ( (end == p) || (*end != ':') || (stop < start) ) goto bad_item;
+
+    p = end + 1;
+    if ( strncasecmp(p, "linear:", 7) == 0 ) {
+        long        step;
+
+        p += 7;
+        step = strtol(p, &end, 0);
+        if ( (end == p) || (*end != '\0') || (step <= 0) ) goto bad_item;
+        while ( start <= stop ) {
+            if ( ! __ParameterSweepAppend(aSweep, start) ) return false;
+            start += step;
+        }
+        return true;
+    }
+    if ( strncasecmp(p, "geometric:", 10) == 0 ) {
+        double      ratio, v = (double)start;
+        long        last = start - 1;
+
+        p += 10;
+        ratio = strtod(p, &end);
+        if ( (end == p) || (*end != '\0') || (ratio <= 1.0) || (start <= 0) ) goto bad_item;
+        while ( v <= (double)stop + 0.5 ) {
+            long    rounded = lround(v);
+
+            if ( rounded > stop ) break;
+            if ( rounded != last ) {
+                if ( ! __ParameterSweepAppend(aSweep, rounded) ) return false;
+                last = rounded;
+            }
+            v *= ratio;
+        }
+        return true;
+    }
+
+bad_item:
+    fprintf(stderr, "ERROR:  invalid sweep item for %s: %s\n", aSweep->name, buffer);
+    return false;
+}
+
+//
+
+ParameterSweepRef
+ParameterSweepCreate(
+    const char      *name,
+    const char      *valuesSpec
+)
+{
+    size_t          nameLen = strlen(name);
+    ParameterSweep  *newSweep = (ParameterSweep*)malloc(sizeof(ParameterSweep) + nameLen + 1);
+
+    if ( newSweep ) {
+        unsigned int    i, j;
+
+        newSweep->refCount = 1;
+        newSweep->nValues = newSweep->capacity = 0;
+        newSweep->values = NULL;
+        strcpy(newSweep->name, name);
+
+        while ( *valuesSpec ) {
+            const char  *itemEnd = strchr(valuesSpec, ',');
+
+            if ( ! itemEnd ) itemEnd = valuesSpec + strlen(valuesSpec);
+            if ( (itemEnd > valuesSpec) && ! __ParameterSweepParseItem(newSweep, valuesSpec, itemEnd) ) {
+                ParameterSweepRelease(newSweep);
+                return NULL;
+            }
+            valuesSpec = (*itemEnd == ',') ? (itemEnd + 1) : itemEnd;
+        }
+        if ( newSweep->nValues == 0 ) {
+            fprintf(stderr, "ERROR:  no values provided for sweep of %s\n", name);
+            ParameterSweepRelease(newSweep);
+            return NULL;
+        }
+
+        // Sort and drop duplicates:
+        qsort(newSweep->values, newSweep->nValues, sizeof(long), __ParameterSweepCompare);
+        for ( i = 1, j = 0; i < newSweep->nValues; i++ ) {
+            if ( newSweep->values[i] != newSweep->values[j] ) newSweep->values[++j] = newSweep->values[i];
+        }
+        newSweep->nValues = j + 1;
+    }
+    return (ParameterSweepRef)newSweep;
+}
+
+//
+
+ParameterSweepRef
+ParameterSweepCreateWithString(
+    const char      *specification
+)
+{
+    const char      *equals = strchr(specification, '=');
+
+    if ( ! equals || (equals == specification) ) {
+        fprintf(stderr, "ERROR:  invalid sweep specification (expected <name>=<values>): %s\n", specification);
+        return NULL;
+    } else {
+        char        name[equals - specification + 1];
+
+        memcpy(name, specification, equals - specification);
+        name[equals - specification] = '\0';
+        return ParameterSweepCreate(name, equals + 1);
+    }
+}
+
+//
+
+ParameterSweepRef
+ParameterSweepRetain(
+    ParameterSweepRef   aSweep
+)
+{
+    aSweep->refCount++;
+    return aSweep;
+}
+
+//
+
+void
+ParameterSweepRelease(
+    ParameterSweepRef   aSweep
+)
+{
+    if ( --(aSweep->refCount) == 0 ) {
+        if ( aSweep->values ) free((void*)aSweep->values);
+        free((void*)aSweep);
+    }
+}
+
+//
+
+const char*
+ParameterSweepGetName(
+    ParameterSweepRef   aSweep
+)
+{
+    return (const char*)aSweep->name;
+}
+
+//
+
+unsigned int
+ParameterSweepGetCount(
+    ParameterSweepRef   aSweep
+)
+{
+    return aSweep->nValues;
+}
+
+//
+
+long
+ParameterSweepGetValue(
+    ParameterSweepRef   aSweep,
+    unsigned int        index
+)
+{
+    return (index < aSweep->nValues) ? aSweep->values[index] : 0;
+}
+
+//
+
+long
+ParameterSweepGetMaxValue(
+    ParameterSweepRef   aSweep
+)
+{
+    return aSweep->values[aSweep->nValues - 1];
+}
+
+//
+
+void
+ParameterSweepPrint(
+    ParameterSweepRef   aSweep,
+    FILE                *stream
+)
+{
+    unsigned int        i;
+
+    for ( i = 0; i < aSweep->nValues; i++ ) fprintf(stream, "%s%ld", (i ? "," : ""), aSweep->values[i]);
+}
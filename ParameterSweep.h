@@ -0,0 +1,100 @@
+/*
+ * ParameterSweep.h
+ *
+ * Pseudo-class that holds an ordered list of integer values for a named
+ * parameter, as parsed from a sweep specification.
+ */
+
+#ifndef __PARAMETERSWEEP_H__
+#define __PARAMETERSWEEP_H__
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*!
+ * @typedef ParameterSweepRef
+ *
+ * Type of a reference to a ParameterSweep object.
+ */
+typedef struct ParameterSweep * ParameterSweepRef;
+
+/*!
+ * @function ParameterSweepCreate
+ *
+ * Create a sweep of the parameter with the given name.  The valuesSpec is
+ * a comma-separated list of items, each of which is one of
+ *
+ *     <integer>
+ *     <start>:<end>:linear:<step>
+ *     <start>:<end>:geometric:<ratio>
+ *
+ * A linear range includes start, start + step, ... up to and including
+ * end; a geometric range includes start, start * ratio, ... (rounded to
+ * the nearest integer, with duplicates dropped) up to and including end.
+ * The resulting values are sorted in ascending order with duplicates
+ * removed.
+ *
+ * Returns NULL (after displaying an error message on stderr) if the
+ * specification could not be parsed.
+ */
+ParameterSweepRef ParameterSweepCreate(const char *name, const char *valuesSpec);
+
+/*!
+ * @function ParameterSweepCreateWithString
+ *
+ * Create a sweep from a specification of the form "<name>=<values-spec>"
+ * (see ParameterSweepCreate() for the format of <values-spec>).
+ */
+ParameterSweepRef ParameterSweepCreateWithString(const char *specification);
+
+/*!
+ * @function ParameterSweepRetain
+ *
+ * Increase the reference count of aSweep.
+ */
+ParameterSweepRef ParameterSweepRetain(ParameterSweepRef aSweep);
+
+/*!
+ * @function ParameterSweepRelease
+ *
+ * Decrease the reference count of aSweep, deallocating it once it reaches
+ * zero.
+ */
+void ParameterSweepRelease(ParameterSweepRef aSweep);
+
+/*!
+ * @function ParameterSweepGetName
+ *
+ * Returns the name of the parameter being swept.
+ */
+const char* ParameterSweepGetName(ParameterSweepRef aSweep);
+
+/*!
+ * @function ParameterSweepGetCount
+ *
+ * Returns the number of values in aSweep.
+ */
+unsigned int ParameterSweepGetCount(ParameterSweepRef aSweep);
+
+/*!
+ * @function ParameterSweepGetValue
+ *
+ * Returns the value at the given index (zero-based) of aSweep.
+ */
+long ParameterSweepGetValue(ParameterSweepRef aSweep, unsigned int index);
+
+/*!
+ * @function ParameterSweepGetMaxValue
+ *
+ * Returns the largest value in aSweep.
+ */
+long ParameterSweepGetMaxValue(ParameterSweepRef aSweep);
+
+/*!
+ * @function ParameterSweepPrint
+ *
+ * Write the list of values in aSweep (comma-separated) to stream.
+ */
+void ParameterSweepPrint(ParameterSweepRef aSweep, FILE *stream);
+
+#endif /* __PARAMETERSWEEP_H__ */
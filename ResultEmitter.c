@@ -0,0 +1,433 @@
+/*
+ * ResultEmitter.c
+ *
+ * Pseudo-class that gathers everything a run writes into a sequence of
+ * sections:  written as they come in the table, CSV, and TSV formats, or
+ * as a single JSON or YAML document.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "ResultEmitter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+//
+
+typedef struct ResultEmitterAttribute {
+    char                        *key;
+    char                        *value;     // already formatted as a JSON/YAML scalar
+} ResultEmitterAttribute;
+
+typedef struct ResultEmitter {
+    unsigned int                refCount;
+    ExecutionTimerOutputFormat  format;
+    bool                        isStructured;
+    bool                        isFinished;
+    bool                        isWritten;
+    FILE                        *stream;
+    unsigned int                nSections;
+    //
+    // The current section:
+    //
+    bool                        isInSection;
+    char                        *kind;
+    char                        *caption;
+    FILE                        *body;
+    char                        *bodyBuffer;
+    size_t                      bodyLen;
+    unsigned int                nAttributes;
+    unsigned int                attributesCapacity;
+    ResultEmitterAttribute      *attributes;
+} ResultEmitter;
+
+//
+
+char*
+__ResultEmitterQuoteString(
+    const char      *s
+)
+{
+    size_t          len = 2;
+    const char      *p;
+    char            *quoted, *q;
+
+    // Worst case, every character becomes a \u00XX escape:
+    for ( p = s; p && *p; p++ ) len += 6;
+    if ( (q = quoted = (char*)malloc(len + 1)) ) {
+        *q++ = '"';
+        for ( p = s; p && *p; p++ ) {
+            unsigned char   c = (unsigned char)*p;
+
+            if ( (c == '"') || (c == '\\') ) {
+                *q++ = '\\';
+                *q++ = c;
+            } else if ( c < 0x20 ) {
+                q += sprintf(q, "\\u%04x", c);
+            } else {
+                *q++ = c;
+            }
+        }
+        *q++ = '"';
+        *q = '\0';
+    }
+    return quoted;
+}
+
+//
+
+void
+__ResultEmitterAddAttribute(
+    ResultEmitter   *anEmitter,
+    const char      *key,
+    char            *value
+)
+{
+    if ( ! anEmitter->isInSection || ! anEmitter->isStructured || ! value ) {
+        if ( value ) free((void*)value);
+        return;
+    }
+    if ( anEmitter->nAttributes == anEmitter->attributesCapacity ) {
+        unsigned int            newCapacity = anEmitter->attributesCapacity + 8;
+        ResultEmitterAttribute  *newAttributes = (ResultEmitterAttribute*)realloc(anEmitter->attributes, newCapacity * sizeof(ResultEmitterAttribute));
+
+        if ( ! newAttributes ) {
+            free((void*)value);
+            anEmitter->isWritten = false;
+            return;
+        }
+        anEmitter->attributes = newAttributes;
+        anEmitter->attributesCapacity = newCapacity;
+    }
+    if ( ! (anEmitter->attributes[anEmitter->nAttributes].key = strdup(key)) ) {
+        free((void*)value);
+        anEmitter->isWritten = false;
+        return;
+    }
+    anEmitter->attributes[anEmitter->nAttributes++].value = value;
+}
+
+//
+
+void
+__ResultEmitterClearSection(
+    ResultEmitter   *anEmitter
+)
+{
+    unsigned int    i;
+
+    if ( anEmitter->body && (anEmitter->body != anEmitter->stream) ) fclose(anEmitter->body);
+    anEmitter->body = NULL;
+    if ( anEmitter->bodyBuffer ) free((void*)anEmitter->bodyBuffer);
+    anEmitter->bodyBuffer = NULL;
+    anEmitter->bodyLen = 0;
+    if ( anEmitter->kind ) free((void*)anEmitter->kind);
+    anEmitter->kind = NULL;
+    if ( anEmitter->caption ) free((void*)anEmitter->caption);
+    anEmitter->caption = NULL;
+    for ( i = 0; i < anEmitter->nAttributes; i++ ) {
+        free((void*)anEmitter->attributes[i].key);
+        free((void*)anEmitter->attributes[i].value);
+    }
+    anEmitter->nAttributes = 0;
+    anEmitter->isInSection = false;
+}
+
+//
+
+void
+__ResultEmitterWriteJSONSection(
+    ResultEmitter   *anEmitter,
+    const char      *body,
+    size_t          bodyLen
+)
+{
+    FILE            *stream = anEmitter->stream;
+    char            *s;
+    unsigned int    i;
+
+    fputs(anEmitter->nSections ? ",\n{\"section\":" : "\n{\"section\":", stream);
+    if ( (s = __ResultEmitterQuoteString(anEmitter->kind)) ) {
+        fputs(s, stream);
+        free((void*)s);
+    }
+    if ( anEmitter->caption && (s = __ResultEmitterQuoteString(anEmitter->caption)) ) {
+        fprintf(stream, ",\"caption\":%s", s);
+        free((void*)s);
+    }
+    for ( i = 0; i < anEmitter->nAttributes; i++ ) {
+        if ( (s = __ResultEmitterQuoteString(anEmitter->attributes[i].key)) ) {
+            fprintf(stream, ",%s:%s", s, anEmitter->attributes[i].value);
+            free((void*)s);
+        }
+    }
+    if ( bodyLen > 0 ) {
+        fputs(",\"data\":", stream);
+        fwrite(body, 1, bodyLen, stream);
+    }
+    fputc('}', stream);
+}
+
+//
+
+void
+__ResultEmitterWriteYAMLSection(
+    ResultEmitter   *anEmitter,
+    const char      *body,
+    size_t          bodyLen
+)
+{
+    FILE            *stream = anEmitter->stream;
+    const char      *end = body + bodyLen;
+    char            *s;
+    unsigned int    i;
+
+    if ( (s = __ResultEmitterQuoteString(anEmitter->kind)) ) {
+        fprintf(stream, "  - section: %s\n", s);
+        free((void*)s);
+    }
+    if ( anEmitter->caption && (s = __ResultEmitterQuoteString(anEmitter->caption)) ) {
+        fprintf(stream, "    caption: %s\n", s);
+        free((void*)s);
+    }
+    for ( i = 0; i < anEmitter->nAttributes; i++ ) {
+        fprintf(stream, "    %s: %s\n", anEmitter->attributes[i].key, anEmitter->attributes[i].value);
+    }
+    if ( bodyLen > 0 ) {
+        //
+        // The body is a YAML document of its own; nest it by indenting
+        // every (non-blank) line:
+        //
+        fputs("    data:\n", stream);
+        while ( body < end ) {
+            const char  *eol = memchr(body, '\n', end - body);
+            size_t      lineLen = (eol ? eol : end) - body;
+
+            if ( lineLen > 0 ) {
+                fputs("      ", stream);
+                fwrite(body, 1, lineLen, stream);
+                fputc('\n', stream);
+            }
+            body += lineLen + 1;
+        }
+    }
+}
+
+//
+
+ResultEmitterRef
+ResultEmitterCreate(
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultEmitter               *newEmitter = (ResultEmitter*)calloc(1, sizeof(ResultEmitter));
+
+    if ( newEmitter ) {
+        newEmitter->refCount = 1;
+        newEmitter->format = format;
+        newEmitter->isStructured = (format == ExecutionTimerOutputFormatJSON) || (format == ExecutionTimerOutputFormatYAML);
+        newEmitter->isWritten = true;
+        newEmitter->stream = stream;
+        switch ( format ) {
+            case ExecutionTimerOutputFormatJSON:
+                fprintf(stream, "{\"format\":\"%s\",\"sections\":[", RESULTEMITTER_DOCUMENT_FORMAT);
+                fflush(stream);
+                break;
+            case ExecutionTimerOutputFormatYAML:
+                fprintf(stream, "format: \"%s\"\nsections:\n", RESULTEMITTER_DOCUMENT_FORMAT);
+                fflush(stream);
+                break;
+            default:
+                break;
+        }
+    }
+    return (ResultEmitterRef)newEmitter;
+}
+
+//
+
+ResultEmitterRef
+ResultEmitterRetain(
+    ResultEmitterRef    anEmitter
+)
+{
+    anEmitter->refCount++;
+    return anEmitter;
+}
+
+//
+
+void
+ResultEmitterRelease(
+    ResultEmitterRef    anEmitter
+)
+{
+    if ( --(anEmitter->refCount) == 0 ) {
+        if ( ! anEmitter->isFinished ) ResultEmitterFinish(anEmitter);
+        __ResultEmitterClearSection(anEmitter);
+        if ( anEmitter->attributes ) free((void*)anEmitter->attributes);
+        free((void*)anEmitter);
+    }
+}
+
+//
+
+ExecutionTimerOutputFormat
+ResultEmitterGetFormat(
+    ResultEmitterRef    anEmitter
+)
+{
+    return anEmitter->format;
+}
+
+//
+
+bool
+ResultEmitterIsStructured(
+    ResultEmitterRef    anEmitter
+)
+{
+    return anEmitter->isStructured;
+}
+
+//
+
+FILE*
+ResultEmitterBeginSection(
+    ResultEmitterRef    anEmitter,
+    const char          *kind,
+    const char          *caption
+)
+{
+    if ( anEmitter->isFinished ) return NULL;
+    if ( anEmitter->isInSection ) ResultEmitterEndSection(anEmitter);
+
+    if ( ! anEmitter->isStructured ) {
+        if ( caption ) fprintf(anEmitter->stream, "%s:\n\n", caption);
+        anEmitter->body = anEmitter->stream;
+    } else {
+        if ( ! (anEmitter->kind = strdup(kind ? kind : "")) ) return NULL;
+        if ( caption && ! (anEmitter->caption = strdup(caption)) ) {
+            __ResultEmitterClearSection(anEmitter);
+            return NULL;
+        }
+        if ( ! (anEmitter->body = open_memstream(&anEmitter->bodyBuffer, &anEmitter->bodyLen)) ) {
+            __ResultEmitterClearSection(anEmitter);
+            return NULL;
+        }
+    }
+    anEmitter->isInSection = true;
+    return anEmitter->body;
+}
+
+//
+
+void
+ResultEmitterSetString(
+    ResultEmitterRef    anEmitter,
+    const char          *key,
+    const char          *value
+)
+{
+    if ( anEmitter->isStructured ) __ResultEmitterAddAttribute(anEmitter, key, __ResultEmitterQuoteString(value));
+}
+
+//
+
+void
+ResultEmitterSetInteger(
+    ResultEmitterRef    anEmitter,
+    const char          *key,
+    long                value
+)
+{
+    char                s[32];
+
+    if ( ! anEmitter->isStructured ) return;
+    snprintf(s, sizeof(s), "%ld", value);
+    __ResultEmitterAddAttribute(anEmitter, key, strdup(s));
+}
+
+//
+
+void
+ResultEmitterSetReal(
+    ResultEmitterRef    anEmitter,
+    const char          *key,
+    double              value
+)
+{
+    char                s[32];
+
+    if ( ! anEmitter->isStructured ) return;
+    if ( isfinite(value) ) {
+        snprintf(s, sizeof(s), "%lg", value);
+    } else {
+        strcpy(s, (anEmitter->format == ExecutionTimerOutputFormatJSON) ? "null" : "~");
+    }
+    __ResultEmitterAddAttribute(anEmitter, key, strdup(s));
+}
+
+//
+
+bool
+ResultEmitterEndSection(
+    ResultEmitterRef    anEmitter
+)
+{
+    bool                isWritten = true;
+
+    if ( ! anEmitter->isInSection ) return false;
+
+    if ( ! anEmitter->isStructured ) {
+        fputs("\n\n", anEmitter->stream);
+    } else {
+        size_t          bodyLen;
+
+        // Closing the memory stream finalizes its buffer and length:
+        if ( fclose(anEmitter->body) != 0 ) isWritten = false;
+        anEmitter->body = NULL;
+        bodyLen = anEmitter->bodyBuffer ? anEmitter->bodyLen : 0;
+        while ( (bodyLen > 0) && isspace((unsigned char)anEmitter->bodyBuffer[bodyLen - 1]) ) bodyLen--;
+        if ( anEmitter->format == ExecutionTimerOutputFormatJSON ) {
+            __ResultEmitterWriteJSONSection(anEmitter, anEmitter->bodyBuffer, bodyLen);
+        } else {
+            __ResultEmitterWriteYAMLSection(anEmitter, anEmitter->bodyBuffer, bodyLen);
+        }
+        anEmitter->nSections++;
+    }
+    __ResultEmitterClearSection(anEmitter);
+    if ( (fflush(anEmitter->stream) != 0) || ferror(anEmitter->stream) ) isWritten = false;
+    if ( ! isWritten ) anEmitter->isWritten = false;
+    return isWritten;
+}
+
+//
+
+bool
+ResultEmitterFinish(
+    ResultEmitterRef    anEmitter
+)
+{
+    if ( anEmitter->isFinished ) return anEmitter->isWritten;
+    if ( anEmitter->isInSection ) ResultEmitterEndSection(anEmitter);
+    switch ( anEmitter->format ) {
+        case ExecutionTimerOutputFormatJSON:
+            fputs("\n]}\n", anEmitter->stream);
+            break;
+        case ExecutionTimerOutputFormatYAML:
+            if ( anEmitter->nSections == 0 ) fputs("    []\n", anEmitter->stream);
+            break;
+        default:
+            break;
+    }
+    if ( (fflush(anEmitter->stream) != 0) || ferror(anEmitter->stream) ) anEmitter->isWritten = false;
+    anEmitter->isFinished = true;
+    return anEmitter->isWritten;
+}
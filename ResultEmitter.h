@@ -0,0 +1,134 @@
+/*
+ * ResultEmitter.h
+ *
+ * Pseudo-class that gathers everything a run writes -- configuration,
+ * manifest, per-method timings, tables -- into a sequence of sections.
+ *
+ * In the table, CSV, and TSV formats each section is written to the stream
+ * as it is produced, preceded by its caption, just as a person would read it.
+ * In the JSON and YAML formats the whole run is a single document:
+ *
+ *     {"format":"mmbench-result-1","sections":[
+ *       {"section":<kind>,"caption":<caption>,<attributes>...,"data":<body>},
+ *       ...
+ *     ]}
+ *
+ * where the body is whatever the section's writer (ExecutionTimer,
+ * ResultTable, ...) produced for it.  Sections are written as each one
+ * ends, so a long run's document grows as it goes.
+ */
+
+#ifndef __RESULTEMITTER_H__
+#define __RESULTEMITTER_H__
+
+#include "ExecutionTimer.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*!
+ * @defined RESULTEMITTER_DOCUMENT_FORMAT
+ *
+ * Value of the "format" key of JSON and YAML documents; changes whenever
+ * the document's structure does.
+ */
+#define RESULTEMITTER_DOCUMENT_FORMAT "mmbench-result-1"
+
+/*!
+ * @typedef ResultEmitterRef
+ *
+ * Type of a reference to a ResultEmitter object.
+ */
+typedef struct ResultEmitter * ResultEmitterRef;
+
+/*!
+ * @function ResultEmitterCreate
+ *
+ * Create a new ResultEmitter that writes to stream in the given format.  In
+ * the JSON and YAML formats the document's header is written immediately.
+ */
+ResultEmitterRef ResultEmitterCreate(ExecutionTimerOutputFormat format, FILE *stream);
+
+/*!
+ * @function ResultEmitterRetain
+ *
+ * Increase the reference count of anEmitter.
+ */
+ResultEmitterRef ResultEmitterRetain(ResultEmitterRef anEmitter);
+
+/*!
+ * @function ResultEmitterRelease
+ *
+ * Decrease the reference count of anEmitter, deallocating it once it
+ * reaches zero.  An emitter that has not been finished is finished first.
+ */
+void ResultEmitterRelease(ResultEmitterRef anEmitter);
+
+/*!
+ * @function ResultEmitterGetFormat
+ *
+ * Returns the output format of anEmitter.
+ */
+ExecutionTimerOutputFormat ResultEmitterGetFormat(ResultEmitterRef anEmitter);
+
+/*!
+ * @function ResultEmitterIsStructured
+ *
+ * Returns boolean true if anEmitter produces a single JSON or YAML document.
+ */
+bool ResultEmitterIsStructured(ResultEmitterRef anEmitter);
+
+/*!
+ * @function ResultEmitterBeginSection
+ *
+ * Start a section of the given kind (e.g. "method", "sweep").  The caption
+ * is optional; in the table, CSV, and TSV formats it is written (followed by
+ * a colon) ahead of the body.  Returns the stream to which the section's
+ * body should be written in anEmitter's format, or NULL if memory could not
+ * be allocated.  The stream is only valid until the section ends.
+ *
+ * A section that is still open is ended first.
+ */
+FILE* ResultEmitterBeginSection(ResultEmitterRef anEmitter, const char *kind, const char *caption);
+
+/*!
+ * @function ResultEmitterSetString
+ *
+ * Add a string attribute to the current section.  Attributes only appear
+ * in the JSON and YAML formats.
+ */
+void ResultEmitterSetString(ResultEmitterRef anEmitter, const char *key, const char *value);
+
+/*!
+ * @function ResultEmitterSetInteger
+ *
+ * Add an integer attribute to the current section.
+ */
+void ResultEmitterSetInteger(ResultEmitterRef anEmitter, const char *key, long value);
+
+/*!
+ * @function ResultEmitterSetReal
+ *
+ * Add a real attribute to the current section; values that are not finite
+ * are written as null (JSON) or ~ (YAML).
+ */
+void ResultEmitterSetReal(ResultEmitterRef anEmitter, const char *key, double value);
+
+/*!
+ * @function ResultEmitterEndSection
+ *
+ * Write the current section (in the JSON and YAML formats) and flush the
+ * stream.  Returns boolean false if the section could not be written.
+ */
+bool ResultEmitterEndSection(ResultEmitterRef anEmitter);
+
+/*!
+ * @function ResultEmitterFinish
+ *
+ * End the current section (if any) and write the document's trailer.  No
+ * further sections can be added afterwards.  Returns boolean false if any
+ * output could not be written.
+ */
+bool ResultEmitterFinish(ResultEmitterRef anEmitter);
+
+#endif /* __RESULTEMITTER_H__ */
@@ -0,0 +1,302 @@
+/*
+ * ResultTable.c
+ *
+ * Pseudo-class that writes "tidy" tabular results -- one row per
+ * observation, one column per variable -- in any of the ExecutionTimer
+ * output formats.  Rows are written to the stream as they are added.
+ */
+
+#include "ResultTable.h"
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+
+//
+
+typedef struct ResultTable {
+    unsigned int                refCount;
+    ExecutionTimerOutputFormat  format;
+    bool                        isFinished;
+    unsigned int                nRows;
+    unsigned int                nColumns;
+    const ResultTableColumn     *columns;
+    const char                  *tableName;
+    FILE                        *stream;
+} ResultTable;
+
+//
+
+void
+__ResultTableWriteJSONString(
+    FILE            *stream,
+    const char      *s
+)
+{
+    fputc('"', stream);
+    while ( s && *s ) {
+        if ( (*s == '"') || (*s == '\\') ) fputc('\\', stream);
+        fputc(*s++, stream);
+    }
+    fputc('"', stream);
+}
+
+//
+
+void
+__ResultTableWriteCSVString(
+    FILE            *stream,
+    const char      *s
+)
+{
+    fputc('"', stream);
+    while ( s && *s ) {
+        if ( *s == '"' ) fputc('"', stream);
+        fputc(*s++, stream);
+    }
+    fputc('"', stream);
+}
+
+//
+
+void
+__ResultTableWriteHeader(
+    ResultTable     *aTable
+)
+{
+    FILE            *stream = aTable->stream;
+    const char      *delim = ",";
+    unsigned int    i;
+
+    switch ( aTable->format ) {
+        case ExecutionTimerOutputFormatTable:
+            for ( i = 0; i < aTable->nColumns; i++ ) {
+                fprintf(stream, (aTable->columns[i].type == ResultTableColumnTypeString) ? "%s%24.24s" : "%s%16.16s", (i ? " " : ""), aTable->columns[i].name);
+            }
+            fputc('\n', stream);
+            for ( i = 0; i < aTable->nColumns; i++ ) {
+                fprintf(stream, (aTable->columns[i].type == ResultTableColumnTypeString) ? "%s%.24s" : "%s%.16s", (i ? " " : ""), "-------------------------------");
+            }
+            fputc('\n', stream);
+            break;
+
+        case ExecutionTimerOutputFormatTSV:
+            delim = "\t";
+        case ExecutionTimerOutputFormatCSV:
+            for ( i = 0; i < aTable->nColumns; i++ ) fprintf(stream, "%s\"%s\"", (i ? delim : ""), aTable->columns[i].name);
+            fputc('\n', stream);
+            break;
+
+        case ExecutionTimerOutputFormatJSON:
+            if ( aTable->tableName ) {
+                fputc('{', stream);
+                __ResultTableWriteJSONString(stream, aTable->tableName);
+                fputc(':', stream);
+            }
+            fputc('[', stream);
+            break;
+
+        case ExecutionTimerOutputFormatYAML:
+            if ( aTable->tableName ) fprintf(stream, "%s:\n", aTable->tableName);
+            break;
+    }
+}
+
+//
+
+ResultTableRef
+ResultTableCreate(
+    ExecutionTimerOutputFormat  format,
+    const char                  *tableName,
+    unsigned int                nColumns,
+    const ResultTableColumn     *columns,
+    FILE                        *stream
+)
+{
+    ResultTable                 *newTable = (ResultTable*)malloc(sizeof(ResultTable));
+
+    if ( newTable ) {
+        newTable->refCount = 1;
+        newTable->format = format;
+        newTable->isFinished = false;
+        newTable->nRows = 0;
+        newTable->nColumns = nColumns;
+        newTable->columns = columns;
+        newTable->tableName = tableName;
+        newTable->stream = stream;
+        __ResultTableWriteHeader(newTable);
+    }
+    return (ResultTableRef)newTable;
+}
+
+//
+
+ResultTableRef
+ResultTableRetain(
+    ResultTableRef  aTable
+)
+{
+    aTable->refCount++;
+    return aTable;
+}
+
+//
+
+void
+ResultTableRelease(
+    ResultTableRef  aTable
+)
+{
+    if ( --(aTable->refCount) == 0 ) {
+        if ( ! aTable->isFinished ) ResultTableFinish(aTable);
+        free((void*)aTable);
+    }
+}
+
+//
+
+void
+ResultTableAddRow(
+    ResultTableRef  aTable,
+    ...
+)
+{
+    FILE            *stream = aTable->stream;
+    const char      *delim = (aTable->format == ExecutionTimerOutputFormatTSV) ? "\t" : ",";
+    const char      *indent = (aTable->tableName ? "    " : "");
+    unsigned int    i;
+    va_list         argv;
+
+    if ( aTable->isFinished ) return;
+
+    switch ( aTable->format ) {
+        case ExecutionTimerOutputFormatJSON:
+            fprintf(stream, aTable->nRows ? ",{" : "{");
+            break;
+        default:
+            break;
+    }
+
+    va_start(argv, aTable);
+    for ( i = 0; i < aTable->nColumns; i++ ) {
+        const char  *s = NULL;
+        long        l = 0;
+        double      d = 0.0;
+
+        switch ( aTable->columns[i].type ) {
+            case ResultTableColumnTypeString:
+                s = va_arg(argv, const char*);
+                break;
+            case ResultTableColumnTypeInteger:
+                l = va_arg(argv, long);
+                break;
+            case ResultTableColumnTypeReal:
+                d = va_arg(argv, double);
+                break;
+        }
+        switch ( aTable->format ) {
+            case ExecutionTimerOutputFormatTable:
+                if ( i ) fputc(' ', stream);
+                switch ( aTable->columns[i].type ) {
+                    case ResultTableColumnTypeString:
+                        fprintf(stream, "%24s", s ? s : "");
+                        break;
+                    case ResultTableColumnTypeInteger:
+                        fprintf(stream, "%16ld", l);
+                        break;
+                    case ResultTableColumnTypeReal:
+                        if ( isfinite(d) ) fprintf(stream, "%16lg", d); else fprintf(stream, "%16s", "");
+                        break;
+                }
+                break;
+
+            case ExecutionTimerOutputFormatTSV:
+            case ExecutionTimerOutputFormatCSV:
+                if ( i ) fputs(delim, stream);
+                switch ( aTable->columns[i].type ) {
+                    case ResultTableColumnTypeString:
+                        __ResultTableWriteCSVString(stream, s);
+                        break;
+                    case ResultTableColumnTypeInteger:
+                        fprintf(stream, "%ld", l);
+                        break;
+                    case ResultTableColumnTypeReal:
+                        if ( isfinite(d) ) fprintf(stream, "%lg", d);
+                        break;
+                }
+                break;
+
+            case ExecutionTimerOutputFormatJSON:
+                if ( i ) fputs(", ", stream);
+                __ResultTableWriteJSONString(stream, aTable->columns[i].name);
+                fputc(':', stream);
+                switch ( aTable->columns[i].type ) {
+                    case ResultTableColumnTypeString:
+                        __ResultTableWriteJSONString(stream, s);
+                        break;
+                    case ResultTableColumnTypeInteger:
+                        fprintf(stream, "%ld", l);
+                        break;
+                    case ResultTableColumnTypeReal:
+                        if ( isfinite(d) ) fprintf(stream, "%lg", d); else fputs("null", stream);
+                        break;
+                }
+                break;
+
+            case ExecutionTimerOutputFormatYAML:
+                // Column names such as "% peak compute" cannot be bare keys:
+                fprintf(stream, "%s%s", indent, (i ? "  " : "- "));
+                __ResultTableWriteJSONString(stream, aTable->columns[i].name);
+                fputs(": ", stream);
+                switch ( aTable->columns[i].type ) {
+                    case ResultTableColumnTypeString:
+                        // A JSON string is a valid YAML double-quoted scalar:
+                        __ResultTableWriteJSONString(stream, s);
+                        fputc('\n', stream);
+                        break;
+                    case ResultTableColumnTypeInteger:
+                        fprintf(stream, "%ld\n", l);
+                        break;
+                    case ResultTableColumnTypeReal:
+                        if ( isfinite(d) ) fprintf(stream, "%lg\n", d); else fputs("~\n", stream);
+                        break;
+                }
+                break;
+        }
+    }
+    va_end(argv);
+
+    switch ( aTable->format ) {
+        case ExecutionTimerOutputFormatJSON:
+            fputc('}', stream);
+            break;
+        case ExecutionTimerOutputFormatYAML:
+            break;
+        default:
+            fputc('\n', stream);
+            break;
+    }
+    aTable->nRows++;
+}
+
+//
+
+void
+ResultTableFinish(
+    ResultTableRef  aTable
+)
+{
+    if ( aTable->isFinished ) return;
+    switch ( aTable->format ) {
+        case ExecutionTimerOutputFormatJSON:
+            fprintf(aTable->stream, aTable->tableName ? "]}\n" : "]\n");
+            break;
+        case ExecutionTimerOutputFormatYAML:
+            if ( aTable->nRows == 0 ) fprintf(aTable->stream, aTable->tableName ? "    []\n" : "[]\n");
+            break;
+        default:
+            break;
+    }
+    aTable->isFinished = true;
+}
@@ -0,0 +1,100 @@
+/*
+ * ResultTable.h
+ *
+ * Pseudo-class that writes "tidy" tabular results -- one row per
+ * observation, one column per variable -- in any of the ExecutionTimer
+ * output formats.  Rows are written to the stream as they are added.
+ */
+
+#ifndef __RESULTTABLE_H__
+#define __RESULTTABLE_H__
+
+#include "ExecutionTimer.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*!
+ * @enum ResultTableColumnType
+ *
+ * The type of the values in a column.  In calls to ResultTableAddRow()
+ * the values are passed as a const char*, long, or double, respectively.
+ */
+enum {
+    ResultTableColumnTypeString = 0,
+    ResultTableColumnTypeInteger,
+    ResultTableColumnTypeReal
+};
+
+/*!
+ * @typedef ResultTableColumnType
+ *
+ * Type used in conjunction with the ResultTableColumnType enumeration.
+ */
+typedef unsigned int ResultTableColumnType;
+
+/*!
+ * @typedef ResultTableColumn
+ *
+ * Describes a column of a ResultTable.
+ *
+ * @field name The column header in table/CSV/TSV output and the key in
+ *          JSON/YAML output.
+ * @field type The type of the column's values.
+ */
+typedef struct {
+    const char              *name;
+    ResultTableColumnType   type;
+} ResultTableColumn;
+
+/*!
+ * @typedef ResultTableRef
+ *
+ * Type of a reference to a ResultTable object.
+ */
+typedef struct ResultTable * ResultTableRef;
+
+/*!
+ * @function ResultTableCreate
+ *
+ * Create a new ResultTable that writes to stream in the given format and
+ * immediately write its header.  The tableName is optional:  in JSON and
+ * YAML output, the list of rows is keyed by it.  The columns array is not
+ * copied, so it must remain valid for the lifetime of the table.
+ */
+ResultTableRef ResultTableCreate(ExecutionTimerOutputFormat format, const char *tableName, unsigned int nColumns, const ResultTableColumn *columns, FILE *stream);
+
+/*!
+ * @function ResultTableRetain
+ *
+ * Increase the reference count of aTable.
+ */
+ResultTableRef ResultTableRetain(ResultTableRef aTable);
+
+/*!
+ * @function ResultTableRelease
+ *
+ * Decrease the reference count of aTable, deallocating it once it reaches
+ * zero.  A table that has not been finished is finished first.
+ */
+void ResultTableRelease(ResultTableRef aTable);
+
+/*!
+ * @function ResultTableAddRow
+ *
+ * Write a row to aTable.  One value must be passed for each column, of
+ * the type indicated by the column's ResultTableColumnType.  Real values
+ * that are not finite are written as empty (table, CSV, TSV), null (JSON),
+ * or ~ (YAML).
+ */
+void ResultTableAddRow(ResultTableRef aTable, ...);
+
+/*!
+ * @function ResultTableFinish
+ *
+ * Write the table's trailer (e.g. the closing brackets of JSON output).
+ * No further rows can be added afterwards.
+ */
+void ResultTableFinish(ResultTableRef aTable);
+
+#endif /* __RESULTTABLE_H__ */
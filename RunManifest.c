@@ -0,0 +1,614 @@
+/*
+ * RunManifest.c
+ *
+ * Pseudo-class that records the context of a benchmark run as an ordered
+ * list of key-value pairs.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "RunManifest.h"
+#include "MachineInfo.h"
+#include "ResultTable.h"
+#include "FortranInterface.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/utsname.h>
+
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+
+//
+// Build configuration, normally defined by CMake for this file only:
+//
+#ifndef MMBENCH_VERSION
+#define MMBENCH_VERSION             "unknown"
+#endif
+#ifndef MMBENCH_BUILD_TYPE
+#define MMBENCH_BUILD_TYPE          "unknown"
+#endif
+#ifndef MMBENCH_C_COMPILER
+#define MMBENCH_C_COMPILER          "unknown"
+#endif
+#ifndef MMBENCH_C_FLAGS
+#define MMBENCH_C_FLAGS             "unknown"
+#endif
+#ifndef MMBENCH_FORTRAN_COMPILER
+#define MMBENCH_FORTRAN_COMPILER    "unknown"
+#endif
+#ifndef MMBENCH_FORTRAN_FLAGS
+#define MMBENCH_FORTRAN_FLAGS       "unknown"
+#endif
+#ifndef MMBENCH_FORTRAN_FLAGS_BASIC
+#define MMBENCH_FORTRAN_FLAGS_BASIC "unknown"
+#endif
+#ifndef MMBENCH_FORTRAN_FLAGS_OPTIMIZED
+#define MMBENCH_FORTRAN_FLAGS_OPTIMIZED "unknown"
+#endif
+#ifndef MMBENCH_BLAS_LIBRARIES
+#define MMBENCH_BLAS_LIBRARIES      "none"
+#endif
+
+//
+// Environment variables that steer the threading and BLAS runtimes:
+//
+static const char *RunManifestEnvPrefixes[] = { "OMP_", "GOMP_", "KMP_", "OPENBLAS_", "GOTO_", "MKL_", "BLIS_", NULL };
+
+extern char **environ;
+
+//
+
+typedef struct RunManifestEntry {
+    char            *key;
+    char            *value;
+} RunManifestEntry;
+
+typedef struct RunManifest {
+    unsigned int        refCount;
+    unsigned int        nEntries;
+    unsigned int        capacity;
+    RunManifestEntry    *entries;
+} RunManifest;
+
+//
+
+bool
+__RunManifestReadLine(
+    const char      *path,
+    char            *buffer,
+    size_t          bufferLen
+)
+{
+    FILE            *fptr = fopen(path, "r");
+    bool            ok = false;
+
+    if ( fptr ) {
+        if ( fgets(buffer, bufferLen, fptr) ) {
+            size_t  len = strlen(buffer);
+
+            while ( len && isspace(buffer[len - 1]) ) buffer[--len] = '\0';
+            ok = true;
+        }
+        fclose(fptr);
+    }
+    return ok;
+}
+
+//
+// Set key to the first line of the file at path (or "unknown").
+//
+void
+__RunManifestSetFromFile(
+    RunManifest     *aManifest,
+    const char      *key,
+    const char      *path
+)
+{
+    char            value[256];
+
+    RunManifestSetValue(aManifest, key, "%s", __RunManifestReadLine(path, value, sizeof(value)) ? value : "unknown");
+}
+
+//
+// Set key to the selected ("[...]") choice in a sysfs setting such as
+// "always [madvise] never".
+//
+void
+__RunManifestSetFromChoice(
+    RunManifest     *aManifest,
+    const char      *key,
+    const char      *path
+)
+{
+    char            value[256], *open, *close;
+
+    if ( __RunManifestReadLine(path, value, sizeof(value)) && (open = strchr(value, '[')) && (close = strchr(open, ']')) ) {
+        *close = '\0';
+        RunManifestSetValue(aManifest, key, "%s", open + 1);
+    } else {
+        RunManifestSetValue(aManifest, key, "unknown");
+    }
+}
+
+//
+// The first processor's model, microcode revision, and feature flags from
+// /proc/cpuinfo (x86 and most other architectures name them differently):
+//
+void
+__RunManifestReadCPUInfo(
+    RunManifest     *aManifest
+)
+{
+    FILE            *fptr = fopen("/proc/cpuinfo", "r");
+    char            *line = NULL;
+    size_t          lineSize = 0;
+    bool            isMicrocodeSet = false, isFlagsSet = false;
+
+    if ( fptr ) {
+        while ( getline(&line, &lineSize, fptr) != -1 ) {
+            char    *value = strchr(line, ':'), *end;
+
+            // A blank line ends the first processor's block:
+            if ( *line == '\n' ) break;
+            if ( ! value ) continue;
+            value++;
+            while ( isspace(*value) ) value++;
+            end = value + strlen(value);
+            while ( (end > value) && isspace(end[-1]) ) *(--end) = '\0';
+
+            if ( ! isMicrocodeSet && (strncasecmp(line, "microcode", 9) == 0) ) {
+                RunManifestSetValue(aManifest, "cpu.microcode", "%s", value);
+                isMicrocodeSet = true;
+            } else if ( ! isFlagsSet && ((strncmp(line, "flags", 5) == 0) || (strncasecmp(line, "Features", 8) == 0)) ) {
+                RunManifestSetValue(aManifest, "cpu.flags", "%s", value);
+                isFlagsSet = true;
+            }
+        }
+        if ( line ) free((void*)line);
+        fclose(fptr);
+    }
+    if ( ! isMicrocodeSet ) {
+        // Not in /proc/cpuinfo on some architectures, but in sysfs on x86:
+        __RunManifestSetFromFile(aManifest, "cpu.microcode", "/sys/devices/system/cpu/cpu0/microcode/version");
+    }
+    if ( ! isFlagsSet ) RunManifestSetValue(aManifest, "cpu.flags", "unknown");
+}
+
+//
+// Count sockets, physical cores, and logical CPUs from the online CPUs'
+// topology, and NUMA nodes from sysfs.
+//
+void
+__RunManifestReadTopology(
+    RunManifest     *aManifest
+)
+{
+    long            nCPU = sysconf(_SC_NPROCESSORS_ONLN), cpu;
+    long            *packages = (long*)calloc(nCPU > 0 ? nCPU : 1, sizeof(long));
+    long            *cores = (long*)calloc(nCPU > 0 ? nCPU : 1, sizeof(long));
+    long            nPackages = 0, nCores = 0, i;
+    DIR             *dir;
+    struct dirent   *entry;
+    int             nNodes = 0;
+
+    if ( packages && cores ) {
+        for ( cpu = 0; cpu < nCPU; cpu++ ) {
+            char    path[128], value[32];
+            long    package, core, key;
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/topology/physical_package_id", cpu);
+            if ( ! __RunManifestReadLine(path, value, sizeof(value)) ) break;
+            package = strtol(value, NULL, 10);
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/topology/core_id", cpu);
+            if ( ! __RunManifestReadLine(path, value, sizeof(value)) ) break;
+            core = strtol(value, NULL, 10);
+
+            for ( i = 0; (i < nPackages) && (packages[i] != package); i++ );
+            if ( i == nPackages ) packages[nPackages++] = package;
+            // Core ids repeat across packages:
+            key = (package << 20) | core;
+            for ( i = 0; (i < nCores) && (cores[i] != key); i++ );
+            if ( i == nCores ) cores[nCores++] = key;
+        }
+    }
+    if ( packages ) free((void*)packages);
+    if ( cores ) free((void*)cores);
+
+    RunManifestSetValue(aManifest, "topology.logical_cpus", "%ld", nCPU);
+    if ( nPackages && nCores ) {
+        RunManifestSetValue(aManifest, "topology.sockets", "%ld", nPackages);
+        RunManifestSetValue(aManifest, "topology.cores", "%ld", nCores);
+        RunManifestSetValue(aManifest, "topology.threads_per_core", "%ld", (nCPU + nCores - 1) / nCores);
+    } else {
+        RunManifestSetValue(aManifest, "topology.sockets", "unknown");
+        RunManifestSetValue(aManifest, "topology.cores", "unknown");
+        RunManifestSetValue(aManifest, "topology.threads_per_core", "unknown");
+    }
+    __RunManifestSetFromFile(aManifest, "topology.smt", "/sys/devices/system/cpu/smt/control");
+
+    if ( (dir = opendir("/sys/devices/system/node")) ) {
+        while ( (entry = readdir(dir)) ) {
+            if ( (strncmp(entry->d_name, "node", 4) == 0) && isdigit(entry->d_name[4]) ) nNodes++;
+        }
+        closedir(dir);
+    }
+    if ( nNodes ) {
+        RunManifestSetValue(aManifest, "topology.numa_nodes", "%d", nNodes);
+    } else {
+        RunManifestSetValue(aManifest, "topology.numa_nodes", "unknown");
+    }
+}
+
+//
+// The first CPU's frequency scaling (sysfs values are in kHz):
+//
+void
+__RunManifestReadFrequency(
+    RunManifest     *aManifest
+)
+{
+    static const char   *files[][2] = {
+                            { "frequency.driver", "scaling_driver" },
+                            { "frequency.governor", "scaling_governor" },
+                            { "frequency.current_khz", "scaling_cur_freq" },
+                            { "frequency.min_khz", "scaling_min_freq" },
+                            { "frequency.max_khz", "scaling_max_freq" },
+                            { "frequency.hardware_max_khz", "cpuinfo_max_freq" }
+                        };
+    unsigned int        i;
+
+    for ( i = 0; i < sizeof(files) / sizeof(files[0]); i++ ) {
+        char            path[128];
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cpufreq/%s", files[i][1]);
+        __RunManifestSetFromFile(aManifest, files[i][0], path);
+    }
+    __RunManifestSetFromFile(aManifest, "frequency.boost", "/sys/devices/system/cpu/cpufreq/boost");
+    if ( ! strcmp(RunManifestGetValue(aManifest, "frequency.boost"), "unknown") ) {
+        char            value[16];
+
+        // Intel's driver inverts the sense:
+        if ( __RunManifestReadLine("/sys/devices/system/cpu/intel_pstate/no_turbo", value, sizeof(value)) ) {
+            RunManifestSetValue(aManifest, "frequency.boost", "%s", (*value == '0') ? "1" : "0");
+        }
+    }
+}
+
+//
+// The library that provides symbol at runtime (NULL if none does):
+//
+const char*
+__RunManifestSymbolLibrary(
+    const char      *symbol
+)
+{
+    void            *address = dlsym(RTLD_DEFAULT, symbol);
+    Dl_info         info;
+
+    if ( address && dladdr(address, &info) && info.dli_fname ) return info.dli_fname;
+    return NULL;
+}
+
+//
+
+void
+__RunManifestReadBLAS(
+    RunManifest     *aManifest
+)
+{
+    const char      *library = __RunManifestSymbolLibrary("sgemm_");
+    char            *(*openblasGetConfig)(void) = (char*(*)(void))dlsym(RTLD_DEFAULT, "openblas_get_config");
+    void            (*mklGetVersionString)(char*, int) = (void(*)(char*, int))dlsym(RTLD_DEFAULT, "MKL_Get_Version_String");
+
+    RunManifestSetValue(aManifest, "blas.configured", "%s", MMBENCH_BLAS_LIBRARIES);
+    RunManifestSetValue(aManifest, "blas.library", "%s", library ? library : "none");
+    if ( openblasGetConfig ) {
+        RunManifestSetValue(aManifest, "blas.version", "%s", openblasGetConfig());
+    } else if ( mklGetVersionString ) {
+        char        version[256];
+
+        mklGetVersionString(version, sizeof(version));
+        version[sizeof(version) - 1] = '\0';
+        RunManifestSetValue(aManifest, "blas.version", "%s", version);
+    } else {
+        RunManifestSetValue(aManifest, "blas.version", "unknown");
+    }
+}
+
+//
+
+void
+__RunManifestReadOpenMP(
+    RunManifest     *aManifest
+)
+{
+#ifdef _OPENMP
+    const char      *library = __RunManifestSymbolLibrary("omp_get_max_threads");
+
+    RunManifestSetValue(aManifest, "openmp.version", "%d", (int)_OPENMP);
+    RunManifestSetValue(aManifest, "openmp.runtime", "%s", library ? library : "unknown");
+    RunManifestSetValue(aManifest, "openmp.max_threads", "%d", omp_get_max_threads());
+#else
+    RunManifestSetValue(aManifest, "openmp.version", "none");
+#endif
+}
+
+//
+
+void
+__RunManifestReadEnvironment(
+    RunManifest     *aManifest
+)
+{
+    char            **env;
+
+    for ( env = environ; env && *env; env++ ) {
+        const char  *eq = strchr(*env, '=');
+        int         i;
+
+        if ( ! eq ) continue;
+        for ( i = 0; RunManifestEnvPrefixes[i]; i++ ) {
+            if ( strncmp(*env, RunManifestEnvPrefixes[i], strlen(RunManifestEnvPrefixes[i])) == 0 ) {
+                char    key[eq - *env + 5];
+
+                snprintf(key, sizeof(key), "env.%.*s", (int)(eq - *env), *env);
+                RunManifestSetValue(aManifest, key, "%s", eq + 1);
+                break;
+            }
+        }
+    }
+}
+
+//
+
+void
+__RunManifestReadHugepages(
+    RunManifest     *aManifest
+)
+{
+    FILE            *fptr = fopen("/proc/meminfo", "r");
+    char            line[256];
+
+    __RunManifestSetFromChoice(aManifest, "hugepages.thp_enabled", "/sys/kernel/mm/transparent_hugepage/enabled");
+    __RunManifestSetFromChoice(aManifest, "hugepages.thp_defrag", "/sys/kernel/mm/transparent_hugepage/defrag");
+    if ( fptr ) {
+        while ( fgets(line, sizeof(line), fptr) ) {
+            static const char   *fields[][2] = {
+                                    { "HugePages_Total:", "hugepages.total" },
+                                    { "HugePages_Free:", "hugepages.free" },
+                                    { "Hugepagesize:", "hugepages.size" }
+                                };
+            unsigned int        i;
+
+            for ( i = 0; i < sizeof(fields) / sizeof(fields[0]); i++ ) {
+                size_t          len = strlen(fields[i][0]);
+
+                if ( strncmp(line, fields[i][0], len) == 0 ) {
+                    char        *value = line + len, *end;
+
+                    while ( isspace(*value) ) value++;
+                    end = value + strlen(value);
+                    while ( (end > value) && isspace(end[-1]) ) *(--end) = '\0';
+                    RunManifestSetValue(aManifest, fields[i][1], "%s", value);
+                }
+            }
+        }
+        fclose(fptr);
+    }
+}
+
+//
+
+RunManifestRef
+RunManifestCreate(void)
+{
+    RunManifest     *newManifest = (RunManifest*)malloc(sizeof(RunManifest));
+
+    if ( newManifest ) {
+        MachineInfoRef  machine = MachineInfoCreate();
+        struct utsname  uts;
+        char            host[256];
+
+        newManifest->refCount = 1;
+        newManifest->nEntries = newManifest->capacity = 0;
+        newManifest->entries = NULL;
+
+        if ( gethostname(host, sizeof(host)) == 0 ) {
+            host[sizeof(host) - 1] = '\0';
+            RunManifestSetValue(newManifest, "host.name", "%s", host);
+        } else {
+            RunManifestSetValue(newManifest, "host.name", "unknown");
+        }
+        if ( machine ) {
+            unsigned int    level;
+
+            RunManifestSetValue(newManifest, "cpu.model", "%s", MachineInfoGetCPUModel(machine));
+            __RunManifestReadCPUInfo(newManifest);
+            for ( level = 1; level <= MachineInfoGetCacheLevelCount(machine); level++ ) {
+                char        key[32];
+
+                snprintf(key, sizeof(key), "cpu.cache.L%u%s", level, (level == 1) ? "d" : "");
+                RunManifestSetValue(newManifest, key, "%ld", MachineInfoGetCacheSize(machine, level));
+            }
+            RunManifestSetValue(newManifest, "cpu.fingerprint", "%s", MachineInfoGetFingerprint(machine));
+            MachineInfoRelease(machine);
+        } else {
+            __RunManifestReadCPUInfo(newManifest);
+        }
+        __RunManifestReadTopology(newManifest);
+        __RunManifestReadFrequency(newManifest);
+
+        if ( uname(&uts) == 0 ) {
+            RunManifestSetValue(newManifest, "kernel.sysname", "%s", uts.sysname);
+            RunManifestSetValue(newManifest, "kernel.release", "%s", uts.release);
+            RunManifestSetValue(newManifest, "kernel.version", "%s", uts.version);
+            RunManifestSetValue(newManifest, "kernel.machine", "%s", uts.machine);
+        }
+
+        RunManifestSetValue(newManifest, "build.version", "%s", MMBENCH_VERSION);
+        RunManifestSetValue(newManifest, "build.type", "%s", *MMBENCH_BUILD_TYPE ? MMBENCH_BUILD_TYPE : "none");
+        RunManifestSetValue(newManifest, "build.c_compiler", "%s", MMBENCH_C_COMPILER);
+        RunManifestSetValue(newManifest, "build.c_flags", "%s", MMBENCH_C_FLAGS);
+        RunManifestSetValue(newManifest, "build.fortran_compiler", "%s", MMBENCH_FORTRAN_COMPILER);
+        RunManifestSetValue(newManifest, "build.fortran_flags", "%s", MMBENCH_FORTRAN_FLAGS);
+        RunManifestSetValue(newManifest, "build.fortran_flags_basic", "%s", MMBENCH_FORTRAN_FLAGS_BASIC);
+        RunManifestSetValue(newManifest, "build.fortran_flags_optimized", "%s", MMBENCH_FORTRAN_FLAGS_OPTIMIZED);
+        RunManifestSetValue(newManifest, "build.real_bytes", "%u", (unsigned int)sizeof(f_real));
+        RunManifestSetValue(newManifest, "build.integer_bytes", "%u", (unsigned int)sizeof(f_integer));
+
+        __RunManifestReadBLAS(newManifest);
+        __RunManifestReadOpenMP(newManifest);
+        __RunManifestReadEnvironment(newManifest);
+        __RunManifestReadHugepages(newManifest);
+    }
+    return (RunManifestRef)newManifest;
+}
+
+//
+
+RunManifestRef
+RunManifestRetain(
+    RunManifestRef  aManifest
+)
+{
+    aManifest->refCount++;
+    return aManifest;
+}
+
+//
+
+void
+RunManifestRelease(
+    RunManifestRef  aManifest
+)
+{
+    if ( --(aManifest->refCount) == 0 ) {
+        unsigned int    i;
+
+        for ( i = 0; i < aManifest->nEntries; i++ ) {
+            free((void*)aManifest->entries[i].key);
+            free((void*)aManifest->entries[i].value);
+        }
+        if ( aManifest->entries ) free((void*)aManifest->entries);
+        free((void*)aManifest);
+    }
+}
+
+//
+
+bool
+RunManifestSetValue(
+    RunManifestRef  aManifest,
+    const char      *key,
+    const char      *format,
+    ...
+)
+{
+    va_list         argv;
+    char            *value;
+    unsigned int    i;
+    int             rc;
+
+    va_start(argv, format);
+    rc = vasprintf(&value, format, argv);
+    va_end(argv);
+    if ( rc < 0 ) return false;
+
+    for ( i = 0; i < aManifest->nEntries; i++ ) {
+        if ( strcmp(aManifest->entries[i].key, key) == 0 ) {
+            free((void*)aManifest->entries[i].value);
+            aManifest->entries[i].value = value;
+            return true;
+        }
+    }
+    if ( aManifest->nEntries == aManifest->capacity ) {
+        unsigned int        newCapacity = aManifest->capacity ? (2 * aManifest->capacity) : 64;
+        RunManifestEntry    *newEntries = (RunManifestEntry*)realloc(aManifest->entries, newCapacity * sizeof(RunManifestEntry));
+
+        if ( ! newEntries ) {
+            free((void*)value);
+            return false;
+        }
+        aManifest->entries = newEntries;
+        aManifest->capacity = newCapacity;
+    }
+    if ( ! (aManifest->entries[aManifest->nEntries].key = strdup(key)) ) {
+        free((void*)value);
+        return false;
+    }
+    aManifest->entries[aManifest->nEntries++].value = value;
+    return true;
+}
+
+//
+
+const char*
+RunManifestGetValue(
+    RunManifestRef  aManifest,
+    const char      *key
+)
+{
+    unsigned int    i;
+
+    for ( i = 0; i < aManifest->nEntries; i++ ) {
+        if ( strcmp(aManifest->entries[i].key, key) == 0 ) return (const char*)aManifest->entries[i].value;
+    }
+    return NULL;
+}
+
+//
+
+unsigned int
+RunManifestGetCount(
+    RunManifestRef  aManifest
+)
+{
+    return aManifest->nEntries;
+}
+
+//
+
+const char*
+RunManifestGetEntry(
+    RunManifestRef  aManifest,
+    unsigned int    index,
+    const char*     *outValue
+)
+{
+    if ( index >= aManifest->nEntries ) return NULL;
+    if ( outValue ) *outValue = (const char*)aManifest->entries[index].value;
+    return (const char*)aManifest->entries[index].key;
+}
+
+//
+
+static const ResultTableColumn RunManifestResultColumns[] = {
+                { "key", ResultTableColumnTypeString },
+                { "value", ResultTableColumnTypeString }
+            };
+
+void
+RunManifestSummarizeToStream(
+    RunManifestRef              aManifest,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "manifest", 2, RunManifestResultColumns, stream);
+    unsigned int                i;
+
+    if ( ! results ) return;
+    for ( i = 0; i < aManifest->nEntries; i++ ) ResultTableAddRow(results, aManifest->entries[i].key, aManifest->entries[i].value);
+    ResultTableRelease(results);
+}
@@ -0,0 +1,101 @@
+/*
+ * RunManifest.h
+ *
+ * Pseudo-class that records the context of a benchmark run -- everything
+ * outside the code being timed that can change its performance -- as an
+ * ordered list of key-value pairs with dotted keys:
+ *
+ *     cpu.*          model, microcode revision, feature flags, cache sizes
+ *     topology.*     sockets, cores, threads per core, NUMA nodes
+ *     frequency.*    scaling driver and governor, current and limit clocks
+ *     kernel.*       operating system, release, version, machine
+ *     build.*        mmbench version, build type, compiler IDs and the exact
+ *                    C and Fortran flags (as configured by CMake)
+ *     blas.*         configured libraries, the library that provides sgemm_
+ *                    at runtime, and its version (OpenBLAS, MKL)
+ *     openmp.*       specification version and runtime library
+ *     env.*          OMP_*, GOMP_*, KMP_*, OPENBLAS_*, GOTO_*, MKL_*, BLIS_*
+ *                    environment variables
+ *     hugepages.*    transparent hugepage settings and the hugepage pool
+ *
+ * Values that cannot be determined are "unknown".
+ */
+
+#ifndef __RUNMANIFEST_H__
+#define __RUNMANIFEST_H__
+
+#include "ExecutionTimer.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*!
+ * @typedef RunManifestRef
+ *
+ * Type of a reference to a RunManifest object.
+ */
+typedef struct RunManifest * RunManifestRef;
+
+/*!
+ * @function RunManifestCreate
+ *
+ * Gather the context of the current process and host.
+ */
+RunManifestRef RunManifestCreate(void);
+
+/*!
+ * @function RunManifestRetain
+ *
+ * Increase the reference count of aManifest.
+ */
+RunManifestRef RunManifestRetain(RunManifestRef aManifest);
+
+/*!
+ * @function RunManifestRelease
+ *
+ * Decrease the reference count of aManifest, deallocating it once it
+ * reaches zero.
+ */
+void RunManifestRelease(RunManifestRef aManifest);
+
+/*!
+ * @function RunManifestSetValue
+ *
+ * Set the value of key (appending it if it is not yet present) from a
+ * printf-style format.
+ *
+ * Returns boolean false if memory could not be allocated.
+ */
+bool RunManifestSetValue(RunManifestRef aManifest, const char *key, const char *format, ...);
+
+/*!
+ * @function RunManifestGetValue
+ *
+ * Returns the value of key, or NULL if it is not present.
+ */
+const char* RunManifestGetValue(RunManifestRef aManifest, const char *key);
+
+/*!
+ * @function RunManifestGetCount
+ *
+ * Returns the number of key-value pairs in aManifest.
+ */
+unsigned int RunManifestGetCount(RunManifestRef aManifest);
+
+/*!
+ * @function RunManifestGetEntry
+ *
+ * Returns the key at index (NULL for an invalid index) and, in the
+ * (optional) outValue, its value.
+ */
+const char* RunManifestGetEntry(RunManifestRef aManifest, unsigned int index, const char* *outValue);
+
+/*!
+ * @function RunManifestSummarizeToStream
+ *
+ * Write the manifest to stream as a two-column ("key", "value") table named
+ * "manifest" in the given format.
+ */
+void RunManifestSummarizeToStream(RunManifestRef aManifest, ExecutionTimerOutputFormat format, FILE *stream);
+
+#endif /* __RUNMANIFEST_H__ */
@@ -0,0 +1,600 @@
+/*
+ * SampleFile.c
+ *
+ * Pseudo-class that holds raw per-cycle samples and reads and writes them
+ * in a compact binary columnar file.
+ */
+
+#include "SampleFile.h"
+#include "ResultTable.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+
+//
+
+#define SAMPLEFILE_MAGIC        "MMBSMPL1"
+#define SAMPLEFILE_BYTE_ORDER   0x01020304U
+
+#ifndef SAMPLEFILE_BOOTSTRAP_RESAMPLES
+#define SAMPLEFILE_BOOTSTRAP_RESAMPLES 2000
+#endif
+
+//
+
+typedef struct SampleFileColumn {
+    char            *series;
+    char            *metric;
+    long            n;
+    int             threads;
+    unsigned long   nValues;
+    double          *values;
+} SampleFileColumn;
+
+typedef struct SampleFile {
+    unsigned int        refCount;
+    unsigned int        nColumns;
+    unsigned int        capacity;
+    SampleFileColumn    *columns;
+} SampleFile;
+
+//
+
+SampleFileRef
+SampleFileCreate(void)
+{
+    SampleFile      *newFile = (SampleFile*)malloc(sizeof(SampleFile));
+
+    if ( newFile ) {
+        newFile->refCount = 1;
+        newFile->nColumns = newFile->capacity = 0;
+        newFile->columns = NULL;
+    }
+    return (SampleFileRef)newFile;
+}
+
+//
+
+bool
+__SampleFileReadString(
+    FILE            *fptr,
+    char*           *outString
+)
+{
+    uint32_t        len;
+    char            *s;
+
+    if ( fread(&len, sizeof(len), 1, fptr) != 1 ) return false;
+    if ( ! (s = (char*)malloc(len + 1)) ) return false;
+    if ( (len > 0) && (fread(s, len, 1, fptr) != 1) ) {
+        free((void*)s);
+        return false;
+    }
+    s[len] = '\0';
+    *outString = s;
+    return true;
+}
+
+//
+
+SampleFileRef
+SampleFileCreateWithPath(
+    const char      *path
+)
+{
+    FILE            *fptr = fopen(path, "rb");
+    SampleFile      *newFile;
+    char            magic[8];
+    uint32_t        byteOrder, nColumns, i;
+
+    if ( ! fptr ) {
+        fprintf(stderr, "ERROR:  unable to open sample file %s (errno = %d)\n", path, errno);
+        return NULL;
+    }
+    if ( (fread(magic, sizeof(magic), 1, fptr) != 1) || memcmp(magic, SAMPLEFILE_MAGIC, sizeof(magic)) ||
+         (fread(&byteOrder, sizeof(byteOrder), 1, fptr) != 1) || (fread(&nColumns, sizeof(nColumns), 1, fptr) != 1)
+    ) {
+        fprintf(stderr, "ERROR:  %s is not a sample file\n", path);
+        fclose(fptr);
+        return NULL;
+    }
+    if ( byteOrder != SAMPLEFILE_BYTE_ORDER ) {
+        fprintf(stderr, "ERROR:  sample file %s was written with a different byte order\n", path);
+        fclose(fptr);
+        return NULL;
+    }
+    if ( ! (newFile = SampleFileCreate()) ) {
+        fclose(fptr);
+        return NULL;
+    }
+    for ( i = 0; i < nColumns; i++ ) {
+        char        *series = NULL, *metric = NULL;
+        int64_t     n;
+        int32_t     threads;
+        uint64_t    nValues;
+        double      *values = NULL;
+        bool        ok = false;
+
+        if ( __SampleFileReadString(fptr, &series) && __SampleFileReadString(fptr, &metric) &&
+             (fread(&n, sizeof(n), 1, fptr) == 1) && (fread(&threads, sizeof(threads), 1, fptr) == 1) &&
+             (fread(&nValues, sizeof(nValues), 1, fptr) == 1) &&
+             (values = (double*)malloc((nValues ? nValues : 1) * sizeof(double))) &&
+             (fread(values, sizeof(double), nValues, fptr) == nValues)
+        ) {
+            ok = SampleFileAddColumn(newFile, series, metric, (long)n, (int)threads, (unsigned long)nValues, values);
+        }
+        if ( series ) free((void*)series);
+        if ( metric ) free((void*)metric);
+        if ( values ) free((void*)values);
+        if ( ! ok ) {
+            fprintf(stderr, "ERROR:  sample file %s is truncated or malformed (column %u)\n", path, (unsigned int)i);
+            SampleFileRelease(newFile);
+            fclose(fptr);
+            return NULL;
+        }
+    }
+    fclose(fptr);
+    return (SampleFileRef)newFile;
+}
+
+//
+
+SampleFileRef
+SampleFileRetain(
+    SampleFileRef   aFile
+)
+{
+    aFile->refCount++;
+    return aFile;
+}
+
+//
+
+void
+SampleFileRelease(
+    SampleFileRef   aFile
+)
+{
+    if ( --(aFile->refCount) == 0 ) {
+        unsigned int    i;
+
+        for ( i = 0; i < aFile->nColumns; i++ ) {
+            free((void*)aFile->columns[i].series);
+            free((void*)aFile->columns[i].metric);
+            free((void*)aFile->columns[i].values);
+        }
+        if ( aFile->columns ) free((void*)aFile->columns);
+        free((void*)aFile);
+    }
+}
+
+//
+
+bool
+SampleFileAddColumn(
+    SampleFileRef       aFile,
+    const char          *series,
+    const char          *metric,
+    long                n,
+    int                 threads,
+    unsigned long       nValues,
+    const double        *values
+)
+{
+    SampleFileColumn    *c;
+
+    if ( aFile->nColumns == aFile->capacity ) {
+        unsigned int        newCapacity = aFile->capacity ? (2 * aFile->capacity) : 32;
+        SampleFileColumn    *newColumns = (SampleFileColumn*)realloc(aFile->columns, newCapacity * sizeof(SampleFileColumn));
+
+        if ( ! newColumns ) return false;
+        aFile->columns = newColumns;
+        aFile->capacity = newCapacity;
+    }
+    c = &aFile->columns[aFile->nColumns];
+    c->series = strdup(series);
+    c->metric = strdup(metric);
+    c->values = (double*)malloc((nValues ? nValues : 1) * sizeof(double));
+    if ( ! c->series || ! c->metric || ! c->values ) {
+        if ( c->series ) free((void*)c->series);
+        if ( c->metric ) free((void*)c->metric);
+        if ( c->values ) free((void*)c->values);
+        return false;
+    }
+    if ( nValues ) memcpy(c->values, values, nValues * sizeof(double));
+    c->n = n;
+    c->threads = threads;
+    c->nValues = nValues;
+    aFile->nColumns++;
+    return true;
+}
+
+//
+
+bool
+SampleFileAddTimer(
+    SampleFileRef           aFile,
+    const char              *series,
+    long                    n,
+    int                     threads,
+    ExecutionTimerRef       aTimer
+)
+{
+    ExecutionTimerMetric    metric;
+
+    for ( metric = ExecutionTimerMetricWalltime; metric < ExecutionTimerMetricEOL; metric++ ) {
+        const double        *values;
+        unsigned int        nValues = ExecutionTimerGetSamples(aTimer, metric, &values), i;
+
+        // Skip metrics the timer never produced:
+        for ( i = 0; i < nValues; i++ ) if ( ! isnan(values[i]) ) break;
+        if ( i == nValues ) continue;
+        if ( ! SampleFileAddColumn(aFile, series, ExecutionTimerMetricGetName(metric), n, threads, nValues, values) ) return false;
+    }
+    return true;
+}
+
+//
+
+unsigned int
+SampleFileGetColumnCount(
+    SampleFileRef   aFile
+)
+{
+    return aFile->nColumns;
+}
+
+//
+
+unsigned long
+SampleFileGetColumn(
+    SampleFileRef       aFile,
+    unsigned int        index,
+    const char*         *outSeries,
+    const char*         *outMetric,
+    long                *outN,
+    int                 *outThreads,
+    const double*       *outValues
+)
+{
+    SampleFileColumn    *c;
+
+    if ( index >= aFile->nColumns ) return 0;
+    c = &aFile->columns[index];
+    if ( outSeries ) *outSeries = (const char*)c->series;
+    if ( outMetric ) *outMetric = (const char*)c->metric;
+    if ( outN ) *outN = c->n;
+    if ( outThreads ) *outThreads = c->threads;
+    if ( outValues ) *outValues = (const double*)c->values;
+    return c->nValues;
+}
+
+//
+
+bool
+__SampleFileWriteString(
+    FILE            *fptr,
+    const char      *s
+)
+{
+    uint32_t        len = (uint32_t)strlen(s);
+
+    return ( (fwrite(&len, sizeof(len), 1, fptr) == 1) && ((len == 0) || (fwrite(s, len, 1, fptr) == 1)) ) ? true : false;
+}
+
+//
+
+bool
+SampleFileWrite(
+    SampleFileRef   aFile,
+    const char      *path
+)
+{
+    FILE            *fptr = fopen(path, "wb");
+    uint32_t        byteOrder = SAMPLEFILE_BYTE_ORDER, nColumns = aFile->nColumns;
+    unsigned int    i;
+    bool            ok;
+
+    if ( ! fptr ) {
+        fprintf(stderr, "ERROR:  unable to create sample file %s (errno = %d)\n", path, errno);
+        return false;
+    }
+    ok = (fwrite(SAMPLEFILE_MAGIC, 8, 1, fptr) == 1) && (fwrite(&byteOrder, sizeof(byteOrder), 1, fptr) == 1) &&
+         (fwrite(&nColumns, sizeof(nColumns), 1, fptr) == 1);
+    for ( i = 0; ok && (i < aFile->nColumns); i++ ) {
+        SampleFileColumn    *c = &aFile->columns[i];
+        int64_t             n = c->n;
+        int32_t             threads = c->threads;
+        uint64_t            nValues = c->nValues;
+
+        ok = __SampleFileWriteString(fptr, c->series) && __SampleFileWriteString(fptr, c->metric) &&
+             (fwrite(&n, sizeof(n), 1, fptr) == 1) && (fwrite(&threads, sizeof(threads), 1, fptr) == 1) &&
+             (fwrite(&nValues, sizeof(nValues), 1, fptr) == 1) &&
+             ((nValues == 0) || (fwrite(c->values, sizeof(double), nValues, fptr) == nValues));
+    }
+    if ( fclose(fptr) != 0 ) ok = false;
+    if ( ! ok ) fprintf(stderr, "ERROR:  unable to write sample file %s (errno = %d)\n", path, errno);
+    return ok;
+}
+
+//
+
+static const ResultTableColumn SampleFileResultColumns[] = {
+                { "series", ResultTableColumnTypeString },
+                { "metric", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "threads", ResultTableColumnTypeInteger },
+                { "cycle", ResultTableColumnTypeInteger },
+                { "value", ResultTableColumnTypeReal }
+            };
+
+void
+SampleFileSummarizeToStream(
+    SampleFileRef               aFile,
+    ExecutionTimerOutputFormat  format,
+    const char                  *series,
+    const char                  *metric,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "samples", sizeof(SampleFileResultColumns) / sizeof(SampleFileResultColumns[0]), SampleFileResultColumns, stream);
+    unsigned int                i;
+
+    if ( ! results ) return;
+    for ( i = 0; i < aFile->nColumns; i++ ) {
+        SampleFileColumn        *c = &aFile->columns[i];
+        unsigned long           cycle;
+
+        if ( series && strcasecmp(series, c->series) ) continue;
+        if ( metric && strcasecmp(metric, c->metric) ) continue;
+        for ( cycle = 0; cycle < c->nValues; cycle++ ) {
+            if ( isnan(c->values[cycle]) ) continue;
+            ResultTableAddRow(results, c->series, c->metric, c->n, (long)c->threads, (long)cycle, c->values[cycle]);
+        }
+    }
+    ResultTableRelease(results);
+}
+
+//
+////
+//
+
+int
+__SampleFileDoubleCompare(
+    const void      *a,
+    const void      *b
+)
+{
+    double          A = *((const double*)a), B = *((const double*)b);
+
+    return (A < B) ? -1 : ((A > B) ? 1 : 0);
+}
+
+//
+
+static inline uint64_t
+__SampleFileXorshift64(
+    uint64_t        *state
+)
+{
+    uint64_t        x = *state;
+
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+//
+
+static inline double
+__SampleFileSortedMedian(
+    const double    *sorted,
+    unsigned long   n
+)
+{
+    return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+//
+
+double
+__SampleFileMedian(
+    double          *values,
+    unsigned long   n
+)
+{
+    qsort(values, n, sizeof(double), __SampleFileDoubleCompare);
+    return __SampleFileSortedMedian(values, n);
+}
+
+//
+// Copy the non-NaN values of a column into out; returns how many there are.
+//
+unsigned long
+__SampleFileCopyValues(
+    const SampleFileColumn  *c,
+    double                  *out
+)
+{
+    unsigned long           i, n = 0;
+
+    for ( i = 0; i < c->nValues; i++ ) if ( ! isnan(c->values[i]) ) out[n++] = c->values[i];
+    return n;
+}
+
+//
+// Two-sided p-value of the Mann-Whitney U test that x and y come from the
+// same distribution, by the normal approximation with tie correction.  Both
+// x and y must be sorted.
+//
+double
+__SampleFileMannWhitneyP(
+    const double    *x,
+    unsigned long   nx,
+    const double    *y,
+    unsigned long   ny
+)
+{
+    double          N = (double)(nx + ny), rankSumX = 0.0, ties = 0.0, mean, variance, z;
+    unsigned long   i = 0, j = 0, rank = 1;
+
+    //
+    // Merge the sorted samples, giving each run of equal values the average
+    // of the ranks it spans:
+    //
+    while ( (i < nx) || (j < ny) ) {
+        double          v = ((j >= ny) || ((i < nx) && (x[i] <= y[j]))) ? x[i] : y[j];
+        unsigned long   nxTied = 0, nyTied = 0, t;
+
+        while ( (i < nx) && (x[i] == v) ) i++, nxTied++;
+        while ( (j < ny) && (y[j] == v) ) j++, nyTied++;
+        t = nxTied + nyTied;
+        rankSumX += (double)nxTied * ((double)rank + 0.5 * (double)(t - 1));
+        ties += (double)t * (double)t * (double)t - (double)t;
+        rank += t;
+    }
+    mean = 0.5 * (double)nx * (double)ny;
+    variance = (double)nx * (double)ny / 12.0 * ((N + 1.0) - ties / (N * (N - 1.0)));
+    if ( variance <= 0.0 ) return 1.0;
+
+    // Continuity-corrected z of U for x:
+    z = fabs(rankSumX - 0.5 * (double)nx * (double)(nx + 1) - mean) - 0.5;
+    if ( z < 0.0 ) z = 0.0;
+    return erfc(z / sqrt(2.0 * variance));
+}
+
+//
+// Percentile bootstrap 95% confidence interval of the ratio of the medians
+// of y and x.  A fixed seed keeps the interval reproducible.
+//
+bool
+__SampleFileBootstrapRatio(
+    const double    *x,
+    unsigned long   nx,
+    const double    *y,
+    unsigned long   ny,
+    double          *outLow,
+    double          *outHigh
+)
+{
+    double          *scratch = (double*)malloc((nx > ny ? nx : ny) * sizeof(double));
+    double          *ratios = (double*)malloc(SAMPLEFILE_BOOTSTRAP_RESAMPLES * sizeof(double));
+    uint64_t        rngState = 0x9E3779B97F4A7C15ULL;
+    unsigned int    b;
+    unsigned long   i;
+
+    if ( ! scratch || ! ratios ) {
+        if ( scratch ) free((void*)scratch);
+        if ( ratios ) free((void*)ratios);
+        return false;
+    }
+    for ( b = 0; b < SAMPLEFILE_BOOTSTRAP_RESAMPLES; b++ ) {
+        double      medianX, medianY;
+
+        for ( i = 0; i < nx; i++ ) scratch[i] = x[(unsigned long)((double)(__SampleFileXorshift64(&rngState) >> 11) * 0x1.0p-53 * (double)nx)];
+        medianX = __SampleFileMedian(scratch, nx);
+        for ( i = 0; i < ny; i++ ) scratch[i] = y[(unsigned long)((double)(__SampleFileXorshift64(&rngState) >> 11) * 0x1.0p-53 * (double)ny)];
+        medianY = __SampleFileMedian(scratch, ny);
+        ratios[b] = medianY / medianX;
+    }
+    qsort(ratios, SAMPLEFILE_BOOTSTRAP_RESAMPLES, sizeof(double), __SampleFileDoubleCompare);
+    *outLow = ratios[(unsigned int)(0.025 * (SAMPLEFILE_BOOTSTRAP_RESAMPLES - 1))];
+    *outHigh = ratios[(unsigned int)(0.975 * (SAMPLEFILE_BOOTSTRAP_RESAMPLES - 1) + 0.5)];
+    free((void*)scratch);
+    free((void*)ratios);
+    return true;
+}
+
+//
+
+static const ResultTableColumn SampleFileCompareColumns[] = {
+                { "series", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "threads", ResultTableColumnTypeInteger },
+                { "baseline median", ResultTableColumnTypeReal },
+                { "current median", ResultTableColumnTypeReal },
+                { "speedup", ResultTableColumnTypeReal },
+                { "ratio CI low", ResultTableColumnTypeReal },
+                { "ratio CI high", ResultTableColumnTypeReal },
+                { "p-value", ResultTableColumnTypeReal },
+                { "verdict", ResultTableColumnTypeString }
+            };
+
+unsigned int
+SampleFileCompareToStream(
+    SampleFileRef               baseline,
+    SampleFileRef               current,
+    const char                  *metric,
+    double                      threshold,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "comparison", sizeof(SampleFileCompareColumns) / sizeof(SampleFileCompareColumns[0]), SampleFileCompareColumns, stream);
+    unsigned int                i, j, nRegressions = 0;
+    static const char           *warmupSuffix = " warm-up";
+
+    if ( ! results ) return 0;
+    for ( i = 0; i < current->nColumns; i++ ) {
+        SampleFileColumn        *c = &current->columns[i], *b = NULL;
+        size_t                  seriesLen = strlen(c->series);
+        double                  *x = NULL, *y = NULL;
+        unsigned long           nx = 0, ny = 0;
+        double                  medianX, medianY, ratioLow, ratioHigh, p;
+        const char              *verdict;
+
+        if ( strcasecmp(metric, c->metric) ) continue;
+        if ( (seriesLen >= strlen(warmupSuffix)) && ! strcmp(c->series + seriesLen - strlen(warmupSuffix), warmupSuffix) ) continue;
+
+        for ( j = 0; j < baseline->nColumns; j++ ) {
+            SampleFileColumn    *candidate = &baseline->columns[j];
+
+            if ( ! strcmp(candidate->series, c->series) && ! strcasecmp(candidate->metric, c->metric) &&
+                 (candidate->n == c->n) && (candidate->threads == c->threads)
+            ) {
+                b = candidate;
+                break;
+            }
+        }
+        if ( ! b ) {
+            ResultTableAddRow(results, c->series, c->n, (long)c->threads, NAN, NAN, NAN, NAN, NAN, NAN, "not in baseline");
+            continue;
+        }
+        x = (double*)malloc((b->nValues ? b->nValues : 1) * sizeof(double));
+        y = (double*)malloc((c->nValues ? c->nValues : 1) * sizeof(double));
+        if ( x && y ) {
+            nx = __SampleFileCopyValues(b, x);
+            ny = __SampleFileCopyValues(c, y);
+        }
+        if ( (nx < 2) || (ny < 2) ) {
+            ResultTableAddRow(results, c->series, c->n, (long)c->threads, NAN, NAN, NAN, NAN, NAN, NAN, "too few samples");
+        } else {
+            medianX = __SampleFileMedian(x, nx);
+            medianY = __SampleFileMedian(y, ny);
+            p = __SampleFileMannWhitneyP(x, nx, y, ny);
+            if ( ! __SampleFileBootstrapRatio(x, nx, y, ny, &ratioLow, &ratioHigh) ) ratioLow = ratioHigh = NAN;
+
+            if ( (p >= SAMPLEFILE_COMPARE_ALPHA) || ! ((ratioLow > 1.0) || (ratioHigh < 1.0)) ) {
+                verdict = "no change";
+            } else if ( medianY < medianX ) {
+                verdict = "faster";
+            } else if ( medianY > (1.0 + threshold) * medianX ) {
+                verdict = "REGRESSION";
+                nRegressions++;
+            } else {
+                verdict = "slower";
+            }
+            ResultTableAddRow(results, c->series, c->n, (long)c->threads, medianX, medianY, medianX / medianY, ratioLow, ratioHigh, p, verdict);
+        }
+        if ( x ) free((void*)x);
+        if ( y ) free((void*)y);
+    }
+    ResultTableRelease(results);
+    return nRegressions;
+}
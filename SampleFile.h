@@ -0,0 +1,155 @@
+/*
+ * SampleFile.h
+ *
+ * Pseudo-class that holds raw per-cycle samples -- columns of values, each
+ * identified by a series (e.g. a multiplication method), a metric, the
+ * matrix dimension, and the thread count -- in memory, and reads and writes
+ * them in a compact binary columnar file:
+ *
+ *     "MMBSMPL1"                       8-byte magic
+ *     uint32  byte-order mark          0x01020304 in the writer's byte order
+ *     uint32  number of columns
+ *
+ * followed by each column:
+ *
+ *     uint32  series length, then the series (no terminating NUL)
+ *     uint32  metric length, then the metric
+ *     int64   matrix dimension (zero if not applicable)
+ *     int32   thread count
+ *     uint64  number of values, then the values as IEEE doubles
+ *
+ * Missing values (cycles that did not produce the metric) are stored as NaN.
+ * The samples can also be written in "tidy" form (one row per value with
+ * series, metric, n, threads, cycle, and value columns) in any of the
+ * ExecutionTimer output formats, e.g. CSV.
+ */
+
+#ifndef __SAMPLEFILE_H__
+#define __SAMPLEFILE_H__
+
+#include "ExecutionTimer.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/*!
+ * @defined SAMPLEFILE_COMPARE_ALPHA
+ *
+ * Significance level of the comparison of two distributions.
+ */
+#define SAMPLEFILE_COMPARE_ALPHA 0.05
+
+/*!
+ * @typedef SampleFileRef
+ *
+ * Type of a reference to a SampleFile object.
+ */
+typedef struct SampleFile * SampleFileRef;
+
+/*!
+ * @function SampleFileCreate
+ *
+ * Allocate an empty SampleFile.
+ */
+SampleFileRef SampleFileCreate(void);
+
+/*!
+ * @function SampleFileCreateWithPath
+ *
+ * Read the binary sample file at path.  Returns NULL (after displaying an
+ * error message on stderr) if the file cannot be read or is malformed.
+ */
+SampleFileRef SampleFileCreateWithPath(const char *path);
+
+/*!
+ * @function SampleFileRetain
+ *
+ * Increase the reference count of aFile.
+ */
+SampleFileRef SampleFileRetain(SampleFileRef aFile);
+
+/*!
+ * @function SampleFileRelease
+ *
+ * Decrease the reference count of aFile, deallocating it once it reaches
+ * zero.  Samples are not saved implicitly.
+ */
+void SampleFileRelease(SampleFileRef aFile);
+
+/*!
+ * @function SampleFileAddColumn
+ *
+ * Append a copy of nValues values as a new column.
+ *
+ * Returns boolean false if memory could not be allocated.
+ */
+bool SampleFileAddColumn(SampleFileRef aFile, const char *series, const char *metric, long n, int threads, unsigned long nValues, const double *values);
+
+/*!
+ * @function SampleFileAddTimer
+ *
+ * Append a column for each metric of aTimer that produced at least one of
+ * the samples it recorded (see ExecutionTimerSetShouldRecordSamples()).
+ *
+ * Returns boolean false if memory could not be allocated.
+ */
+bool SampleFileAddTimer(SampleFileRef aFile, const char *series, long n, int threads, ExecutionTimerRef aTimer);
+
+/*!
+ * @function SampleFileGetColumnCount
+ *
+ * Returns the number of columns in aFile.
+ */
+unsigned int SampleFileGetColumnCount(SampleFileRef aFile);
+
+/*!
+ * @function SampleFileGetColumn
+ *
+ * Returns the number of values in column index of aFile and, in the
+ * (optional) out arguments, its series, metric, dimension, thread count,
+ * and values (all owned by aFile).  Returns zero for an invalid index.
+ */
+unsigned long SampleFileGetColumn(SampleFileRef aFile, unsigned int index, const char* *outSeries, const char* *outMetric, long *outN, int *outThreads, const double* *outValues);
+
+/*!
+ * @function SampleFileWrite
+ *
+ * Write aFile in the binary columnar format to path.
+ *
+ * Returns boolean false (after displaying an error message on stderr) if
+ * the file could not be written.
+ */
+bool SampleFileWrite(SampleFileRef aFile, const char *path);
+
+/*!
+ * @function SampleFileSummarizeToStream
+ *
+ * Write the samples to stream in tidy form in the given format.  Only
+ * columns whose series and metric match the (optional, case-insensitive)
+ * series and metric filters are written, and missing values are skipped.
+ */
+void SampleFileSummarizeToStream(SampleFileRef aFile, ExecutionTimerOutputFormat format, const char *series, const char *metric, FILE *stream);
+
+/*!
+ * @function SampleFileCompareToStream
+ *
+ * Compare every column of the given metric in current with the column of
+ * the same series, metric, dimension, and thread count in baseline and
+ * write one row per column to stream in the given format.  Values are taken
+ * to be costs (lower is better), e.g. walltimes.  Warm-up series (named
+ * "<series> warm-up") are not compared.
+ *
+ * Each row gives both medians, the speedup (baseline median over current
+ * median), the bootstrap 95% confidence interval of the ratio of medians
+ * (current over baseline), and the two-sided p-value of a Mann-Whitney U
+ * test.  A difference is significant if p is below SAMPLEFILE_COMPARE_ALPHA
+ * and the confidence interval excludes 1; the verdict is "faster",
+ * "slower", "no change", or -- for a significant slowdown larger than the
+ * fraction threshold -- "REGRESSION".  Columns missing from baseline or
+ * with fewer than two values on either side are listed without statistics.
+ *
+ * Returns the number of regressions.
+ */
+unsigned int SampleFileCompareToStream(SampleFileRef baseline, SampleFileRef current, const char *metric, double threshold, ExecutionTimerOutputFormat format, FILE *stream);
+
+#endif /* __SAMPLEFILE_H__ */
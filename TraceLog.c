@@ -0,0 +1,307 @@
+/*
+ * TraceLog.c
+ *
+ * Process-wide recorder of timeline events in the Chrome trace-event JSON
+ * format.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "TraceLog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+
+//
+
+typedef struct TraceLogEvent {
+    uint64_t                timestamp;
+    const char              *category;
+    const char              *argName;
+    double                  argValue;
+    TraceLogPhase           phase;
+    char                    name[TRACELOG_MAX_NAME_LENGTH + 1];
+} TraceLogEvent;
+
+typedef struct TraceLogThread {
+    struct TraceLogThread   *next;
+    pid_t                   tid;
+    unsigned long           nEvents;
+    TraceLogEvent           events[];
+} TraceLogThread;
+
+//
+
+static atomic_bool                  __TraceLogIsOpen = false;
+static FILE                         *__TraceLogFile = NULL;
+static char                         *__TraceLogPath = NULL;
+static unsigned int                 __TraceLogCapacity = 0;
+static uint64_t                     __TraceLogEpoch = 0;
+static _Atomic(TraceLogThread*)     __TraceLogThreads = NULL;
+
+//
+// Every open/close cycle is a new generation, so a thread's cached ring from
+// an earlier generation (already freed) is never reused:
+//
+static atomic_ulong                 __TraceLogGeneration = 1;
+
+static __thread TraceLogThread      *__TraceLogThisThread = NULL;
+static __thread unsigned long       __TraceLogThisGeneration = 0;
+
+static const char                   *__TraceLogPhaseCodes[TraceLogPhaseMax] = { "B", "E", "i" };
+
+//
+
+static inline uint64_t
+__TraceLogNow(void)
+{
+    struct timespec         t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+//
+
+TraceLogThread*
+__TraceLogGetThread(void)
+{
+    unsigned long           generation = atomic_load_explicit(&__TraceLogGeneration, memory_order_acquire);
+    TraceLogThread          *thread;
+
+    if ( __TraceLogThisGeneration == generation ) return __TraceLogThisThread;
+
+    thread = (TraceLogThread*)malloc(sizeof(TraceLogThread) + __TraceLogCapacity * sizeof(TraceLogEvent));
+    if ( thread ) {
+        thread->tid = (pid_t)syscall(SYS_gettid);
+        thread->nEvents = 0;
+        thread->next = atomic_load_explicit(&__TraceLogThreads, memory_order_relaxed);
+        while ( ! atomic_compare_exchange_weak_explicit(&__TraceLogThreads, &thread->next, thread, memory_order_release, memory_order_relaxed) );
+    }
+    // A failed allocation is not retried for this generation:
+    __TraceLogThisThread = thread;
+    __TraceLogThisGeneration = generation;
+    return thread;
+}
+
+//
+
+void
+__TraceLogAtExit(void)
+{
+    TraceLogClose();
+}
+
+//
+
+bool
+TraceLogOpen(
+    const char              *path,
+    unsigned int            capacity
+)
+{
+    static bool             isAtExitRegistered = false;
+
+    if ( atomic_load(&__TraceLogIsOpen) ) {
+        fprintf(stderr, "ERROR:  trace log is already open\n");
+        return false;
+    }
+    if ( ! (__TraceLogFile = fopen(path, "w")) ) {
+        fprintf(stderr, "ERROR:  unable to create trace file %s (errno = %d)\n", path, errno);
+        return false;
+    }
+    if ( ! (__TraceLogPath = strdup(path)) ) {
+        fclose(__TraceLogFile);
+        __TraceLogFile = NULL;
+        fprintf(stderr, "ERROR:  unable to allocate trace log\n");
+        return false;
+    }
+    __TraceLogCapacity = capacity ? capacity : TRACELOG_DEFAULT_CAPACITY;
+    __TraceLogEpoch = __TraceLogNow();
+    if ( ! isAtExitRegistered ) {
+        atexit(__TraceLogAtExit);
+        isAtExitRegistered = true;
+    }
+    if ( ! __TraceLogGetThread() ) {
+        fclose(__TraceLogFile);
+        __TraceLogFile = NULL;
+        free((void*)__TraceLogPath);
+        __TraceLogPath = NULL;
+        atomic_fetch_add(&__TraceLogGeneration, 1);
+        fprintf(stderr, "ERROR:  unable to allocate trace log\n");
+        return false;
+    }
+    atomic_store_explicit(&__TraceLogIsOpen, true, memory_order_release);
+    return true;
+}
+
+//
+
+bool
+TraceLogIsOpen(void)
+{
+    return atomic_load_explicit(&__TraceLogIsOpen, memory_order_relaxed);
+}
+
+//
+
+void
+TraceLogAddEvent(
+    TraceLogPhase           phase,
+    const char              *category,
+    const char              *name,
+    const char              *argName,
+    double                  argValue
+)
+{
+    TraceLogThread          *thread;
+    TraceLogEvent           *event;
+
+    if ( ! atomic_load_explicit(&__TraceLogIsOpen, memory_order_acquire) || (phase >= TraceLogPhaseMax) ) return;
+    if ( ! (thread = __TraceLogGetThread()) ) return;
+
+    event = &thread->events[thread->nEvents++ % __TraceLogCapacity];
+    event->timestamp = __TraceLogNow();
+    event->phase = phase;
+    event->category = category ? category : "";
+    event->argName = argName;
+    event->argValue = argValue;
+    if ( name ) {
+        strncpy(event->name, name, TRACELOG_MAX_NAME_LENGTH);
+        event->name[TRACELOG_MAX_NAME_LENGTH] = '\0';
+    } else {
+        event->name[0] = '\0';
+    }
+}
+
+//
+
+void
+TraceLogBegin(
+    const char              *category,
+    const char              *name
+)
+{
+    TraceLogAddEvent(TraceLogPhaseBegin, category, name, NULL, 0.0);
+}
+
+//
+
+void
+TraceLogEnd(
+    const char              *category,
+    const char              *name
+)
+{
+    TraceLogAddEvent(TraceLogPhaseEnd, category, name, NULL, 0.0);
+}
+
+//
+
+void
+__TraceLogWriteString(
+    FILE                    *fptr,
+    const char              *s
+)
+{
+    fputc('"', fptr);
+    while ( *s ) {
+        unsigned char       c = (unsigned char)*s++;
+
+        if ( (c == '"') || (c == '\\') ) {
+            fputc('\\', fptr);
+            fputc(c, fptr);
+        } else if ( c < 0x20 ) {
+            fprintf(fptr, "\\u%04x", c);
+        } else {
+            fputc(c, fptr);
+        }
+    }
+    fputc('"', fptr);
+}
+
+//
+
+bool
+TraceLogClose(void)
+{
+    TraceLogThread          *thread;
+    unsigned long           nDropped = 0;
+    const char              *sep = "\n";
+    pid_t                   pid = getpid();
+    bool                    ok;
+
+    if ( ! atomic_exchange(&__TraceLogIsOpen, false) ) return true;
+
+    fprintf(__TraceLogFile, "{\"traceEvents\":[");
+    for ( thread = atomic_load(&__TraceLogThreads); thread; thread = thread->next ) {
+        unsigned long       i, first = 0, count = thread->nEvents;
+
+        //
+        // Name the thread, then emit its events oldest first (a full ring
+        // starts at the slot that will be overwritten next):
+        //
+        fprintf(__TraceLogFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", sep, (int)pid, (int)thread->tid);
+        if ( thread->tid == pid ) {
+            fprintf(__TraceLogFile, "\"main\"}}");
+        } else {
+            fprintf(__TraceLogFile, "\"thread %d\"}}", (int)thread->tid);
+        }
+        sep = ",\n";
+        if ( count > __TraceLogCapacity ) {
+            nDropped += count - __TraceLogCapacity;
+            first = count % __TraceLogCapacity;
+            count = __TraceLogCapacity;
+        }
+        for ( i = 0; i < count; i++ ) {
+            TraceLogEvent   *event = &thread->events[(first + i) % __TraceLogCapacity];
+
+            fprintf(__TraceLogFile, "%s{\"name\":", sep);
+            __TraceLogWriteString(__TraceLogFile, event->name);
+            fprintf(__TraceLogFile, ",\"cat\":");
+            __TraceLogWriteString(__TraceLogFile, event->category);
+            fprintf(__TraceLogFile, ",\"ph\":\"%s\",\"ts\":%.3lf,\"pid\":%d,\"tid\":%d",
+                    __TraceLogPhaseCodes[event->phase],
+                    1e-3 * (double)(event->timestamp - __TraceLogEpoch),
+                    (int)pid, (int)thread->tid
+                );
+            // Instant events are scoped to their thread:
+            if ( event->phase == TraceLogPhaseInstant ) fprintf(__TraceLogFile, ",\"s\":\"t\"");
+            if ( event->argName ) {
+                fprintf(__TraceLogFile, ",\"args\":{");
+                __TraceLogWriteString(__TraceLogFile, event->argName);
+                fprintf(__TraceLogFile, ":%.17lg}", event->argValue);
+            }
+            fputc('}', __TraceLogFile);
+        }
+    }
+    fprintf(__TraceLogFile, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"droppedEvents\":%lu}}\n", nDropped);
+
+    ok = (ferror(__TraceLogFile) == 0);
+    if ( fclose(__TraceLogFile) != 0 ) ok = false;
+    if ( ! ok ) fprintf(stderr, "ERROR:  unable to write trace file %s (errno = %d)\n", __TraceLogPath, errno);
+    if ( nDropped ) fprintf(stderr, "WARNING:  %lu trace event(s) were overwritten; the trace holds the last %u per thread\n", nDropped, __TraceLogCapacity);
+
+    thread = atomic_exchange(&__TraceLogThreads, NULL);
+    while ( thread ) {
+        TraceLogThread      *next = thread->next;
+
+        free((void*)thread);
+        thread = next;
+    }
+    atomic_fetch_add(&__TraceLogGeneration, 1);
+    __TraceLogFile = NULL;
+    free((void*)__TraceLogPath);
+    __TraceLogPath = NULL;
+    return ok;
+}
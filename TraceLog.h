@@ -0,0 +1,117 @@
+/*
+ * TraceLog.h
+ *
+ * Process-wide recorder of timeline events in the Chrome trace-event JSON
+ * format, which can be loaded into chrome://tracing or Perfetto.
+ *
+ * Each thread records events into its own ring buffer, allocated when the
+ * thread records its first event (the opening thread's buffer is allocated
+ * by TraceLogOpen()), so recording an event takes no locks and no system
+ * calls beyond reading CLOCK_MONOTONIC.  When a ring is full the oldest
+ * events are overwritten.  Nothing is written to the trace file until the
+ * log is closed -- explicitly, or at the latest when the program exits.
+ */
+
+#ifndef __TRACELOG_H__
+#define __TRACELOG_H__
+
+#include <stdbool.h>
+
+/*!
+ * @defined TRACELOG_DEFAULT_CAPACITY
+ *
+ * Default number of events held by each thread's ring buffer.
+ */
+#define TRACELOG_DEFAULT_CAPACITY 65536
+
+/*!
+ * @defined TRACELOG_MAX_NAME_LENGTH
+ *
+ * Event names are copied into the ring buffer and truncated to this many
+ * characters.
+ */
+#define TRACELOG_MAX_NAME_LENGTH 47
+
+/*!
+ * @enum TraceLogPhase
+ *
+ * The kinds of event that can be recorded:
+ *
+ *     TraceLogPhaseBegin:    start of a span on the calling thread ("B")
+ *     TraceLogPhaseEnd:      end of the innermost open span ("E")
+ *     TraceLogPhaseInstant:  a point in time ("i")
+ */
+enum {
+    TraceLogPhaseBegin = 0,
+    TraceLogPhaseEnd,
+    TraceLogPhaseInstant,
+    //
+    TraceLogPhaseMax
+};
+
+/*!
+ * @typedef TraceLogPhase
+ *
+ * Type used in conjunction with the TraceLogPhase enumeration.
+ */
+typedef unsigned int TraceLogPhase;
+
+/*!
+ * @function TraceLogOpen
+ *
+ * Start recording events that will be written to the file at path.  Each
+ * thread's ring buffer holds capacity events (TRACELOG_DEFAULT_CAPACITY if
+ * zero).  The file is created immediately so that an unwritable path is
+ * reported up front.
+ *
+ * Returns boolean false (after displaying an error message on stderr) if
+ * the log is already open, the file cannot be created, or memory could not
+ * be allocated.
+ */
+bool TraceLogOpen(const char *path, unsigned int capacity);
+
+/*!
+ * @function TraceLogIsOpen
+ *
+ * Returns boolean true if events are being recorded.
+ */
+bool TraceLogIsOpen(void);
+
+/*!
+ * @function TraceLogAddEvent
+ *
+ * Record an event on the calling thread.  The category and argName must be
+ * string constants (they are not copied); the name is copied.  If argName
+ * is not NULL the event carries a single numeric argument.  Does nothing if
+ * the log is not open.
+ */
+void TraceLogAddEvent(TraceLogPhase phase, const char *category, const char *name, const char *argName, double argValue);
+
+/*!
+ * @function TraceLogBegin
+ *
+ * Record the start of a span on the calling thread.
+ */
+void TraceLogBegin(const char *category, const char *name);
+
+/*!
+ * @function TraceLogEnd
+ *
+ * Record the end of the innermost open span on the calling thread.
+ */
+void TraceLogEnd(const char *category, const char *name);
+
+/*!
+ * @function TraceLogClose
+ *
+ * Stop recording and write every thread's events to the trace file, then
+ * release the ring buffers.  No other thread may be recording events.  A
+ * warning is displayed if events were overwritten.  Does nothing (and
+ * returns boolean true) if the log is not open.
+ *
+ * Returns boolean false (after displaying an error message on stderr) if
+ * the file could not be written.
+ */
+bool TraceLogClose(void);
+
+#endif /* __TRACELOG_H__ */
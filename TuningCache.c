@@ -0,0 +1,333 @@
+/*
+ * TuningCache.c
+ *
+ * Pseudo-class that maintains the persistent autotuning results.
+ */
+
+#include "TuningCache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//
+
+typedef struct TuningCacheRecord {
+    char            *fingerprint;
+    long            n;
+    char            *spec;
+    int             threads;
+    double          gflops;
+} TuningCacheRecord_t;
+
+typedef struct TuningCache {
+    unsigned int        refCount;
+    char                *path;
+    char                *fingerprint;
+    unsigned int        nRecords;
+    unsigned int        capacity;
+    TuningCacheRecord_t *records;
+} TuningCache;
+
+//
+
+const char*
+TuningCacheDefaultPath(void)
+{
+    static char     defaultPath[4096];
+    const char      *s;
+
+    if ( (s = getenv("MMBENCH_TUNING_CACHE")) && *s ) return s;
+    if ( (s = getenv("XDG_CACHE_HOME")) && *s ) {
+        snprintf(defaultPath, sizeof(defaultPath), "%s/mmbench/tuning.cache", s);
+        return (const char*)defaultPath;
+    }
+    if ( (s = getenv("HOME")) && *s ) {
+        snprintf(defaultPath, sizeof(defaultPath), "%s/.cache/mmbench/tuning.cache", s);
+        return (const char*)defaultPath;
+    }
+    return NULL;
+}
+
+//
+
+bool
+__TuningCacheAppend(
+    TuningCache     *aCache,
+    const char      *fingerprint,
+    long            n,
+    const char      *spec,
+    int             threads,
+    double          gflops
+)
+{
+    TuningCacheRecord_t *r;
+
+    if ( aCache->nRecords == aCache->capacity ) {
+        unsigned int        newCapacity = aCache->capacity ? (2 * aCache->capacity) : 32;
+        TuningCacheRecord_t *newRecords = (TuningCacheRecord_t*)realloc(aCache->records, newCapacity * sizeof(TuningCacheRecord_t));
+
+        if ( ! newRecords ) return false;
+        aCache->records = newRecords;
+        aCache->capacity = newCapacity;
+    }
+    r = &aCache->records[aCache->nRecords];
+    r->fingerprint = strdup(fingerprint);
+    r->spec = strdup(spec);
+    if ( ! r->fingerprint || ! r->spec ) {
+        if ( r->fingerprint ) free((void*)r->fingerprint);
+        if ( r->spec ) free((void*)r->spec);
+        return false;
+    }
+    r->n = n;
+    r->threads = threads;
+    r->gflops = gflops;
+    aCache->nRecords++;
+    return true;
+}
+
+//
+
+void
+__TuningCacheLoad(
+    TuningCache     *aCache
+)
+{
+    FILE            *fptr = fopen(aCache->path, "r");
+    char            line[8192];
+    unsigned int    lineNo = 0;
+
+    if ( ! fptr ) return;
+    while ( fgets(line, sizeof(line), fptr) ) {
+        char        *fields[5], *p = line;
+        int         nFields = 0;
+
+        lineNo++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if ( (*line == '#') || (*line == '\0') ) continue;
+        while ( nFields < 5 ) {
+            fields[nFields++] = p;
+            if ( ! (p = strchr(p, '\t')) ) break;
+            *p++ = '\0';
+        }
+        if ( nFields != 5 ) {
+            fprintf(stderr, "WARNING:  ignoring malformed line %u of tuning cache %s\n", lineNo, aCache->path);
+            continue;
+        }
+        __TuningCacheAppend(aCache, fields[0], strtol(fields[1], NULL, 10), fields[2], (int)strtol(fields[3], NULL, 10), strtod(fields[4], NULL));
+    }
+    fclose(fptr);
+}
+
+//
+
+TuningCacheRef
+TuningCacheCreate(
+    const char      *path,
+    const char      *fingerprint
+)
+{
+    TuningCache     *newCache;
+
+    if ( ! path && ! (path = TuningCacheDefaultPath()) ) {
+        fprintf(stderr, "ERROR:  no tuning cache path could be determined\n");
+        return NULL;
+    }
+    if ( (newCache = (TuningCache*)malloc(sizeof(TuningCache))) ) {
+        newCache->refCount = 1;
+        newCache->path = strdup(path);
+        newCache->fingerprint = strdup(fingerprint);
+        newCache->nRecords = newCache->capacity = 0;
+        newCache->records = NULL;
+        if ( ! newCache->path || ! newCache->fingerprint ) {
+            TuningCacheRelease(newCache);
+            return NULL;
+        }
+        __TuningCacheLoad(newCache);
+    }
+    return (TuningCacheRef)newCache;
+}
+
+//
+
+TuningCacheRef
+TuningCacheRetain(
+    TuningCacheRef  aCache
+)
+{
+    aCache->refCount++;
+    return aCache;
+}
+
+//
+
+void
+TuningCacheRelease(
+    TuningCacheRef  aCache
+)
+{
+    if ( --(aCache->refCount) == 0 ) {
+        unsigned int    i;
+
+        for ( i = 0; i < aCache->nRecords; i++ ) {
+            free((void*)aCache->records[i].fingerprint);
+            free((void*)aCache->records[i].spec);
+        }
+        if ( aCache->records ) free((void*)aCache->records);
+        if ( aCache->path ) free((void*)aCache->path);
+        if ( aCache->fingerprint ) free((void*)aCache->fingerprint);
+        free((void*)aCache);
+    }
+}
+
+//
+
+const char*
+TuningCacheGetPath(
+    TuningCacheRef  aCache
+)
+{
+    return (const char*)aCache->path;
+}
+
+//
+
+unsigned int
+TuningCacheGetCount(
+    TuningCacheRef  aCache
+)
+{
+    unsigned int    i, count = 0;
+
+    for ( i = 0; i < aCache->nRecords; i++ ) if ( strcmp(aCache->records[i].fingerprint, aCache->fingerprint) == 0 ) count++;
+    return count;
+}
+
+//
+
+bool
+TuningCacheLookup(
+    TuningCacheRef  aCache,
+    long            n,
+    const char*     *outSpec,
+    int             *outThreads,
+    double          *outGFLOPs
+)
+{
+    TuningCacheRecord_t *best = NULL;
+    double              bestDistance = INFINITY;
+    unsigned int        i;
+
+    //
+    // First find the recorded dimension nearest n (on a log scale), then the
+    // fastest configuration at that dimension:
+    //
+    for ( i = 0; i < aCache->nRecords; i++ ) {
+        TuningCacheRecord_t *r = &aCache->records[i];
+        double              distance;
+
+        if ( (r->n <= 0) || strcmp(r->fingerprint, aCache->fingerprint) ) continue;
+        distance = fabs(log((double)r->n / (double)n));
+        if ( ! best || (distance < bestDistance) || ((r->n == best->n) && (r->gflops > best->gflops)) ) {
+            best = r;
+            bestDistance = distance;
+        }
+    }
+    if ( ! best ) return false;
+    if ( outSpec ) *outSpec = (const char*)best->spec;
+    if ( outThreads ) *outThreads = best->threads;
+    if ( outGFLOPs ) *outGFLOPs = best->gflops;
+    return true;
+}
+
+//
+
+bool
+TuningCacheRecord(
+    TuningCacheRef  aCache,
+    long            n,
+    const char      *methodSpec,
+    int             threads,
+    double          gflops
+)
+{
+    size_t          methodLen = strcspn(methodSpec, "=");
+    unsigned int    i;
+
+    for ( i = 0; i < aCache->nRecords; i++ ) {
+        TuningCacheRecord_t *r = &aCache->records[i];
+
+        if ( (r->n == n) && (strcmp(r->fingerprint, aCache->fingerprint) == 0) &&
+             (strcspn(r->spec, "=") == methodLen) && (strncasecmp(r->spec, methodSpec, methodLen) == 0)
+        ) {
+            char            *newSpec = strdup(methodSpec);
+
+            if ( ! newSpec ) return false;
+            free((void*)r->spec);
+            r->spec = newSpec;
+            r->threads = threads;
+            r->gflops = gflops;
+            return true;
+        }
+    }
+    return __TuningCacheAppend(aCache, aCache->fingerprint, n, methodSpec, threads, gflops);
+}
+
+//
+
+bool
+TuningCacheSave(
+    TuningCacheRef  aCache
+)
+{
+    size_t          pathLen = strlen(aCache->path);
+    char            tmpPath[pathLen + 32], dirPath[pathLen + 1], *slash;
+    FILE            *fptr;
+    unsigned int    i;
+
+    //
+    // Create the parent directory (and its parents) as needed:
+    //
+    strcpy(dirPath, aCache->path);
+    if ( (slash = strrchr(dirPath, '/')) && (slash > dirPath) ) {
+        char        *p = dirPath + 1;
+
+        *slash = '\0';
+        while ( 1 ) {
+            char    *nextSlash = strchr(p, '/');
+
+            if ( nextSlash ) *nextSlash = '\0';
+            if ( (mkdir(dirPath, 0755) != 0) && (errno != EEXIST) ) {
+                fprintf(stderr, "ERROR:  unable to create directory %s (errno = %d)\n", dirPath, errno);
+                return false;
+            }
+            if ( ! nextSlash ) break;
+            *nextSlash = '/';
+            p = nextSlash + 1;
+        }
+    }
+
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp.%ld", aCache->path, (long)getpid());
+    if ( ! (fptr = fopen(tmpPath, "w")) ) {
+        fprintf(stderr, "ERROR:  unable to write tuning cache %s (errno = %d)\n", tmpPath, errno);
+        return false;
+    }
+    fprintf(fptr, "# mmbench tuning cache\n# fingerprint\tn\tmethod\tthreads\tGFLOP/s\n");
+    for ( i = 0; i < aCache->nRecords; i++ ) {
+        TuningCacheRecord_t *r = &aCache->records[i];
+
+        fprintf(fptr, "%s\t%ld\t%s\t%d\t%.6lg\n", r->fingerprint, r->n, r->spec, r->threads, r->gflops);
+    }
+    if ( fclose(fptr) != 0 || rename(tmpPath, aCache->path) != 0 ) {
+        fprintf(stderr, "ERROR:  unable to write tuning cache %s (errno = %d)\n", aCache->path, errno);
+        unlink(tmpPath);
+        return false;
+    }
+    return true;
+}
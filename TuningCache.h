@@ -0,0 +1,112 @@
+/*
+ * TuningCache.h
+ *
+ * Pseudo-class that maintains the persistent autotuning results:  the best
+ * configuration found for each multiplication method and matrix dimension,
+ * keyed by a hardware fingerprint (see MachineInfoGetFingerprint()).
+ *
+ * The cache file is plain text with one tab-delimited record per line:
+ *
+ *     <fingerprint> <n> <method-spec> <threads> <GFLOP/s>
+ *
+ * Lines starting with '#' are comments.  Records for other fingerprints
+ * are preserved when the cache is saved, so a single file can be shared
+ * by heterogeneous nodes (e.g. in a home directory).
+ */
+
+#ifndef __TUNINGCACHE_H__
+#define __TUNINGCACHE_H__
+
+#include <stdbool.h>
+
+/*!
+ * @typedef TuningCacheRef
+ *
+ * Type of a reference to a TuningCache object.
+ */
+typedef struct TuningCache * TuningCacheRef;
+
+/*!
+ * @function TuningCacheDefaultPath
+ *
+ * Returns the default path of the tuning cache file:  the value of the
+ * MMBENCH_TUNING_CACHE environment variable, else
+ * $XDG_CACHE_HOME/mmbench/tuning.cache, else
+ * $HOME/.cache/mmbench/tuning.cache.  Returns NULL if none can be
+ * determined.
+ */
+const char* TuningCacheDefaultPath(void);
+
+/*!
+ * @function TuningCacheCreate
+ *
+ * Load the tuning cache at path (a missing file yields an empty cache)
+ * for the hardware with the given fingerprint.  If path is NULL the
+ * default path is used.
+ */
+TuningCacheRef TuningCacheCreate(const char *path, const char *fingerprint);
+
+/*!
+ * @function TuningCacheRetain
+ *
+ * Increase the reference count of aCache.
+ */
+TuningCacheRef TuningCacheRetain(TuningCacheRef aCache);
+
+/*!
+ * @function TuningCacheRelease
+ *
+ * Decrease the reference count of aCache, deallocating it once it reaches
+ * zero.  Changes are not saved implicitly.
+ */
+void TuningCacheRelease(TuningCacheRef aCache);
+
+/*!
+ * @function TuningCacheGetPath
+ *
+ * Returns the path of the file backing aCache.
+ */
+const char* TuningCacheGetPath(TuningCacheRef aCache);
+
+/*!
+ * @function TuningCacheGetCount
+ *
+ * Returns the number of records in aCache that match its fingerprint.
+ */
+unsigned int TuningCacheGetCount(TuningCacheRef aCache);
+
+/*!
+ * @function TuningCacheLookup
+ *
+ * Find the fastest configuration recorded for this hardware at the matrix
+ * dimension closest (by ratio) to n.  On success the method specification,
+ * thread count, and GFLOP/s are returned in the (optional) out arguments;
+ * the specification string is owned by aCache.
+ *
+ * Returns boolean false if no record matches the fingerprint.
+ */
+bool TuningCacheLookup(TuningCacheRef aCache, long n, const char* *outSpec, int *outThreads, double *outGFLOPs);
+
+/*!
+ * @function TuningCacheRecord
+ *
+ * Record the best configuration of a method at dimension n, replacing any
+ * existing record for the same method (the portion of methodSpec before
+ * any '=') and dimension.
+ *
+ * Returns boolean false if memory could not be allocated.
+ */
+bool TuningCacheRecord(TuningCacheRef aCache, long n, const char *methodSpec, int threads, double gflops);
+
+/*!
+ * @function TuningCacheSave
+ *
+ * Write aCache back to its file (atomically, via a temporary file and
+ * rename()), creating the parent directory if necessary.
+ *
+ * Returns boolean false (after displaying an error message on stderr) if
+ * the file could not be written.
+ */
+bool TuningCacheSave(TuningCacheRef aCache);
+
+#endif /* __TUNINGCACHE_H__ */
@@ -0,0 +1,682 @@
+/*
+ * mmbench-aggregate.c
+ *
+ * Fleet aggregation of mmbench --screen records:  reads the single-line JSON
+ * records written by many nodes, groups them by hardware fingerprint (and
+ * precision, thread count, dimension, and routine), computes robust fleet
+ * statistics, and lists the nodes that fall below a percentile of their
+ * group or below an expected GFLOP/s.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <getopt.h>
+#include <errno.h>
+#include <math.h>
+
+#include "ResultTable.h"
+#include "ResultEmitter.h"
+#include "ExecutionTimer.h"
+
+//
+// Various compile-time constants that act as default values for
+// some of the CLI options:
+//
+#define DEFAULT_OUTPUT_FORMAT       "table"
+#define DEFAULT_PERCENTILE          5.0
+#define DEFAULT_MIN_DEVIATION       5.0
+
+//
+// Record format written by mmbench --screen:
+//
+#define SCREEN_FORMAT_TAG           "mmbench-screen-1"
+
+//
+// Scale factor that makes the MAD a consistent estimator of the standard
+// deviation of normally-distributed data:
+//
+#define MAD_TO_SIGMA                1.4826
+
+//
+// Exit status when any node is flagged:
+//
+#define EXIT_SLOW_NODES             2
+
+//
+// CLI options this program recognizes:
+//
+struct option cli_opts[] = {
+        { "help",           no_argument,        NULL,           'h' },
+        { "verbose",        no_argument,        NULL,           'v' },
+        { "format",         required_argument,  NULL,           'f' },
+        { "percentile",     required_argument,  NULL,           'p' },
+        { "min-deviation",  required_argument,  NULL,           'm' },
+        { "expect",         required_argument,  NULL,           'e' },
+        { NULL,             0,                  0,              0   }
+    };
+
+const char *cli_optstring = "hvf:p:m:e:";
+
+//
+// Make verbosity a global:
+//
+unsigned int        verbosity = 0;
+
+#define WARN(F, ...) if (verbosity >= 1) fprintf(stderr, "WARNING(%s:%d)  " F "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+#define ERROR(F, ...) fprintf(stderr, "ERROR(%s:%d)  " F "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+
+//
+// Writes a program usage help screen and exits.
+//
+void
+usage(
+    const char      *exe
+)
+{
+    printf(
+        "usage:\n\n"
+        "  %s [options] {<record-file> ...}\n\n"
+        "  Reads mmbench --screen records (one JSON object per line) from each file,\n"
+        "  or from stdin if none are given (or for \"-\").\n\n"
+        " options:\n\n"
+        "  -h/--help                            display this information\n"
+        "  -v/--verbose                         increase the amount of information displayed\n"
+        "  -f/--format <format>                 output format (default: %s)\n\n"
+        "      <format> = (%s)\n\n"
+        "  -p/--percentile <real>               flag nodes below this percentile of their group's\n"
+        "                                       GFLOP/s (default: %lg); zero disables\n"
+        "  -m/--min-deviation <real>            only flag nodes below the percentile that are also\n"
+        "                                       at least this many percent below their group's\n"
+        "                                       median (default: %lg)\n"
+        "  -e/--expect <routine>=<real>         flag nodes whose GFLOP/s for <routine> is below\n"
+        "                                       this value; may be repeated\n"
+        "\n"
+        " The exit status is %d if any node was flagged.\n"
+        "\n",
+        exe,
+        DEFAULT_OUTPUT_FORMAT,
+        ExecutionTimerOutputFormats(),
+        DEFAULT_PERCENTILE,
+        DEFAULT_MIN_DEVIATION,
+        (int)EXIT_SLOW_NODES
+      );
+    exit(0);
+}
+
+//
+// One routine's result on one node:
+//
+typedef struct {
+    char            *host;
+    char            *fingerprint;
+    char            *precision;
+    char            *method;
+    int             threads;
+    long            n;
+    double          gflops;
+    // Filled in once the node's group has been summarized:
+    double          groupMedian;
+    double          groupMAD;
+    const char      *reason;
+} NodeResult;
+
+typedef struct {
+    unsigned int    nResults;
+    unsigned int    capacity;
+    NodeResult      *results;
+} NodeResults;
+
+//
+// An expected GFLOP/s for a routine:
+//
+typedef struct {
+    char            *method;
+    double          gflops;
+} Expectation;
+
+//
+// Minimal JSON scanning for the screen records:  locate a key's value
+// within [p, end) at the current nesting depth and parse strings and
+// numbers.
+//
+const char*
+__JSONSkipString(
+    const char      *p,
+    const char      *end
+)
+{
+    p++;
+    while ( (p < end) && (*p != '"') ) {
+        if ( (*p == '\\') && (p + 1 < end) ) p++;
+        p++;
+    }
+    return (p < end) ? p + 1 : end;
+}
+
+const char*
+__JSONFindValue(
+    const char      *p,
+    const char      *end,
+    const char      *key
+)
+{
+    size_t          keyLen = strlen(key);
+    int             depth = 0;
+
+    while ( p < end ) {
+        if ( *p == '"' ) {
+            const char  *q = __JSONSkipString(p, end);
+
+            if ( (depth == 1) && ((size_t)(q - p) == keyLen + 2) && ! strncmp(p + 1, key, keyLen) ) {
+                while ( (q < end) && ((*q == ' ') || (*q == '\t')) ) q++;
+                if ( (q < end) && (*q == ':') ) {
+                    q++;
+                    while ( (q < end) && ((*q == ' ') || (*q == '\t')) ) q++;
+                    return q;
+                }
+            }
+            p = q;
+            continue;
+        }
+        if ( (*p == '{') || (*p == '[') ) depth++;
+        else if ( (*p == '}') || (*p == ']') ) depth--;
+        p++;
+    }
+    return NULL;
+}
+
+char*
+__JSONParseString(
+    const char      *p,
+    const char      *end
+)
+{
+    char            *s, *q;
+
+    if ( ! p || (p >= end) || (*p != '"') ) return NULL;
+    if ( ! (s = q = (char*)malloc(end - p)) ) return NULL;
+    p++;
+    while ( (p < end) && (*p != '"') ) {
+        if ( (*p == '\\') && (p + 1 < end) ) {
+            p++;
+            switch ( *p ) {
+                case 'n':  *q++ = '\n'; break;
+                case 't':  *q++ = '\t'; break;
+                case 'r':  *q++ = '\r'; break;
+                case 'u': {
+                    // Only control characters are escaped by mmbench:
+                    if ( p + 4 < end ) *q++ = (char)strtol((char[5]){ p[1], p[2], p[3], p[4], '\0' }, NULL, 16);
+                    p += 4;
+                    break;
+                }
+                default:   *q++ = *p; break;
+            }
+            p++;
+        } else {
+            *q++ = *p++;
+        }
+    }
+    *q = '\0';
+    return s;
+}
+
+double
+__JSONParseReal(
+    const char      *p
+)
+{
+    char            *endp;
+    double          v;
+
+    if ( ! p || ! strncmp(p, "null", 4) ) return NAN;
+    v = strtod(p, &endp);
+    return (endp == p) ? NAN : v;
+}
+
+//
+
+void
+NodeResultsAdd(
+    NodeResults     *results,
+    NodeResult      *result
+)
+{
+    if ( results->nResults == results->capacity ) {
+        unsigned int    newCapacity = results->capacity ? (2 * results->capacity) : 256;
+        NodeResult      *newResults = (NodeResult*)realloc(results->results, newCapacity * sizeof(NodeResult));
+
+        if ( ! newResults ) {
+            ERROR("unable to allocate node results");
+            exit(ENOMEM);
+        }
+        results->results = newResults;
+        results->capacity = newCapacity;
+    }
+    results->results[results->nResults++] = *result;
+}
+
+//
+// Parse one screen record, adding a result per routine.  Returns false if
+// the line is not a screen record.
+//
+bool
+ParseRecord(
+    NodeResults     *results,
+    const char      *line
+)
+{
+    const char      *end = line + strlen(line), *p;
+    char            *format, *host, *fingerprint, *precision;
+    int             threads;
+    long            n;
+    bool            isScreenRecord;
+
+    format = __JSONParseString(__JSONFindValue(line, end, "format"), end);
+    isScreenRecord = format && ! strcmp(format, SCREEN_FORMAT_TAG);
+    if ( format ) free((void*)format);
+    if ( ! isScreenRecord ) return false;
+    host = __JSONParseString(__JSONFindValue(line, end, "host"), end);
+    fingerprint = __JSONParseString(__JSONFindValue(line, end, "fingerprint"), end);
+    precision = __JSONParseString(__JSONFindValue(line, end, "precision"), end);
+    threads = (int)__JSONParseReal(__JSONFindValue(line, end, "threads"));
+    n = (long)__JSONParseReal(__JSONFindValue(line, end, "n"));
+    p = __JSONFindValue(line, end, "results");
+    if ( ! host || ! fingerprint || ! precision || ! p || (*p != '[') ) {
+        if ( host ) free((void*)host);
+        if ( fingerprint ) free((void*)fingerprint);
+        if ( precision ) free((void*)precision);
+        return false;
+    }
+
+    //
+    // Each element of the results array is a flat object:
+    //
+    p++;
+    while ( (p = strchr(p, '{')) ) {
+        const char  *q = p + 1;
+        NodeResult  result;
+
+        while ( (q < end) && (*q != '}') ) q = (*q == '"') ? __JSONSkipString(q, end) : q + 1;
+        if ( q >= end ) break;
+        result.method = __JSONParseString(__JSONFindValue(p, q + 1, "method"), q + 1);
+        if ( result.method ) {
+            result.gflops = __JSONParseReal(__JSONFindValue(p, q + 1, "gflops"));
+            result.host = strdup(host);
+            result.fingerprint = strdup(fingerprint);
+            result.precision = strdup(precision);
+            result.threads = threads;
+            result.n = n;
+            if ( ! result.host || ! result.fingerprint || ! result.precision ) {
+                ERROR("unable to allocate node results");
+                exit(ENOMEM);
+            }
+            NodeResultsAdd(results, &result);
+        }
+        p = q + 1;
+    }
+    free((void*)host);
+    free((void*)fingerprint);
+    free((void*)precision);
+    return true;
+}
+
+//
+// Read every screen record from stream.
+//
+void
+ReadRecords(
+    NodeResults     *results,
+    FILE            *stream,
+    const char      *name
+)
+{
+    char            *line = NULL;
+    size_t          lineSize = 0;
+    unsigned long   lineNo = 0;
+
+    while ( getline(&line, &lineSize, stream) != -1 ) {
+        lineNo++;
+        if ( strspn(line, " \t\r\n") == strlen(line) ) continue;
+        if ( ! ParseRecord(results, line) ) WARN("%s:%lu is not an mmbench screen record", name, lineNo);
+    }
+    if ( line ) free((void*)line);
+}
+
+//
+
+int
+__NodeResultCompare(
+    const void      *a,
+    const void      *b
+)
+{
+    const NodeResult    *A = (const NodeResult*)a, *B = (const NodeResult*)b;
+    int                 rc;
+
+    if ( (rc = strcmp(A->fingerprint, B->fingerprint)) ) return rc;
+    if ( (rc = strcmp(A->precision, B->precision)) ) return rc;
+    if ( A->threads != B->threads ) return (A->threads < B->threads) ? -1 : 1;
+    if ( A->n != B->n ) return (A->n < B->n) ? -1 : 1;
+    return strcmp(A->method, B->method);
+}
+
+int
+__DoubleCompare(
+    const void      *a,
+    const void      *b
+)
+{
+    double          A = *((const double*)a), B = *((const double*)b);
+
+    return (A < B) ? -1 : ((A > B) ? 1 : 0);
+}
+
+//
+// Linear interpolation between the closest ranks of the sorted values:
+//
+double
+SortedPercentile(
+    const double    *sorted,
+    unsigned int    n,
+    double          percentile
+)
+{
+    double          rank = 0.01 * percentile * (double)(n - 1);
+    unsigned int    lo = (unsigned int)floor(rank);
+
+    if ( lo + 1 >= n ) return sorted[n - 1];
+    return sorted[lo] + (rank - (double)lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+double
+SortedMedian(
+    const double    *sorted,
+    unsigned int    n
+)
+{
+    return (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+//
+// Columns of the two tables:
+//
+static const ResultTableColumn FleetResultColumns[] = {
+                { "fingerprint", ResultTableColumnTypeString },
+                { "precision", ResultTableColumnTypeString },
+                { "threads", ResultTableColumnTypeInteger },
+                { "n", ResultTableColumnTypeInteger },
+                { "method", ResultTableColumnTypeString },
+                { "nodes", ResultTableColumnTypeInteger },
+                { "median GFLOP/s", ResultTableColumnTypeReal },
+                { "MAD", ResultTableColumnTypeReal },
+                { "pctl GFLOP/s", ResultTableColumnTypeReal },
+                { "min GFLOP/s", ResultTableColumnTypeReal },
+                { "max GFLOP/s", ResultTableColumnTypeReal }
+            };
+
+static const ResultTableColumn SlowNodeResultColumns[] = {
+                { "host", ResultTableColumnTypeString },
+                { "fingerprint", ResultTableColumnTypeString },
+                { "threads", ResultTableColumnTypeInteger },
+                { "method", ResultTableColumnTypeString },
+                { "GFLOP/s", ResultTableColumnTypeReal },
+                { "% of median", ResultTableColumnTypeReal },
+                { "robust z", ResultTableColumnTypeReal },
+                { "reason", ResultTableColumnTypeString }
+            };
+
+//
+
+int
+main(
+    int                 argc,
+    char* const         argv[]
+)
+{
+    const char                  *exe = argv[0];
+    ExecutionTimerOutputFormat  format = ExecutionTimerOutputFormatParse(DEFAULT_OUTPUT_FORMAT);
+    double                      percentile = DEFAULT_PERCENTILE;
+    double                      minDeviation = DEFAULT_MIN_DEVIATION;
+    Expectation                 *expectations = NULL;
+    unsigned int                nExpectations = 0, i, j, k;
+    NodeResults                 results = { 0, 0, NULL };
+    ResultEmitterRef            emitter;
+    ResultTableRef              fleetTable, slowTable;
+    FILE                        *stream;
+    char                        caption[64];
+    double                      *values;
+    unsigned int                nSlow = 0;
+    int                         optc;
+
+    //
+    // Process CLI arguments:
+    //
+    while ( (optc = getopt_long(argc, argv, cli_optstring, cli_opts, NULL)) != -1 ) {
+        switch (optc) {
+            case 'h': {
+                usage(exe);
+                break;
+            }
+
+            case 'v': {
+                verbosity++;
+                break;
+            }
+
+            case 'f': {
+                ExecutionTimerOutputFormat  newFormat = ExecutionTimerOutputFormatParse(optarg);
+
+                if ( newFormat == ExecutionTimerOutputFormatInvalid ) {
+                    ERROR("invalid output format: %s", optarg);
+                    exit(EINVAL);
+                }
+                format = newFormat;
+                break;
+            }
+
+            case 'p': {
+                char        *end;
+
+                percentile = strtod(optarg, &end);
+                if ( (end == optarg) || (percentile < 0.0) || (percentile > 100.0) ) {
+                    ERROR("invalid percentile: %s", optarg);
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 'm': {
+                char        *end;
+
+                minDeviation = strtod(optarg, &end);
+                if ( (end == optarg) || (minDeviation < 0.0) || (minDeviation > 100.0) ) {
+                    ERROR("invalid minimum deviation: %s", optarg);
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 'e': {
+                const char  *eq = strchr(optarg, '=');
+                Expectation *newExpectations;
+                char        *end;
+
+                if ( ! eq || (eq == optarg) ) {
+                    ERROR("invalid expectation (<routine>=<GFLOP/s>): %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( ! (newExpectations = (Expectation*)realloc(expectations, (nExpectations + 1) * sizeof(Expectation))) ) {
+                    ERROR("unable to allocate expectations");
+                    exit(ENOMEM);
+                }
+                expectations = newExpectations;
+                expectations[nExpectations].gflops = strtod(eq + 1, &end);
+                if ( (end == eq + 1) || (expectations[nExpectations].gflops <= 0.0) ) {
+                    ERROR("invalid expected GFLOP/s: %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( ! (expectations[nExpectations].method = strndup(optarg, eq - optarg)) ) {
+                    ERROR("unable to allocate expectations");
+                    exit(ENOMEM);
+                }
+                nExpectations++;
+                break;
+            }
+
+            default: {
+                exit(EINVAL);
+            }
+        }
+    }
+
+    //
+    // Read the records:
+    //
+    if ( optind == argc ) {
+        ReadRecords(&results, stdin, "stdin");
+    } else {
+        for ( ; optind < argc; optind++ ) {
+            FILE        *fptr;
+
+            if ( ! strcmp(argv[optind], "-") ) {
+                ReadRecords(&results, stdin, "stdin");
+                continue;
+            }
+            if ( ! (fptr = fopen(argv[optind], "r")) ) {
+                ERROR("unable to open %s (errno = %d)", argv[optind], errno);
+                exit(errno);
+            }
+            ReadRecords(&results, fptr, argv[optind]);
+            fclose(fptr);
+        }
+    }
+    if ( results.nResults == 0 ) {
+        ERROR("no screen records found");
+        exit(EINVAL);
+    }
+    qsort(results.results, results.nResults, sizeof(NodeResult), __NodeResultCompare);
+    if ( ! (values = (double*)malloc(results.nResults * sizeof(double))) ) {
+        ERROR("unable to allocate node results");
+        exit(ENOMEM);
+    }
+
+    //
+    // Both tables go into a single document; the captions are only shown in
+    // the table format:
+    //
+    if ( ! (emitter = ResultEmitterCreate(format, stdout)) ) {
+        ERROR("unable to allocate results");
+        exit(ENOMEM);
+    }
+    snprintf(caption, sizeof(caption), "Fleet statistics (percentile = %lg)", percentile);
+    if ( ! (stream = ResultEmitterBeginSection(emitter, "fleet", (format == ExecutionTimerOutputFormatTable) ? caption : NULL)) ) {
+        ERROR("unable to allocate fleet table");
+        exit(ENOMEM);
+    }
+    ResultEmitterSetReal(emitter, "percentile", percentile);
+    ResultEmitterSetReal(emitter, "min-deviation", minDeviation);
+    fleetTable = ResultTableCreate(format, "fleet", sizeof(FleetResultColumns) / sizeof(FleetResultColumns[0]), FleetResultColumns, stream);
+    if ( ! fleetTable ) {
+        ERROR("unable to allocate fleet table");
+        exit(ENOMEM);
+    }
+    //
+    // Sorting made each group a contiguous run [i, j):
+    //
+    for ( i = 0; i < results.nResults; i = j ) {
+        NodeResult      *first = &results.results[i];
+        unsigned int    nValues = 0;
+        double          median = NAN, mad = NAN, cutoff = NAN, min, max;
+
+        for ( j = i; (j < results.nResults) && (__NodeResultCompare(first, &results.results[j]) == 0); j++ ) {
+            if ( isfinite(results.results[j].gflops) ) values[nValues++] = results.results[j].gflops;
+        }
+        if ( nValues > 0 ) {
+            qsort(values, nValues, sizeof(double), __DoubleCompare);
+            median = SortedMedian(values, nValues);
+            cutoff = SortedPercentile(values, nValues, percentile);
+            min = values[0];
+            max = values[nValues - 1];
+            for ( k = 0; k < nValues; k++ ) values[k] = fabs(values[k] - median);
+            qsort(values, nValues, sizeof(double), __DoubleCompare);
+            mad = SortedMedian(values, nValues);
+            ResultTableAddRow(fleetTable, first->fingerprint, first->precision, (long)first->threads, first->n, first->method,
+                    (long)(j - i), median, mad, cutoff, min, max);
+        } else {
+            ResultTableAddRow(fleetTable, first->fingerprint, first->precision, (long)first->threads, first->n, first->method,
+                    (long)(j - i), NAN, NAN, NAN, NAN, NAN);
+        }
+
+        for ( k = i; k < j; k++ ) {
+            NodeResult  *r = &results.results[k];
+            unsigned int e;
+
+            r->groupMedian = median;
+            r->groupMAD = mad;
+            r->reason = NULL;
+            if ( ! isfinite(r->gflops) ) {
+                r->reason = "no result";
+                continue;
+            }
+            //
+            // The interpolated percentile is always above the slowest node,
+            // so a node must also be meaningfully below the median:
+            //
+            if ( (percentile > 0.0) && (nValues > 1) && (r->gflops < cutoff) && (r->gflops < (1.0 - 0.01 * minDeviation) * median) ) {
+                r->reason = "below percentile";
+            }
+            for ( e = 0; e < nExpectations; e++ ) {
+                if ( ! strcasecmp(expectations[e].method, r->method) && (r->gflops < expectations[e].gflops) ) {
+                    r->reason = r->reason ? "below percentile and expected" : "below expected";
+                    break;
+                }
+            }
+        }
+    }
+    ResultTableRelease(fleetTable);
+    ResultEmitterEndSection(emitter);
+    free((void*)values);
+
+    //
+    // List the slow nodes, slowest relative to their group first within
+    // each group:
+    //
+    if ( ! (stream = ResultEmitterBeginSection(emitter, "slow_nodes", (format == ExecutionTimerOutputFormatTable) ? "Slow nodes" : NULL)) ) {
+        ERROR("unable to allocate slow node table");
+        exit(ENOMEM);
+    }
+    slowTable = ResultTableCreate(format, "slow_nodes", sizeof(SlowNodeResultColumns) / sizeof(SlowNodeResultColumns[0]), SlowNodeResultColumns, stream);
+    if ( ! slowTable ) {
+        ERROR("unable to allocate slow node table");
+        exit(ENOMEM);
+    }
+    for ( i = 0; i < results.nResults; i++ ) {
+        NodeResult      *r = &results.results[i];
+        double          z = NAN;
+
+        if ( ! r->reason ) continue;
+        if ( r->groupMAD > 0.0 ) z = (r->gflops - r->groupMedian) / (MAD_TO_SIGMA * r->groupMAD);
+        ResultTableAddRow(slowTable, r->host, r->fingerprint, (long)r->threads, r->method, r->gflops,
+                100.0 * r->gflops / r->groupMedian, z, r->reason);
+        nSlow++;
+    }
+    ResultTableRelease(slowTable);
+    ResultEmitterFinish(emitter);
+    ResultEmitterRelease(emitter);
+    if ( nSlow > 0 ) fprintf(stderr, "%u slow node result(s) among %u\n", nSlow, results.nResults);
+
+    for ( i = 0; i < results.nResults; i++ ) {
+        free((void*)results.results[i].host);
+        free((void*)results.results[i].fingerprint);
+        free((void*)results.results[i].precision);
+        free((void*)results.results[i].method);
+    }
+    if ( results.results ) free((void*)results.results);
+    for ( i = 0; i < nExpectations; i++ ) free((void*)expectations[i].method);
+    if ( expectations ) free((void*)expectations);
+    return (nSlow > 0) ? EXIT_SLOW_NODES : 0;
+}
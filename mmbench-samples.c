@@ -0,0 +1,211 @@
+/*
+ * mmbench-samples.c
+ *
+ * Reader for the raw sample files written by mmbench --samples:  lists the
+ * columns in a file or writes the samples in tidy form (one row per value)
+ * in any of the timing output formats.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <getopt.h>
+#include <errno.h>
+#include <math.h>
+
+#include "SampleFile.h"
+#include "ResultTable.h"
+
+#define DEFAULT_OUTPUT_FORMAT       "csv"
+
+//
+// CLI options this program recognizes:
+//
+struct option cli_opts[] = {
+        { "help",           no_argument,        NULL,           'h' },
+        { "format",         required_argument,  NULL,           'f' },
+        { "series",         required_argument,  NULL,           's' },
+        { "metric",         required_argument,  NULL,           'm' },
+        { "list",           no_argument,        NULL,           'l' },
+        { "output",         required_argument,  NULL,           'o' },
+        { NULL,             0,                  0,              0   }
+    };
+
+const char *cli_optstring = "hf:s:m:lo:";
+
+#define ERROR(F, ...) fprintf(stderr, "ERROR(%s:%d)  " F "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
+
+//
+// Writes a program usage help screen and exits.
+//
+void
+usage(
+    const char      *exe
+)
+{
+    printf(
+        "usage:\n\n"
+        "  %s [options] <sample-file>\n\n"
+        " options:\n\n"
+        "  -h/--help                            display this information\n"
+        "  -f/--format <format>                 output format (default: %s)\n\n"
+        "      <format> = (%s)\n\n"
+        "  -s/--series <name>                   only write the series with this name, e.g.\n"
+        "                                       \"basic\", \"basic warm-up\", or \"init:random\"\n"
+        "  -m/--metric <name>                   only write the metric with this name, e.g.\n"
+        "                                       \"Walltime\" or \"GFLOP/s\"\n"
+        "  -l/--list                            list the columns in the file (series, metric,\n"
+        "                                       dimension, threads, and number of values)\n"
+        "                                       rather than the values themselves\n"
+        "  -o/--output <path>                   write to <path> rather than stdout\n"
+        "\n",
+        exe,
+        DEFAULT_OUTPUT_FORMAT,
+        ExecutionTimerOutputFormats()
+      );
+    exit(0);
+}
+
+//
+// Columns of the column listing:
+//
+static const ResultTableColumn ListResultColumns[] = {
+                { "series", ResultTableColumnTypeString },
+                { "metric", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "threads", ResultTableColumnTypeInteger },
+                { "values", ResultTableColumnTypeInteger },
+                { "missing", ResultTableColumnTypeInteger }
+            };
+
+//
+// Write one row per column of samples (subject to the filters), counting
+// the missing values in each.
+//
+void
+ListColumns(
+    SampleFileRef               samples,
+    ExecutionTimerOutputFormat  format,
+    const char                  *series,
+    const char                  *metric,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "columns", sizeof(ListResultColumns) / sizeof(ListResultColumns[0]), ListResultColumns, stream);
+    unsigned int                i, nColumns = SampleFileGetColumnCount(samples);
+
+    if ( ! results ) {
+        ERROR("unable to allocate column table");
+        exit(ENOMEM);
+    }
+    for ( i = 0; i < nColumns; i++ ) {
+        const char              *columnSeries, *columnMetric;
+        const double            *values;
+        long                    n;
+        int                     threads;
+        unsigned long           nValues = SampleFileGetColumn(samples, i, &columnSeries, &columnMetric, &n, &threads, &values), j, nMissing = 0;
+
+        if ( series && strcasecmp(series, columnSeries) ) continue;
+        if ( metric && strcasecmp(metric, columnMetric) ) continue;
+        for ( j = 0; j < nValues; j++ ) if ( isnan(values[j]) ) nMissing++;
+        ResultTableAddRow(results, columnSeries, columnMetric, n, (long)threads, (long)nValues, (long)nMissing);
+    }
+    ResultTableRelease(results);
+}
+
+//
+
+int
+main(
+    int                 argc,
+    char* const         argv[]
+)
+{
+    const char                  *exe = argv[0];
+    const char                  *series = NULL, *metric = NULL, *outputPath = NULL;
+    bool                        shouldList = false, isWritten;
+    ExecutionTimerOutputFormat  format = ExecutionTimerOutputFormatParse(DEFAULT_OUTPUT_FORMAT);
+    SampleFileRef               samples;
+    FILE                        *stream = stdout;
+    int                         optc;
+
+    //
+    // Process CLI arguments:
+    //
+    while ( (optc = getopt_long(argc, argv, cli_optstring, cli_opts, NULL)) != -1 ) {
+        switch (optc) {
+            case 'h': {
+                usage(exe);
+                break;
+            }
+
+            case 'f': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no output format specified");
+                    exit(EINVAL);
+                }
+                format = ExecutionTimerOutputFormatParse(optarg);
+                if ( format == ExecutionTimerOutputFormatInvalid ) {
+                    ERROR("invalid output format: %s", optarg);
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 's': {
+                series = optarg;
+                break;
+            }
+
+            case 'm': {
+                metric = optarg;
+                break;
+            }
+
+            case 'l': {
+                shouldList = true;
+                break;
+            }
+
+            case 'o': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no output file specified");
+                    exit(EINVAL);
+                }
+                outputPath = optarg;
+                break;
+            }
+
+            default: {
+                exit(EINVAL);
+            }
+        }
+    }
+    if ( optind != argc - 1 ) {
+        ERROR("exactly one sample file must be specified");
+        exit(EINVAL);
+    }
+    if ( ! (samples = SampleFileCreateWithPath(argv[optind])) ) exit(EINVAL);
+    if ( outputPath && ! (stream = fopen(outputPath, "w")) ) {
+        ERROR("unable to create %s (errno = %d)", outputPath, errno);
+        exit(errno);
+    }
+
+    if ( shouldList ) {
+        ListColumns(samples, format, series, metric, stream);
+    } else {
+        SampleFileSummarizeToStream(samples, format, series, metric, stream);
+    }
+    SampleFileRelease(samples);
+
+    isWritten = (ferror(stream) == 0);
+    if ( (stream != stdout) && (fclose(stream) != 0) ) isWritten = false;
+    if ( ! isWritten ) {
+        ERROR("unable to write %s (errno = %d)", outputPath ? outputPath : "to stdout", errno);
+        return 1;
+    }
+    return 0;
+}
@@ -15,6 +15,9 @@
 #include <limits.h>
 #include <getopt.h>
 #include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
 
 #ifdef HAVE_OPENMP
 #   include <omp.h>
@@ -23,6 +26,15 @@
 #include "FortranInterface.h"
 #include "MatrixInitMethod.h"
 #include "MatrixMultiplyMethod.h"
+#include "ParameterSweep.h"
+#include "ResultTable.h"
+#include "MachineInfo.h"
+#include "MachineProbe.h"
+#include "TuningCache.h"
+#include "TraceLog.h"
+#include "SampleFile.h"
+#include "RunManifest.h"
+#include "ResultEmitter.h"
 
 //
 // Various compile-time constants that act as default values for
@@ -36,6 +48,56 @@
 #define DEFAULT_BETA                F_ZERO
 #define DEFAULT_ALLOC_ALIGNMENT     8
 #define DEFAULT_NLOOP               4
+#define DEFAULT_MAX_NLOOP           100
+#define DEFAULT_WARMUP              -1
+#define DEFAULT_TARGET_CI           0.0
+#define DEFAULT_TUNE_BUDGET         48
+#define DEFAULT_REGRESSION_THRESHOLD 0.05
+
+//
+// Exit status when a routine regresses against the --compare baseline:
+//
+#define EXIT_REGRESSION             2
+
+//
+// The node-screening suite (--screen) is fixed so that results from
+// different nodes are comparable:  a threaded compiled routine, the
+// cache-blocked C routine, and the BLAS (if any) at a dimension that takes
+// well under a second per iteration on current hardware.
+//
+#define SCREEN_INIT_METHOD          "random"
+#ifdef HAVE_BLAS
+#   define SCREEN_MULTIPLY_METHODS  "opt-fortran-omp,tiled,blas"
+#else
+#   define SCREEN_MULTIPLY_METHODS  "opt-fortran-omp,tiled"
+#endif
+#define SCREEN_DIMENSION            512
+#define SCREEN_NLOOP                10
+
+//
+// Parameters of the automatic warm-up detection:  warm-up iterations are
+// discarded until the walltimes of the last WARMUP_WINDOW iterations agree
+// to within WARMUP_TOLERANCE of their median.  Detection is abandoned after
+// WARMUP_MAX_ITERATIONS iterations or WARMUP_MAX_SECONDS of warm-up time.
+//
+#define WARMUP_WINDOW               3
+#define WARMUP_TOLERANCE            0.05
+#define WARMUP_MAX_ITERATIONS       20
+#define WARMUP_MAX_SECONDS          1.0
+
+//
+// Number of empty start/stop cycles used to calibrate each timer's overhead:
+//
+#define TIMER_OVERHEAD_SAMPLES      1000
+
+//
+// Autotuning:  a candidate whose single screening iteration is more than
+// TUNE_PRUNE_FACTOR times slower than the best median so far is not fully
+// measured, and the search stops after TUNE_PATIENCE consecutive candidates
+// fail to improve on the best.
+//
+#define TUNE_PRUNE_FACTOR           1.25
+#define TUNE_PATIENCE               12
 
 //
 // CLI options this program recognizes:
@@ -51,10 +113,35 @@ struct option cli_opts[] = {
         { "init",           required_argument,  NULL,           'i' },
         { "routines",       required_argument,  NULL,           'r' },
         { "randomseed",     required_argument,  NULL,           's' },
+        { "nloop",          required_argument,  NULL,           'l' },
+        { "max-nloop",      required_argument,  NULL,           'L' },
+        { "warmup",         required_argument,  NULL,           'w' },
+        { "target-ci",      required_argument,  NULL,           'c' },
         { "dimension",      required_argument,  NULL,           'n' },
         { "alpha",          required_argument,  NULL,           'a' },
         { "beta",           required_argument,  NULL,           'b' },
         { "format",         required_argument,  NULL,           'f' },
+        { "perf-counters",  no_argument,        NULL,           'P' },
+        { "sweep",          required_argument,  NULL,           'N' },
+        { "thread-sweep",   required_argument,  NULL,           'T' },
+        { "weak-scaling",   no_argument,        NULL,           'W' },
+        { "tune",           no_argument,        NULL,           'u' },
+        { "tune-budget",    required_argument,  NULL,           'U' },
+        { "tuning-cache",   required_argument,  NULL,           'C' },
+        { "probe",          no_argument,        NULL,           'p' },
+        { "reprobe",        no_argument,        NULL,           'R' },
+        { "timer-scope",    required_argument,  NULL,           'X' },
+        { "clock",          required_argument,  NULL,           'k' },
+        { "batch",          required_argument,  NULL,           'K' },
+        { "subtract-overhead", no_argument,     NULL,           'O' },
+        { "trace",          required_argument,  NULL,           'E' },
+        { "samples",        required_argument,  NULL,           'Y' },
+        { "samples-csv",    required_argument,  NULL,           'Z' },
+        { "save-baseline",  required_argument,  NULL,           'G' },
+        { "compare",        required_argument,  NULL,           'Q' },
+        { "regression-threshold", required_argument, NULL,      'q' },
+        { "screen",         no_argument,        NULL,           'F' },
+        { "no-manifest",    no_argument,        NULL,           'M' },
         { NULL,             0,                  0,              0   }
     };
 
@@ -62,7 +149,7 @@ const char *cli_optstring = ""
 #ifdef HAVE_OPENMP
     "t:"
 #endif
-    "hvAS:i:r:s:n:a:b:f:";
+    "hvAS:i:r:s:l:L:w:c:n:a:b:f:PN:T:WuU:C:pRX:k:K:OE:Y:Z:G:Q:q:FM";
 
 //
 // Make verbosity a global:
@@ -74,6 +161,12 @@ unsigned int        verbosity = 0;
 #define WARN(F, ...) if (verbosity >= 1) fprintf(stderr, "WARNING(%s:%d)  " F "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
 #define ERROR(F, ...) fprintf(stderr, "ERROR(%s:%d)  " F "\n", __FILE__, __LINE__, ##__VA_ARGS__ )
 
+//
+// Progress for the person watching goes to stderr, so stdout holds only
+// results:
+//
+#define PROGRESS(F, ...) fprintf(stderr, F "\n", ##__VA_ARGS__ )
+
 //
 // Writes a program usage help screen and exits.
 //
@@ -90,6 +183,49 @@ usage(
         "  -v/--verbose                         increase the amount of information displayed\n"
         "  -f/--format <format>                 output format for the timing data (default: %s)\n\n"
         "      <format> = (%s)\n\n"
+        "  -P/--perf-counters                   collect hardware performance counters (cycles,\n"
+        "                                       instructions, cache/TLB/branch misses) via\n"
+        "                                       perf_event_open(); ignored if unavailable\n"
+        "  -X/--timer-scope <scope-spec>        account CPU time and resource usage over the whole\n"
+        "                                       process or only the timing thread (default: %s)\n\n"
+        "      <scope-spec> = {init=|multiply=}(%s){,...}\n\n"
+        "  -k/--clock <clock>                   clock used by the timers (default: %s)\n\n"
+        "      <clock> = (%s)\n\n"
+        "                                       tsc reads the invariant time-stamp counter and\n"
+        "                                       skips resource usage for minimal overhead\n"
+        "  -K/--batch <integer>                 time each iteration as this many back-to-back\n"
+        "                                       multiplications and report per-call values\n"
+        "                                       (default: 1)\n"
+        "  -O/--subtract-overhead               subtract the median timer overhead (measured at\n"
+        "                                       startup) from every walltime\n"
+        "  -E/--trace <path>                    record a timeline of timer, iteration, thread, and\n"
+        "                                       i/o events and write it to <path> at exit in the\n"
+        "                                       Chrome trace-event format (chrome://tracing or\n"
+        "                                       Perfetto)\n"
+        "  -Y/--samples <path>                  write every iteration's raw timer values (each\n"
+        "                                       method, its warm-up, and init) to <path> in a\n"
+        "                                       compact binary columnar format; read it back\n"
+        "                                       with mmbench-samples\n"
+        "  -Z/--samples-csv <path>              also write the raw values to <path> as CSV with\n"
+        "                                       one row per value\n"
+        "  -G/--save-baseline <path>            save every routine's walltime distribution (the\n"
+        "                                       raw samples) to <path> as a baseline for --compare\n"
+        "  -Q/--compare <path>                  compare each routine's walltimes with the baseline\n"
+        "                                       at <path> (Mann-Whitney U test and bootstrap CI of\n"
+        "                                       the ratio of medians) and exit with status %d if\n"
+        "                                       any routine is significantly slower by more than\n"
+        "                                       the regression threshold\n"
+        "  -q/--regression-threshold <real>{%%}  slowdown tolerated by --compare, as a fraction\n"
+        "                                       (or percentage) of the baseline median\n"
+        "                                       (default: %lg%%)\n"
+        "  -F/--screen                          run the fixed node-screening suite and write a\n"
+        "                                       single-line JSON record for mmbench-aggregate:\n"
+        "                                       %s\n"
+        "                                       at n = %d, %d iterations, %s init\n"
+        "  -M/--no-manifest                     do not write the run manifest (CPU, microcode,\n"
+        "                                       topology, frequency governor, kernel, compilers\n"
+        "                                       and flags, BLAS, OpenMP runtime and environment,\n"
+        "                                       hugepages) ahead of the results\n"
 #ifdef HAVE_OPENMP
         "  -t/--nthreads <integer>              OpenMP code should use this many threads max; zero\n"
         "                                       implies that the OpenMP runtime default should be used\n"
@@ -111,20 +247,73 @@ usage(
         "  -l/--nloop <integer>                 number of times to perform calculation for each\n"
         "                                       chosen routine; counts greater than 1 will show\n"
         "                                       averaged timings (default: "FMT_F_INTEGER")\n"
+        "  -w/--warmup <warmup-spec>            discard warm-up iterations before timing each\n"
+        "                                       routine (default: auto)\n\n"
+        "      <warmup-spec> = (auto|<integer>)\n\n"
+        "                                       auto discards iterations until the walltimes of\n"
+        "                                       %d consecutive iterations agree within %lg%%\n"
+        "  -c/--target-ci <real>{%%}             keep iterating beyond --nloop until the 95%%\n"
+        "                                       confidence interval on the average walltime is\n"
+        "                                       within this fraction (or percentage) of it\n"
+        "  -L/--max-nloop <integer>             cap on the iteration count for --target-ci\n"
+        "                                       (default: "FMT_F_INTEGER")\n"
         "  -n/--dimension <integer>             dimension of the matrices (default: "FMT_F_INTEGER")\n"
+        "  -N/--sweep n=<sweep-spec>            run every routine at each of a list of matrix\n"
+        "                                       dimensions and display a single table of results\n\n"
+        "      <sweep-spec> = <item>{,<item>..}\n"
+        "      <item> = (<integer>|<start>:<end>:linear:<step>|<start>:<end>:geometric:<ratio>)\n\n"
+        "  -T/--thread-sweep <thread-spec>      run every threaded routine at each of a list of\n"
+        "                                       thread counts and display speedup, parallel\n"
+        "                                       efficiency, and Karp-Flatt serial fraction\n\n"
+        "      <thread-spec> = <item>{,<item>..}\n"
+        "      <item> = (<integer>|max|pow2|all|<start>:<end>:linear:<step>|...)\n\n"
+        "                                       max is the maximum thread count, pow2 the powers of\n"
+        "                                       two up to (and including) max, all = 1:max:linear:1\n"
+        "  -W/--weak-scaling                    with --thread-sweep, grow the matrix dimension as\n"
+        "                                       n * threads^(1/3) so the work per thread is constant\n"
+        "  -u/--tune                            search each routine's tuning parameters (and\n"
+        "                                       thread counts) for the fastest configuration at\n"
+        "                                       the matrix dimension (or each --sweep dimension)\n"
+        "                                       and record it in the tuning cache for use by the\n"
+        "                                       auto routine\n"
+        "  -U/--tune-budget <integer>           maximum number of configurations tried per\n"
+        "                                       routine and dimension; larger search spaces are\n"
+        "                                       randomly sampled (default: %d)\n"
+        "  -C/--tuning-cache <path>             tuning cache file (default: %s)\n"
+        "  -p/--probe                           measure the machine's peak FMA throughput, cache\n"
+        "                                       and memory bandwidth, and latency, then place each\n"
+        "                                       routine's result on a roofline; the measurements\n"
+        "                                       are cached (default: %s)\n"
+        "  -R/--reprobe                         like --probe, but always re-measure the machine\n"
         "  -a/--alpha <real>                    alpha value in equation (default: "FMT_F_REAL")\n"
         "  -b/--beta <real>                     beta value in equation (default: "FMT_F_REAL")\n"
         "\n",
         exe,
         DEFAULT_OUTPUT_FORMAT,
         ExecutionTimerOutputFormats(),
+        ExecutionTimerScopeToString(ExecutionTimerScopeProcess),
+        ExecutionTimerScopes(),
+        ExecutionTimerClockToString(ExecutionTimerClockMonotonic),
+        ExecutionTimerClocks(),
+        (int)EXIT_REGRESSION,
+        100.0 * DEFAULT_REGRESSION_THRESHOLD,
+        SCREEN_MULTIPLY_METHODS,
+        (int)SCREEN_DIMENSION,
+        (int)SCREEN_NLOOP,
+        SCREEN_INIT_METHOD,
         (f_integer)DEFAULT_ALLOC_ALIGNMENT,
         DEFAULT_INIT_METHOD,
         MatrixInitMethodTokenList(),
         DEFAULT_MULTIPLY_METHODS,
         MatrixMultiplyMethodTokenList(),
         (f_integer)DEFAULT_NLOOP,
+        (int)WARMUP_WINDOW,
+        100.0 * WARMUP_TOLERANCE,
+        (f_integer)DEFAULT_MAX_NLOOP,
         (f_integer)DEFAULT_MATRIX_DIMENSION,
+        (int)DEFAULT_TUNE_BUDGET,
+        TuningCacheDefaultPath() ? TuningCacheDefaultPath() : "none",
+        MachineProbeDefaultPath() ? MachineProbeDefaultPath() : "none",
         (f_real)DEFAULT_ALPHA,
         (f_real)DEFAULT_BETA
       );
@@ -292,14 +481,23 @@ MultiplyMethodListParse(
             // If it was add, then put 'em all back:
             if ( ! shouldRemove ) {
                 size_t      allMethodsLen = strlen(MatrixMultiplyMethodTokenList()) + 1;
-                char        allMethods[allMethodsLen], *p;
+                char        allMethods[allMethodsLen], *p, *q;
+                int         braceDepth = 0;
 
                 MatrixMultiplyMethodCopyTokenList(allMethods, allMethodsLen);
-                p = allMethods;
+                // Drop optional-argument help text (e.g. "{=<arg>}") as well:
+                p = q = allMethods;
                 while ( *p ) {
-                    if ( *p == '|' ) *p = ',';
+                    if ( *p == '{' ) {
+                        braceDepth++;
+                    } else if ( *p == '}' ) {
+                        braceDepth--;
+                    } else if ( braceDepth == 0 ) {
+                        *q++ = (*p == '|') ? ',' : *p;
+                    }
                     p++;
                 }
+                *q = '\0';
                 MultiplyMethodListParse(&list, allMethods);
             }
         } else {
@@ -356,212 +554,1829 @@ MultiplyMethodListDestroy(
 }
 
 //
-// Main program.
+// Everything needed to measure a multiplication method, aside from the
+// method itself and the matrix dimension:
 //
-int
-main(
-    int                 argc,
-    char* const         argv[]
+typedef struct {
+    MatrixInitObjectRef     initObj;
+    ExecutionTimerRef       initTimer;
+    ExecutionTimerRef       warmupTimer;
+    ExecutionTimerRef       warmupInitTimer;
+    f_integer               nloop;
+    f_integer               maxNloop;
+    f_integer               nwarmup;
+    double                  targetCI;
+    int                     nthreads;
+    f_real                  alpha;
+    f_real                  beta;
+    f_real                  *A;
+    f_real                  *B;
+    f_real                  *C;
+    SampleFileRef           samples;
+} BenchmarkContext;
+
+//
+// Allocate the three n-by-n matrices, optionally aligned.
+//
+bool
+AllocateMatrices(
+    f_integer       n,
+    bool            shouldAlign,
+    int             allocAlign,
+    f_real*         *A,
+    f_real*         *B,
+    f_real*         *C
 )
 {
-    const char                  *exe = argv[0];
-    f_integer                   n = DEFAULT_MATRIX_DIMENSION, nloop = DEFAULT_NLOOP, loop;
-#ifdef HAVE_OPENMP
-    int                         nthreads = 0;
-#endif
-    f_real                      *A=NULL, *B=NULL, *C=NULL, alpha = DEFAULT_ALPHA, beta = DEFAULT_BETA;
-    const char                  *initMethod = DEFAULT_INIT_METHOD;
-    MatrixInitObjectRef         matrixInitMethod = NULL;
-    MultiplyMethodList          *multiplyMethods = NULL, *iterMultiplyMethods;
-    size_t                      allocAlign = DEFAULT_ALLOC_ALIGNMENT;
-    bool                        shouldAlign = true;
-    ExecutionTimerRef           matInitTimer = ExecutionTimerCreate();
-    ExecutionTimerRef           matMulTimer = ExecutionTimerCreate();
-    ExecutionTimerOutputFormat  timerOutputFormat;
+    *A = *B = *C = NULL;
+    if (shouldAlign) {
+        INFO("Allocating matrices with alignment of %d bytes", allocAlign);
+        posix_memalign((void**)A, allocAlign, n * n * sizeof(f_real));
+        posix_memalign((void**)B, allocAlign, n * n * sizeof(f_real));
+        posix_memalign((void**)C, allocAlign, n * n * sizeof(f_real));
+    } else {
+        size_t      offset;
 
-    int                         optc;
+        *A = calloc(n * n + 1, sizeof(f_real));
+        *B = calloc(n * n + 1, sizeof(f_real));
+        *C = calloc(n * n + 1, sizeof(f_real));
+        if ( !*A || !*B || !*C ) return false;
 
-    MultiplyMethodListParse(&multiplyMethods, DEFAULT_MULTIPLY_METHODS);
-    timerOutputFormat = ExecutionTimerOutputFormatParse(DEFAULT_OUTPUT_FORMAT);
+        // Force onto an unaligned position:
+        offset = ((unsigned long long int)*A) % sizeof(f_real);
+        if ( offset == 0 ) *A = (f_real*)((void*)*A + 3);
+        offset = ((unsigned long long int)*A) % sizeof(f_real);
+        INFO("Allocated A matrix with offset alignment %d bytes", offset);
 
-    //
-    // Process CLI arguments:
-    //
-    while ( (optc = getopt_long(argc, argv, cli_optstring, cli_opts, NULL)) != -1 ) {
-        switch (optc) {
-            case 'h': {
-                usage(exe);
-                break;
-            }
+        offset = ((unsigned long long int)*B) % sizeof(f_real);
+        if ( offset == 0 ) *B = (f_real*)((void*)*B + 3);
+        offset = ((unsigned long long int)*B) % sizeof(f_real);
+        INFO("Allocated B matrix with offset alignment %d bytes", offset);
 
-            case 'v': {
-                verbosity++;
-                break;
-            }
+        offset = ((unsigned long long int)*C) % sizeof(f_real);
+        if ( offset == 0 ) *C = (f_real*)((void*)*C + 3);
+        offset = ((unsigned long long int)*C) % sizeof(f_real);
+        INFO("Allocated C matrix with offset alignment %d bytes", offset);
+    }
+    return ( *A && *B && *C ) ? true : false;
+}
 
-            case 'A': {
-                shouldAlign = false;
-                break;
-            }
+//
+// Timer events become trace spans:  a timer's cycles and its per-thread
+// work in parallel regions are named for the timer, regions for themselves.
+//
+void
+TraceTimerEvent(
+    ExecutionTimerRef   aTimer,
+    ExecutionTimerEvent theEvent,
+    const char          *label,
+    void                *context
+)
+{
+    switch ( theEvent ) {
+        case ExecutionTimerEventStart:
+            TraceLogBegin("timer", label);
+            break;
+        case ExecutionTimerEventStop:
+            TraceLogEnd("timer", label);
+            break;
+        case ExecutionTimerEventThreadStart:
+            TraceLogBegin("thread", label);
+            break;
+        case ExecutionTimerEventThreadStop:
+            TraceLogEnd("thread", label);
+            break;
+        case ExecutionTimerEventPushRegion:
+            TraceLogBegin("region", label);
+            break;
+        case ExecutionTimerEventPopRegion:
+            TraceLogEnd("region", label);
+            break;
+    }
+}
 
-            case 'i': {
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("ERROR:  no matrix init specification provided");
-                    exit(EINVAL);
-                }
-                initMethod = optarg;
-                break;
-            }
+//
+// Perform one iteration:  initialize the matrices into initTimer and multiply
+// them into mulTimer.  With a batched timer the multiplication is repeated to
+// fill the batch (C keeps accumulating, which does not affect the timing).
+//
+void
+RunIteration(
+    BenchmarkContext        *ctx,
+    MatrixMultiplyObjectRef multObj,
+    ExecutionTimerRef       initTimer,
+    ExecutionTimerRef       mulTimer,
+    f_integer               n,
+    f_integer               loop
+)
+{
+    unsigned int            call = ExecutionTimerGetBatchSize(mulTimer);
+    char                    iterationName[TRACELOG_MAX_NAME_LENGTH + 1] = "";
+    f_real                  *A, *B, *C;
 
-            case 'r': {
-                if ( optarg && *optarg ) MultiplyMethodListParse(&multiplyMethods, optarg);
-                break;
-            }
+    if ( TraceLogIsOpen() ) {
+        snprintf(iterationName, sizeof(iterationName), "%s iteration", ExecutionTimerGetName(mulTimer));
+        TraceLogAddEvent(TraceLogPhaseBegin, "iteration", iterationName, "loop", (double)loop);
+    }
+    // Methods that map their data (e.g. mmap) provide the matrices in place
+    // of the allocated ones:
+    if ( ! (A = MatrixInitObjectProvide(ctx->initObj, initTimer, ctx->nthreads, n, MatrixInitMatrixA, ctx->A)) ||
+         ! (B = MatrixInitObjectProvide(ctx->initObj, initTimer, ctx->nthreads, n, MatrixInitMatrixB, ctx->B)) ||
+         ! (C = MatrixInitObjectProvide(ctx->initObj, initTimer, ctx->nthreads, n, MatrixInitMatrixC, ctx->C))
+    ) {
+        ERROR("failure in iteration %ld of %s init method", (long)loop, MatrixInitObjectGetName(ctx->initObj));
+        exit(1);
+    }
+    while ( call-- > 0 ) {
+        if ( ! MatrixMultiplyObjectMultiply(multObj, mulTimer, ctx->nthreads, n, ctx->alpha, A, B, ctx->beta, C) ) {
+            ERROR("failure in iteration %ld of %s multiplication method", (long)loop, MatrixMultiplyObjectGetName(multObj));
+            exit(1);
+        }
+    }
+    if ( TraceLogIsOpen() ) TraceLogEnd("iteration", iterationName);
+}
 
-            case 'a': {
-                char        *end;
+//
+// Returns true if the walltimes of the last WARMUP_WINDOW warm-up iterations
+// agree to within WARMUP_TOLERANCE of their median.
+//
+bool
+IsWarmupWindowStable(
+    double          *window,
+    int             nWindow
+)
+{
+    double          sorted[WARMUP_WINDOW], median;
+    int             i, j;
 
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("no value provided for alpha coefficient");
-                    exit(EINVAL);
-                }
-                alpha = strtod(optarg, &end);
-                if ( end == NULL || end == optarg ) {
-                    ERROR("invalid alpha coefficient: %s", optarg);
-                    exit(EINVAL);
-                }
-                break;
-            }
+    if ( nWindow < WARMUP_WINDOW ) return false;
+    for ( i = 0; i < WARMUP_WINDOW; i++ ) {
+        double      v = window[i];
 
-            case 'b': {
-                char        *end;
+        j = i;
+        while ( (j > 0) && (sorted[j - 1] > v) ) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+    median = sorted[WARMUP_WINDOW / 2];
+    return ((sorted[WARMUP_WINDOW - 1] - sorted[0]) <= WARMUP_TOLERANCE * median) ? true : false;
+}
 
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("no value provided for beta coefficient");
-                    exit(EINVAL);
-                }
-                beta = strtod(optarg, &end);
-                if ( end == NULL || end == optarg ) {
-                    ERROR("invalid beta coefficient: %s", optarg);
-                    exit(EINVAL);
-                }
-                break;
-            }
+//
+// Run warm-up iterations into the context's warmupTimer; their matrix
+// initializations go to the (never summarized) warmupInitTimer so they do not
+// skew the init statistics.  If nwarmup is negative, iterations continue
+// until the walltime stabilizes; otherwise exactly nwarmup iterations are
+// performed.  Returns the number of warm-up iterations.
+//
+f_integer
+RunWarmup(
+    BenchmarkContext        *ctx,
+    MatrixMultiplyObjectRef multObj,
+    f_integer               n
+)
+{
+    double                  window[WARMUP_WINDOW], elapsed = 0.0;
+    int                     nWindow = 0;
+    f_integer               loop = 0;
 
-            case 't': {
-                char        *end;
-                long        v;
+    ExecutionTimerReset(ctx->warmupTimer);
+    if ( ctx->nwarmup >= 0 ) {
+        while ( loop < ctx->nwarmup ) RunIteration(ctx, multObj, ctx->warmupInitTimer, ctx->warmupTimer, n, loop++);
+        return loop;
+    }
+    while ( loop < WARMUP_MAX_ITERATIONS ) {
+        double              walltime;
 
-#ifdef HAVE_OPENMP
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("no value provided for thread count");
-                    exit(EINVAL);
-                }
-                v = strtol(optarg, &end, 0);
-                if ( v < 0 || end == NULL || end == optarg ) {
-                    ERROR("invalid thread count: %s", optarg);
-                    exit(EINVAL);
-                }
-                nthreads = v;
-#else
-                WARN("OpenMP arguments ignored");
-#endif
-                break;
-            }
+        RunIteration(ctx, multObj, ctx->warmupInitTimer, ctx->warmupTimer, n, loop++);
+        walltime = ExecutionTimerGetValue(ctx->warmupTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueLastValue);
+        elapsed += walltime;
 
-            case 'n': {
-                char        *end;
-                long        v;
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("no matrix dimension specified");
-                    exit(EINVAL);
-                }
-                v = strtol(optarg, &end, 0);
-                if ( (v <= 1) || end == NULL || end == optarg ) {
-                    ERROR("invalid matrix dimension: %s", optarg);
-                    exit(EINVAL);
-                }
-                n = v;
-                break;
-            }
+        // Shift the walltime into the moving window:
+        if ( nWindow == WARMUP_WINDOW ) {
+            memmove(&window[0], &window[1], (WARMUP_WINDOW - 1) * sizeof(double));
+            nWindow--;
+        }
+        window[nWindow++] = walltime;
 
-            case 'S': {
-                char        *end;
-                long        v;
-                if ( !optarg || (*optarg == '\0') ) {
-                    ERROR("no alignment byte count specified");
-                    exit(EINVAL);
-                }
-                v = strtol(optarg, &end, 0);
-                if ( (v <= 0) || end == NULL || end == optarg ) {
-                    ERROR("invalid alignment byte count: %s", optarg);
-                    exit(EINVAL);
-                }
-                allocAlign = v;
-                break;
-            }
+        if ( IsWarmupWindowStable(window, nWindow) ) break;
+        if ( elapsed >= WARMUP_MAX_SECONDS ) {
+            INFO("warm-up time limit reached after " FMT_F_INTEGER " iteration(s)", loop);
+            break;
+        }
+    }
+    if ( loop >= WARMUP_MAX_ITERATIONS ) WARN("walltime did not stabilize within %d warm-up iterations", WARMUP_MAX_ITERATIONS);
+    return loop;
+}
 
-            case 'f': {
-                ExecutionTimerOutputFormat  newFormat = ExecutionTimerOutputFormatParse(optarg);
+//
+// Warm up and then time multObj at dimension n into mulTimer.  Returns the
+// number of timed iterations; the number of warm-up iterations is returned
+// in *nwarmupActual.
+//
+f_integer
+MeasureMethod(
+    BenchmarkContext        *ctx,
+    MatrixMultiplyObjectRef multObj,
+    ExecutionTimerRef       mulTimer,
+    f_integer               n,
+    f_integer               *nwarmupActual
+)
+{
+    f_integer               loop = 0, nloopLimit = ctx->nloop;
+    bool                    isTargetCIReached = false;
 
-                if ( newFormat == ExecutionTimerOutputFormatInvalid ) {
-                    WARN("invalid timer output format specified: %s", optarg);
-                } else {
-                    timerOutputFormat = newFormat;
-                }
-                break;
-            }
+    TraceLogAddEvent(TraceLogPhaseBegin, "method", MatrixMultiplyObjectGetName(multObj), "n", (double)n);
+    *nwarmupActual = RunWarmup(ctx, multObj, n);
+
+    //
+    // With a confidence interval target, keep iterating past nloop (up to maxNloop)
+    // until the target is reached:
+    //
+    if ( (ctx->targetCI > 0.0) && (ctx->maxNloop > nloopLimit) ) nloopLimit = ctx->maxNloop;
+    ExecutionTimerReset(mulTimer);
+    while ( loop < nloopLimit ) {
+        RunIteration(ctx, multObj, ctx->initTimer, mulTimer, n, loop++);
+        if ( loop < ctx->nloop ) continue;
+        if ( ctx->targetCI <= 0.0 ) break;
+        if ( (loop >= 2) &&
+             (ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMeanCI95) <=
+                ctx->targetCI * ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueAverage))
+        ) {
+            isTargetCIReached = true;
+            break;
         }
     }
+    if ( (ctx->targetCI > 0.0) && ! isTargetCIReached ) {
+        WARN("confidence interval target not reached for %s within " FMT_F_INTEGER " iterations", MatrixMultiplyObjectGetName(multObj), loop);
+    }
+    if ( ctx->samples ) {
+        const char          *name = MatrixMultiplyObjectGetName(multObj);
+        char                warmupName[strlen(name) + 16];
 
-    INFO("Initialization method requested: %s", initMethod);
-    matrixInitMethod = MatrixInitObjectCreate(initMethod);
-    if ( ! matrixInitMethod ) {
-        ERROR("unable to allocate matrix initializer: %s", initMethod);
-        exit(EINVAL);
+        snprintf(warmupName, sizeof(warmupName), "%s warm-up", name);
+        if ( ((*nwarmupActual > 0) && ! SampleFileAddTimer(ctx->samples, warmupName, (long)n, ctx->nthreads, ctx->warmupTimer)) ||
+             ! SampleFileAddTimer(ctx->samples, name, (long)n, ctx->nthreads, mulTimer)
+        ) {
+            ERROR("unable to allocate raw samples");
+            exit(ENOMEM);
+        }
     }
-    INFO("Multiplication methods requested: %s", MultiplyMethodListGetString(multiplyMethods));
-    INFO("Matrix dimension: " FMT_F_INTEGER, n);
-    INFO("Number of loop iterations per method: " FMT_F_INTEGER, nloop);
-    INFO("Timing output format: %s", ExecutionTimerOutputFormatToString(timerOutputFormat));
+    TraceLogEnd("method", MatrixMultiplyObjectGetName(multObj));
+    return loop;
+}
 
-    //
-    // Allocate matrices:
-    //
-    if (shouldAlign) {
-        INFO("Allocating matrices with alignment of %d bytes", allocAlign);
-        posix_memalign((void**)&A, allocAlign, n * n * sizeof(f_real));
-        posix_memalign((void**)&B, allocAlign, n * n * sizeof(f_real));
-        posix_memalign((void**)&C, allocAlign, n * n * sizeof(f_real));
-    } else {
-        size_t      offset;
+//
+// Results collected for placement on the roofline:
+//
+typedef struct {
+    char            *method;
+    f_integer       n;
+    double          gflops;
+    double          gbps;
+    double          intensity;
+} RooflinePoint;
 
-        A = calloc(n * n + 1, sizeof(f_real));
-        B = calloc(n * n + 1, sizeof(f_real));
-        C = calloc(n * n + 1, sizeof(f_real));
-        // Force onto an unaligned position:
-        offset = ((unsigned long long int)A) % sizeof(f_real);
-        if ( offset == 0 ) A = (f_real*)((void*)A + 3);
-        offset = ((unsigned long long int)A) % sizeof(f_real);
-        INFO("Allocated A matrix with offset alignment %d bytes", offset);
+typedef struct {
+    unsigned int    nPoints;
+    unsigned int    capacity;
+    RooflinePoint   *points;
+} RooflinePoints;
 
-        offset = ((unsigned long long int)B) % sizeof(f_real);
-        if ( offset == 0 ) B = (f_real*)((void*)B + 3);
-        offset = ((unsigned long long int)B) % sizeof(f_real);
-        INFO("Allocated B matrix with offset alignment %d bytes", offset);
+//
+// Fetch a statistic of a metric in timer, falling back to the last value when
+// the statistic is not defined (e.g. the median of a single iteration).
+//
+double
+GetValueOrLastValue(
+    ExecutionTimerRef       timer,
+    ExecutionTimerMetric    metric,
+    ExecutionTimerValue     value
+)
+{
+    double                  v = ExecutionTimerGetValue(timer, metric, value);
 
-        offset = ((unsigned long long int)C) % sizeof(f_real);
-        if ( offset == 0 ) C = (f_real*)((void*)C + 3);
-        offset = ((unsigned long long int)C) % sizeof(f_real);
-        INFO("Allocated C matrix with offset alignment %d bytes", offset);
+    return isfinite(v) ? v : ExecutionTimerGetValue(timer, metric, ExecutionTimerValueLastValue);
+}
+
+//
+// Record the median rates of the last measurement in mulTimer.
+//
+void
+RooflineAddPoint(
+    RooflinePoints      *roofline,
+    const char          *method,
+    f_integer           n,
+    ExecutionTimerRef   mulTimer
+)
+{
+    RooflinePoint       *p;
+
+    if ( roofline->nPoints == roofline->capacity ) {
+        unsigned int    newCapacity = roofline->capacity ? (2 * roofline->capacity) : 16;
+        RooflinePoint   *newPoints = (RooflinePoint*)realloc(roofline->points, newCapacity * sizeof(RooflinePoint));
+
+        if ( ! newPoints ) {
+            ERROR("unable to allocate roofline points");
+            exit(ENOMEM);
+        }
+        roofline->points = newPoints;
+        roofline->capacity = newCapacity;
     }
-    if ( !A || !B || !C ) {
-        ERROR("unable to allocate matrices");
-        exit(1);
+    p = &roofline->points[roofline->nPoints];
+    if ( ! (p->method = strdup(method)) ) {
+        ERROR("unable to allocate roofline points");
+        exit(ENOMEM);
     }
+    p->n = n;
+    p->gflops = GetValueOrLastValue(mulTimer, ExecutionTimerMetricGFLOPs, ExecutionTimerValueMedian);
+    p->gbps = GetValueOrLastValue(mulTimer, ExecutionTimerMetricGBPerSec, ExecutionTimerValueMedian);
+    p->intensity = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricArithIntensity, ExecutionTimerValueLastValue);
+    roofline->nPoints++;
+}
 
-    //
-    // If no explicit nthreads has been specified, get it from the env:
+//
+// Columns of the roofline table:
+//
+static const ResultTableColumn RooflineResultColumns[] = {
+                { "method", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "GFLOP/s", ResultTableColumnTypeReal },
+                { "GB/s", ResultTableColumnTypeReal },
+                { "intensity", ResultTableColumnTypeReal },
+                { "level", ResultTableColumnTypeString },
+                { "roof GFLOP/s", ResultTableColumnTypeReal },
+                { "% peak compute", ResultTableColumnTypeReal },
+                { "% peak bandwidth", ResultTableColumnTypeReal },
+                { "bound", ResultTableColumnTypeString }
+            };
+
+//
+// Place each recorded result on the probe's roofline.  The bandwidth roof is
+// that of the innermost level of the memory hierarchy that holds the three
+// matrices; a result is memory-bound if its intensity is left of the ridge
+// point (peak GFLOP/s / bandwidth).  The points are released.
+//
+void
+RooflineSummarize(
+    RooflinePoints              *roofline,
+    MachineProbeRef             probe,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "roofline", sizeof(RooflineResultColumns) / sizeof(RooflineResultColumns[0]), RooflineResultColumns, stream);
+    unsigned int                i;
+
+    if ( ! results ) {
+        ERROR("unable to allocate roofline table");
+        exit(ENOMEM);
+    }
+    for ( i = 0; i < roofline->nPoints; i++ ) {
+        RooflinePoint               *p = &roofline->points[i];
+        double                      footprint = 3.0 * (double)p->n * (double)p->n * sizeof(f_real);
+        double                      bandwidth, roof;
+        unsigned int                level;
+        MachineProbeRooflineBound   bound;
+
+        roof = MachineProbeGetRoofline(probe, p->intensity, footprint, &bandwidth, &level, &bound);
+        ResultTableAddRow(results,
+                p->method,
+                (long)p->n,
+                p->gflops,
+                p->gbps,
+                p->intensity,
+                MachineProbeGetLevelName(probe, level),
+                roof,
+                100.0 * p->gflops / MachineProbeGetPeakGFLOPs(probe),
+                100.0 * p->gbps / bandwidth,
+                (bound == MachineProbeRooflineBoundMemory) ? "memory" : "compute"
+            );
+        free((void*)p->method);
+    }
+    ResultTableRelease(results);
+    if ( roofline->points ) free((void*)roofline->points);
+    roofline->points = NULL;
+    roofline->nPoints = roofline->capacity = 0;
+}
+
+//
+// Columns of the dimension sweep results table:
+//
+static const ResultTableColumn SweepResultColumns[] = {
+                { "method", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "iterations", ResultTableColumnTypeInteger },
+                { "walltime", ResultTableColumnTypeReal },
+                { "walltime MAD", ResultTableColumnTypeReal },
+                { "GFLOP/s", ResultTableColumnTypeReal },
+                { "GFLOP/s max", ResultTableColumnTypeReal },
+                { "GB/s", ResultTableColumnTypeReal },
+                { "intensity", ResultTableColumnTypeReal }
+            };
+
+//
+// Run every method in the list at every dimension in the sweep, writing one
+// row to stream per (method, dimension) pair.  Walltime, GFLOP/s and GB/s are medians
+// (the single value when only one iteration was timed).  If roofline is not NULL each result is also recorded there.
+//
+void
+RunDimensionSweep(
+    BenchmarkContext            *ctx,
+    MultiplyMethodList          *multiplyMethods,
+    ParameterSweepRef           dimensions,
+    ExecutionTimerRef           mulTimer,
+    ExecutionTimerOutputFormat  format,
+    RooflinePoints              *roofline,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "sweep", sizeof(SweepResultColumns) / sizeof(SweepResultColumns[0]), SweepResultColumns, stream);
+    MultiplyMethodList          *iterMultiplyMethods = multiplyMethods;
+
+    if ( ! results ) {
+        ERROR("unable to allocate sweep results table");
+        exit(ENOMEM);
+    }
+    while ( iterMultiplyMethods ) {
+        const char              *methodStr;
+        size_t                  methodStrLen;
+        MatrixMultiplyObjectRef multMethod;
+        unsigned int            i;
+
+        iterMultiplyMethods = MultiplyMethodListIter(iterMultiplyMethods, &methodStr, &methodStrLen);
+        if ( ! (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
+            ERROR("no such multiplication method: %s", methodStr);
+            exit(EINVAL);
+        }
+        for ( i = 0; i < ParameterSweepGetCount(dimensions); i++ ) {
+            f_integer           n = (f_integer)ParameterSweepGetValue(dimensions, i), nwarmupActual, nloopActual;
+
+            INFO("Sweep: %s at n = " FMT_F_INTEGER, MatrixMultiplyObjectGetName(multMethod), n);
+            nloopActual = MeasureMethod(ctx, multMethod, mulTimer, n, &nwarmupActual);
+            ResultTableAddRow(results,
+                    MatrixMultiplyObjectGetName(multMethod),
+                    (long)n,
+                    (long)nloopActual,
+                    GetValueOrLastValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMedian),
+                    ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMAD),
+                    GetValueOrLastValue(mulTimer, ExecutionTimerMetricGFLOPs, ExecutionTimerValueMedian),
+                    GetValueOrLastValue(mulTimer, ExecutionTimerMetricGFLOPs, ExecutionTimerValueMax),
+                    GetValueOrLastValue(mulTimer, ExecutionTimerMetricGBPerSec, ExecutionTimerValueMedian),
+                    ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricArithIntensity, ExecutionTimerValueLastValue)
+                );
+            fflush(stream);
+            if ( roofline ) RooflineAddPoint(roofline, MatrixMultiplyObjectGetName(multMethod), n, mulTimer);
+        }
+        MatrixMultiplyObjectRelease(multMethod);
+    }
+    ResultTableRelease(results);
+}
+
+//
+// Create a sweep of thread counts from a specification that may contain the
+// symbolic items "pow2" (powers of two up to maxThreads, plus maxThreads),
+// "all" (every count up to maxThreads), and "max" (maxThreads itself, also
+// permitted as a range bound).
+//
+ParameterSweepRef
+CreateThreadSweep(
+    const char      *spec,
+    int             maxThreads
+)
+{
+    size_t          expandedLen = 8 * strlen(spec) + 128, used = 0;
+    char            *expanded = malloc(expandedLen);
+    ParameterSweepRef   threadSweep;
+
+    if ( ! expanded ) {
+        ERROR("unable to allocate thread sweep specification");
+        exit(ENOMEM);
+    }
+    *expanded = '\0';
+    while ( *spec ) {
+        const char  *itemEnd = strchr(spec, ',');
+        size_t      itemLen;
+
+        if ( ! itemEnd ) itemEnd = spec + strlen(spec);
+        itemLen = itemEnd - spec;
+        if ( used ) expanded[used++] = ',';
+        if ( (itemLen == 4) && (strncasecmp(spec, "pow2", 4) == 0) ) {
+            used += snprintf(expanded + used, expandedLen - used, "1:%d:geometric:2,%d", maxThreads, maxThreads);
+        } else if ( (itemLen == 3) && (strncasecmp(spec, "all", 3) == 0) ) {
+            used += snprintf(expanded + used, expandedLen - used, "1:%d:linear:1", maxThreads);
+        } else {
+            while ( spec < itemEnd ) {
+                if ( (itemEnd - spec >= 3) && (strncasecmp(spec, "max", 3) == 0) ) {
+                    used += snprintf(expanded + used, expandedLen - used, "%d", maxThreads);
+                    spec += 3;
+                } else {
+                    expanded[used++] = *spec++;
+                }
+            }
+            expanded[used] = '\0';
+        }
+        spec = (*itemEnd == ',') ? (itemEnd + 1) : itemEnd;
+    }
+    threadSweep = ParameterSweepCreate("threads", expanded);
+    free((void*)expanded);
+    if ( threadSweep && (ParameterSweepGetValue(threadSweep, 0) <= 0) ) {
+        ERROR("invalid thread count in sweep: %ld", ParameterSweepGetValue(threadSweep, 0));
+        exit(EINVAL);
+    }
+    return threadSweep;
+}
+
+//
+// Matrix dimension used for a thread count in weak-scaling mode:  the work
+// (proportional to n^3) grows linearly with the thread count.
+//
+f_integer
+WeakScalingDimension(
+    f_integer       baseN,
+    long            threads
+)
+{
+    return (f_integer)lround((double)baseN * cbrt((double)threads));
+}
+
+//
+// Columns of the thread sweep results table:
+//
+static const ResultTableColumn ThreadSweepResultColumns[] = {
+                { "method", ResultTableColumnTypeString },
+                { "threads", ResultTableColumnTypeInteger },
+                { "n", ResultTableColumnTypeInteger },
+                { "iterations", ResultTableColumnTypeInteger },
+                { "walltime", ResultTableColumnTypeReal },
+                { "GFLOP/s", ResultTableColumnTypeReal },
+                { "speedup", ResultTableColumnTypeReal },
+                { "efficiency", ResultTableColumnTypeReal },
+                { "Karp-Flatt", ResultTableColumnTypeReal },
+                { "imbalance", ResultTableColumnTypeReal }
+            };
+
+//
+// Run every threaded method in the list at every thread count in the sweep,
+// writing one row to stream per (method, thread count) pair.
+//
+// Speedup is measured by the rate of work (flops per median walltime)
+// relative to the smallest thread count t0 in the sweep, scaled by t0 -- so
+// with t0 = 1 it is the usual T(1)/T(t) for strong scaling and the scaled
+// (Gustafson) speedup for weak scaling.  Parallel efficiency is speedup/t
+// and the Karp-Flatt experimentally-determined serial fraction is
+// (1/speedup - 1/t) / (1 - 1/t).
+//
+void
+RunThreadSweep(
+    BenchmarkContext            *ctx,
+    MultiplyMethodList          *multiplyMethods,
+    ParameterSweepRef           threadCounts,
+    f_integer                   baseN,
+    bool                        isWeakScaling,
+    ExecutionTimerRef           mulTimer,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, isWeakScaling ? "weak-scaling" : "strong-scaling", sizeof(ThreadSweepResultColumns) / sizeof(ThreadSweepResultColumns[0]), ThreadSweepResultColumns, stream);
+    MultiplyMethodList          *iterMultiplyMethods = multiplyMethods;
+
+    if ( ! results ) {
+        ERROR("unable to allocate thread sweep results table");
+        exit(ENOMEM);
+    }
+    while ( iterMultiplyMethods ) {
+        const char              *methodStr;
+        size_t                  methodStrLen;
+        MatrixMultiplyObjectRef multMethod;
+        unsigned int            i;
+        double                  baseRate = 0.0;
+        long                    baseThreads = ParameterSweepGetValue(threadCounts, 0);
+
+        iterMultiplyMethods = MultiplyMethodListIter(iterMultiplyMethods, &methodStr, &methodStrLen);
+        if ( ! (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
+            ERROR("no such multiplication method: %s", methodStr);
+            exit(EINVAL);
+        }
+        if ( ! MatrixMultiplyObjectIsThreaded(multMethod) ) {
+            WARN("%s is not a threaded method, skipping it in the thread sweep", MatrixMultiplyObjectGetName(multMethod));
+            MatrixMultiplyObjectRelease(multMethod);
+            continue;
+        }
+        for ( i = 0; i < ParameterSweepGetCount(threadCounts); i++ ) {
+            long                t = ParameterSweepGetValue(threadCounts, i);
+            f_integer           n = isWeakScaling ? WeakScalingDimension(baseN, t) : baseN;
+            f_integer           nwarmupActual, nloopActual;
+            double              flops = 0.0, bytes = 0.0, walltime, rate, speedup, karpFlatt = INFINITY;
+
+            INFO("Thread sweep: %s with %ld thread(s) at n = " FMT_F_INTEGER, MatrixMultiplyObjectGetName(multMethod), t, n);
+            ctx->nthreads = (int)t;
+            nloopActual = MeasureMethod(ctx, multMethod, mulTimer, n, &nwarmupActual);
+
+            walltime = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMedian);
+            if ( ! isfinite(walltime) ) walltime = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueLastValue);
+            MatrixMultiplyObjectGetWorkModel(multMethod, n, ctx->alpha, ctx->beta, &flops, &bytes);
+            rate = flops / walltime;
+            if ( i == 0 ) baseRate = rate;
+            speedup = (double)baseThreads * rate / baseRate;
+            if ( t > 1 ) karpFlatt = (1.0 / speedup - 1.0 / (double)t) / (1.0 - 1.0 / (double)t);
+            ResultTableAddRow(results,
+                    MatrixMultiplyObjectGetName(multMethod),
+                    t,
+                    (long)n,
+                    (long)nloopActual,
+                    walltime,
+                    1e-9 * rate,
+                    speedup,
+                    speedup / (double)t,
+                    karpFlatt,
+                    ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricThreadImbalance, ExecutionTimerValueMedian)
+                );
+            fflush(stream);
+        }
+        MatrixMultiplyObjectRelease(multMethod);
+    }
+    ResultTableRelease(results);
+}
+
+//
+// Columns of the autotuning results table:
+//
+static const ResultTableColumn TuneResultColumns[] = {
+                { "method", ResultTableColumnTypeString },
+                { "n", ResultTableColumnTypeInteger },
+                { "configuration", ResultTableColumnTypeString },
+                { "threads", ResultTableColumnTypeInteger },
+                { "walltime", ResultTableColumnTypeReal },
+                { "GFLOP/s", ResultTableColumnTypeReal },
+                { "search space", ResultTableColumnTypeInteger },
+                { "evaluated", ResultTableColumnTypeInteger },
+                { "pruned", ResultTableColumnTypeInteger }
+            };
+
+//
+// One point in a method's search space:
+//
+typedef struct {
+    char            *spec;
+    int             threads;
+} TuneCandidate;
+
+//
+// Enumerate the configurations of a method at dimension n:  the cartesian
+// product of its tuning parameters' values (tile sizes clamped to n, with
+// coincident values only tried once) and the thread counts.  A method
+// specification that already carries arguments only has its thread count
+// tuned.  Returns the number of candidates in *outCandidates.
+//
+unsigned int
+TuneEnumerateCandidates(
+    const char          *methodSpec,
+    f_integer           n,
+    ParameterSweepRef   threadCounts,
+    TuneCandidate*      *outCandidates
+)
+{
+    const MatrixMultiplyMethodTuningParameter   *params = MatrixMultiplyMethodGetTuningParameters(methodSpec);
+    unsigned int        nParams = 0, i, j, nCandidates = 0, nConfigs = 1;
+    size_t              specLen = strlen(methodSpec) + 1;
+    TuneCandidate       *candidates;
+
+    if ( strchr(methodSpec, '=') ) params = NULL;
+    while ( params && params[nParams].name ) nParams++;
+    {
+        const char      *values[nParams ? nParams : 1][64];
+        unsigned int    nValues[nParams ? nParams : 1], index[nParams ? nParams : 1];
+        char            clamped[nParams ? nParams : 1][64][24];
+
+        //
+        // Split each parameter's candidate values:
+        //
+        for ( i = 0; i < nParams; i++ ) {
+            const char  *v = params[i].values;
+
+            nValues[i] = 0;
+            while ( *v && (nValues[i] < 64) ) {
+                size_t  vLen = strcspn(v, ",");
+                char    *value = clamped[i][nValues[i]];
+                bool    isDuplicate = false;
+
+                snprintf(value, sizeof(clamped[i][0]), "%.*s", (int)vLen, v);
+                if ( params[i].isTileSize && (strtol(value, NULL, 0) > n) ) snprintf(value, sizeof(clamped[i][0]), FMT_F_INTEGER, n);
+                for ( j = 0; j < nValues[i]; j++ ) if ( strcmp(values[i][j], value) == 0 ) isDuplicate = true;
+                if ( ! isDuplicate ) values[i][nValues[i]++] = value;
+                v += vLen;
+                if ( *v == ',' ) v++;
+            }
+            nConfigs *= nValues[i];
+            index[i] = 0;
+            specLen += 24 + 1;
+        }
+        candidates = (TuneCandidate*)malloc(nConfigs * ParameterSweepGetCount(threadCounts) * sizeof(TuneCandidate));
+        if ( ! candidates ) {
+            ERROR("unable to allocate tuning candidates");
+            exit(ENOMEM);
+        }
+        for ( i = 0; i < nConfigs; i++ ) {
+            char        spec[specLen];
+            size_t      used = snprintf(spec, specLen, "%s", methodSpec);
+
+            for ( j = 0; j < nParams; j++ ) used += snprintf(spec + used, specLen - used, "%c%s", (j ? ':' : '='), values[j][index[j]]);
+            for ( j = 0; j < ParameterSweepGetCount(threadCounts); j++ ) {
+                if ( ! (candidates[nCandidates].spec = strdup(spec)) ) {
+                    ERROR("unable to allocate tuning candidates");
+                    exit(ENOMEM);
+                }
+                candidates[nCandidates++].threads = (int)ParameterSweepGetValue(threadCounts, j);
+            }
+            // Advance the mixed-radix index:
+            for ( j = nParams; j-- > 0; ) {
+                if ( ++index[j] < nValues[j] ) break;
+                index[j] = 0;
+            }
+        }
+    }
+    *outCandidates = candidates;
+    return nCandidates;
+}
+
+//
+// Search the configurations of each method in the list at each dimension,
+// recording the fastest (by median walltime) in the tuning cache and
+// writing one row per (method, dimension) pair.
+//
+// Search spaces no larger than the budget are searched exhaustively;
+// larger ones are sampled at random (with a fixed seed, so repeated runs
+// try the same configurations).  Each candidate is first screened with a
+// single warm-up and a single timed iteration; only candidates that are
+// within TUNE_PRUNE_FACTOR of the best median so far are measured with
+// the full iteration count.
+//
+void
+RunTuning(
+    BenchmarkContext            *ctx,
+    MultiplyMethodList          *multiplyMethods,
+    ParameterSweepRef           dimensions,
+    int                         budget,
+    TuningCacheRef              tuningCache,
+    ExecutionTimerRef           mulTimer,
+    ExecutionTimerOutputFormat  format,
+    FILE                        *stream
+)
+{
+    ResultTableRef              results = ResultTableCreate(format, "tuning", sizeof(TuneResultColumns) / sizeof(TuneResultColumns[0]), TuneResultColumns, stream);
+    MultiplyMethodList          *iterMultiplyMethods = multiplyMethods;
+    BenchmarkContext            screenCtx = *ctx;
+    int                         maxThreads = ctx->nthreads;
+    uint64_t                    rngState = 0x9E3779B97F4A7C15ULL;
+
+    if ( ! results ) {
+        ERROR("unable to allocate tuning results table");
+        exit(ENOMEM);
+    }
+    screenCtx.nloop = 1;
+    screenCtx.nwarmup = 1;
+    screenCtx.targetCI = 0.0;
+    // Screening iterations are not kept as raw samples:
+    screenCtx.samples = NULL;
+
+    while ( iterMultiplyMethods ) {
+        const char              *methodStr;
+        size_t                  methodStrLen;
+        MatrixMultiplyObjectRef multMethod;
+        ParameterSweepRef       threadCounts;
+        unsigned int            i;
+
+        iterMultiplyMethods = MultiplyMethodListIter(iterMultiplyMethods, &methodStr, &methodStrLen);
+        if ( ! (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
+            ERROR("no such multiplication method: %s", methodStr);
+            exit(EINVAL);
+        }
+        if ( strcasecmp(MatrixMultiplyObjectGetName(multMethod), "auto") == 0 ) {
+            WARN("the auto method cannot be tuned, skipping it");
+            MatrixMultiplyObjectRelease(multMethod);
+            continue;
+        }
+        if ( MatrixMultiplyObjectIsThreaded(multMethod) ) {
+            threadCounts = CreateThreadSweep("pow2", maxThreads);
+        } else {
+            threadCounts = ParameterSweepCreate("threads", "0");
+        }
+        MatrixMultiplyObjectRelease(multMethod);
+        if ( ! threadCounts ) exit(ENOMEM);
+
+        for ( i = 0; i < ParameterSweepGetCount(dimensions); i++ ) {
+            f_integer           n = (f_integer)ParameterSweepGetValue(dimensions, i);
+            TuneCandidate       *candidates, best = { NULL, 0 };
+            unsigned int        nCandidates = TuneEnumerateCandidates(methodStr, n, threadCounts, &candidates);
+            unsigned int        nTried = nCandidates, nEvaluated = 0, nPruned = 0, nSinceImprovement = 0, c;
+            double              bestWalltime = INFINITY, bestGFLOPs = 0.0;
+
+            //
+            // Sample the search space down to the budget by a partial
+            // Fisher-Yates shuffle:
+            //
+            if ( nCandidates > (unsigned int)budget ) {
+                for ( c = 0; c < (unsigned int)budget; c++ ) {
+                    unsigned int    r;
+                    TuneCandidate   swap;
+
+                    rngState ^= rngState << 13; rngState ^= rngState >> 7; rngState ^= rngState << 17;
+                    r = c + (unsigned int)(rngState % (nCandidates - c));
+                    swap = candidates[c]; candidates[c] = candidates[r]; candidates[r] = swap;
+                }
+                nTried = budget;
+            }
+            INFO("Tuning %s at n = " FMT_F_INTEGER ": %u of %u configuration(s)", methodStr, n, nTried, nCandidates);
+
+            for ( c = 0; (c < nTried) && (nSinceImprovement < TUNE_PATIENCE); c++ ) {
+                MatrixMultiplyObjectRef candidateMethod = MatrixMultiplyObjectCreate(candidates[c].spec);
+                f_integer               nwarmupActual;
+                double                  walltime, flops = 0.0, bytes = 0.0;
+                int                     threads = candidates[c].threads ? candidates[c].threads : maxThreads;
+
+                if ( ! candidateMethod ) {
+                    WARN("unable to create tuning candidate %s", candidates[c].spec);
+                    continue;
+                }
+                nEvaluated++;
+                screenCtx.nthreads = ctx->nthreads = threads;
+                MeasureMethod(&screenCtx, candidateMethod, mulTimer, n, &nwarmupActual);
+                walltime = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueLastValue);
+                if ( walltime > TUNE_PRUNE_FACTOR * bestWalltime ) {
+                    DEBUG("Pruned %s with %d thread(s): %lg s", candidates[c].spec, threads, walltime);
+                    nPruned++;
+                    nSinceImprovement++;
+                    MatrixMultiplyObjectRelease(candidateMethod);
+                    continue;
+                }
+                MeasureMethod(ctx, candidateMethod, mulTimer, n, &nwarmupActual);
+                walltime = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMedian);
+                if ( ! isfinite(walltime) ) walltime = ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueLastValue);
+                DEBUG("Measured %s with %d thread(s): %lg s", candidates[c].spec, threads, walltime);
+                if ( walltime < bestWalltime ) {
+                    MatrixMultiplyObjectGetWorkModel(candidateMethod, n, ctx->alpha, ctx->beta, &flops, &bytes);
+                    bestWalltime = walltime;
+                    bestGFLOPs = 1e-9 * flops / walltime;
+                    best = candidates[c];
+                    nSinceImprovement = 0;
+                } else {
+                    nSinceImprovement++;
+                }
+                MatrixMultiplyObjectRelease(candidateMethod);
+            }
+            if ( c < nTried ) INFO("No improvement in %d consecutive configurations, stopping early", TUNE_PATIENCE);
+            ctx->nthreads = maxThreads;
+
+            if ( best.spec ) {
+                if ( ! TuningCacheRecord(tuningCache, n, best.spec, best.threads, bestGFLOPs) ) {
+                    ERROR("unable to record tuning result");
+                    exit(ENOMEM);
+                }
+            }
+            ResultTableAddRow(results,
+                    methodStr,
+                    (long)n,
+                    best.spec ? best.spec : "",
+                    (long)(best.threads ? best.threads : maxThreads),
+                    bestWalltime,
+                    bestGFLOPs,
+                    (long)nCandidates,
+                    (long)nEvaluated,
+                    (long)nPruned
+                );
+            fflush(stream);
+            for ( c = 0; c < nCandidates; c++ ) free((void*)candidates[c].spec);
+            free((void*)candidates);
+        }
+        ParameterSweepRelease(threadCounts);
+    }
+    ResultTableRelease(results);
+}
+
+//
+// Where the raw samples go and what they are compared with:
+//
+typedef struct {
+    const char      *path;
+    const char      *csvPath;
+    const char      *baselinePath;
+    const char      *comparePath;
+    SampleFileRef   baseline;
+    double          regressionThreshold;
+} SampleOptions;
+
+//
+// The results that are being written, so that a fatal exit part-way through
+// the run still leaves a complete JSON or YAML document:
+//
+static ResultEmitterRef OpenResults = NULL;
+
+void
+FinishOpenResultsAtExit(void)
+{
+    if ( OpenResults ) ResultEmitterFinish(OpenResults);
+}
+
+//
+// Start a section of results, exiting if that is not possible.
+//
+FILE*
+BeginResultSection(
+    ResultEmitterRef            results,
+    const char                  *kind,
+    const char                  *caption
+)
+{
+    FILE                        *stream = ResultEmitterBeginSection(results, kind, caption);
+
+    if ( ! stream ) {
+        ERROR("unable to allocate %s results", kind);
+        exit(ENOMEM);
+    }
+    return stream;
+}
+
+//
+// Add the values of a parameter sweep to the current section of results as
+// a string attribute.
+//
+void
+SetResultSweep(
+    ResultEmitterRef            results,
+    const char                  *key,
+    ParameterSweepRef           aSweep
+)
+{
+    char                        *values = NULL;
+    size_t                      valuesLen = 0;
+    FILE                        *stream = open_memstream(&values, &valuesLen);
+
+    if ( stream ) {
+        ParameterSweepPrint(aSweep, stream);
+        if ( fclose(stream) == 0 ) ResultEmitterSetString(results, key, values);
+    }
+    if ( values ) free((void*)values);
+}
+
+//
+// Finish and release the results, returning rc -- or 1 if it was zero and
+// the results could not be written.
+//
+int
+FinishResults(
+    ResultEmitterRef            results,
+    int                         rc
+)
+{
+    bool                        isWritten = ResultEmitterFinish(results);
+
+    if ( results == OpenResults ) OpenResults = NULL;
+    ResultEmitterRelease(results);
+    if ( ! isWritten ) {
+        ERROR("unable to write results (errno = %d)", errno);
+        if ( rc == 0 ) rc = 1;
+    }
+    return rc;
+}
+
+//
+// Add the init timer's samples (accumulated over the whole run) to the raw
+// samples, write them to the sample file, CSV, and/or baseline, and compare
+// the walltimes with the baseline (as a section of results or, if that is
+// NULL, a table on stderr).  The samples are released.  Returns zero, 1 if a
+// file could not be written, or EXIT_REGRESSION if any routine regressed.
+//
+int
+FinishSamples(
+    BenchmarkContext            *ctx,
+    long                        n,
+    SampleOptions               *options,
+    ResultEmitterRef            results
+)
+{
+    char                        initName[strlen(MatrixInitObjectGetName(ctx->initObj)) + 8];
+    int                         rc = 0;
+
+    if ( ! ctx->samples ) return 0;
+    snprintf(initName, sizeof(initName), "init:%s", MatrixInitObjectGetName(ctx->initObj));
+    if ( ! SampleFileAddTimer(ctx->samples, initName, n, ctx->nthreads, ctx->initTimer) ) {
+        ERROR("unable to allocate raw samples");
+        exit(ENOMEM);
+    }
+    if ( options->path ) {
+        if ( SampleFileWrite(ctx->samples, options->path) ) {
+            INFO("Raw samples written to %s (%u column(s))", options->path, SampleFileGetColumnCount(ctx->samples));
+        } else {
+            rc = 1;
+        }
+    }
+    if ( options->csvPath ) {
+        FILE                    *csvFile = fopen(options->csvPath, "w");
+        bool                    isWritten = false;
+
+        if ( csvFile ) {
+            SampleFileSummarizeToStream(ctx->samples, ExecutionTimerOutputFormatCSV, NULL, NULL, csvFile);
+            isWritten = (ferror(csvFile) == 0);
+            if ( fclose(csvFile) != 0 ) isWritten = false;
+        }
+        if ( ! isWritten ) {
+            ERROR("unable to write raw samples to %s (errno = %d)", options->csvPath, errno);
+            rc = 1;
+        }
+    }
+    if ( options->baselinePath ) {
+        if ( SampleFileWrite(ctx->samples, options->baselinePath) ) {
+            INFO("Baseline saved to %s", options->baselinePath);
+        } else {
+            rc = 1;
+        }
+    }
+    if ( options->baseline ) {
+        unsigned int            nRegressions;
+        char                    caption[strlen(options->comparePath) + 64];
+
+        snprintf(caption, sizeof(caption), "Comparison of walltime medians with baseline %s", options->comparePath);
+        if ( results ) {
+            FILE                *stream = BeginResultSection(results, "comparison", caption);
+
+            ResultEmitterSetString(results, "baseline", options->comparePath);
+            ResultEmitterSetReal(results, "regression_threshold", options->regressionThreshold);
+            nRegressions = SampleFileCompareToStream(options->baseline, ctx->samples, "Walltime", options->regressionThreshold, ResultEmitterGetFormat(results), stream);
+            ResultEmitterEndSection(results);
+        } else {
+            fprintf(stderr, "%s:\n\n", caption);
+            nRegressions = SampleFileCompareToStream(options->baseline, ctx->samples, "Walltime", options->regressionThreshold, ExecutionTimerOutputFormatTable, stderr);
+            fprintf(stderr, "\n\n");
+        }
+        if ( nRegressions > 0 ) {
+            ERROR("%u routine(s) regressed by more than %lg%% against %s", nRegressions, 100.0 * options->regressionThreshold, options->comparePath);
+            if ( rc == 0 ) rc = EXIT_REGRESSION;
+        }
+        SampleFileRelease(options->baseline);
+        options->baseline = NULL;
+    }
+    SampleFileRelease(ctx->samples);
+    ctx->samples = NULL;
+    return rc;
+}
+
+//
+// Write a C string to stream as a JSON string.
+//
+void
+WriteJSONString(
+    FILE            *stream,
+    const char      *s
+)
+{
+    fputc('"', stream);
+    while ( *s ) {
+        unsigned char   c = (unsigned char)*s++;
+
+        if ( (c == '"') || (c == '\\') ) {
+            fputc('\\', stream);
+            fputc(c, stream);
+        } else if ( c < 0x20 ) {
+            fprintf(stream, "\\u%04x", c);
+        } else {
+            fputc(c, stream);
+        }
+    }
+    fputc('"', stream);
+}
+
+//
+// Write a real number to stream as a JSON number (null if not finite).
+//
+void
+WriteJSONReal(
+    FILE            *stream,
+    double          v
+)
+{
+    if ( isfinite(v) ) fprintf(stream, "%.6lg", v); else fputs("null", stream);
+}
+
+//
+// Run the node-screening suite and write its results to stdout as a single
+// line of JSON:
+//
+//     {"format":"mmbench-screen-1","host":...,"fingerprint":...,"precision":...,
+//      "threads":...,"n":...,"timestamp":...,"kernel":...,"microcode":...,
+//      "governor":...,"results":[{"method":...,"iterations":...,"gflops":...,
+//      "gflops_mad":...,"walltime":...},...]}
+//
+// GFLOP/s and walltime are medians; the kernel, microcode, and governor come
+// from the run manifest, as the usual suspects when a node is slow.  Returns false if a routine could not
+// be created.
+//
+bool
+RunScreen(
+    BenchmarkContext        *ctx,
+    MultiplyMethodList      *multiplyMethods,
+    ExecutionTimerRef       mulTimer,
+    f_integer               n,
+    RunManifestRef          manifest
+)
+{
+    MachineInfoRef          machine = MachineInfoCreate();
+    char                    host[256] = "", timestamp[32] = "";
+    time_t                  now = time(NULL);
+    struct tm               utc;
+    const char              *sep = "";
+
+    if ( ! machine ) {
+        ERROR("unable to gather machine information");
+        exit(ENOMEM);
+    }
+    if ( gethostname(host, sizeof(host)) != 0 ) strncpy(host, "unknown", sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    if ( gmtime_r(&now, &utc) ) strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+    printf("{\"format\":\"mmbench-screen-1\",\"host\":");
+    WriteJSONString(stdout, host);
+    printf(",\"fingerprint\":");
+    WriteJSONString(stdout, MachineInfoGetFingerprint(machine));
+    printf(",\"precision\":\"%s\",\"threads\":%d,\"n\":%ld,\"timestamp\":\"%s\",\"kernel\":",
+            (sizeof(f_real) == 8) ? "double" : "single", ctx->nthreads, (long)n, timestamp);
+    WriteJSONString(stdout, RunManifestGetValue(manifest, "kernel.release") ? RunManifestGetValue(manifest, "kernel.release") : "unknown");
+    printf(",\"microcode\":");
+    WriteJSONString(stdout, RunManifestGetValue(manifest, "cpu.microcode"));
+    printf(",\"governor\":");
+    WriteJSONString(stdout, RunManifestGetValue(manifest, "frequency.governor"));
+    printf(",\"results\":[");
+    MachineInfoRelease(machine);
+
+    while ( multiplyMethods ) {
+        const char              *methodStr;
+        size_t                  methodStrLen;
+        MatrixMultiplyObjectRef multMethod;
+        f_integer               nwarmupActual, loop;
+
+        multiplyMethods = MultiplyMethodListIter(multiplyMethods, &methodStr, &methodStrLen);
+        if ( ! (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
+            ERROR("no such multiplication method: %s", methodStr);
+            return false;
+        }
+        INFO("Screening %s at n = " FMT_F_INTEGER, MatrixMultiplyObjectGetName(multMethod), n);
+        loop = MeasureMethod(ctx, multMethod, mulTimer, n, &nwarmupActual);
+        printf("%s{\"method\":", sep);
+        WriteJSONString(stdout, MatrixMultiplyObjectGetName(multMethod));
+        printf(",\"iterations\":%ld,\"gflops\":", (long)loop);
+        WriteJSONReal(stdout, ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricGFLOPs, ExecutionTimerValueMedian));
+        printf(",\"gflops_mad\":");
+        WriteJSONReal(stdout, ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricGFLOPs, ExecutionTimerValueMAD));
+        printf(",\"walltime\":");
+        WriteJSONReal(stdout, ExecutionTimerGetValue(mulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMedian));
+        printf("}");
+        sep = ",";
+        MatrixMultiplyObjectRelease(multMethod);
+    }
+    printf("]}\n");
+    fflush(stdout);
+    return true;
+}
+
+//
+// Main program.
+//
+int
+main(
+    int                 argc,
+    char* const         argv[]
+)
+{
+    const char                  *exe = argv[0];
+    f_integer                   n = DEFAULT_MATRIX_DIMENSION, nloop = DEFAULT_NLOOP, loop;
+    f_integer                   maxNloop = DEFAULT_MAX_NLOOP, nwarmup = DEFAULT_WARMUP;
+    double                      targetCI = DEFAULT_TARGET_CI;
+    ParameterSweepRef           dimensionSweep = NULL, threadSweep = NULL;
+    const char                  *threadSweepSpec = NULL;
+    bool                        isWeakScaling = false;
+    bool                        shouldTune = false;
+    int                         tuneBudget = DEFAULT_TUNE_BUDGET;
+    const char                  *tuningCachePath = NULL;
+    bool                        shouldProbe = false, shouldReprobe = false;
+    MachineProbeRef             machineProbe = NULL;
+    RooflinePoints              roofline = { 0, 0, NULL };
+    f_integer                   baseN;
+    BenchmarkContext            benchmark;
+#ifdef HAVE_OPENMP
+    int                         nthreads = 0;
+#endif
+    f_real                      *A=NULL, *B=NULL, *C=NULL, alpha = DEFAULT_ALPHA, beta = DEFAULT_BETA;
+    const char                  *initMethod = DEFAULT_INIT_METHOD;
+    MatrixInitObjectRef         matrixInitMethod = NULL;
+    MultiplyMethodList          *multiplyMethods = NULL, *iterMultiplyMethods;
+    size_t                      allocAlign = DEFAULT_ALLOC_ALIGNMENT;
+    bool                        shouldAlign = true;
+    bool                        shouldUsePerfCounters = false;
+    bool                        shouldSubtractOverhead = false;
+    const char                  *tracePath = NULL;
+    bool                        shouldScreen = false;
+    bool                        shouldWriteManifest = true;
+    RunManifestRef              manifest;
+    ResultEmitterRef            results = NULL;
+    SampleOptions               sampleOptions = { NULL, NULL, NULL, NULL, NULL, DEFAULT_REGRESSION_THRESHOLD };
+    int                         rc;
+    ExecutionTimerRef           matInitTimer = ExecutionTimerCreate();
+    ExecutionTimerRef           matMulTimer = ExecutionTimerCreate();
+    ExecutionTimerRef           warmupTimer = ExecutionTimerCreate();
+    ExecutionTimerRef           warmupInitTimer = ExecutionTimerCreate();
+    ExecutionTimerOutputFormat  timerOutputFormat;
+
+    int                         optc;
+
+    MultiplyMethodListParse(&multiplyMethods, DEFAULT_MULTIPLY_METHODS);
+    timerOutputFormat = ExecutionTimerOutputFormatParse(DEFAULT_OUTPUT_FORMAT);
+
+    //
+    // Process CLI arguments:
+    //
+    while ( (optc = getopt_long(argc, argv, cli_optstring, cli_opts, NULL)) != -1 ) {
+        switch (optc) {
+            case 'h': {
+                usage(exe);
+                break;
+            }
+
+            case 'v': {
+                verbosity++;
+                break;
+            }
+
+            case 'A': {
+                shouldAlign = false;
+                break;
+            }
+
+            case 'P': {
+                shouldUsePerfCounters = true;
+                break;
+            }
+
+            case 'X': {
+                char        *spec, *item, *savePtr = NULL;
+
+                if ( !optarg || (*optarg == '\0') || ! (spec = strdup(optarg)) ) {
+                    ERROR("no timer scope specification provided");
+                    exit(EINVAL);
+                }
+                for ( item = strtok_r(spec, ",", &savePtr); item; item = strtok_r(NULL, ",", &savePtr) ) {
+                    char                *value = strchr(item, '=');
+                    bool                isInit = true, isMultiply = true;
+                    ExecutionTimerScope scope;
+
+                    if ( value ) {
+                        *value++ = '\0';
+                        if ( strcasecmp(item, "init") == 0 ) {
+                            isMultiply = false;
+                        } else if ( strcasecmp(item, "multiply") == 0 ) {
+                            isInit = false;
+                        } else {
+                            ERROR("invalid timer in scope specification: %s", item);
+                            exit(EINVAL);
+                        }
+                    } else {
+                        value = item;
+                    }
+                    scope = ExecutionTimerScopeParse(value);
+                    if ( scope == ExecutionTimerScopeInvalid ) {
+                        ERROR("invalid timer scope: %s", value);
+                        exit(EINVAL);
+                    }
+                    if ( isInit ) {
+                        ExecutionTimerSetScope(matInitTimer, scope);
+                        ExecutionTimerSetScope(warmupInitTimer, scope);
+                    }
+                    if ( isMultiply ) {
+                        ExecutionTimerSetScope(matMulTimer, scope);
+                        ExecutionTimerSetScope(warmupTimer, scope);
+                    }
+                }
+                free((void*)spec);
+                break;
+            }
+
+            case 'O': {
+                shouldSubtractOverhead = true;
+                break;
+            }
+
+            case 'E': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no trace file specified");
+                    exit(EINVAL);
+                }
+                tracePath = optarg;
+                break;
+            }
+
+            case 'Y': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no sample file specified");
+                    exit(EINVAL);
+                }
+                sampleOptions.path = optarg;
+                break;
+            }
+
+            case 'Z': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no sample CSV file specified");
+                    exit(EINVAL);
+                }
+                sampleOptions.csvPath = optarg;
+                break;
+            }
+
+            case 'G': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no baseline file specified");
+                    exit(EINVAL);
+                }
+                sampleOptions.baselinePath = optarg;
+                break;
+            }
+
+            case 'Q': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no baseline file specified");
+                    exit(EINVAL);
+                }
+                sampleOptions.comparePath = optarg;
+                break;
+            }
+
+            case 'q': {
+                char        *end;
+                double      v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no regression threshold specified");
+                    exit(EINVAL);
+                }
+                v = strtod(optarg, &end);
+                if ( end == NULL || end == optarg || v < 0.0 ) {
+                    ERROR("invalid regression threshold: %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( *end == '%' ) v *= 0.01;
+                sampleOptions.regressionThreshold = v;
+                break;
+            }
+
+            case 'k': {
+                ExecutionTimerClock clock = ExecutionTimerClockParse(optarg);
+
+                if ( !optarg || (*optarg == '\0') || (clock == ExecutionTimerClockInvalid) ) {
+                    ERROR("invalid timer clock: %s", optarg ? optarg : "");
+                    exit(EINVAL);
+                }
+                ExecutionTimerSetClock(matInitTimer, clock);
+                ExecutionTimerSetClock(warmupInitTimer, clock);
+                ExecutionTimerSetClock(matMulTimer, clock);
+                ExecutionTimerSetClock(warmupTimer, clock);
+                if ( clock == ExecutionTimerClockTSC ) {
+                    if ( ExecutionTimerGetTSCFrequency() > 0.0 ) {
+                        INFO("invariant TSC calibrated at %.6lg GHz", 1e-9 * ExecutionTimerGetTSCFrequency());
+                    }
+                }
+                break;
+            }
+
+            case 'K': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no batch size specified");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( (v <= 0) || (v > INT_MAX) || end == NULL || end == optarg ) {
+                    ERROR("invalid batch size: %s", optarg);
+                    exit(EINVAL);
+                }
+                ExecutionTimerSetBatchSize(matMulTimer, (unsigned int)v);
+                ExecutionTimerSetBatchSize(warmupTimer, (unsigned int)v);
+                break;
+            }
+
+            case 'i': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("ERROR:  no matrix init specification provided");
+                    exit(EINVAL);
+                }
+                initMethod = optarg;
+                break;
+            }
+
+            case 'r': {
+                if ( optarg && *optarg ) MultiplyMethodListParse(&multiplyMethods, optarg);
+                break;
+            }
+
+            case 'a': {
+                char        *end;
+
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no value provided for alpha coefficient");
+                    exit(EINVAL);
+                }
+                alpha = strtod(optarg, &end);
+                if ( end == NULL || end == optarg ) {
+                    ERROR("invalid alpha coefficient: %s", optarg);
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 'b': {
+                char        *end;
+
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no value provided for beta coefficient");
+                    exit(EINVAL);
+                }
+                beta = strtod(optarg, &end);
+                if ( end == NULL || end == optarg ) {
+                    ERROR("invalid beta coefficient: %s", optarg);
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 't': {
+                char        *end;
+                long        v;
+
+#ifdef HAVE_OPENMP
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no value provided for thread count");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( v < 0 || end == NULL || end == optarg ) {
+                    ERROR("invalid thread count: %s", optarg);
+                    exit(EINVAL);
+                }
+                nthreads = v;
+#else
+                WARN("OpenMP arguments ignored");
+#endif
+                break;
+            }
+
+            case 'n': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no matrix dimension specified");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( (v <= 1) || end == NULL || end == optarg ) {
+                    ERROR("invalid matrix dimension: %s", optarg);
+                    exit(EINVAL);
+                }
+                n = v;
+                break;
+            }
+
+            case 'l':
+            case 'L': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no iteration count specified");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( (v <= 0) || end == NULL || end == optarg ) {
+                    ERROR("invalid iteration count: %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( optc == 'l' ) nloop = v; else maxNloop = v;
+                break;
+            }
+
+            case 'w': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no warm-up specification provided");
+                    exit(EINVAL);
+                }
+                if ( strcasecmp(optarg, "auto") == 0 ) {
+                    nwarmup = -1;
+                } else {
+                    v = strtol(optarg, &end, 0);
+                    if ( (v < 0) || end == NULL || end == optarg ) {
+                        ERROR("invalid warm-up specification: %s", optarg);
+                        exit(EINVAL);
+                    }
+                    nwarmup = v;
+                }
+                break;
+            }
+
+            case 'c': {
+                char        *end;
+                double      v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no confidence interval target specified");
+                    exit(EINVAL);
+                }
+                v = strtod(optarg, &end);
+                if ( end == NULL || end == optarg || v < 0.0 ) {
+                    ERROR("invalid confidence interval target: %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( *end == '%' ) v *= 0.01;
+                targetCI = v;
+                break;
+            }
+
+            case 'N': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no sweep specification provided");
+                    exit(EINVAL);
+                }
+                if ( dimensionSweep ) ParameterSweepRelease(dimensionSweep);
+                if ( ! (dimensionSweep = ParameterSweepCreateWithString(optarg)) ) exit(EINVAL);
+                if ( strcmp(ParameterSweepGetName(dimensionSweep), "n") != 0 ) {
+                    ERROR("only the matrix dimension (n) can be swept: %s", optarg);
+                    exit(EINVAL);
+                }
+                if ( ParameterSweepGetValue(dimensionSweep, 0) <= 0 ) {
+                    ERROR("invalid matrix dimension in sweep: %ld", ParameterSweepGetValue(dimensionSweep, 0));
+                    exit(EINVAL);
+                }
+                break;
+            }
+
+            case 'T': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no thread sweep specification provided");
+                    exit(EINVAL);
+                }
+                threadSweepSpec = optarg;
+                break;
+            }
+
+            case 'W': {
+                isWeakScaling = true;
+                break;
+            }
+
+            case 'u': {
+                shouldTune = true;
+                break;
+            }
+
+            case 'F': {
+                shouldScreen = true;
+                break;
+            }
+
+            case 'M': {
+                shouldWriteManifest = false;
+                break;
+            }
+
+            case 'R':
+                shouldReprobe = true;
+            case 'p': {
+                shouldProbe = true;
+                break;
+            }
+
+            case 'U': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no tuning budget specified");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( (v <= 0) || (v > INT_MAX) || end == NULL || end == optarg ) {
+                    ERROR("invalid tuning budget: %s", optarg);
+                    exit(EINVAL);
+                }
+                tuneBudget = v;
+                break;
+            }
+
+            case 'C': {
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no tuning cache path specified");
+                    exit(EINVAL);
+                }
+                //
+                // The auto method locates the cache through the environment:
+                //
+                tuningCachePath = optarg;
+                setenv("MMBENCH_TUNING_CACHE", tuningCachePath, 1);
+                break;
+            }
+
+            case 'S': {
+                char        *end;
+                long        v;
+                if ( !optarg || (*optarg == '\0') ) {
+                    ERROR("no alignment byte count specified");
+                    exit(EINVAL);
+                }
+                v = strtol(optarg, &end, 0);
+                if ( (v <= 0) || end == NULL || end == optarg ) {
+                    ERROR("invalid alignment byte count: %s", optarg);
+                    exit(EINVAL);
+                }
+                allocAlign = v;
+                break;
+            }
+
+            case 'f': {
+                ExecutionTimerOutputFormat  newFormat = ExecutionTimerOutputFormatParse(optarg);
+
+                if ( newFormat == ExecutionTimerOutputFormatInvalid ) {
+                    WARN("invalid timer output format specified: %s", optarg);
+                } else {
+                    timerOutputFormat = newFormat;
+                }
+                break;
+            }
+        }
+    }
+
+    //
+    // The screening suite overrides the initialization, routines, dimension,
+    // and iteration counts:
+    //
+    if ( shouldScreen ) {
+        if ( dimensionSweep || threadSweepSpec || shouldTune || shouldProbe ) {
+            ERROR("--screen cannot be combined with --sweep, --thread-sweep, --tune, or --probe");
+            exit(EINVAL);
+        }
+        initMethod = SCREEN_INIT_METHOD;
+        MultiplyMethodListParse(&multiplyMethods, "=" SCREEN_MULTIPLY_METHODS);
+        n = SCREEN_DIMENSION;
+        nloop = SCREEN_NLOOP;
+        nwarmup = DEFAULT_WARMUP;
+        targetCI = 0.0;
+    }
+
+    INFO("Initialization method requested: %s", initMethod);
+    matrixInitMethod = MatrixInitObjectCreate(initMethod);
+    if ( ! matrixInitMethod ) {
+        ERROR("unable to allocate matrix initializer: %s", initMethod);
+        exit(EINVAL);
+    }
+    INFO("Multiplication methods requested: %s", MultiplyMethodListGetString(multiplyMethods));
+    //
+    // Every routine is checked before any results are written:
+    //
+    {
+        MultiplyMethodList      *iterMultiplyMethods = multiplyMethods;
+
+        while ( iterMultiplyMethods ) {
+            const char          *methodStr;
+            size_t              methodStrLen;
+            MatrixMultiplyObjectRef multMethod;
+
+            iterMultiplyMethods = MultiplyMethodListIter(iterMultiplyMethods, &methodStr, &methodStrLen);
+            if ( ! (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
+                ERROR("no such multiplication method: %s", methodStr);
+                exit(EINVAL);
+            }
+            MatrixMultiplyObjectRelease(multMethod);
+        }
+    }
+    //
+    // Thread counts are resolved against the maximum (the -t value or the
+    // OpenMP runtime default):
+    //
+    if ( threadSweepSpec ) {
+        int             maxThreads;
+
+        if ( dimensionSweep ) {
+            ERROR("--sweep and --thread-sweep cannot be combined");
+            exit(EINVAL);
+        }
+        if ( shouldTune ) {
+            ERROR("--tune and --thread-sweep cannot be combined");
+            exit(EINVAL);
+        }
+#ifdef HAVE_OPENMP
+        maxThreads = (nthreads > 0) ? nthreads : omp_get_max_threads();
+#else
+        maxThreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if ( ! (threadSweep = CreateThreadSweep(threadSweepSpec, maxThreads)) ) exit(EINVAL);
+        if ( verbosity >= 2 ) {
+            fprintf(stderr, "INFO(%s:%d)  Thread count sweep: ", __FILE__, __LINE__);
+            ParameterSweepPrint(threadSweep, stderr);
+            fputc('\n', stderr);
+        }
+    } else if ( isWeakScaling ) {
+        WARN("--weak-scaling has no effect without --thread-sweep");
+    }
+
+    baseN = n;
+    if ( threadSweep && isWeakScaling ) {
+        n = WeakScalingDimension(baseN, ParameterSweepGetMaxValue(threadSweep));
+        INFO("Weak scaling from matrix dimension " FMT_F_INTEGER " up to " FMT_F_INTEGER, baseN, n);
+    } else if ( dimensionSweep ) {
+        //
+        // The matrices are allocated once at the largest dimension in the
+        // sweep and reused (as a leading sub-region) for all smaller ones:
+        //
+        n = (f_integer)ParameterSweepGetMaxValue(dimensionSweep);
+        if ( verbosity >= 2 ) {
+            fprintf(stderr, "INFO(%s:%d)  Matrix dimension sweep: ", __FILE__, __LINE__);
+            ParameterSweepPrint(dimensionSweep, stderr);
+            fputc('\n', stderr);
+        }
+    } else {
+        INFO("Matrix dimension: " FMT_F_INTEGER, n);
+    }
+    INFO("Number of loop iterations per method: " FMT_F_INTEGER, nloop);
+    if ( targetCI > 0.0 ) INFO("Iterating until 95%% confidence interval is within %lg%% of average walltime (max " FMT_F_INTEGER " iterations)", 100.0 * targetCI, maxNloop);
+    if ( nwarmup < 0 ) {
+        INFO("Warm-up iterations: auto");
+    } else {
+        INFO("Warm-up iterations: " FMT_F_INTEGER, nwarmup);
+    }
+    INFO("Timing output format: %s", ExecutionTimerOutputFormatToString(timerOutputFormat));
+
+    //
+    // Hardware counters must be opened before any worker threads are started
+    // so that the threads inherit them:
+    //
+    if ( shouldUsePerfCounters ) {
+        if ( ExecutionTimerEnableHardwareCounters(matMulTimer) && ExecutionTimerEnableHardwareCounters(warmupTimer) ) {
+            INFO("Hardware performance counters enabled");
+        }
+    }
+
+    //
+    // Measure what each timer costs in its final configuration:
+    //
+    ExecutionTimerCalibrateOverhead(matInitTimer, TIMER_OVERHEAD_SAMPLES);
+    ExecutionTimerCalibrateOverhead(matMulTimer, TIMER_OVERHEAD_SAMPLES);
+    ExecutionTimerCalibrateOverhead(warmupTimer, TIMER_OVERHEAD_SAMPLES);
+    ExecutionTimerSetShouldSubtractOverhead(matInitTimer, shouldSubtractOverhead);
+    ExecutionTimerSetShouldSubtractOverhead(matMulTimer, shouldSubtractOverhead);
+    ExecutionTimerSetShouldSubtractOverhead(warmupTimer, shouldSubtractOverhead);
+    INFO("Timer overhead (median): %lg s multiply, %lg s init",
+            ExecutionTimerGetOverheadValue(matMulTimer, ExecutionTimerValueMedian),
+            ExecutionTimerGetOverheadValue(matInitTimer, ExecutionTimerValueMedian));
+
+    //
+    // The trace is written when the program exits:
+    //
+    ExecutionTimerSetName(matInitTimer, "init");
+    ExecutionTimerSetName(matMulTimer, "multiply");
+    ExecutionTimerSetName(warmupTimer, "warm-up");
+    ExecutionTimerSetName(warmupInitTimer, "warm-up init");
+    if ( tracePath ) {
+        if ( ! TraceLogOpen(tracePath, 0) ) exit(EINVAL);
+        ExecutionTimerSetEventHook(TraceTimerEvent, NULL);
+        INFO("Recording trace events to %s", tracePath);
+    }
+
+    //
+    // Keep every cycle's values (after calibration, so the empty cycles are
+    // not among them):
+    //
+    if ( sampleOptions.path || sampleOptions.csvPath || sampleOptions.baselinePath || sampleOptions.comparePath ) {
+        ExecutionTimerSetShouldRecordSamples(matInitTimer, true);
+        ExecutionTimerSetShouldRecordSamples(matMulTimer, true);
+        ExecutionTimerSetShouldRecordSamples(warmupTimer, true);
+    }
+
+    //
+    // An unreadable baseline is reported before the run:
+    //
+    if ( sampleOptions.comparePath ) {
+        if ( ! (sampleOptions.baseline = SampleFileCreateWithPath(sampleOptions.comparePath)) ) exit(EINVAL);
+        INFO("Comparing with baseline %s (%u column(s)), regression threshold %lg%%",
+                sampleOptions.comparePath, SampleFileGetColumnCount(sampleOptions.baseline), 100.0 * sampleOptions.regressionThreshold);
+    }
+
+    //
+    // Allocate matrices:
+    //
+    if ( ! AllocateMatrices(n, shouldAlign, allocAlign, &A, &B, &C) ) {
+        ERROR("unable to allocate matrices");
+        exit(1);
+    }
+
+    //
+    // If no explicit nthreads has been specified, get it from the env:
     //
 #ifdef HAVE_OPENMP
     if ( nthreads <= 0 ) nthreads = omp_get_max_threads();
@@ -569,6 +2384,199 @@ main(
     INFO("Threaded routines will use %d thread(s)", nthreads);
 #endif
 
+    benchmark = (BenchmarkContext){
+                    .initObj = matrixInitMethod,
+                    .initTimer = matInitTimer,
+                    .warmupTimer = warmupTimer,
+                    .warmupInitTimer = warmupInitTimer,
+                    .nloop = nloop,
+                    .maxNloop = maxNloop,
+                    .nwarmup = nwarmup,
+                    .targetCI = targetCI,
+#ifdef HAVE_OPENMP
+                    .nthreads = nthreads,
+#else
+                    .nthreads = 1,
+#endif
+                    .alpha = alpha,
+                    .beta = beta,
+                    .A = A,
+                    .B = B,
+                    .C = C,
+                    .samples = NULL
+                };
+    if ( (sampleOptions.path || sampleOptions.csvPath || sampleOptions.baselinePath || sampleOptions.comparePath) && ! (benchmark.samples = SampleFileCreate()) ) {
+        ERROR("unable to allocate raw samples");
+        exit(ENOMEM);
+    }
+
+    //
+    // Record the context of the run ahead of its results:
+    //
+    if ( ! (manifest = RunManifestCreate()) ) {
+        ERROR("unable to allocate run manifest");
+        exit(ENOMEM);
+    }
+    {
+        size_t              commandLen = 1;
+        char                *command, *p;
+        int                 argi;
+
+        for ( argi = 0; argi < argc; argi++ ) commandLen += strlen(argv[argi]) + 1;
+        if ( (p = command = (char*)malloc(commandLen)) ) {
+            for ( argi = 0; argi < argc; argi++ ) p += sprintf(p, "%s%s", argi ? " " : "", argv[argi]);
+            RunManifestSetValue(manifest, "run.command", "%s", command);
+            free((void*)command);
+        }
+    }
+    RunManifestSetValue(manifest, "run.threads", "%d", benchmark.nthreads);
+    RunManifestSetValue(manifest, "run.clock", "%s", ExecutionTimerClockToString(ExecutionTimerGetClock(matMulTimer)));
+
+    //
+    // Everything but the screening record goes through the result emitter;
+    // in JSON and YAML the configuration leads the document:
+    //
+    if ( ! shouldScreen ) {
+        if ( ! (results = ResultEmitterCreate(timerOutputFormat, stdout)) ) {
+            ERROR("unable to allocate results");
+            exit(ENOMEM);
+        }
+        OpenResults = results;
+        atexit(FinishOpenResultsAtExit);
+        if ( ResultEmitterIsStructured(results) ) {
+            BeginResultSection(results, "config", NULL);
+            ResultEmitterSetString(results, "mode", shouldTune ? "tune" : (dimensionSweep ? "dimension-sweep" : (threadSweep ? "thread-sweep" : "methods")));
+            ResultEmitterSetString(results, "init", MatrixInitObjectGetName(matrixInitMethod));
+            ResultEmitterSetString(results, "routines", MultiplyMethodListGetString(multiplyMethods));
+            ResultEmitterSetInteger(results, "n", (long)n);
+            if ( dimensionSweep ) SetResultSweep(results, "dimensions", dimensionSweep);
+            if ( threadSweep ) {
+                SetResultSweep(results, "thread_counts", threadSweep);
+                ResultEmitterSetString(results, "scaling", isWeakScaling ? "weak" : "strong");
+            }
+            ResultEmitterSetInteger(results, "threads", (long)benchmark.nthreads);
+            ResultEmitterSetInteger(results, "nloop", (long)nloop);
+            ResultEmitterSetInteger(results, "max_nloop", (long)maxNloop);
+            ResultEmitterSetInteger(results, "warmup", (long)nwarmup);
+            ResultEmitterSetReal(results, "target_ci", targetCI);
+            ResultEmitterSetInteger(results, "alignment", shouldAlign ? (long)allocAlign : 0);
+            ResultEmitterSetReal(results, "alpha", (double)alpha);
+            ResultEmitterSetReal(results, "beta", (double)beta);
+            ResultEmitterSetString(results, "precision", (sizeof(f_real) == 8) ? "double" : "single");
+            ResultEmitterSetString(results, "clock", ExecutionTimerClockToString(ExecutionTimerGetClock(matMulTimer)));
+            ResultEmitterSetInteger(results, "subtract_overhead", shouldSubtractOverhead ? 1 : 0);
+            ResultEmitterEndSection(results);
+        }
+        if ( shouldWriteManifest ) {
+            RunManifestSummarizeToStream(manifest, timerOutputFormat, BeginResultSection(results, "manifest", "Run manifest"));
+            ResultEmitterEndSection(results);
+        }
+    }
+
+    //
+    // Characterize the machine (with the thread count the routines will use):
+    //
+    if ( shouldProbe ) {
+        MachineInfoRef      machine = MachineInfoCreate();
+
+        if ( ! machine ) {
+            ERROR("unable to gather machine information");
+            exit(ENOMEM);
+        }
+        INFO("%s machine with %d thread(s)", shouldReprobe ? "Probing" : "Loading or probing", benchmark.nthreads);
+        machineProbe = MachineProbeCreateWithCache(machine, benchmark.nthreads, NULL, shouldReprobe);
+        MachineInfoRelease(machine);
+        if ( ! machineProbe ) {
+            ERROR("unable to probe the machine");
+            exit(1);
+        }
+        if ( results ) {
+            MachineProbeSummarizeToStream(machineProbe, timerOutputFormat, BeginResultSection(results, "machine", MachineProbeIsCached(machineProbe) ? "Machine characterization (cached)" : "Machine characterization (measured)"));
+            ResultEmitterSetString(results, "source", MachineProbeIsCached(machineProbe) ? "cached" : "measured");
+            ResultEmitterEndSection(results);
+        }
+    }
+
+    //
+    // Screening produces only its JSON record:
+    //
+    if ( shouldScreen ) {
+        bool                isScreened = RunScreen(&benchmark, multiplyMethods, matMulTimer, n, manifest);
+
+        rc = FinishSamples(&benchmark, (long)n, &sampleOptions, NULL);
+        MultiplyMethodListDestroy(&multiplyMethods);
+        MatrixInitObjectRelease(matrixInitMethod);
+        RunManifestRelease(manifest);
+        return isScreened ? rc : 1;
+    }
+
+    //
+    // Tuning covers the dimension sweep (if any) or the single dimension:
+    //
+    if ( shouldTune ) {
+        MachineInfoRef      machine = MachineInfoCreate();
+        TuningCacheRef      tuningCache;
+        bool                isSaved;
+
+        if ( ! machine ) {
+            ERROR("unable to gather machine information");
+            exit(ENOMEM);
+        }
+        INFO("Hardware fingerprint: %s", MachineInfoGetFingerprint(machine));
+        if ( ! (tuningCache = TuningCacheCreate(tuningCachePath, MachineInfoGetFingerprint(machine))) ) exit(EINVAL);
+        INFO("Tuning cache: %s (%u record(s) for this hardware)", TuningCacheGetPath(tuningCache), TuningCacheGetCount(tuningCache));
+        if ( ! dimensionSweep ) {
+            char            nStr[32];
+
+            snprintf(nStr, sizeof(nStr), FMT_F_INTEGER, n);
+            dimensionSweep = ParameterSweepCreate("n", nStr);
+        }
+        RunTuning(&benchmark, multiplyMethods, dimensionSweep, tuneBudget, tuningCache, matMulTimer, timerOutputFormat, BeginResultSection(results, "tuning", NULL));
+        ResultEmitterEndSection(results);
+        isSaved = TuningCacheSave(tuningCache);
+        rc = FinishSamples(&benchmark, 0, &sampleOptions, results);
+        if ( isSaved ) INFO("Tuning results saved to %s", TuningCacheGetPath(tuningCache));
+        TuningCacheRelease(tuningCache);
+        MachineInfoRelease(machine);
+        if ( machineProbe ) MachineProbeRelease(machineProbe);
+        ParameterSweepRelease(dimensionSweep);
+        MultiplyMethodListDestroy(&multiplyMethods);
+        MatrixInitObjectRelease(matrixInitMethod);
+        RunManifestRelease(manifest);
+        return FinishResults(results, isSaved ? rc : 1);
+    }
+
+    //
+    // A dimension sweep produces a single table of results:
+    //
+    if ( dimensionSweep ) {
+        RunDimensionSweep(&benchmark, multiplyMethods, dimensionSweep, matMulTimer, timerOutputFormat, machineProbe ? &roofline : NULL, BeginResultSection(results, "sweep", NULL));
+        ResultEmitterEndSection(results);
+        if ( machineProbe ) {
+            RooflineSummarize(&roofline, machineProbe, timerOutputFormat, BeginResultSection(results, "roofline", "Roofline"));
+            ResultEmitterEndSection(results);
+            MachineProbeRelease(machineProbe);
+        }
+        ParameterSweepRelease(dimensionSweep);
+        MultiplyMethodListDestroy(&multiplyMethods);
+        rc = FinishSamples(&benchmark, 0, &sampleOptions, results);
+        MatrixInitObjectRelease(matrixInitMethod);
+        RunManifestRelease(manifest);
+        return FinishResults(results, rc);
+    }
+    if ( threadSweep ) {
+        RunThreadSweep(&benchmark, multiplyMethods, threadSweep, baseN, isWeakScaling, matMulTimer, timerOutputFormat, BeginResultSection(results, "scaling", NULL));
+        ResultEmitterEndSection(results);
+        // The probe's roofs only apply at its own thread count:
+        if ( machineProbe ) MachineProbeRelease(machineProbe);
+        ParameterSweepRelease(threadSweep);
+        MultiplyMethodListDestroy(&multiplyMethods);
+        rc = FinishSamples(&benchmark, isWeakScaling ? 0 : (long)baseN, &sampleOptions, results);
+        MatrixInitObjectRelease(matrixInitMethod);
+        RunManifestRelease(manifest);
+        return FinishResults(results, rc);
+    }
+
     //
     // Loop over the list of methods:
     //
@@ -580,36 +2588,66 @@ main(
 
         iterMultiplyMethods = MultiplyMethodListIter(iterMultiplyMethods, &methodStr, &methodStrLen);
         if ( (multMethod = MatrixMultiplyObjectCreate(methodStr)) ) {
-            printf("Starting test of methods: %s, %s\n\n", MatrixInitObjectGetName(matrixInitMethod), MatrixMultiplyObjectGetName(multMethod));
-            ExecutionTimerReset(matMulTimer);
-            for ( loop = 0; loop < nloop; loop++ ) {
-                if ( ! MatrixInitObjectInit(matrixInitMethod, matInitTimer, nthreads, n, A) ||
-                     ! MatrixInitObjectInit(matrixInitMethod, matInitTimer, nthreads, n, B) ||
-                     ! MatrixInitObjectInit(matrixInitMethod, matInitTimer, nthreads, n, C)
-                ) {
-                    ERROR("failure in iteration %ld of %s init method", (long)loop, initMethod);
-                    exit(1);
-                }
-                if ( ! MatrixMultiplyObjectMultiply(multMethod, matMulTimer, nthreads, n, alpha, A, B, beta, C) ) {
-                    ERROR("failure in iteration %ld of %s multiplication method", (long)loop, methodStr);
-                    exit(1);
-                }
-            }
-            ExecutionTimerSummarizeToStream(matMulTimer, timerOutputFormat, MatrixMultiplyObjectGetName(multMethod), stdout);
+            f_integer           nwarmupActual;
+            FILE                *stream;
+
+            PROGRESS("Starting test of methods: %s, %s", MatrixInitObjectGetName(matrixInitMethod), MatrixMultiplyObjectGetName(multMethod));
+            loop = MeasureMethod(&benchmark, multMethod, matMulTimer, n, &nwarmupActual);
+            PROGRESS("Warm-up iterations discarded: " FMT_F_INTEGER ", timed iterations: " FMT_F_INTEGER, nwarmupActual, loop);
+            stream = BeginResultSection(results, "method", NULL);
+            ResultEmitterSetString(results, "init", MatrixInitObjectGetName(matrixInitMethod));
+            ResultEmitterSetString(results, "method", MatrixMultiplyObjectGetName(multMethod));
+            ResultEmitterSetInteger(results, "n", (long)n);
+            ResultEmitterSetInteger(results, "warmup_iterations", (long)nwarmupActual);
+            ResultEmitterSetInteger(results, "iterations", (long)loop);
+            if ( ExecutionTimerHasStatistics(matMulTimer) ) {
+                double  ci = ExecutionTimerGetValue(matMulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueMeanCI95);
+                double  avg = ExecutionTimerGetValue(matMulTimer, ExecutionTimerMetricWalltime, ExecutionTimerValueAverage);
+
+                PROGRESS("Average walltime 95%% confidence interval: %lg +/- %lg (%lg%%)", avg, ci, 100.0 * ci / avg);
+            }
+            PROGRESS("");
+            ExecutionTimerSummarizeToStream(matMulTimer, timerOutputFormat, MatrixMultiplyObjectGetName(multMethod), stream);
+            ResultEmitterEndSection(results);
+            if ( ! ExecutionTimerIsReliable(matMulTimer) ) {
+                WARN("%s walltime is within %dx of the timer overhead; consider --batch", MatrixMultiplyObjectGetName(multMethod), 10);
+            }
+            if ( machineProbe ) RooflineAddPoint(&roofline, MatrixMultiplyObjectGetName(multMethod), n, matMulTimer);
+            if ( nwarmupActual > 0 ) {
+                char        warmupName[strlen(MatrixMultiplyObjectGetName(multMethod)) + 16];
+
+                snprintf(warmupName, sizeof(warmupName), "%s warm-up", MatrixMultiplyObjectGetName(multMethod));
+                stream = BeginResultSection(results, "warm-up", NULL);
+                ResultEmitterSetString(results, "method", MatrixMultiplyObjectGetName(multMethod));
+                ResultEmitterSetInteger(results, "n", (long)n);
+                ExecutionTimerSummarizeToStream(warmupTimer, timerOutputFormat, warmupName, stream);
+                ResultEmitterEndSection(results);
+            }
             MatrixMultiplyObjectRelease(multMethod);
-            printf("\n\n");
         } else {
             ERROR("no such multiplication method: %s", methodStr);
             exit(EINVAL);
         }
     }
 
-    printf("Matrix initialization timing results:\n\n");
-    ExecutionTimerSummarizeToStream(matInitTimer, timerOutputFormat, MatrixInitObjectGetName(matrixInitMethod), stdout);
-    printf("\n\n");
+    if ( machineProbe ) {
+        if ( roofline.nPoints > 0 ) {
+            RooflineSummarize(&roofline, machineProbe, timerOutputFormat, BeginResultSection(results, "roofline", "Roofline"));
+            ResultEmitterEndSection(results);
+        }
+        MachineProbeRelease(machineProbe);
+    }
+
+    ExecutionTimerSummarizeToStream(matInitTimer, timerOutputFormat, MatrixInitObjectGetName(matrixInitMethod),
+            BeginResultSection(results, "init", "Matrix initialization timing results"));
+    ResultEmitterSetString(results, "init", MatrixInitObjectGetName(matrixInitMethod));
+    ResultEmitterSetInteger(results, "n", (long)n);
+    ResultEmitterEndSection(results);
 
     MultiplyMethodListDestroy(&multiplyMethods);
+    rc = FinishSamples(&benchmark, (long)n, &sampleOptions, results);
     MatrixInitObjectRelease(matrixInitMethod);
+    RunManifestRelease(manifest);
 
-    return 0;
+    return FinishResults(results, rc);
 }